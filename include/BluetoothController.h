@@ -6,6 +6,18 @@
 #include "LightBelt.h"
 #include "ServoPlatformInter.h"
 #include "ServoPlatform.h"  // 添加外部驱动平台的头文件
+#include "Timeline.h"
+#include "ShowPlayer.h"
+#include "JitterBuffer.h"
+#include "Telemetry.h"
+#include "PixelReceiver.h"
+#include "LayerMap.h"
+#include "Compositor.h"
+#include "EffectVM.h"
+#include "OutputLatch.h"
+#include "IdleGovernor.h"
+#include "Scheduler.h"
+#include "LatencyTrace.h"
 
 /**
  * @class BluetoothController
@@ -30,6 +42,31 @@ private:
     bool isConnected;                ///< 蓝牙连接状态
     uint32_t lastActivityTime;       ///< 最后一次活动时间
     uint32_t disconnectTimeout;      ///< 断开连接超时时间（毫秒）
+    Timeline timeline;               ///< 关键帧时间线
+    ShowPlayer showPlayer;           ///< SPIFFS演出播放器
+    JitterBuffer followBuffer;       ///< 带时间戳Follow参数的抖动缓冲区
+    Telemetry telemetry;             ///< 二进制遥测流
+    PixelReceiver* pixelReceiver;    ///< 网络像素接收器（未启用Wi-Fi时为空）
+    LayerMap layerMap;               ///< 舵机层到灯带LED的映射
+    Compositor compositor;           ///< Layers模式的效果层
+    EffectVM effectVM;               ///< Effect模式的用户效果程序
+    OutputLatch outputLatch;         ///< 每帧同步释放舵机和灯带输出
+    IdleGovernor governor;           ///< 按当前模式和输出变化决定帧间隔
+    Scheduler scheduler;             ///< 命令、舵机、灯带三个任务各自的周期
+    LatencyTrace latency;            ///< 命令到舵机和灯带输出的延迟
+    const char* deviceName;          ///< 蓝牙设备名称
+    volatile bool transportReady;    ///< 蓝牙协议栈是否已在后台任务中初始化完成
+    
+    /**
+     * @brief 后台初始化蓝牙协议栈的任务
+     * @param arg BluetoothController指针
+     */
+    static void transportTask(void* arg);
+    
+    /**
+     * @brief 连接后恢复上次保存的模式，未保存过时为Idle
+     */
+    void restoreBootMode();
     
     /**
      * @brief 处理接收到的命令 
@@ -56,6 +93,18 @@ private:
      */
     void sendStatus();
     
+    /**
+     * @brief 采集当前状态并发送一帧遥测数据
+     */
+    void sendTelemetry();
+    
+    /**
+     * @brief 按映射表设置一层舵机对应的全部灯带
+     * @param servoLayer 舵机层号
+     * @param color 32位RGB颜色值
+     */
+    void setServoLayerColor(uint8_t servoLayer, uint32_t color);
+    
     /**
      * @brief 处理断开连接状态
      * @details 设置所有舵机为最小角度，LED为蓝色常亮
@@ -68,6 +117,23 @@ private:
      */
     bool checkConnection();
 
+    /**
+     * @brief 当前模式对帧率的需求，供空闲调速使用
+     */
+    FrameActivity frameActivity() const;
+    
+    /**
+     * @brief 设置各任务的周期
+     */
+    void initScheduler();
+    
+    /**
+     * @brief 运行当前模式并输出到期的舵机或灯带
+     * @param servoDue 舵机输出是否到期
+     * @param ledDue 灯带输出是否到期
+     */
+    void renderFrame(bool servoDue, bool ledDue);
+
 public:
     /**
      * @brief 构造函数 - 使用内部PWM
@@ -89,11 +155,55 @@ public:
     
     /**
      * @brief 初始化蓝牙模块
+     * @details 先输出断开状态的第一帧，蓝牙协议栈在核心0的后台任务中初始化，完成前不处理蓝牙数据
      * 
-     * @param deviceName 蓝牙设备名称，默认为"ESP32-Lightbelt"
+     * @param deviceName 蓝牙设备名称，默认为"ESP32-Lightbelt"，需在控制器生命周期内有效
      */
     void begin(const char* deviceName = "ESP32-Lightbelt");
     
+    /**
+     * @brief 设置网络像素接收器，启用Network模式
+     * @param receiver 接收器指针
+     */
+    void setPixelReceiver(PixelReceiver* receiver) { pixelReceiver = receiver; }
+    
+    /**
+     * @brief 获取舵机层到灯带LED的映射表
+     * @details 构造时按层数比例生成，灯带接线不规则时可在begin()之前用clear()/add()重新指定
+     */
+    LayerMap& getLayerMap() { return layerMap; }
+    
+    /**
+     * @brief 获取Layers模式的效果层
+     */
+    Compositor& getCompositor() { return compositor; }
+    
+    /**
+     * @brief 获取舵机与灯带输出的同步统计
+     */
+    const OutputLatch& getOutputLatch() const { return outputLatch; }
+    
+    /**
+     * @brief 获取空闲调速的统计
+     */
+    const IdleGovernor& getIdleGovernor() const { return governor; }
+    
+    /**
+     * @brief 获取各任务的周期和执行统计
+     */
+    const Scheduler& getScheduler() const { return scheduler; }
+    
+    /**
+     * @brief 获取命令延迟的统计
+     */
+    const LatencyTrace& getLatencyTrace() const { return latency; }
+    
+    /**
+     * @brief 等待到下一帧，在主循环中update()之后调用
+     * @details 等到舵机或灯带的下一次输出，低活动模式或输出不变时等待更久，收到命令立即返回
+     */
+    void waitForNextFrame() { governor.wait(BT, scheduler.untilNext(micros())); }
+    
     /**
      * @brief 更新处理蓝牙命令
      * 
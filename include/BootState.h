@@ -0,0 +1,67 @@
+#ifndef BOOT_STATE_H
+#define BOOT_STATE_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 重启后需要恢复的设置
+ */
+struct BootSettings {
+    uint8_t i2cAddress;     ///< 上次找到的PCA9685地址，0表示未知
+    float brightness;       ///< LED最大亮度（0.0-1.0）
+    bool reverseAngle;      ///< 舵机角度反转
+    char mode[10];          ///< 预设模式名或Follow
+    int params[6];          ///< Follow参数
+};
+
+/**
+ * @brief 保存在NVS中的启动状态
+ * @details 启动时读取一次，之后由控制器在设置变化时更新内存中的副本，
+ * update()在设置静默BOOT_STATE_SAVE_DELAY_MS后统一写入NVS。
+ * USE_BOOT_STATE为false时只使用GlobalConfig.h中的默认值，不读写NVS。
+ */
+class BootState {
+public:
+    /**
+     * @brief 从NVS读取设置，没有保存过的项使用默认值
+     */
+    static void begin();
+
+    /**
+     * @brief 到期时写入NVS，需要在主循环中调用
+     */
+    static void update();
+
+    /**
+     * @brief 立即写入尚未保存的设置
+     */
+    static void flush();
+
+    static const BootSettings& get() { return settings; }
+
+    static void setI2CAddress(uint8_t address);
+    static void setBrightness(float brightness);
+    static void setReverseAngle(bool reverse);
+
+    /**
+     * @brief 记录当前模式，只保存重启后可以直接恢复的预设模式和Follow
+     * @param mode 模式名
+     * @param params Follow参数，其他模式可为NULL
+     */
+    static void setMode(const char* mode, const int* params);
+
+    /**
+     * @brief 模式是否可以在重启后恢复
+     */
+    static bool isRestorable(const char* mode);
+
+private:
+    static void markDirty();
+
+    static BootSettings settings;
+    static bool dirty;
+    static uint32_t lastChange;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file ClockSync.h
+ * @brief 多机时钟同步的数据包格式与偏差/漂移估计
+ *
+ * @details 主机周期性广播自己的演出时钟（微秒），从机以收到数据包时的本地时钟为对照，
+ * 对最近若干个(本地时间, 偏差)样本做线性回归，得到偏差和漂移率，从而把本地时钟换算为
+ * 主机的演出时钟。网络延迟只会让样本偏小，明显偏离拟合直线的样本视为被延迟的包丢弃。
+ * 不依赖Arduino，可以在上位机上编译，用于模拟多台设备验证收敛速度和精度。
+ */
+
+#define CLOCK_SYNC_PORT 5570
+#define CLOCK_SYNC_PACKET_SIZE 16
+
+/**
+ * @brief 写入时钟同步包：'L''B''C''K' | 版本 | 序号 | 保留(2) | 主机时钟us(8，小端)
+ */
+static inline void clockSyncWritePacket(uint8_t* buf, uint8_t sequence, int64_t leaderUs) {
+    memcpy(buf, "LBCK", 4);
+    buf[4] = 1;
+    buf[5] = sequence;
+    buf[6] = 0;
+    buf[7] = 0;
+    uint64_t value = (uint64_t)leaderUs;
+    for (uint8_t i = 0; i < 8; i++) {
+        buf[8 + i] = value >> (8 * i);
+    }
+}
+
+/**
+ * @brief 解析时钟同步包
+ * @return 格式正确返回true
+ */
+static inline bool clockSyncParsePacket(const uint8_t* buf, size_t len, uint8_t& sequence, int64_t& leaderUs) {
+    if (len < CLOCK_SYNC_PACKET_SIZE || memcmp(buf, "LBCK", 4) != 0 || buf[4] != 1) return false;
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        value |= (uint64_t)buf[8 + i] << (8 * i);
+    }
+    sequence = buf[5];
+    leaderUs = (int64_t)value;
+    return true;
+}
+
+/**
+ * @class ClockSync
+ * @brief 从机时钟估计器
+ */
+class ClockSync {
+public:
+    static const uint8_t WINDOW = 32;               ///< 参与回归的样本数，越多漂移率越准但跟随温漂越慢
+    static const int32_t OUTLIER_US = 2000;         ///< 偏离拟合值超过该值的样本丢弃
+    static const uint8_t RESET_AFTER = 3;           ///< 连续丢弃该数量的样本后重新同步（主机重启等）
+    static const int32_t MAX_SKEW_PPB = 500000;     ///< 漂移率上限（500ppm）
+
+    ClockSync() { reset(); }
+
+    void reset() {
+        count = 0;
+        head = 0;
+        outliers = 0;
+        rejected = 0;
+        baseLocal = 0;
+        baseOffset = 0;
+        skewPpb = 0;
+        lastResidual = 0;
+    }
+
+    /**
+     * @brief 加入一个同步样本
+     * @param leaderUs 包中携带的主机时钟
+     * @param localUs 收到包时的本地时钟
+     * @return 样本被采用返回true
+     */
+    bool addSample(int64_t leaderUs, int64_t localUs) {
+        int64_t offset = leaderUs - localUs;
+
+        // 相邻样本间隔约1秒，即使漂移率尚未估准，预测误差也远小于离群阈值
+        if (count > 0) {
+            int64_t residual = offset - offsetAt(localUs);
+            lastResidual = (int32_t)residual;
+            if (residual < -OUTLIER_US || residual > OUTLIER_US) {
+                rejected++;
+                if (++outliers < RESET_AFTER) return false;
+                uint32_t total = rejected;
+                reset();
+                rejected = total;
+            }
+        }
+        outliers = 0;
+
+        sampleLocal[head] = localUs;
+        sampleOffset[head] = offset;
+        head = (head + 1) % WINDOW;
+        if (count < WINDOW) count++;
+
+        fit();
+        return true;
+    }
+
+    /**
+     * @brief 把本地时钟换算为演出时钟，未同步时返回本地时钟
+     */
+    int64_t toShow(int64_t localUs) const {
+        return localUs + offsetAt(localUs);
+    }
+
+    bool isSynced() const { return count >= 2; }
+    uint8_t getSampleCount() const { return count; }
+    uint32_t getRejected() const { return rejected; }
+    int32_t getSkewPpb() const { return skewPpb; }
+    int32_t getLastResidual() const { return lastResidual; }
+    int64_t getOffset(int64_t localUs) const { return offsetAt(localUs); }
+
+private:
+    int64_t sampleLocal[WINDOW];
+    int64_t sampleOffset[WINDOW];
+    uint8_t count;
+    uint8_t head;
+    uint8_t outliers;
+    uint32_t rejected;
+
+    int64_t baseLocal;          ///< 回归中心的本地时间
+    int64_t baseOffset;         ///< 回归中心的偏差
+    int32_t skewPpb;            ///< 漂移率（十亿分之一）
+    int32_t lastResidual;
+
+    int64_t offsetAt(int64_t localUs) const {
+        if (count == 0) return 0;
+        return baseOffset + (localUs - baseLocal) * skewPpb / 1000000000;
+    }
+
+    /**
+     * @brief 最小二乘拟合偏差随本地时间的变化，每秒只运行一次，可以使用浮点数
+     */
+    void fit() {
+        // 以最新样本为参照减小数值范围
+        uint8_t newest = (head + WINDOW - 1) % WINDOW;
+        int64_t refLocal = sampleLocal[newest];
+        int64_t refOffset = sampleOffset[newest];
+
+        double meanX = 0, meanY = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            meanX += (double)(sampleLocal[i] - refLocal);
+            meanY += (double)(sampleOffset[i] - refOffset);
+        }
+        meanX /= count;
+        meanY /= count;
+
+        double sxx = 0, sxy = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            double dx = (double)(sampleLocal[i] - refLocal) - meanX;
+            double dy = (double)(sampleOffset[i] - refOffset) - meanY;
+            sxx += dx * dx;
+            sxy += dx * dy;
+        }
+
+        double skew = sxx > 0 ? sxy / sxx * 1e9 : 0;
+        if (skew > MAX_SKEW_PPB) skew = MAX_SKEW_PPB;
+        if (skew < -MAX_SKEW_PPB) skew = -MAX_SKEW_PPB;
+
+        skewPpb = (int32_t)skew;
+        baseLocal = refLocal + (int64_t)meanX;
+        baseOffset = refOffset + (int64_t)meanY;
+    }
+};
+
+#endif
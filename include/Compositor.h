@@ -0,0 +1,156 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+#include "LayerMap.h"
+#include "Palette.h"
+
+/**
+ * @brief 效果层的内容
+ */
+enum LayerEffect : uint8_t {
+    EFFECT_OFF = 0,         ///< 不参与合成
+    EFFECT_SOLID,           ///< 调色板最亮端的纯色
+    EFFECT_RAINBOW,         ///< 与Rainbow模式相同，各层灯带在调色板上错开循环
+    EFFECT_BREATHING,       ///< 与Idle/Standby模式相同，整条灯带按正弦在调色板上往复
+    EFFECT_PULSE,           ///< 与Heatup模式相同，每层舵机对应的灯带按三角波交替明暗
+    EFFECT_HIGHLIGHT,       ///< 只覆盖正在运动的舵机层对应的灯带，其余部分透明
+    EFFECT_COUNT
+};
+
+/**
+ * @brief 效果层与下方结果的混合方式
+ */
+enum BlendMode : uint8_t {
+    BLEND_REPLACE = 0,      ///< 覆盖下方，颜色乘以不透明度
+    BLEND_ADD,              ///< 饱和相加，加上的颜色乘以不透明度
+    BLEND_MULTIPLY,         ///< 与下方相乘，按不透明度与下方混合
+    BLEND_ALPHA,            ///< 按不透明度与下方线性混合
+    BLEND_COUNT
+};
+
+/**
+ * @brief 一个效果层的设置
+ */
+struct EffectLayer {
+    LayerEffect effect;
+    BlendMode blend;
+    uint8_t opacity;        ///< 0-255
+    uint8_t paletteSlot;    ///< Palettes的槽位
+    uint32_t periodMs;      ///< 动画周期
+};
+
+/**
+ * @brief 效果层在一段连续LED上的颜色
+ */
+struct CompositorRun {
+    uint16_t end;           ///< 颜色不变的最后一个LED之后
+    uint8_t rgb[3];
+    uint8_t coverage;       ///< 0为透明，255为完全覆盖
+};
+
+/**
+ * @brief 多个效果层的叠加
+ * @details 效果层从下到上依次与下方结果混合。每层每帧只在prepare()中计算一次各层灯带或各舵机层的颜色，
+ * 合成时由LightBelt::compose()从第一个LED向后逐段推进：每层给出从当前位置起颜色不变的一段，
+ * 取各层中最短的一段混合一次后整段填充，因此不需要每层一个整帧缓冲区，耗时随层数线性增长。
+ * Highlight层跟随trackServos()中输出变化最大的舵机层，舵机静止时保持上一次的层。
+ */
+class Compositor {
+public:
+    static const uint8_t MAX_LAYERS = COMPOSITOR_MAX_LAYERS;
+
+    /**
+     * @brief 构造函数，默认为Rainbow底层上叠加Heatup脉冲
+     */
+    Compositor();
+
+    /**
+     * @brief 关闭所有效果层
+     */
+    void clear();
+
+    /**
+     * @brief 设置一个效果层
+     * @return 编号、效果或混合方式超出范围时返回false
+     */
+    bool setLayer(int index, int effect, int blend, int opacity, int paletteSlot, uint32_t periodMs);
+
+    /**
+     * @brief 解析并设置一个效果层
+     * @param args 格式为"编号|效果|混合|不透明度|槽位|周期ms"，效果和混合为名称（如Pulse、Add），
+     * 不透明度默认255，槽位默认为效果对应模式的内置调色板，周期默认3000
+     * @return 设置的层编号，格式错误时返回-1
+     */
+    int setLayer(const char* args);
+
+    const EffectLayer& getLayer(uint8_t index) const { return layers[index]; }
+
+    /**
+     * @brief 参与合成的层数（最上面一个未关闭的层编号+1）
+     */
+    uint8_t getLayerCount() const;
+
+    /**
+     * @brief 记录各舵机层当前的输出，找出正在运动的层
+     * @param ticks 每层舵机第一个通道的输出值
+     * @param servoLayers 舵机层数
+     */
+    void trackServos(const uint16_t* ticks, uint8_t servoLayers);
+
+    /**
+     * @brief 正在运动的舵机层，还没有运动过时返回-1
+     */
+    int8_t getMovingServoLayer() const { return movingLayer; }
+
+    /**
+     * @brief 计算本帧各效果层的颜色
+     * @param now 演出时钟
+     * @param map 舵机层到灯带的映射，合成期间需保持有效
+     * @param lightLayers 灯带层数
+     * @param ledsPerLayer 每层LED数量
+     * @param maxBrightness 灯带的最大亮度限制，Breathing和Pulse的颜色额外乘以该值，
+     * 与Idle/Standby/Heatup模式中的dimColor(颜色, 255)一致
+     */
+    void prepare(uint32_t now, const LayerMap& map, uint8_t lightLayers, uint8_t ledsPerLayer, float maxBrightness);
+
+    /**
+     * @brief 效果层从指定LED开始的一段颜色
+     */
+    void run(uint8_t index, uint16_t led, CompositorRun& out) const;
+
+    /**
+     * @brief 把效果层的一段颜色混合到下方结果上
+     * @param index 效果层编号
+     * @param run 该层的颜色
+     * @param rgb 下方结果，混合后写回
+     */
+    void apply(uint8_t index, const CompositorRun& run, uint8_t* rgb) const;
+
+    static const char* effectName(uint8_t effect);
+    static const char* blendName(uint8_t blend);
+
+private:
+    /**
+     * @brief 舵机层效果（Pulse/Highlight）在指定LED处的一段
+     */
+    void servoRun(uint8_t index, uint16_t led, CompositorRun& out) const;
+
+    EffectLayer layers[MAX_LAYERS];
+
+    // 以下由prepare()每帧计算
+    uint8_t frameColor[MAX_LAYERS][3];                              ///< Solid/Breathing/Highlight的颜色
+    uint8_t servoColor[MAX_LAYERS][LAYER_MAP_MAX_SERVO_LAYERS][3];  ///< Pulse各舵机层的颜色
+    uint8_t wheelPos[MAX_LAYERS];                                   ///< Rainbow的起始位置
+    const LayerMap* layerMap;
+    uint8_t lightLayers;
+    uint8_t ledsPerLayer;
+    uint16_t ledCount;
+
+    uint16_t lastTicks[LAYER_MAP_MAX_SERVO_LAYERS];
+    uint8_t trackedLayers;      ///< lastTicks中有效的层数
+    int8_t movingLayer;
+};
+
+#endif
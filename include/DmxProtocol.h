@@ -0,0 +1,129 @@
+#ifndef DMX_PROTOCOL_H
+#define DMX_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @file DmxProtocol.h
+ * @brief E1.31 (sACN) 与 Art-Net 数据包解析
+ *
+ * @details 只做原地解析，不复制数据：解析结果中的通道数据指针直接指向收到的UDP负载。
+ * 不依赖Arduino，可以在上位机上编译。
+ */
+
+#define E131_PORT 5568
+#define ARTNET_PORT 6454
+#define DMX_UNIVERSE_SIZE 512
+
+enum DmxPacketType : uint8_t {
+    DMX_PACKET_INVALID = 0,
+    DMX_PACKET_DATA,        ///< 一个universe的通道数据
+    DMX_PACKET_SYNC         ///< 同步包，收到后统一输出
+};
+
+/**
+ * @brief 解析结果
+ */
+struct DmxPacket {
+    DmxPacketType type;
+    uint16_t universe;          ///< universe编号（Art-Net为15位端口地址）
+    uint8_t sequence;           ///< 序号，0表示发送方未启用
+    uint16_t syncAddress;       ///< E1.31同步地址，非0表示发送方会发送同步包
+    const uint8_t* data;        ///< 指向第一个通道（DMX地址1）
+    uint16_t length;            ///< 通道数
+};
+
+static inline uint16_t dmxRead16BE(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+static inline uint32_t dmxRead32BE(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * @brief 解析E1.31数据包或同步包
+ */
+static inline bool dmxParseE131(const uint8_t* buf, size_t len, DmxPacket& packet) {
+    static const uint8_t ACN_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    if (len < 49 || dmxRead16BE(buf) != 0x0010 || memcmp(buf + 4, ACN_ID, 12) != 0) return false;
+
+    uint32_t rootVector = dmxRead32BE(buf + 18);
+
+    // 扩展包中的同步包：根向量0x08，帧向量0x01
+    if (rootVector == 0x00000008) {
+        if (dmxRead32BE(buf + 40) != 0x00000001) return false;
+        packet.type = DMX_PACKET_SYNC;
+        packet.sequence = buf[44];
+        packet.syncAddress = dmxRead16BE(buf + 45);
+        packet.universe = 0;
+        packet.data = NULL;
+        packet.length = 0;
+        return true;
+    }
+
+    // 数据包：根向量0x04，帧向量0x02，DMP向量0x02，起始码必须为0
+    if (rootVector != 0x00000004 || len < 126) return false;
+    if (dmxRead32BE(buf + 40) != 0x00000002 || buf[117] != 0x02 || buf[125] != 0) return false;
+
+    // 选项位6为Stream_Terminated，位5为Preview_Data，都不输出
+    if (buf[112] & 0x60) return false;
+
+    uint16_t count = dmxRead16BE(buf + 123);
+    if (count < 1 || 125 + (size_t)count > len) return false;
+
+    packet.type = DMX_PACKET_DATA;
+    packet.syncAddress = dmxRead16BE(buf + 109);
+    packet.sequence = buf[111];
+    packet.universe = dmxRead16BE(buf + 113);
+    packet.data = buf + 126;
+    packet.length = count - 1;
+    if (packet.length > DMX_UNIVERSE_SIZE) packet.length = DMX_UNIVERSE_SIZE;
+    return true;
+}
+
+/**
+ * @brief 解析Art-Net的ArtDmx或ArtSync包
+ */
+static inline bool dmxParseArtNet(const uint8_t* buf, size_t len, DmxPacket& packet) {
+    if (len < 14 || memcmp(buf, "Art-Net\0", 8) != 0) return false;
+
+    uint16_t opcode = buf[8] | (buf[9] << 8);
+
+    if (opcode == 0x5200) {
+        packet.type = DMX_PACKET_SYNC;
+        packet.sequence = 0;
+        packet.syncAddress = 0;
+        packet.universe = 0;
+        packet.data = NULL;
+        packet.length = 0;
+        return true;
+    }
+
+    if (opcode != 0x5000 || len < 18) return false;
+
+    uint16_t count = dmxRead16BE(buf + 16);
+    if (18 + (size_t)count > len) return false;
+
+    packet.type = DMX_PACKET_DATA;
+    packet.sequence = buf[12];
+    packet.universe = ((buf[15] & 0x7F) << 8) | buf[14];
+    packet.syncAddress = 0;
+    packet.data = buf + 18;
+    packet.length = count > DMX_UNIVERSE_SIZE ? DMX_UNIVERSE_SIZE : count;
+    return true;
+}
+
+/**
+ * @brief 自动识别并解析E1.31或Art-Net数据包
+ * @return 识别成功返回true
+ */
+static inline bool dmxParsePacket(const uint8_t* buf, size_t len, DmxPacket& packet) {
+    packet.type = DMX_PACKET_INVALID;
+    if (len >= 8 && buf[0] == 'A') return dmxParseArtNet(buf, len, packet);
+    return dmxParseE131(buf, len, packet);
+}
+
+#endif
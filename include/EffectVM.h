@@ -0,0 +1,149 @@
+#ifndef EFFECT_VM_H
+#define EFFECT_VM_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 效果程序的指令
+ * @details 栈式整数指令，操作数为32位有符号整数，运算按32位回绕。立即数和跳转偏移紧跟在操作码之后，
+ * 多字节立即数为小端序。跳转只能向前，因此每次运行执行的指令数不超过程序中的指令数。
+ */
+enum EffectOp : uint8_t {
+    OP_END = 0,     ///< 结束，栈顶为结果
+    OP_PUSH8,       ///< 压入有符号8位立即数
+    OP_PUSH16,      ///< 压入有符号16位立即数
+    OP_PUSH32,      ///< 压入32位立即数
+    OP_IN,          ///< 压入输入量，8位立即数为EffectInput
+    OP_GET,         ///< 压入局部变量，8位立即数为编号
+    OP_SET,         ///< 弹出并写入局部变量
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,         ///< 除数为0时结果为0
+    OP_MOD,         ///< 除数为0时结果为0
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_SHL,         ///< 移位数取低5位
+    OP_SHR,         ///< 算术右移，移位数取低5位
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+    OP_NEG,
+    OP_NOT,         ///< 按位取反
+    OP_LNOT,        ///< 逻辑非
+    OP_MIN,
+    OP_MAX,
+    OP_ABS,
+    OP_SIN8,        ///< 0-255一个周期的正弦，结果0-255
+    OP_TRI8,        ///< 0-255一个周期的三角波，结果0-255
+    OP_CLAMP,       ///< clamp(x, lo, hi)
+    OP_RGB,         ///< rgb(r, g, b)，各分量限制在0-255后合成0xRRGGBB
+    OP_JZ,          ///< 弹出，为0时向前跳转8位无符号偏移（相对下一条指令）
+    OP_JMP,         ///< 向前跳转8位无符号偏移
+    OP_COUNT
+};
+
+/**
+ * @brief 效果程序的输入量
+ */
+enum EffectInput : uint8_t {
+    INPUT_TIME = 0,     ///< 演出时钟（毫秒，低31位）
+    INPUT_LAYER,        ///< 舵机程序为舵机层号，像素程序为灯带层号
+    INPUT_PIXEL,        ///< LED序号（舵机程序为0）
+    INPUT_INDEX,        ///< LED在本层中的序号（舵机程序为0）
+    INPUT_LAYERS,       ///< 舵机层数或灯带层数
+    INPUT_SIZE,         ///< 每层LED数量（舵机程序为0）
+    INPUT_COUNT
+};
+
+/**
+ * @brief 用户效果的字节码解释器
+ * @details 程序通过控制链路以十六进制分段上传，格式为：版本(1) 舵机段长度(1) 舵机段 像素段。
+ * 舵机段每帧对每层舵机运行一次，结果限制在0-1023后作为舵机输出，长度为0时不控制舵机；
+ * 像素段每帧对每个LED运行一次，结果为0xRRGGBB。
+ *
+ * 加载时一次性校验：操作码和立即数完整、局部变量编号有效、跳转向前且不越界、
+ * 每条指令的栈深度确定且在EFFECT_VM_STACK之内、每段以OP_END结束；
+ * 再按每段的指令数乘以每帧运行次数得到每帧最多执行的指令数，超过EFFECT_VM_FRAME_BUDGET时拒绝。
+ * 校验通过后运行时不再检查栈和跳转，除0等情况有确定的结果，程序无法访问指定的输入和局部变量之外的内存。
+ */
+class EffectVM {
+public:
+    static const uint8_t VERSION = 1;
+
+    EffectVM();
+
+    /**
+     * @brief 清空上传缓冲区和已加载的程序
+     */
+    void clear();
+
+    /**
+     * @brief 追加一段十六进制编码的程序
+     * @details 成功后已加载的程序失效，需要重新load()
+     * @return 格式错误或超出EFFECT_VM_MAX_CODE时返回false，之前上传的部分保留
+     */
+    bool append(const char* hex);
+
+    /**
+     * @brief 校验并加载已上传的程序
+     * @param servoLayers 舵机层数
+     * @param ledCount LED总数
+     * @return 校验失败时返回false，错误原因由getError()获取
+     */
+    bool load(uint8_t servoLayers, uint16_t ledCount);
+
+    bool isLoaded() const { return loaded; }
+    bool hasServoProgram() const { return loaded && servoCode != NULL; }
+    const char* getError() const { return error; }
+    uint16_t getSize() const { return size; }
+
+    /**
+     * @brief 每帧最多执行的指令数（已加载时有效）
+     */
+    uint32_t getFrameInstructions() const { return frameInstructions; }
+
+    /**
+     * @brief 运行舵机段
+     * @param inputs INPUT_COUNT个输入量
+     * @return 0-1023
+     */
+    int32_t runServo(const int32_t* inputs) const;
+
+    /**
+     * @brief 运行像素段
+     * @param inputs INPUT_COUNT个输入量
+     * @return 0xRRGGBB
+     */
+    uint32_t runPixel(const int32_t* inputs) const { return run(pixelCode, inputs) & 0xFFFFFF; }
+
+    /**
+     * @brief 校验一段代码
+     * @param code 代码
+     * @param length 长度
+     * @param instructions 输出指令数
+     * @return 通过时返回NULL，否则返回错误原因
+     */
+    static const char* verify(const uint8_t* code, uint16_t length, uint16_t* instructions);
+
+private:
+    /**
+     * @brief 解释执行一段已校验的代码
+     */
+    int32_t run(const uint8_t* code, const int32_t* inputs) const;
+
+    uint8_t code[EFFECT_VM_MAX_CODE];
+    uint16_t size;
+    bool loaded;
+    const uint8_t* servoCode;       ///< 未加载或没有舵机段时为NULL
+    const uint8_t* pixelCode;
+    uint32_t frameInstructions;
+    const char* error;
+};
+
+#endif
@@ -13,4 +13,78 @@
 // LED灯带亮度限制: 0.0-1.0之间的值，限制灯带功率
 #define MAX_LED_BRIGHTNESS 0.2f
 
+// Wi-Fi像素接收: true启用E1.31(sACN)/Art-Net接收，由灯光控台直接驱动灯带和舵机
+#define USE_WIFI false
+#define WIFI_SSID "Lightbelt"
+#define WIFI_PASSWORD "lightbelt"
+
+// 第一个像素universe编号，像素依次占用后续universe（每个170像素），之后一个universe用于舵机
+#define DMX_START_UNIVERSE 1
+
+// 多机时钟同步（需开启USE_WIFI）: 主机广播演出时钟，从机的扫动/呼吸效果与主机锁相
+#define USE_CLOCK_SYNC false
+#define CLOCK_SYNC_LEADER false
+#define CLOCK_SYNC_INTERVAL_MS 1000
+
+// 启动状态保存: true将I2C地址、亮度、反转设置和当前模式保存到NVS，重启后直接恢复
+// 设置变化后静默BOOT_STATE_SAVE_DELAY_MS才写入，连续的Follow流不会频繁擦写Flash
+#define USE_BOOT_STATE true
+#define BOOT_STATE_SAVE_DELAY_MS 3000
+
+// 舵机层到灯带LED映射表的容量: 最多舵机层数（PCA9685的16个通道为8层）和LED段数
+#define LAYER_MAP_MAX_SERVO_LAYERS 8
+#define LAYER_MAP_MAX_SPANS 32
+
+// 可上传的调色板槽位数（各模式的内置调色板之外），每个槽位约0.8KB RAM
+#define PALETTE_USER_SLOTS 2
+
+// Layers模式最多叠加的效果层数
+#define COMPOSITOR_MAX_LAYERS 4
+
+// 灯带最多分几段并行输出（每段一个数据引脚和一个RMT通道，分段在main.cpp的LED_SEGMENTS中配置）
+#define LIGHT_BELT_MAX_SEGMENTS 4
+
+// 用户效果字节码: 程序最大字节数、栈深度、局部变量数和每帧最多执行的指令数
+#define EFFECT_VM_MAX_CODE 256
+#define EFFECT_VM_STACK 16
+#define EFFECT_VM_LOCALS 8
+#define EFFECT_VM_FRAME_BUDGET 60000
+
+// 输出同步: true时每帧先暂存全部舵机值和整帧灯带，帧末连续输出并统计舵机与灯带的生效时间差（Stats命令查看），
+// false时每次设置立即输出（每层灯带各show一次）
+#define OUTPUT_LATCH true
+
+// 多速率调度: 舵机每个PWM周期（1/SERVO_PWM_FREQ）输出一次，周期内多次写入只有最后一次生效；
+// 灯带每LED_FRAME_US输出一次；命令每次循环都处理。Stats命令输出每个任务的实际周期、延迟和耗时
+#define SERVO_PWM_FREQ 50
+#define SERVO_FRAME_US (1000000 / SERVO_PWM_FREQ)
+#define LED_FRAME_US 10000
+
+// 空闲调速: true时按模式和输出变化放慢舵机和灯带的输出周期，Standby和蓝牙断开不快于IDLE_SLOW_FRAME_MS，
+// 输出连续不变时周期逐帧加倍（最长IDLE_MAX_FRAME_MS），收到命令立即恢复；false时始终按多速率调度的周期输出
+#define IDLE_GOVERNOR true
+#define IDLE_SLOW_FRAME_MS 40
+#define IDLE_MAX_FRAME_MS 250
+
+// 浅睡眠: true时Standby等缓慢变化的模式在IDLE_SLEEP_AFTER_MS内没有串口输入后，帧间用浅睡眠代替延时，串口收到数据即唤醒。
+// 唤醒所用的字节会丢失（睡眠后的第一条命令开头不完整），默认关闭；Follow和Stream模式始终不睡眠。
+// 只在串口控制、PCA9685舵机且不使用Wi-Fi时生效（内部PWM在浅睡眠中停止输出，蓝牙和Wi-Fi需要射频持续工作）
+#define IDLE_LIGHT_SLEEP false
+#define IDLE_SLEEP_AFTER_MS 30000
+
+// 延迟追踪: true时记录每条命令从到达到解析、效果计算、舵机写入和灯带传输完成的时间，按命令类型统计（Stats命令查看）；
+// LATENCY_TRACE_PENDING为同时追踪的命令数，超出时丢弃最早的（FollowT样本在抖动缓冲区中等待回放期间也占用槽位）
+#define LATENCY_TRACE true
+#define LATENCY_TRACE_PENDING 16
+
+// 串口像素流: "Ada"开头的Adalight帧和"Adz"开头的压缩帧（关键帧/差分帧，游程编码）直接解码到灯带缓冲区并进入Stream模式；
+// PIXEL_STREAM_MAX_LEDS决定接收缓冲区大小，帧中途超过PIXEL_STREAM_TIMEOUT_MS没有新字节时丢弃该帧；
+// SERIAL_RX_BUFFER为串口接收缓冲区字节数，灯带输出期间到达的像素数据暂存在这里
+#define PIXEL_STREAM_MAX_LEDS 512
+#define PIXEL_STREAM_TIMEOUT_MS 100
+#define SERIAL_RX_BUFFER 2048
+
+// 分阶段性能统计: true启用基于周期计数器的帧耗时统计（Stats命令查看），false完全编译掉
+#define ENABLE_PROFILER true
+
 #endif
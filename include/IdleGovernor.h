@@ -0,0 +1,101 @@
+#ifndef IDLE_GOVERNOR_H
+#define IDLE_GOVERNOR_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 当前模式对帧率的需求
+ */
+enum FrameActivity {
+    FRAME_ACTIVE,       ///< 随时间变化的效果，按多速率调度的周期输出
+    FRAME_ADAPTIVE,     ///< 输出只随输入变化（Follow），输出不变时放慢
+    FRAME_SLOW          ///< 缓慢变化的效果（Standby、蓝牙断开），以IDLE_SLOW_FRAME_MS为基础，输出不变时放慢
+};
+
+/**
+ * @brief 空闲调速：按模式和输出是否变化放慢舵机和灯带的输出，并在两次任务之间等待
+ * @details 每帧结束时控制器报告当前模式的需求和本帧是否有输出（OutputLatch按内容判断），
+ * 得到输出周期的下限（交给Scheduler::setPeriodFloor）：输出连续不变时逐帧加倍，直到IDLE_MAX_FRAME_MS，
+ * 有输出时回到模式的基础值。等待时长由调度器给出（到下一个任务到期），
+ * 期间每毫秒检查一次输入，收到数据立即返回处理命令，收到命令后取消放慢。
+ * 允许浅睡眠时，FRAME_SLOW的模式在IDLE_SLEEP_AFTER_MS内没有输入后改用浅睡眠等待，由定时器或串口唤醒。
+ *
+ * 同时按运行、等待、浅睡眠三种状态的时间估算芯片的平均功耗（不含射频、灯带和舵机），Stats命令输出。
+ */
+class IdleGovernor {
+public:
+    IdleGovernor();
+
+    /**
+     * @brief 是否允许浅睡眠（仅串口控制、PCA9685舵机且不使用Wi-Fi时）
+     * @details 允许时配置串口唤醒，IDLE_LIGHT_SLEEP为false时忽略
+     */
+    void setLightSleep(bool allowed);
+
+    /**
+     * @brief 报告一帧的结果，计算输出周期的下限
+     * @param activity 当前模式的需求
+     * @param outputChanged 本帧舵机或灯带是否有输出
+     */
+    void frameDone(FrameActivity activity, bool outputChanged);
+
+    /**
+     * @brief 等待到下一个任务到期，代替loop()末尾的固定延时
+     * @param input 命令输入，等待期间有数据时立即返回
+     * @param durationMicros 最长等待时间（Scheduler::untilNext()）
+     */
+    void wait(Stream& input, uint32_t durationMicros);
+
+    /**
+     * @brief 收到命令时调用：取消放慢，并在IDLE_SLEEP_AFTER_MS内不再浅睡眠
+     */
+    void inputReceived();
+
+    /**
+     * @brief 清空统计计数
+     */
+    void resetCounters();
+
+    /**
+     * @brief 输出统计信息：Governor|帧数|帧率|当前间隔ms|运行%|等待%|睡眠%|mWh每小时
+     * @param out 输出目标
+     */
+    void report(Print& out) const;
+
+    uint16_t getIntervalMs() const { return intervalMs; }     ///< 输出周期的下限，0为不放慢
+    uint32_t getFrames() const { return frames; }
+
+    /**
+     * @brief 统计期间的平均帧率
+     */
+    float getFrameRate() const;
+
+    /**
+     * @brief 按统计期间各状态的时间比例估算的每小时能耗（mWh）
+     */
+    float getEnergyPerHour() const { return energyPerHour(activeMicros, waitMicros, sleepMicros); }
+
+    /**
+     * @brief 按各状态的时间估算每小时能耗（mWh）
+     */
+    static float energyPerHour(uint64_t activeMicros, uint64_t waitMicros, uint64_t sleepMicros);
+
+    uint64_t getActiveMicros() const { return activeMicros; }  ///< 等待以外的时间
+    uint64_t getWaitMicros() const { return waitMicros; }      ///< 延时等待的时间
+    uint64_t getSleepMicros() const { return sleepMicros; }    ///< 浅睡眠的时间
+
+private:
+    FrameActivity activity;
+    uint16_t intervalMs;
+    bool sleepAllowed;
+    uint32_t lastInputMs;       // 最近一次收到输入的时间
+    uint32_t frameStart;        // 上次等待结束的时间
+
+    uint32_t frames;
+    uint64_t activeMicros;
+    uint64_t waitMicros;
+    uint64_t sleepMicros;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Follow设定值抖动缓冲区
+ * @details 接收带上位机时间戳的Follow参数，以固定延迟回放，每帧在相邻样本之间线性插值，
+ * 缓冲区欠载时按最后两个样本的斜率短暂外推，之后保持最后的值。
+ * 延迟越大越能吸收蓝牙SPP的突发传输，但控制响应也越慢。
+ */
+class JitterBuffer {
+public:
+    static const uint8_t CAPACITY = 16;        ///< 缓冲样本数
+    static const uint8_t CHANNELS = 6;         ///< 每个样本的参数个数
+
+    JitterBuffer();
+
+    /**
+     * @brief 清空缓冲区，回到立即生效模式
+     */
+    void reset();
+
+    /**
+     * @brief 写入一个带时间戳的样本
+     * @param hostTime 上位机时间戳（毫秒）
+     * @param values CHANNELS个参数（0-1023）
+     * @param now 到达时的millis时间
+     * @return 样本被接受返回true，过期被丢弃返回false
+     */
+    bool push(uint32_t hostTime, const int* values, uint32_t now);
+
+    /**
+     * @brief 计算当前时刻应输出的参数
+     * @param now 当前millis时间
+     * @param values 输出CHANNELS个参数
+     * @return 缓冲区中有样本返回true
+     */
+    bool sample(uint32_t now, int* values);
+
+    /**
+     * @brief 最近接受的样本到达回放点的millis时间
+     * @details 按push()时的时钟差估计换算，缓冲区为空时为0
+     */
+    uint32_t getLastPlayAt() const { return count > 0 ? at(count - 1).localTime + delayMs : 0; }
+
+    /**
+     * @brief 是否有可回放的样本
+     */
+    bool isActive() const { return count > 0; }
+
+    /**
+     * @brief 设置回放延迟
+     * @param ms 延迟（毫秒）
+     */
+    void setDelay(uint16_t ms) { delayMs = ms; }
+    uint16_t getDelay() const { return delayMs; }
+
+    /**
+     * @brief 设置欠载时最长外推时间
+     * @param ms 外推时间（毫秒），0表示不外推
+     */
+    void setMaxExtrapolation(uint16_t ms) { maxExtrapolationMs = ms; }
+
+    uint32_t getReceived() const { return received; }     ///< 接受的样本数
+    uint32_t getLateDrops() const { return lateDrops; }   ///< 因过期或乱序被丢弃的样本数
+    uint32_t getUnderruns() const { return underruns; }   ///< 欠载次数
+    uint32_t getOverflows() const { return overflows; }   ///< 缓冲区满时丢弃最旧样本的次数
+
+    /**
+     * @brief 清空统计计数
+     */
+    void resetCounters();
+
+    /**
+     * @brief 输出统计信息
+     * @param out 输出目标
+     */
+    void report(Print& out) const;
+
+private:
+    struct Sample {
+        uint32_t localTime;          ///< 换算到本地时钟后的时间戳
+        int16_t values[CHANNELS];
+    };
+
+    Sample samples[CAPACITY];
+    Sample previous;                 ///< 最近一个已出队的样本，用于外推斜率
+    bool previousValid;
+    uint8_t head;                    ///< 最旧样本的位置
+    uint8_t count;
+    int32_t offset;                  ///< 本地时间 - 上位机时间的估计
+    bool offsetValid;
+    uint32_t lastPlayTime;           ///< 上次回放到的本地时间
+    bool inUnderrun;
+    uint16_t delayMs;
+    uint16_t maxExtrapolationMs;
+    uint32_t received;
+    uint32_t lateDrops;
+    uint32_t underruns;
+    uint32_t overflows;
+
+    const Sample& at(uint8_t i) const { return samples[(head + i) % CAPACITY]; }
+};
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 被分别统计延迟的命令类型
+ */
+enum TraceType : uint8_t {
+    TRACE_FOLLOW = 0,       ///< Follow
+    TRACE_FOLLOW_T,         ///< FollowT（效果计算从样本到达回放点时算起，含抖动缓冲区的回放延迟）
+    TRACE_MODE,             ///< 预设模式切换
+    TRACE_OTHER,            ///< 其他命令
+    TRACE_TYPE_COUNT
+};
+
+/**
+ * @brief 命令到执行的端到端延迟追踪
+ * @details 每条命令在收到第一个字节时记下到达时间并分配编号，之后依次记录解析完成、
+ * 下一次效果计算完成、舵机写入（I2C STOP或LEDC寄存器写入）完成和灯带传输完成的时刻，
+ * 舵机和灯带都完成后按命令类型计入统计和直方图。舵机和灯带的输出周期不同，两者分别等各自的下一次输出。
+ * FollowT样本进入抖动缓冲区后由deferUntil()推迟，回放点到达该样本之前的效果计算不算作它的效果。
+ *
+ * 命令前可以加"@编号 "前缀（如"@42 Follow|..."），前缀在解析前去掉，编号代替设备分配的序号。
+ * 开启回显（Trace|1）后每条命令完成时回复一行Trace|编号|解析us|效果us|舵机us|灯带us（均从到达算起），
+ * 上位机按编号对应发送时间即可得到往返时间。
+ *
+ * 时间取自micros()：周期计数器约18秒回绕一次且两个核心各自计数，延迟为毫秒级，1us分辨率足够。
+ * 舵机写入后新的脉宽在下一个PWM周期开始时生效，最多再晚一个周期，不计入。
+ */
+class LatencyTrace {
+public:
+    static const uint8_t HISTOGRAM_BUCKETS = 16;    ///< 直方图桶数，第i桶为[2^i, 2^(i+1))微秒
+
+    /**
+     * @brief 一种命令类型的统计
+     */
+    struct TypeStats {
+        uint32_t count;                             ///< 完成的命令数
+        uint64_t totalParse;                        ///< 到解析完成的累计时间（微秒）
+        uint64_t totalEffect;                       ///< 到效果计算完成
+        uint64_t totalServo;                        ///< 到舵机写入完成
+        uint64_t totalLed;                          ///< 到灯带传输完成
+        uint32_t maxServo;
+        uint32_t maxLed;
+        uint16_t servoHistogram[HISTOGRAM_BUCKETS]; ///< 到舵机写入完成的直方图（饱和计数）
+        uint16_t ledHistogram[HISTOGRAM_BUCKETS];   ///< 到灯带传输完成的直方图（饱和计数）
+    };
+
+    LatencyTrace();
+
+    /**
+     * @brief 收到一条命令的第一个字节时调用
+     * @param now 当前时间（micros()）
+     */
+    void arrived(uint32_t now) { arrival = now; }
+
+    /**
+     * @brief 一行命令接收完整、解析之前调用：开始追踪，去掉"@编号 "前缀
+     * @param line 命令行
+     * @return 去掉前缀后命令在line中的偏移
+     */
+    size_t begin(const char* line);
+
+    /**
+     * @brief 命令处理完成后调用
+     */
+    void parsed();
+
+    /**
+     * @brief 当前命令要到指定时刻才生效，之前的效果计算和输出不计入
+     * @details 在parsed()之前调用，用于经抖动缓冲区延迟回放的FollowT样本
+     * @param playAtMs 样本到达回放点的millis时间
+     */
+    void deferUntil(uint32_t playAtMs);
+
+    /**
+     * @brief 当前模式的效果计算完成后调用
+     */
+    void effectDone();
+
+    /**
+     * @brief 舵机和灯带输出后调用
+     * @param servoDue 本帧是否输出了舵机
+     * @param ledDue 本帧是否输出了灯带
+     * @param servoDoneAt 舵机写入完成的时刻
+     * @param ledDoneAt 灯带传输完成的时刻
+     */
+    void outputDone(bool servoDue, bool ledDue, uint32_t servoDoneAt, uint32_t ledDoneAt);
+
+    /**
+     * @brief 设置回显目标，NULL为关闭
+     */
+    void setEcho(Print* out) { echo = out; }
+    bool isEchoing() const { return echo != NULL; }
+
+    /**
+     * @brief 清空统计计数（追踪中的命令保留）
+     */
+    void resetCounters();
+
+    /**
+     * @brief 每种类型输出三行：
+     * Latency|类型|次数|平均解析us|平均效果us|平均舵机us|最大舵机us|平均灯带us|最大灯带us，
+     * LatHist|类型|Servo|桶0,...和LatHist|类型|LED|桶0,...
+     * @param out 输出目标
+     */
+    void report(Print& out) const;
+
+    const TypeStats& getStats(TraceType type) const { return stats[type]; }
+    uint32_t getDropped() const { return dropped; }     ///< 追踪槽位已满被丢弃的命令数
+
+private:
+    /**
+     * @brief 一条追踪中的命令，时间为相对到达时刻的微秒数
+     */
+    struct Pending {
+        uint32_t id;
+        uint32_t arrival;
+        TraceType type;
+        bool deferred;          ///< playAtMs之前不算作效果计算完成
+        uint32_t playAtMs;
+        bool parsed;
+        bool effect;
+        bool servo;
+        bool led;
+        uint32_t parseMicros;
+        uint32_t effectMicros;
+        uint32_t servoMicros;
+        uint32_t ledMicros;
+    };
+
+    void complete(const Pending& p);
+    static void addToHistogram(uint16_t* histogram, uint32_t micros);
+
+    Pending pending[LATENCY_TRACE_PENDING];
+    uint8_t pendingCount;
+    uint32_t arrival;           // 当前命令第一个字节到达的时刻
+    uint32_t nextId;            // 没有前缀时分配的编号
+    Print* echo;
+
+    uint32_t dropped;
+    TypeStats stats[TRACE_TYPE_COUNT];
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef LAYER_MAP_H
+#define LAYER_MAP_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 一段连续的LED
+ */
+struct LedSpan {
+    uint16_t first;     ///< 第一个LED的序号
+    uint16_t count;     ///< LED数量
+};
+
+/**
+ * @brief 舵机层到灯带LED的映射表
+ * @details 每层舵机对应若干段连续LED，启动时建立一次，效果代码每帧直接遍历对应的段。
+ * build()按比例生成默认映射：灯带层数不少于舵机层数时每层舵机分到整数层灯带
+ * （12层灯带对6层舵机即每层舵机两层灯带），灯带层数较少时按LED数平分。
+ * 灯带接线不规则时可以用clear()/add()逐段指定。段按舵机层顺序连续存放，不使用堆。
+ */
+class LayerMap {
+public:
+    LayerMap();
+
+    /**
+     * @brief 按比例生成默认映射
+     * @param servoLayers 舵机层数
+     * @param lightLayers 灯带层数
+     * @param ledsPerLayer 每层LED数量
+     */
+    void build(uint8_t servoLayers, uint8_t lightLayers, uint16_t ledsPerLayer);
+
+    /**
+     * @brief 清空映射，之后用add()按舵机层顺序添加
+     * @param servoLayers 舵机层数
+     */
+    void clear(uint8_t servoLayers);
+
+    /**
+     * @brief 为舵机层添加一段LED
+     * @param servoLayer 舵机层号，必须不小于上一次添加的层号
+     * @param first 第一个LED的序号
+     * @param count LED数量
+     * @return 添加成功返回true，层号乱序、超出范围或表已满返回false
+     */
+    bool add(uint8_t servoLayer, uint16_t first, uint16_t count);
+
+    /**
+     * @brief 舵机层对应的第一段
+     */
+    const LedSpan* begin(uint8_t servoLayer) const { return spans + offsets[servoLayer]; }
+
+    /**
+     * @brief 舵机层对应的最后一段之后
+     */
+    const LedSpan* end(uint8_t servoLayer) const { return spans + offsets[servoLayer + 1]; }
+
+    uint8_t getServoLayers() const { return servoLayers; }
+    uint8_t getSpanCount() const { return offsets[servoLayers]; }
+
+private:
+    LedSpan spans[LAYER_MAP_MAX_SPANS];
+    uint8_t offsets[LAYER_MAP_MAX_SERVO_LAYERS + 1];   ///< 第i层舵机的段为spans[offsets[i]]到spans[offsets[i + 1]]
+    uint8_t servoLayers;
+};
+
+#endif
@@ -2,18 +2,129 @@
 #define LIGHTBELT_H
 
 #include <Adafruit_NeoPixel.h>
+#include "Palette.h"
+#include "PixelKernels.h"
+#include "ParallelOutput.h"
+
+class Compositor;
+class LayerMap;
+class EffectVM;
+
+/**
+ * @brief 可以使用外部缓冲区的WS2812灯带（GRB，800kHz）
+ * @details Adafruit_NeoPixel的缓冲区指针和长度是protected成员，使用外部缓冲区时直接指向
+ * 调用者提供的静态数组，不在堆上分配；析构时先解除指向，避免库释放该数组。
+ */
+class NeoPixelStrip : public Adafruit_NeoPixel {
+public:
+    /**
+     * @brief 由库在堆上分配缓冲区
+     */
+    NeoPixelStrip(uint16_t numLeds, int16_t pin)
+        : Adafruit_NeoPixel(numLeds, pin, NEO_GRB + NEO_KHZ800), externalBuffer(false) {}
+
+    /**
+     * @brief 使用外部缓冲区
+     * @param buffer 至少numLeds * 3字节，生命周期不短于本对象
+     */
+    NeoPixelStrip(uint8_t* buffer, uint16_t numLeds, int16_t pin) : Adafruit_NeoPixel(), externalBuffer(true) {
+        setPin(pin);
+        pixels = buffer;
+        numLEDs = numLeds;
+        numBytes = numLeds * 3;
+    }
+
+    ~NeoPixelStrip() {
+        if (externalBuffer) pixels = NULL;
+    }
+
+private:
+    NeoPixelStrip(const NeoPixelStrip&);
+    NeoPixelStrip& operator=(const NeoPixelStrip&);
+
+    bool externalBuffer;
+};
+
+/**
+ * @brief 把RGB字节换成GRB并按灯带整体亮度缩放的查找表
+ * @details 缩放方式与Adafruit_NeoPixel的setBrightness及LightBelt::scaleColor()一致，
+ * 供串口像素流和网络接收器直接解码到像素缓冲区
+ */
+class BrightnessLut {
+public:
+    BrightnessLut() : brightness(0) { memset(table, 0, sizeof(table)); }
+
+    /**
+     * @brief 亮度等级改变时重建查找表
+     * @param outputBrightness 灯带整体亮度等级（LightBelt::getOutputBrightness()）
+     * @return 重建了查找表返回true
+     */
+    bool update(uint8_t outputBrightness);
+
+    /**
+     * @brief 解码连续的RGB像素
+     * @param rgb 每个像素3字节，按R、G、B顺序
+     * @param grb 输出，每个像素3字节，按G、R、B顺序
+     * @param count 像素数
+     */
+    void decode(const uint8_t* rgb, uint8_t* grb, uint16_t count) const {
+        for (uint16_t i = 0; i < count; i++, rgb += 3, grb += 3) {
+            grb[0] = table[rgb[1]];
+            grb[1] = table[rgb[0]];
+            grb[2] = table[rgb[2]];
+        }
+    }
+
+private:
+    uint8_t table[256];
+    uint8_t brightness;     // 查找表对应的亮度等级
+};
 
 /**
  * @brief LED灯带控制类
- * @details 用于控制多层WS2812 LED灯带，每层LED数量相同
+ * @details 用于控制多层WS2812 LED灯带，每层LED数量相同。
+ * 层数和每层LED数在编译期已知时使用StaticLightBelt，缓冲区静态分配。
  */
 class LightBelt {
 private:
-    Adafruit_NeoPixel strip;
+    NeoPixelStrip strip;
     uint8_t layers;
     uint8_t ledsPerLayer;
     uint32_t totalLeds;
     float maxBrightness;    // 最大亮度限制(0.0-1.0)
+    bool holding;           // beginFrame()之后只写缓冲区，不输出
+    bool pending;           // 暂存期间缓冲区有改动
+    ParallelOutput parallel;    // 多段时的并行输出
+    bool parallelActive;        // true时由parallel输出，false时由strip在单个引脚上输出
+    uint8_t* shown;             // commitFrame()最近一次输出的帧内容，用于判断帧是否变化
+    bool shownOwned;            // shown由本对象分配
+    bool shownValid;            // shown与灯带当前显示的内容一致
+
+    void showStrip();       // 输出缓冲区到灯带（计入LED输出耗时），暂存期间只做标记
+    void outputStrip();     // 实际输出
+    
+protected:
+    /**
+     * @brief 使用外部缓冲区的构造函数，供StaticLightBelt使用
+     * @param pixelBuffer numLayers * ledsInLayer * 3字节的缓冲区
+     * @param shownBuffer 同样大小，保存上次输出的帧供commitFrame()比较
+     */
+    LightBelt(uint8_t pin, uint8_t numLayers, uint8_t ledsInLayer, uint8_t* pixelBuffer, uint8_t* shownBuffer);
+
+    /**
+     * @brief 按灯带整体亮度缩放颜色，得到写入缓冲区的GRB字节（与Adafruit_NeoPixel的缩放一致）
+     */
+    void scaleColor(uint32_t color, uint8_t* grb) const;
+
+    /**
+     * @brief 用已缩放的GRB值填充一层，layer已检查范围
+     */
+    virtual void fillLayer(uint8_t layer, const uint8_t* grb);
+
+    /**
+     * @brief 用已缩放的GRB值填充所有LED
+     */
+    virtual void fillAll(const uint8_t* grb);
     
 public:
     /**
@@ -24,11 +135,44 @@ public:
      */
     LightBelt(uint8_t pin, uint8_t numLayers, uint8_t ledsInLayer);
 
+    virtual ~LightBelt();
+
+    /**
+     * @brief 把灯带按层分段，每段接一个数据引脚并行输出
+     * @details 须在begin()之前调用，各段层数之和必须等于总层数。只有一段时仍由Adafruit_NeoPixel
+     * 在该段的引脚上输出；多段时由RMT通道同时发送，传输时间约为单引脚的1/段数。
+     * 层号和LED序号的含义不变，各效果仍写同一个帧缓冲区。
+     * @param segments 各段的引脚和层数，按层号顺序排列
+     * @param count 段数（1到LIGHT_BELT_MAX_SEGMENTS）
+     * @return 分段有效返回true
+     */
+    bool setSegments(const LedSegment* segments, uint8_t count);
+
+    /**
+     * @brief 获取灯带段数
+     */
+    uint8_t getSegmentCount() const { return parallel.getSegmentCount() > 0 ? parallel.getSegmentCount() : 1; }
+
     /**
      * @brief 初始化LED灯带
      */
     void begin();
 
+    /**
+     * @brief 开始暂存一帧
+     * @details 之后的设置只写缓冲区，直到commitFrame()才整帧输出一次；
+     * 上次commitFrame()之后的改动保留，灯带本帧未到期时留到下一次输出
+     */
+    void beginFrame() { holding = true; }
+
+    /**
+     * @brief 结束暂存，暂存期间有改动且内容与上次输出不同时输出一次
+     * @details 与上次输出的帧逐字节比较，内容相同时不再发送，WS2812保持原来的颜色；
+     * 使用库分配的缓冲区时，第一次调用时分配同样大小的比较缓冲区
+     * @return 是否输出了一帧
+     */
+    bool commitFrame();
+
     /**
      * @brief 设置指定层的LED颜色
      * @param layer 层号（从0开始）
@@ -36,6 +180,14 @@ public:
      */
     void setLayerColor(uint8_t layer, uint32_t color);
 
+    /**
+     * @brief 设置一段连续LED的颜色
+     * @param first 第一个LED的序号
+     * @param count LED数量，超出灯带的部分忽略
+     * @param color 32位RGB颜色值
+     */
+    void setRangeColor(uint16_t first, uint16_t count, uint32_t color);
+
     /**
      * @brief 设置所有层的LED为相同颜色
      * @param color 32位RGB颜色值
@@ -44,12 +196,14 @@ public:
 
     /**
      * @brief 使LED灯带呈现彩虹循环效果
+     * @details 各层在调色板上均匀错开，随时间循环移动
      * @param periodMs 完成一次彩虹循环的时间（毫秒）
+     * @param palette 首尾相接的调色板
      */
-    void rainbowCycle(uint32_t periodMs);
+    void rainbowCycle(uint32_t periodMs, const Palette& palette);
 
     /**
-     * @brief 颜色轮转换函数
+     * @brief 颜色轮转换函数，即内置彩虹调色板查表
      * @param wheelPos 0-255的位置值
      * @return 对应位置的32位RGB颜色值
      */
@@ -57,10 +211,25 @@ public:
 
     /**
      * @brief 使LED灯带呈现呼吸灯效果
-     * @param color 32位RGB颜色值
+     * @details 按正弦亮度在调色板上取色，0为最暗，255为最亮
+     * @param palette 调色板
      * @param periodMs 完成一次呼吸周期的时间（毫秒）
      */
-    void breathing(uint32_t color, uint32_t periodMs);
+    void breathing(const Palette& palette, uint32_t periodMs);
+
+    /**
+     * @brief 叠加多个效果层并输出
+     * @details 从第一个LED向后逐段合成，每段颜色只混合一次后整段填充，不使用额外的帧缓冲区
+     * @param compositor 效果层
+     * @param map 舵机层到灯带的映射，供按舵机层的效果使用
+     */
+    void compose(Compositor& compositor, const LayerMap& map);
+
+    /**
+     * @brief 对每个LED运行用户效果的像素程序并输出
+     * @param vm 已加载的效果程序
+     */
+    void renderEffect(const EffectVM& vm);
     
     /**
      * @brief 调整颜色亮度
@@ -87,6 +256,90 @@ public:
      * @return 灯带的层数
      */
     uint8_t getLayers() const { return layers; }
+
+    /**
+     * @brief 获取每层LED数量
+     */
+    uint8_t getLedsPerLayer() const { return ledsPerLayer; }
+
+    /**
+     * @brief 获取LED总数
+     */
+    uint16_t getLedCount() const { return totalLeds; }
+
+    /**
+     * @brief 获取像素缓冲区
+     * @details 每个LED 3字节，按G、R、B顺序排列，写入的值即为实际输出值（不再做亮度缩放）
+     */
+    uint8_t* getPixelBuffer() { return strip.getPixels(); }
+
+    /**
+     * @brief 获取灯带整体亮度等级（0-255），直接写缓冲区时按此缩放
+     */
+    uint8_t getOutputBrightness() const { return 255 * maxBrightness; }
+
+    /**
+     * @brief 将像素缓冲区输出到灯带
+     */
+    void show() { showStrip(); }
+
+    /**
+     * @brief 获取指定层实际输出的颜色（已包含亮度缩放）
+     * @param layer 层号（从0开始）
+     * @return 该层第一个LED的32位RGB颜色值
+     */
+    uint32_t getLayerColor(uint8_t layer) const;
+};
+
+/**
+ * @brief StaticLightBelt的缓冲区，作为第一个基类保证先于LightBelt构造
+ */
+template <uint16_t Bytes>
+struct LightBeltStorage {
+    alignas(4) uint8_t frame[Bytes];
+    alignas(4) uint8_t shown[Bytes];    ///< 上次输出的帧，commitFrame()比较用
+
+    LightBeltStorage() : frame(), shown() {}
+};
+
+/**
+ * @brief 编译期确定尺寸的LED灯带
+ * @details 像素缓冲区和比较用的上一帧为对象内的静态数组（全局对象即位于.bss），不使用堆；
+ * 层偏移和每层LED数为编译期常量，fillLayer()/fillAll()使用按像素数在编译期展开的PixelKernels::fill<Count>，
+ * 不调用按运行时长度循环的fill()（基类的效果代码仍经虚函数每层调用一次）。
+ * 
+ * @tparam Layers 灯带层数
+ * @tparam LedsPerLayer 每层LED数量
+ */
+template <uint8_t Layers, uint8_t LedsPerLayer>
+class StaticLightBelt : private LightBeltStorage<(uint16_t)Layers * LedsPerLayer * 3>, public LightBelt {
+    typedef LightBeltStorage<(uint16_t)Layers * LedsPerLayer * 3> Storage;
+
+public:
+    static constexpr uint16_t LED_COUNT = (uint16_t)Layers * LedsPerLayer;
+
+    static_assert(Layers > 0 && LedsPerLayer > 0, "StaticLightBelt needs at least one LED");
+    static_assert((uint32_t)Layers * LedsPerLayer * 3 <= 0xFFFF, "StaticLightBelt buffer exceeds 64KB");
+
+    /**
+     * @brief 指定层第一个LED在缓冲区中的字节偏移
+     */
+    static constexpr uint16_t layerOffset(uint8_t layer) { return (uint16_t)layer * LedsPerLayer * 3; }
+
+    /**
+     * @brief 构造函数
+     * @param pin LED灯带的数据引脚
+     */
+    explicit StaticLightBelt(uint8_t pin) : Storage(), LightBelt(pin, Layers, LedsPerLayer, Storage::frame, Storage::shown) {}
+
+protected:
+    void fillLayer(uint8_t layer, const uint8_t* grb) override {
+        PixelKernels::fill<LedsPerLayer>(Storage::frame + layerOffset(layer), grb);
+    }
+
+    void fillAll(const uint8_t* grb) override {
+        PixelKernels::fill<LED_COUNT>(Storage::frame, grb);
+    }
 };
 
 #endif
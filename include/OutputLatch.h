@@ -0,0 +1,92 @@
+#ifndef OUTPUT_LATCH_H
+#define OUTPUT_LATCH_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+#include "LightBelt.h"
+#include "ServoPlatform.h"
+#include "ServoPlatformInter.h"
+
+/**
+ * @brief 每帧同步释放舵机和灯带输出
+ * @details stage()之后各模式对舵机和灯带的设置只写入内存，commit()时两者背靠背输出：
+ * PCA9685的全部通道在一次I2C传输中写入，STOP时同时生效；灯带整帧只show一次，传输结束后锁存。
+ * 两者的生效时间差等于后输出一方的传输时间，因此每帧先输出耗时长的一方（按上一帧测得的耗时），
+ * 耗时短的一方紧随其后。只有舵机和灯带在同一帧都有输出时才统计时间差。
+ * 多速率调度下舵机和灯带的输出周期不同，未到期的一方保持暂存，到期时再输出。
+ */
+class OutputLatch {
+public:
+    OutputLatch();
+
+    /**
+     * @brief 绑定灯带和舵机平台
+     */
+    void attach(LightBelt* belt, ServoPlatform* servo);
+    void attach(LightBelt* belt, ServoPlatformInter* servo);
+
+    /**
+     * @brief 开始暂存一帧
+     */
+    void stage();
+
+    /**
+     * @brief 输出暂存的舵机值和灯带帧，记录时间差
+     * @param servoDue 舵机本帧是否到期，未到期时继续暂存
+     * @param ledDue 灯带本帧是否到期，未到期时继续暂存
+     */
+    void commit(bool servoDue = true, bool ledDue = true);
+
+    /**
+     * @brief 清空统计计数
+     */
+    void resetCounters();
+
+    /**
+     * @brief 输出统计信息
+     * @param out 输出目标
+     */
+    void report(Print& out) const;
+
+    uint32_t getFrames() const { return frames; }             ///< 舵机和灯带都有输出的帧数
+    uint32_t getLastSkew() const { return lastSkew; }         ///< 最近一帧的时间差（微秒）
+    uint32_t getMinSkew() const { return frames ? minSkew : 0; }
+    uint32_t getMaxSkew() const { return maxSkew; }
+    uint32_t getAverageSkew() const { return frames ? totalSkew / frames : 0; }
+    uint32_t getLedFirstFrames() const { return ledFirstFrames; }  ///< 先输出灯带的帧数
+    uint32_t getLedMicros() const { return ledMicros; }       ///< 最近一次灯带输出耗时
+    uint32_t getServoMicros() const { return servoMicros; }   ///< 最近一次舵机输出耗时
+    uint32_t getLedCommitMicros() const { return ledCommitMicros; }      ///< 最近一次commit()中灯带部分的耗时（含无改动）
+    uint32_t getServoCommitMicros() const { return servoCommitMicros; }  ///< 最近一次commit()中舵机部分的耗时（含无改动）
+    uint32_t getLedDoneAt() const { return ledDoneAt; }       ///< 最近一次commit()中灯带输出完成的时刻（micros()）
+    uint32_t getServoDoneAt() const { return servoDoneAt; }   ///< 最近一次commit()中舵机输出完成的时刻（micros()）
+
+    /**
+     * @brief 最近一帧是否有输出（舵机值或灯带内容有变化），OUTPUT_LATCH关闭时无法判断，总是返回true
+     */
+    bool outputChanged() const { return changed; }
+
+private:
+    bool commitServo();
+
+    LightBelt* belt;
+    ServoPlatform* pca;                 ///< 使用内部PWM时为NULL
+    ServoPlatformInter* ledc;           ///< 使用PCA9685时为NULL
+    bool ledFirst;
+    uint32_t ledMicros;
+    uint32_t servoMicros;
+    uint32_t ledCommitMicros;
+    uint32_t servoCommitMicros;
+    uint32_t ledDoneAt;
+    uint32_t servoDoneAt;
+    bool changed;
+
+    uint32_t frames;
+    uint32_t lastSkew;
+    uint32_t minSkew;
+    uint32_t maxSkew;
+    uint64_t totalSkew;
+    uint32_t ledFirstFrames;
+};
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 各模式使用的调色板，编号同时也是该模式内置调色板所在的槽位
+ */
+enum PaletteRole : uint8_t {
+    PALETTE_RAINBOW = 0,    ///< Rainbow：按层错开的色轮
+    PALETTE_IDLE,           ///< Idle：呼吸亮度从黑到白
+    PALETTE_HEATUP,         ///< Heatup：与舵机同步从黑到红
+    PALETTE_COOLDOWN,       ///< Cooldown：从橙黄到黑
+    PALETTE_STANDBY,        ///< Standby和蓝牙断开：从黑到蓝
+    PALETTE_FOLLOW,         ///< Follow：参数越大越蓝越亮
+    PALETTE_ROLE_COUNT
+};
+
+/**
+ * @brief 调色板的一个关键色
+ */
+struct PaletteStop {
+    uint8_t index;          ///< 在256项表中的位置
+    uint32_t color;         ///< 0xRRGGBB
+};
+
+/**
+ * @brief 256项RGB调色板
+ * @details 由若干关键色生成完整的颜色表，效果代码每帧只查表；关键色之间在RGB空间按整数线性插值，
+ * 或者在OKLab感知均匀空间中插值（只在生成时计算一次）。第一个关键色之前和最后一个之后保持端点颜色。
+ */
+class Palette {
+public:
+    static const uint8_t MAX_STOPS = 16;
+
+    Palette();
+
+    /**
+     * @brief 清空关键色，颜色表变为全黑
+     * @param perceptual true在OKLab空间插值，false在RGB空间插值
+     */
+    void clear(bool perceptual = false);
+
+    /**
+     * @brief 添加关键色并重新生成颜色表，位置相同时替换原来的颜色
+     * @return 关键色已满时返回false
+     */
+    bool addStop(uint8_t index, uint32_t color);
+
+    /**
+     * @brief 添加一组关键色，全部插入后只重新生成一次颜色表
+     * @return 新增的位置超出MAX_STOPS时返回false，调色板不变
+     */
+    bool addStops(const PaletteStop* stops, uint8_t count);
+
+    /**
+     * @brief 用一组关键色替换调色板
+     * @param stops 关键色，位置不必有序
+     * @param count 关键色数量，超过MAX_STOPS的部分忽略
+     * @param perceptual true在OKLab空间插值
+     */
+    void setStops(const PaletteStop* stops, uint8_t count, bool perceptual = false);
+
+    /**
+     * @brief 查表
+     * @param index 0-255
+     * @return 0xRRGGBB
+     */
+    uint32_t at(uint8_t index) const {
+        const uint8_t* c = table[index];
+        return ((uint32_t)c[0] << 16) | ((uint32_t)c[1] << 8) | c[2];
+    }
+
+    /**
+     * @brief 按16位位置取色，在相邻两项之间整数插值
+     * @param position 0-65535，高8位为表项，低8位为两项之间的比例
+     * @return 0xRRGGBB
+     */
+    uint32_t sample(uint16_t position) const;
+
+    uint8_t getStopCount() const { return stopCount; }
+    bool isPerceptual() const { return perceptual; }
+
+private:
+    /**
+     * @brief 由关键色重新生成颜色表
+     */
+    void render();
+
+    uint8_t table[256][3];
+    PaletteStop stops[MAX_STOPS];   ///< 按位置升序
+    uint8_t stopCount;
+    bool perceptual;
+};
+
+/**
+ * @brief 调色板槽位
+ * @details 前PALETTE_ROLE_COUNT个槽位为各模式的内置调色板，之后PALETTE_USER_SLOTS个槽位供上传。
+ * 每种模式通过PaletteRole取调色板，默认指向同编号的内置槽位，可以改为指向任意槽位；
+ * 上传到内置槽位即直接替换该模式的颜色。调色板不保存到NVS，重启后恢复内置值。
+ */
+class Palettes {
+public:
+    static const uint8_t SLOT_COUNT = PALETTE_ROLE_COUNT + PALETTE_USER_SLOTS;
+
+    /**
+     * @brief 生成内置调色板，所有模式指向各自的内置槽位
+     */
+    static void begin();
+
+    /**
+     * @brief 模式当前使用的调色板
+     */
+    static const Palette& get(PaletteRole role) { return slots[roleSlots[role]]; }
+
+    /**
+     * @brief 槽位中的调色板，slot需小于SLOT_COUNT
+     */
+    static Palette& slot(uint8_t slot) { return slots[slot]; }
+
+    /**
+     * @brief 指定模式使用的槽位
+     * @return 编号超出范围时返回false
+     */
+    static bool assign(int role, int slot);
+
+    /**
+     * @brief 清空槽位
+     * @return 槽位超出范围时返回false
+     */
+    static bool clear(int slot, bool perceptual);
+
+    /**
+     * @brief 解析并添加关键色
+     * @param slot 槽位
+     * @param args 格式为"位置|颜色|位置|颜色..."，数值可以是十进制或0x开头的十六进制
+     * @return 添加的关键色数量，格式错误、槽位超出范围或关键色放不下时返回-1（调色板不变）
+     */
+    static int addStops(int slot, const char* args);
+
+private:
+    static Palette slots[SLOT_COUNT];
+    static uint8_t roleSlots[PALETTE_ROLE_COUNT];
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PARALLEL_OUTPUT_H
+#define PARALLEL_OUTPUT_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 一段灯带：数据引脚和连续的层数
+ * @details 各段按顺序覆盖灯带的全部层，第一段从第0层开始
+ */
+struct LedSegment {
+    uint8_t pin;
+    uint8_t layers;
+};
+
+/**
+ * @brief 多引脚并行的WS2812输出
+ * @details 灯带按层分为若干段，每段接一个数据引脚，由一个RMT通道发送。
+ * show()先启动所有通道，再等待全部完成，各段同时传输，一帧的传输时间为最长一段的时间。
+ * 各段直接发送帧缓冲区中对应的一块，不复制数据；发送期间缓冲区不能改动，show()返回前已全部发送完。
+ */
+class ParallelOutput {
+public:
+    ParallelOutput();
+
+    /**
+     * @brief 设置分段
+     * @param segments 各段的引脚和层数
+     * @param count 段数（1到LIGHT_BELT_MAX_SEGMENTS）
+     * @param totalLayers 灯带总层数，各段层数之和必须等于它
+     * @param ledsPerLayer 每层LED数
+     * @return 分段有效返回true，否则保持原设置
+     */
+    bool configure(const LedSegment* segments, uint8_t count, uint8_t totalLayers, uint8_t ledsPerLayer);
+
+    /**
+     * @brief 为每段配置并安装RMT通道
+     * @return 全部通道安装成功返回true
+     */
+    bool begin();
+
+    /**
+     * @brief 并行发送整帧
+     * @param pixels 帧缓冲区（GRB，每LED 3字节）
+     */
+    void show(const uint8_t* pixels);
+
+    /**
+     * @brief 获取段数
+     */
+    uint8_t getSegmentCount() const { return count; }
+
+    /**
+     * @brief 获取指定段
+     */
+    const LedSegment& getSegment(uint8_t index) const { return segments[index]; }
+
+private:
+    LedSegment segments[LIGHT_BELT_MAX_SEGMENTS];
+    uint16_t offsets[LIGHT_BELT_MAX_SEGMENTS];      // 各段在缓冲区中的起始字节
+    uint16_t lengths[LIGHT_BELT_MAX_SEGMENTS];      // 各段的字节数
+    uint8_t count;
+    bool ready;
+    uint32_t lastEnd;                               // 上一帧发送完成的时间（微秒），用于保证复位时间
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief 直接操作GRB像素缓冲区的内核函数
+ * @details 缓冲区中是已经编码好的输出字节，内核不再做颜色拆分和GRB重排。
+ * 填充以已写入的部分为源倍增memcpy；缩放、混合和饱和加法按32位字一次处理4个字节，
+ * 每个字内偶数字节和奇数字节分两组计算，每个字节占用16位，乘积不会溢出到相邻字节。
+ * 目标与源的地址对齐方式相同时按字处理，否则逐字节处理，结果完全相同。
+ */
+class PixelKernels {
+public:
+    /**
+     * @brief 用同一颜色填充连续像素
+     * @param dst 第一个像素
+     * @param count 像素数量
+     * @param grb 3字节GRB颜色
+     */
+    static void fill(uint8_t* dst, uint16_t count, const uint8_t* grb);
+
+    /**
+     * @brief 像素数量为编译期常量的fill，结果与fill(dst, Count, grb)相同
+     * @details 倍增复制在编译期展开为固定次数、每次长度为常量的memcpy，内联到调用处，没有循环和函数调用
+     * @tparam Count 像素数量
+     */
+    template <uint16_t Count>
+    static inline void fill(uint8_t* dst, const uint8_t* grb) {
+        static_assert(Count > 0, "fill needs at least one pixel");
+        dst[0] = grb[0];
+        dst[1] = grb[1];
+        dst[2] = grb[2];
+        FillCopy<3, (uint32_t)Count * 3>::copy(dst);
+    }
+
+    /**
+     * @brief 缩放每个字节：c = (c * scale) >> 8
+     * @param buf 缓冲区
+     * @param bytes 字节数
+     * @param scale 0-256，256为不变（与Adafruit_NeoPixel的亮度+1相同）
+     */
+    static void scale(uint8_t* buf, uint16_t bytes, uint16_t scale);
+
+    /**
+     * @brief 按比例混合：d = (d * (256 - alpha) + s * alpha) >> 8
+     * @param dst 目标缓冲区，结果写回
+     * @param src 源缓冲区
+     * @param bytes 字节数
+     * @param alpha 0-256，0为保持目标，256为源
+     */
+    static void blend(uint8_t* dst, const uint8_t* src, uint16_t bytes, uint16_t alpha);
+
+    /**
+     * @brief 饱和加法：d = min(d + s, 255)
+     * @param dst 目标缓冲区，结果写回
+     * @param src 源缓冲区
+     * @param bytes 字节数
+     */
+    static void addSaturate(uint8_t* dst, const uint8_t* src, uint16_t bytes);
+
+private:
+    // 已填充Filled字节时复制下一段，直到填满Total字节
+    template <uint32_t Filled, uint32_t Total>
+    struct FillCopy {
+        static inline void copy(uint8_t* dst) {
+            memcpy(dst + Filled, dst, Total - Filled < Filled ? Total - Filled : Filled);
+            FillCopy<(Total - Filled < Filled ? Total : Filled * 2), Total>::copy(dst);
+        }
+    };
+
+    template <uint32_t Total>
+    struct FillCopy<Total, Total> {
+        static inline void copy(uint8_t*) {}
+    };
+};
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef PIXEL_RECEIVER_H
+#define PIXEL_RECEIVER_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+#include "LightBelt.h"
+#include "DmxProtocol.h"
+
+#if USE_WIFI
+#include <AsyncUDP.h>
+#endif
+
+/**
+ * @brief E1.31(sACN)/Art-Net像素接收器
+ * @details 通过UDP接收灯光控台渲染好的帧，通道数据从UDP负载原地解码到帧缓冲区，
+ * 每个universe承载170个像素，最后一个universe的前2×舵机层数个通道为16位舵机设定值。
+ * 多个universe组成一帧：发送方使用同步包时在同步包到达时输出，否则在所有universe
+ * 到齐或某个universe重复出现时输出。接收回调运行在网络任务中，主循环调用present()输出。
+ */
+class PixelReceiver {
+public:
+    static const uint8_t MAX_UNIVERSES = 8;             ///< 像素universe数量上限
+    static const uint8_t PIXELS_PER_UNIVERSE = 170;     ///< 每个universe的像素数
+    static const uint8_t MAX_SERVO_LAYERS = 16;
+    static const uint16_t MAX_PIXEL_BYTES = MAX_UNIVERSES * PIXELS_PER_UNIVERSE * 3;
+
+    /**
+     * @brief 构造函数
+     * @param lightBeltPtr 灯带控制器指针
+     * @param servoLayers 舵机层数
+     * @param firstUniverse 第一个像素universe编号
+     */
+    PixelReceiver(LightBelt* lightBeltPtr, uint8_t servoLayers, uint16_t firstUniverse = DMX_START_UNIVERSE);
+
+    /**
+     * @brief 开始监听E1.31和Art-Net端口
+     * @return 监听成功返回true
+     */
+    bool begin();
+
+    /**
+     * @brief 处理一个UDP负载（在网络任务中调用，也可在上位机回放抓包时直接调用）
+     * @param data 负载数据
+     * @param length 负载长度
+     */
+    void handlePacket(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 有完整的新帧时复制到灯带缓冲区并输出
+     * @return 输出了新帧返回true
+     */
+    bool present();
+
+    /**
+     * @brief 获取最近一次present()输出的帧中的舵机设定值
+     * @details 舵机值在present()中与像素一起在锁内复制，不会混合两帧
+     * @param layer 舵机层号
+     * @param value 输出0-1023的值
+     * @return 已输出的帧中收到过舵机universe返回true
+     */
+    bool getServoValue(uint8_t layer, int& value) const;
+
+    /**
+     * @brief 输出接收统计：Network|数据包|帧|丢帧|乱序|无效包
+     */
+    void report(Print& out) const;
+
+private:
+    struct FrameBuffer {
+        uint8_t pixels[MAX_PIXEL_BYTES];        ///< GRB顺序，已按亮度缩放
+        uint16_t servo[MAX_SERVO_LAYERS];       ///< 0-1023
+        bool hasServo;                          ///< 收到过舵机universe
+    };
+
+    LightBelt* lightBelt;
+    FrameBuffer buffers[2];
+    uint8_t writeIndex;             ///< 网络任务正在写入的缓冲区
+    uint8_t readyIndex;             ///< 已完成等待输出的缓冲区
+    volatile bool frameReady;
+    uint16_t presentedServo[MAX_SERVO_LAYERS];  ///< present()时复制的舵机值，只在主循环中读取
+    bool servoPresented;
+
+    uint16_t firstUniverse;
+    uint16_t pixelCount;
+    uint8_t pixelUniverses;
+    uint8_t servoLayers;
+    uint16_t expectedMask;          ///< 一帧需要的universe位图
+    uint16_t receivedMask;          ///< 当前帧已收到的universe位图
+    uint8_t lastSequence[MAX_UNIVERSES + 1];
+    bool syncMode;
+    uint32_t lastSyncTime;
+    BrightnessLut brightnessLut;
+
+    uint32_t packets;
+    uint32_t frames;
+    uint32_t droppedFrames;
+    uint32_t sequenceErrors;
+    uint32_t invalidPackets;
+
+    portMUX_TYPE lock;
+
+#if USE_WIFI
+    AsyncUDP e131Udp;
+    AsyncUDP artnetUdp;
+#endif
+
+    void decodeUniverse(uint8_t index, const DmxPacket& packet);
+    void completeFrame();
+};
+
+#endif
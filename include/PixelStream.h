@@ -0,0 +1,136 @@
+#ifndef PIXEL_STREAM_H
+#define PIXEL_STREAM_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+#include "LightBelt.h"
+
+/**
+ * @brief 串口像素流接收器
+ * @details 上位机逐帧发送整条灯带的颜色，与文本命令共用串口。两种帧：
+ *
+ *   Adalight帧：'A' 'd' 'a' | LED数-1（2字节，高字节在前） | 校验 | RGB × LED数
+ *   压缩帧：    'A' 'd' 'z' | 类型(1) | 序号(1) | 负载长度（2字节，高字节在前） | 校验 | 负载 | CRC8
+ *
+ * 校验为帧头中魔数之后各字节的异或再异或0x55，CRC8（多项式0x07）覆盖负载。
+ * 类型0为关键帧（相对全黑），1为差分帧（相对上一帧）。负载由操作组成，从第0个LED依次向后：
+ *   00nnnnnn           跳过n+1个LED：差分帧保持上一帧，关键帧为黑
+ *   01nnnnnn R G B     n+1个LED为同一颜色
+ *   10nnnnnn RGB...    n+1个LED各自的颜色
+ * 未覆盖到的LED同跳过。差分帧只在关键帧之后序号连续时使用，中途丢帧或校验失败后丢弃差分帧直到下一个关键帧；
+ * Adalight帧不带序号，之后同样需要关键帧。
+ *
+ * 魔数只在一行的开头识别，最近一秒内收到过像素帧时在任意位置识别（Adalight上位机不发送换行，
+ * 出错后靠下一个帧头重新同步）。负载先收进接收缓冲区，校验通过后一次性解码到灯带缓冲区，
+ * 同时换成GRB并按输出亮度缩放；present()每次最多输出一帧。
+ */
+class PixelStream {
+public:
+    static const uint8_t TYPE_KEYFRAME = 0;
+    static const uint8_t TYPE_DELTA = 1;
+    static const uint8_t OP_SKIP = 0x00;
+    static const uint8_t OP_RUN = 0x40;
+    static const uint8_t OP_LITERAL = 0x80;
+    static const uint8_t OP_COUNT_MASK = 0x3F;      ///< 操作的LED数-1
+    static const uint16_t MAX_PAYLOAD = PIXEL_STREAM_MAX_LEDS * 3 + (PIXEL_STREAM_MAX_LEDS + 63) / 64;
+
+    /**
+     * @brief 构造函数
+     * @param lightBeltPtr 解码目标灯带
+     */
+    explicit PixelStream(LightBelt* lightBeltPtr);
+
+    /**
+     * @brief 逐字节处理串口输入
+     * @param c 收到的字节
+     * @param now 当前millis时间
+     * @return 该字节属于像素帧时返回true，不再交给文本命令解析（识别到魔数时调用方应丢弃当前行）
+     */
+    bool feed(uint8_t c, uint32_t now);
+
+    /**
+     * @brief 正在接收负载时直接从串口整块读入，不逐字节处理
+     * @param input 串口
+     * @param now 当前millis时间
+     * @return 读取的字节数，不在负载中时为0
+     */
+    size_t receive(Stream& input, uint32_t now);
+
+    /**
+     * @brief 是否有已解码、尚未输出的帧
+     */
+    bool hasFrame() const { return frameReady; }
+
+    /**
+     * @brief 有新帧时标记灯带输出
+     * @return 输出了新帧返回true
+     */
+    bool present();
+
+    /**
+     * @brief 灯带缓冲区将被其他模式改写，之后的差分帧失去参照
+     * @details 丢弃尚未输出的帧，直到下一个关键帧或Adalight帧之前不再接受差分帧；离开Stream模式时调用
+     */
+    void invalidate();
+
+    /**
+     * @brief 解码成功的帧数（三种帧之和）
+     */
+    uint32_t getFrames() const { return rawFrames + keyframes + deltaFrames; }
+
+    /**
+     * @brief 输出之前就被下一帧覆盖的帧数
+     */
+    uint32_t getOverwritten() const { return overwritten; }
+
+    /**
+     * @brief 清空统计计数
+     */
+    void resetCounters();
+
+    /**
+     * @brief 输出接收统计：Stream|Adalight帧|关键帧|差分帧|未同步丢弃|无效帧|超时|未输出覆盖|接收字节
+     */
+    void report(Print& out) const;
+
+private:
+    enum State { STATE_SCAN, STATE_HEADER, STATE_PAYLOAD };
+
+    LightBelt* lightBelt;
+    uint8_t state;
+    uint8_t history[2];         ///< 识别魔数用的最近两个字节
+    uint8_t lineBytes;          ///< 本行已收到的字节数（饱和到255）
+    char kind;                  ///< 'a'为Adalight帧，'z'为压缩帧
+    uint8_t header[5];
+    uint8_t headerLength;
+    uint8_t headerNeeded;
+    uint32_t payloadLength;     ///< 负载字节数（压缩帧含CRC8）
+    uint32_t received;
+    uint32_t lastByteTime;
+    uint32_t lastFrameTime;
+    bool streaming;             ///< 收到过完整帧，用于判断是否在任意位置识别魔数
+    bool synced;                ///< 差分帧可以使用
+    uint8_t lastSequence;
+    bool frameReady;
+    uint8_t payload[MAX_PAYLOAD + 1];
+    BrightnessLut brightnessLut;
+
+    uint32_t rawFrames;
+    uint32_t keyframes;
+    uint32_t deltaFrames;
+    uint32_t unsynced;
+    uint32_t invalidFrames;
+    uint32_t timeouts;
+    uint32_t overwritten;
+    uint32_t bytes;
+
+    bool expired(uint32_t now);
+    void finishFrame();
+    void headerDone();
+    void payloadDone();
+    void decodeRaw(uint32_t count);
+    bool decodeCompressed(const uint8_t* data, uint16_t length, bool keyframe);
+    void frameDecoded();
+};
+
+#endif
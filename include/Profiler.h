@@ -0,0 +1,113 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 帧内被统计的阶段
+ */
+enum ProfileStage : uint8_t {
+    PROFILE_PARSE = 0,       ///< 命令解析
+    PROFILE_EFFECT,          ///< 效果计算（不含下面两项输出时间）
+    PROFILE_LED_OUTPUT,      ///< LightBelt输出（strip.show）
+    PROFILE_SERVO_OUTPUT,    ///< 舵机I2C/LEDC写入
+    PROFILE_FRAME,           ///< 整帧（包含全部子阶段）
+    PROFILE_STAGE_COUNT
+};
+
+/**
+ * @brief 基于Xtensa周期计数器的分阶段性能统计
+ * @details 每个阶段在固定内存中保存最小/平均/最大耗时以及按2的幂划分的微秒直方图。
+ * 阶段可以嵌套，父阶段只统计扣除子阶段后的独占时间（PROFILE_FRAME除外，统计整帧时间）。
+ */
+class Profiler {
+public:
+    static const uint8_t HISTOGRAM_BUCKETS = 16;  ///< 直方图桶数，第i桶为[2^i, 2^(i+1))微秒
+    static const uint8_t MAX_DEPTH = 4;           ///< 最大嵌套深度
+
+    struct StageStats {
+        uint32_t count;                          ///< 采样次数
+        uint32_t minCycles;                      ///< 最小周期数
+        uint32_t maxCycles;                      ///< 最大周期数
+        uint64_t totalCycles;                    ///< 累计周期数
+        uint32_t lastCycles;                     ///< 最近一次的周期数
+        uint16_t histogram[HISTOGRAM_BUCKETS];   ///< 耗时直方图（饱和计数）
+    };
+
+    /**
+     * @brief 进入一个阶段
+     * @param stage 阶段编号
+     */
+    static void enter(ProfileStage stage);
+
+    /**
+     * @brief 退出最近进入的阶段并记录耗时
+     */
+    static void exit();
+
+    /**
+     * @brief 直接记录一次阶段耗时
+     * @param stage 阶段编号
+     * @param cycles 耗时（CPU周期）
+     */
+    static void record(ProfileStage stage, uint32_t cycles);
+
+    /**
+     * @brief 输出所有阶段的统计信息
+     * @param out 输出目标（Serial或蓝牙串口）
+     */
+    static void report(Print& out);
+
+    /**
+     * @brief 清空所有统计信息
+     */
+    static void reset();
+
+    /**
+     * @brief 获取指定阶段的统计信息
+     */
+    static const StageStats& getStats(ProfileStage stage) { return stats[stage]; }
+
+    /**
+     * @brief 将CPU周期数转换为微秒
+     */
+    static uint32_t cyclesToMicros(uint32_t cycles);
+
+    /**
+     * @brief 读取CPU周期计数器
+     */
+    static inline uint32_t now() { return ESP.getCycleCount(); }
+
+private:
+    struct Frame {
+        ProfileStage stage;
+        uint32_t startCycles;
+        uint32_t childCycles;
+    };
+
+    static StageStats stats[PROFILE_STAGE_COUNT];
+    static Frame stack[MAX_DEPTH];
+    static uint8_t depth;
+};
+
+/**
+ * @brief 作用域计时辅助类，构造时进入阶段，析构时退出
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) { Profiler::enter(stage); }
+    ~ProfileScope() { Profiler::exit(); }
+};
+
+#if ENABLE_PROFILER
+#define PROFILE_SCOPE(stage) ProfileScope profileScope_(stage)
+#define PROFILE_BEGIN(stage) Profiler::enter(stage)
+#define PROFILE_END() Profiler::exit()
+#else
+#define PROFILE_SCOPE(stage)
+#define PROFILE_BEGIN(stage)
+#define PROFILE_END()
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+
+/**
+ * @brief 主循环中的周期任务
+ */
+enum SchedulerJob : uint8_t {
+    JOB_COMMS = 0,      ///< 命令接收和解析，每次循环都执行
+    JOB_SERVO,          ///< 舵机输出，周期为舵机PWM周期
+    JOB_LED,            ///< 效果计算后的灯带输出
+    JOB_COUNT
+};
+
+/**
+ * @brief 多速率调度：各任务按各自的周期执行，并分别统计实际周期、延迟和耗时
+ * @details 到期时间按固定网格推进（上次计划时间加周期），开始时间的抖动不会累积；
+ * 落后超过一个周期时跳过错过的周期，计入skipped，不连续补执行。
+ * 周期为0的任务每次循环都执行。空闲调速可以给输出任务设置最短周期（setPeriodFloor）。
+ */
+class Scheduler {
+public:
+    /**
+     * @brief 一个任务的统计
+     */
+    struct JobStats {
+        uint32_t runs;              ///< 执行次数
+        uint32_t skipped;           ///< 落后而跳过的周期数
+        uint32_t maxLate;           ///< 开始时间晚于计划时间的最大值（微秒）
+        uint64_t totalLate;
+        uint32_t intervals;         ///< 记录了间隔和延迟的次数（第一次执行没有）
+        uint32_t minInterval;       ///< 相邻两次执行的最小间隔（微秒）
+        uint32_t maxInterval;
+        uint64_t totalInterval;
+        uint32_t maxDuration;       ///< 单次执行的最大耗时（微秒）
+        uint64_t totalDuration;
+    };
+
+    Scheduler();
+
+    /**
+     * @brief 设置任务周期
+     * @param job 任务
+     * @param periodMicros 周期（微秒），0为每次循环都执行
+     */
+    void setPeriod(SchedulerJob job, uint32_t periodMicros);
+
+    /**
+     * @brief 输出任务的最短周期，0为不限制
+     * @details 空闲调速放慢帧率时设置；缩短时已安排的到期时间随之提前
+     */
+    void setPeriodFloor(uint32_t periodMicros);
+
+    /**
+     * @brief 任务是否到期，到期时记录开始时间并安排下一次
+     * @param job 任务
+     * @param now 当前时间（micros()）
+     */
+    bool due(SchedulerJob job, uint32_t now);
+
+    /**
+     * @brief 记录任务本次执行的耗时
+     */
+    void record(SchedulerJob job, uint32_t durationMicros);
+
+    /**
+     * @brief 到下一个周期任务到期的微秒数，已到期为0
+     */
+    uint32_t untilNext(uint32_t now) const;
+
+    /**
+     * @brief 任务当前生效的周期（含最短周期限制）
+     */
+    uint32_t getPeriod(SchedulerJob job) const;
+
+    const JobStats& getStats(SchedulerJob job) const { return stats[job]; }
+
+    /**
+     * @brief 清空统计计数
+     */
+    void resetCounters();
+
+    /**
+     * @brief 每个任务输出一行：Job|名称|周期us|次数|平均间隔us|最大间隔us|平均延迟us|最大延迟us|平均耗时us|最大耗时us|跳过
+     * @param out 输出目标
+     */
+    void report(Print& out) const;
+
+private:
+    uint32_t periods[JOB_COUNT];
+    uint32_t next[JOB_COUNT];       // 下一次计划执行的时间
+    uint32_t lastStart[JOB_COUNT];
+    bool scheduled[JOB_COUNT];      // 是否已执行过（之后才有计划时间）
+    uint32_t periodFloor;
+    JobStats stats[JOB_COUNT];
+};
+
+#endif
@@ -5,6 +5,19 @@
 #include "LightBelt.h"
 #include "ServoPlatformInter.h"
 #include "ServoPlatform.h"
+#include "Timeline.h"
+#include "ShowPlayer.h"
+#include "JitterBuffer.h"
+#include "Telemetry.h"
+#include "PixelReceiver.h"
+#include "LayerMap.h"
+#include "Compositor.h"
+#include "EffectVM.h"
+#include "OutputLatch.h"
+#include "IdleGovernor.h"
+#include "Scheduler.h"
+#include "LatencyTrace.h"
+#include "PixelStream.h"
 
 /**
  * @class SerialController
@@ -21,10 +34,24 @@ private:
     char currentMode[10];            ///< 当前工作模式
     int params[6];                   ///< 存储6个参数值（0-1023）
     uint32_t periodMs;               ///< 动作周期（毫秒）
+    Timeline timeline;               ///< 关键帧时间线
+    ShowPlayer showPlayer;           ///< SPIFFS演出播放器
+    JitterBuffer followBuffer;       ///< 带时间戳Follow参数的抖动缓冲区
+    Telemetry telemetry;             ///< 二进制遥测流
+    PixelReceiver* pixelReceiver;    ///< 网络像素接收器（未启用Wi-Fi时为空）
+    LayerMap layerMap;               ///< 舵机层到灯带LED的映射
+    Compositor compositor;           ///< Layers模式的效果层
+    EffectVM effectVM;               ///< Effect模式的用户效果程序
+    OutputLatch outputLatch;         ///< 每帧同步释放舵机和灯带输出
+    IdleGovernor governor;           ///< 按当前模式和输出变化决定帧间隔
+    Scheduler scheduler;             ///< 命令、舵机、灯带三个任务各自的周期
+    LatencyTrace latency;            ///< 命令到舵机和灯带输出的延迟
+    PixelStream pixelStream;         ///< 串口像素流（Adalight帧和压缩帧）
     
     // 命令处理相关
     char cmdBuffer[64];              ///< 命令缓冲区
     uint8_t cmdIndex;                ///< 当前命令索引
+    bool cmdOverflow;                ///< 当前行超出缓冲区，整行丢弃
     
     /**
      * @brief 处理命令
@@ -46,6 +73,11 @@ private:
      */
     void sendStatus();
     
+    /**
+     * @brief 采集当前状态并发送一帧遥测数据
+     */
+    void sendTelemetry();
+    
     /**
      * @brief 比较模式名称
      */
@@ -56,6 +88,13 @@ private:
      */
     int parseIntParam(const char* str);
     
+    /**
+     * @brief 按映射表设置一层舵机对应的全部灯带
+     * @param servoLayer 舵机层号
+     * @param color 32位RGB颜色值
+     */
+    void setServoLayerColor(uint8_t servoLayer, uint32_t color);
+    
     /**
      * @brief 执行Idle模式
      */
@@ -79,6 +118,60 @@ private:
      */
     void executeStandbyMode();
     
+    /**
+     * @brief 执行Timeline模式
+     * @details 按上传的关键帧在本地插值回放舵机和灯带
+     */
+    void executeTimelineMode();
+    
+    /**
+     * @brief 执行Show模式
+     * @details 从SPIFFS流式读取演出文件并输出当前帧
+     */
+    void executeShowMode();
+    
+    /**
+     * @brief 执行Network模式
+     * @details 输出E1.31/Art-Net接收到的完整帧，舵机跟随舵机universe
+     */
+    void executeNetworkMode();
+    
+    /**
+     * @brief 执行Stream模式
+     * @details 输出串口像素流解码好的新帧，舵机保持
+     * @param ledDue 灯带输出是否到期，未到期时新帧留到下一次输出
+     */
+    void executeStreamMode(bool ledDue);
+    
+    /**
+     * @brief 执行Layers模式
+     * @details 舵机与Rainbow模式相同做相位差往复运动，灯带为多个效果层的叠加
+     */
+    void executeLayersMode();
+    
+    /**
+     * @brief 执行Effect模式
+     * @details 运行上传的用户效果程序计算舵机输出和每个LED的颜色
+     */
+    void executeEffectMode();
+
+    /**
+     * @brief 当前模式对帧率的需求，供空闲调速使用
+     */
+    FrameActivity frameActivity() const;
+    
+    /**
+     * @brief 设置各任务的周期
+     */
+    void initScheduler();
+    
+    /**
+     * @brief 运行当前模式并输出到期的舵机或灯带
+     * @param servoDue 舵机输出是否到期
+     * @param ledDue 灯带输出是否到期
+     */
+    void renderFrame(bool servoDue, bool ledDue);
+    
     /**
      * @brief 获取Cooldown模式状态指针
      * @return Cooldown模式状态指针
@@ -119,6 +212,53 @@ public:
      */
     void begin();
     
+    /**
+     * @brief 设置网络像素接收器，启用Network模式
+     */
+    void setPixelReceiver(PixelReceiver* receiver) { pixelReceiver = receiver; }
+    
+    /**
+     * @brief 获取舵机层到灯带LED的映射表
+     * @details 构造时按层数比例生成，灯带接线不规则时可在begin()之前用clear()/add()重新指定
+     */
+    LayerMap& getLayerMap() { return layerMap; }
+    
+    /**
+     * @brief 获取Layers模式的效果层
+     */
+    Compositor& getCompositor() { return compositor; }
+    
+    /**
+     * @brief 获取舵机与灯带输出的同步统计
+     */
+    const OutputLatch& getOutputLatch() const { return outputLatch; }
+    
+    /**
+     * @brief 获取空闲调速的统计
+     */
+    const IdleGovernor& getIdleGovernor() const { return governor; }
+    
+    /**
+     * @brief 获取各任务的周期和执行统计
+     */
+    const Scheduler& getScheduler() const { return scheduler; }
+    
+    /**
+     * @brief 获取命令延迟的统计
+     */
+    const LatencyTrace& getLatencyTrace() const { return latency; }
+    
+    /**
+     * @brief 获取串口像素流的接收统计
+     */
+    const PixelStream& getPixelStream() const { return pixelStream; }
+    
+    /**
+     * @brief 等待到下一帧，在主循环中update()之后调用
+     * @details 等到舵机或灯带的下一次输出，低活动模式或输出不变时等待更久，收到命令立即返回
+     */
+    void waitForNextFrame() { governor.wait(Serial, scheduler.untilNext(micros())); }
+    
     /**
      * @brief 更新处理串口命令
      */
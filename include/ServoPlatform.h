@@ -17,10 +17,13 @@ private:
     uint16_t servoMin;    // 最小脉冲长度计数值
     uint16_t servoMax;    // 最大脉冲长度计数值
     float currentAngles[16];  // 存储当前角度
+    uint16_t currentTicks[16];  // 存储当前脉冲计数值
     uint8_t i2cAddress;  // 添加I2C地址成员变量
     bool sweepCompleted;    // 添加标记变量，表示一次性扫描是否完成
     uint32_t sweepStartTime;  // 添加扫描开始时间记录
     bool reverseAngle;          // 添加是否反转角度的标志
+    bool holding;               // beginFrame()之后只记录脉冲计数值，不写I2C
+    uint16_t dirtyChannels;     // 暂存期间改变过的通道
 
     uint16_t angleToMicros(uint8_t angle);
     void setServoAngle(uint8_t servoNum, uint8_t angle);
@@ -40,9 +43,35 @@ public:
     
     /**
      * @brief 初始化舵机平台
-     * @details 包括I2C初始化、设备扫描和舵机自检
+     * @details 包括I2C初始化和设备探测：先探测已知地址，没有应答时才扫描整条总线
      */
     void begin();
+    
+    /**
+     * @brief 设置begin()时优先探测的I2C地址（通常为上次启动保存的地址）
+     * @param address I2C地址，0表示直接扫描
+     */
+    void setI2CAddress(uint8_t address) { i2cAddress = address; }
+    
+    /**
+     * @brief 获取实际使用的I2C地址
+     */
+    uint8_t getI2CAddress() const { return i2cAddress; }
+
+    /**
+     * @brief 开始暂存一帧
+     * @details 之后设置的角度只记录下来，直到commitFrame()才写入PCA9685；
+     * 上次commitFrame()之后暂存的改动保留，舵机本帧未到期时留到下一次输出
+     */
+    void beginFrame() { holding = true; }
+
+    /**
+     * @brief 结束暂存，把改变过的通道在一次I2C传输中写入
+     * @details PCA9685默认在STOP条件时更新输出（MODE2.OCH=0），且库已开启寄存器自动递增，
+     * 连续通道的LEDn寄存器在同一次传输中写完，所有通道在传输结束时同时生效。
+     * @return 是否写入了I2C
+     */
+    bool commitFrame();
 
     /**
      * @brief 使指定层的舵机进行往复运动
@@ -90,6 +119,18 @@ public:
      */
     bool getReverseAngle() const;
 
+    /**
+     * @brief 获取舵机通道当前的PCA9685脉冲计数值
+     * @param servoNum 舵机编号（从0开始）
+     * @return 脉冲计数值，编号无效时返回0
+     */
+    uint16_t getServoTicks(uint8_t servoNum) const { return servoNum < 16 ? currentTicks[servoNum] : 0; }
+
+    /**
+     * @brief 获取舵机通道数（每层2个）
+     */
+    uint8_t getChannelCount() const { return layers * 2; }
+
     /**
      * @brief 获取舵机平台的层数
      * @return 舵机平台的层数
@@ -16,9 +16,12 @@ private:
     uint16_t maxPulseWidth;    // 最大脉冲宽度（微秒）
     float currentAngles[12];    // 最多支持6层，每层2个舵机
     uint8_t servoPins[12];      // 存储每个舵机的引脚
+    uint16_t currentDuty[12];   // 存储每个通道当前的LEDC占空比
     bool sweepCompleted;    // 添加标记变量，表示一次性扫描是否完成
     uint32_t sweepStartTime;  // 添加扫描开始时间记录
     bool reverseAngle;          // 添加是否反转角度的标志
+    bool holding;               // beginFrame()之后只记录占空比，不写LEDC
+    uint16_t dirtyChannels;     // 暂存期间改变过的通道
     
     void initPWM();
     void setServoPWM(uint8_t channel, uint16_t pulseWidth);
@@ -42,6 +45,20 @@ public:
      */
     void begin();
 
+    /**
+     * @brief 开始暂存一帧
+     * @details 之后设置的角度只记录下来，直到commitFrame()才写入LEDC；
+     * 上次commitFrame()之后暂存的改动保留，舵机本帧未到期时留到下一次输出
+     */
+    void beginFrame() { holding = true; }
+
+    /**
+     * @brief 结束暂存，连续写入改变过的通道
+     * @details 每次写入约1us，全部通道在几微秒内写完，新占空比从各通道的下一个PWM周期开始生效
+     * @return 是否写入了LEDC
+     */
+    bool commitFrame();
+
     /**
      * @brief 使指定层的舵机进行往复运动
      * @param layer 层号（从0开始）
@@ -88,6 +105,18 @@ public:
      */
     bool getReverseAngle() const;
 
+    /**
+     * @brief 获取舵机通道当前的LEDC占空比（16位分辨率）
+     * @param servoNum 舵机编号（从0开始）
+     * @return 占空比，编号无效时返回0
+     */
+    uint16_t getServoTicks(uint8_t servoNum) const { return servoNum < 12 ? currentDuty[servoNum] : 0; }
+
+    /**
+     * @brief 获取舵机通道数（每层2个）
+     */
+    uint8_t getChannelCount() const { return layers * 2; }
+
     /**
      * @brief 获取舵机平台的层数
      * @return 舵机平台的层数
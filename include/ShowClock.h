@@ -0,0 +1,76 @@
+#ifndef SHOW_CLOCK_H
+#define SHOW_CLOCK_H
+
+#include <Arduino.h>
+#include "GlobalConfig.h"
+#include "ClockSync.h"
+
+#if USE_WIFI && USE_CLOCK_SYNC
+#include <AsyncUDP.h>
+#endif
+
+/**
+ * @brief 多台设备共享的演出时钟
+ * @details 周期性效果（彩虹、呼吸、扫动、Heatup）以演出时钟代替millis()计算相位，
+ * 多台设备并排安装时动作保持锁相。主机按CLOCK_SYNC_INTERVAL_MS广播自己的时钟，
+ * 从机用ClockSync估计偏差和漂移；未启用同步或尚未收到主机时钟时等同于本地时钟。
+ */
+class ShowClock {
+public:
+    /**
+     * @brief 开始同步
+     * @param leader true作为主机广播时钟，false作为从机接收
+     * @return 端口监听成功返回true
+     */
+    static bool begin(bool leader);
+
+    /**
+     * @brief 主机按间隔广播时钟，需要在主循环中调用
+     */
+    static void update();
+
+    /**
+     * @brief 切换主机/从机角色，切换后从机重新同步
+     */
+    static void setLeader(bool leader);
+
+    static bool isLeader() { return leader; }
+
+    /**
+     * @brief 当前演出时钟（微秒），保证单调不减
+     */
+    static int64_t nowMicros();
+
+    /**
+     * @brief 当前演出时钟（毫秒），用于代替millis()计算效果相位
+     */
+    static uint32_t now() { return (uint32_t)(nowMicros() / 1000); }
+
+    /**
+     * @brief 处理收到的同步包（在网络任务中调用）
+     * @param data 负载数据
+     * @param length 负载长度
+     * @param localUs 收到包时的本地时钟
+     */
+    static void handlePacket(const uint8_t* data, size_t length, int64_t localUs);
+
+    /**
+     * @brief 输出同步状态：Clock|角色|样本数|偏差us|漂移ppb|最近残差us|丢弃数
+     */
+    static void report(Print& out);
+
+private:
+    static bool leader;
+    static bool active;
+    static uint8_t sequence;
+    static uint32_t lastSend;
+    static int64_t lastShowUs;
+    static ClockSync sync;
+    static portMUX_TYPE lock;
+
+#if USE_WIFI && USE_CLOCK_SYNC
+    static AsyncUDP udp;
+#endif
+};
+
+#endif
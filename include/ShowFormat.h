@@ -0,0 +1,229 @@
+#ifndef SHOW_FORMAT_H
+#define SHOW_FORMAT_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file ShowFormat.h
+ * @brief 演出文件（.show）格式定义
+ *
+ * @details 固件和上位机工具（tools/showtool.cpp）共用此文件，不依赖Arduino。
+ * 文件由16字节文件头和若干数据块组成，所有多字节整数均为小端序：
+ *
+ *   文件头：
+ *     "LBSH" | 版本(1) | 舵机层数(1) | 灯带层数(1) | 保留(1) |
+ *     帧间隔ms(2) | 关键帧间隔(2) | 帧数(4)
+ *
+ *   数据块（每块对应一帧）：
+ *     类型(1) | 负载长度(2) | 负载
+ *
+ *   关键帧负载：每个舵机层2字节设定值(0-1023)，随后每个灯带层3字节RGB
+ *   差分帧负载：舵机变化掩码(2) | 灯带变化掩码(4) |
+ *              每个变化的舵机层1字节差值(-127..127)，超出范围时写0x80再跟2字节绝对值 |
+ *              每个变化的灯带层3字节RGB
+ *   结束块：负载为空，表示演出结束
+ */
+
+#define SHOW_MAGIC "LBSH"
+#define SHOW_VERSION 1
+#define SHOW_HEADER_SIZE 16
+#define SHOW_CHUNK_HEADER_SIZE 3
+#define SHOW_MAX_SERVO_LAYERS 16
+#define SHOW_MAX_LIGHT_LAYERS 32
+#define SHOW_DELTA_ESCAPE 0x80
+
+/** 最大块负载：关键帧或全部变化的差分帧 */
+#define SHOW_MAX_PAYLOAD (6 + SHOW_MAX_SERVO_LAYERS * 3 + SHOW_MAX_LIGHT_LAYERS * 3)
+
+enum ShowChunkType : uint8_t {
+    SHOW_CHUNK_KEYFRAME = 0x01,
+    SHOW_CHUNK_DELTA = 0x02,
+    SHOW_CHUNK_END = 0xFF
+};
+
+/**
+ * @brief 演出文件头
+ */
+struct ShowHeader {
+    uint8_t servoLayers;
+    uint8_t lightLayers;
+    uint16_t frameIntervalMs;
+    uint16_t keyframeInterval;
+    uint32_t frameCount;
+};
+
+/**
+ * @brief 一帧的完整输出状态
+ */
+struct ShowFrame {
+    uint16_t servo[SHOW_MAX_SERVO_LAYERS];   ///< 舵机设定值(0-1023)
+    uint32_t light[SHOW_MAX_LIGHT_LAYERS];   ///< 灯带层颜色0xRRGGBB
+};
+
+static inline uint16_t showRead16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t showRead32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void showWrite16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static inline void showWrite32(uint8_t* p, uint32_t v) {
+    for (uint8_t i = 0; i < 4; i++) p[i] = (v >> (i * 8)) & 0xFF;
+}
+
+/**
+ * @brief 解析文件头
+ * @return 格式有效返回true
+ */
+static inline bool showParseHeader(const uint8_t* data, ShowHeader& header) {
+    if (memcmp(data, SHOW_MAGIC, 4) != 0 || data[4] != SHOW_VERSION) return false;
+    header.servoLayers = data[5];
+    header.lightLayers = data[6];
+    header.frameIntervalMs = showRead16(data + 8);
+    header.keyframeInterval = showRead16(data + 10);
+    header.frameCount = showRead32(data + 12);
+    return header.servoLayers <= SHOW_MAX_SERVO_LAYERS &&
+           header.lightLayers <= SHOW_MAX_LIGHT_LAYERS &&
+           header.frameIntervalMs > 0;
+}
+
+/**
+ * @brief 写入文件头
+ */
+static inline void showWriteHeader(uint8_t* data, const ShowHeader& header) {
+    memcpy(data, SHOW_MAGIC, 4);
+    data[4] = SHOW_VERSION;
+    data[5] = header.servoLayers;
+    data[6] = header.lightLayers;
+    data[7] = 0;
+    showWrite16(data + 8, header.frameIntervalMs);
+    showWrite16(data + 10, header.keyframeInterval);
+    showWrite32(data + 12, header.frameCount);
+}
+
+/**
+ * @brief 将一个数据块应用到帧状态上
+ * @param type 块类型
+ * @param payload 块负载
+ * @param length 负载长度
+ * @param header 文件头
+ * @param frame 输入为上一帧状态，输出为本帧状态
+ * @param changedLights 输出本帧颜色发生变化的灯带层掩码
+ * @return 负载格式有效返回true
+ */
+static inline bool showApplyChunk(uint8_t type, const uint8_t* payload, uint16_t length,
+                                  const ShowHeader& header, ShowFrame& frame, uint32_t& changedLights) {
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + length;
+    changedLights = 0;
+
+    if (type == SHOW_CHUNK_KEYFRAME) {
+        if (length != header.servoLayers * 2 + header.lightLayers * 3) return false;
+        for (uint8_t i = 0; i < header.servoLayers; i++, p += 2) {
+            frame.servo[i] = showRead16(p);
+        }
+        for (uint8_t i = 0; i < header.lightLayers; i++, p += 3) {
+            frame.light[i] = ((uint32_t)p[0] << 16) | (p[1] << 8) | p[2];
+        }
+        changedLights = header.lightLayers >= 32 ? 0xFFFFFFFF : ((1UL << header.lightLayers) - 1);
+        return true;
+    }
+
+    if (type == SHOW_CHUNK_DELTA) {
+        if (length < 6) return false;
+        uint16_t servoMask = showRead16(p);
+        uint32_t lightMask = showRead32(p + 2);
+        p += 6;
+
+        for (uint8_t i = 0; i < header.servoLayers; i++) {
+            if (!(servoMask & (1U << i))) continue;
+            if (p >= end) return false;
+            if (*p == SHOW_DELTA_ESCAPE) {
+                if (p + 3 > end) return false;
+                frame.servo[i] = showRead16(p + 1);
+                p += 3;
+            } else {
+                frame.servo[i] += (int8_t)*p;
+                p++;
+            }
+        }
+        for (uint8_t i = 0; i < header.lightLayers; i++) {
+            if (!(lightMask & (1UL << i))) continue;
+            if (p + 3 > end) return false;
+            frame.light[i] = ((uint32_t)p[0] << 16) | (p[1] << 8) | p[2];
+            p += 3;
+        }
+        changedLights = lightMask;
+        return p == end;
+    }
+
+    return type == SHOW_CHUNK_END && length == 0;
+}
+
+/**
+ * @brief 编码一帧
+ * @param keyframe 是否编码为关键帧
+ * @param header 文件头
+ * @param prev 上一帧状态（差分帧时使用）
+ * @param frame 本帧状态
+ * @param out 输出缓冲区，至少SHOW_CHUNK_HEADER_SIZE + SHOW_MAX_PAYLOAD字节
+ * @return 写入的总字节数（含块头）
+ */
+static inline uint16_t showEncodeFrame(bool keyframe, const ShowHeader& header, const ShowFrame& prev,
+                                       const ShowFrame& frame, uint8_t* out) {
+    uint8_t* p = out + SHOW_CHUNK_HEADER_SIZE;
+
+    if (keyframe) {
+        out[0] = SHOW_CHUNK_KEYFRAME;
+        for (uint8_t i = 0; i < header.servoLayers; i++, p += 2) {
+            showWrite16(p, frame.servo[i]);
+        }
+        for (uint8_t i = 0; i < header.lightLayers; i++, p += 3) {
+            p[0] = frame.light[i] >> 16;
+            p[1] = frame.light[i] >> 8;
+            p[2] = frame.light[i];
+        }
+    } else {
+        out[0] = SHOW_CHUNK_DELTA;
+        uint8_t* masks = p;
+        p += 6;
+        uint16_t servoMask = 0;
+        uint32_t lightMask = 0;
+
+        for (uint8_t i = 0; i < header.servoLayers; i++) {
+            int32_t delta = (int32_t)frame.servo[i] - prev.servo[i];
+            if (delta == 0) continue;
+            servoMask |= 1U << i;
+            if (delta >= -127 && delta <= 127) {
+                *p++ = (uint8_t)(int8_t)delta;
+            } else {
+                *p++ = SHOW_DELTA_ESCAPE;
+                showWrite16(p, frame.servo[i]);
+                p += 2;
+            }
+        }
+        for (uint8_t i = 0; i < header.lightLayers; i++) {
+            if (frame.light[i] == prev.light[i]) continue;
+            lightMask |= 1UL << i;
+            p[0] = frame.light[i] >> 16;
+            p[1] = frame.light[i] >> 8;
+            p[2] = frame.light[i];
+            p += 3;
+        }
+        showWrite16(masks, servoMask);
+        showWrite32(masks + 2, lightMask);
+    }
+
+    uint16_t payloadLength = p - (out + SHOW_CHUNK_HEADER_SIZE);
+    showWrite16(out + 1, payloadLength);
+    return SHOW_CHUNK_HEADER_SIZE + payloadLength;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef SHOW_PLAYER_H
+#define SHOW_PLAYER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "ShowFormat.h"
+
+/**
+ * @brief SPIFFS演出文件流式播放器
+ * @details 从SPIFFS分区按块读取演出文件，只保留一个小的预读缓冲区和当前帧状态，
+ * 不会把整个演出载入内存，因此演出长度只受分区大小限制。
+ */
+class ShowPlayer {
+public:
+    static const uint16_t READ_AHEAD_SIZE = 512;   ///< 预读缓冲区大小（字节）
+
+    ShowPlayer();
+
+    /**
+     * @brief 打开演出文件并开始播放
+     * @param path SPIFFS中的文件路径，例如"/demo.show"
+     * @param startTime 播放起点（millis时间）
+     * @param loop 是否循环播放
+     * @return 文件存在且格式有效返回true
+     */
+    bool open(const char* path, uint32_t startTime, bool loop);
+
+    /**
+     * @brief 停止播放并关闭文件
+     */
+    void close();
+
+    /**
+     * @brief 推进到当前时间对应的帧
+     * @param now 当前millis时间
+     * @return 播放仍在进行返回true，结束或出错返回false
+     */
+    bool update(uint32_t now);
+
+    /**
+     * @brief 获取舵机层当前设定值
+     * @return 层号超出文件中的舵机层数时返回false
+     */
+    bool getServoValue(uint8_t layer, int& value) const;
+
+    /**
+     * @brief 获取灯带层当前颜色
+     * @return 层号超出文件中的灯带层数时返回false
+     */
+    bool getLightColor(uint8_t layer, uint32_t& color) const;
+
+    /**
+     * @brief 获取上次update后颜色发生变化的灯带层掩码
+     */
+    uint32_t getChangedLights() const { return changedLights; }
+
+    /**
+     * @brief 是否正在播放
+     */
+    bool isPlaying() const { return playing; }
+
+    /**
+     * @brief 当前帧序号
+     */
+    uint32_t getFrameIndex() const { return frameIndex; }
+
+    /**
+     * @brief 因读取跟不上而跳过的帧数
+     */
+    uint32_t getLateFrames() const { return lateFrames; }
+
+private:
+    File file;
+    ShowHeader header;
+    ShowFrame frame;
+    uint8_t buffer[READ_AHEAD_SIZE];
+    uint16_t bufferStart;       ///< 缓冲区中未处理数据的起点
+    uint16_t bufferEnd;         ///< 缓冲区中有效数据的终点
+    uint32_t startTime;
+    uint32_t frameIndex;        ///< 已解码的帧数
+    uint32_t changedLights;
+    uint32_t lateFrames;
+    bool looping;
+    bool playing;
+    bool mounted;
+
+    bool fill(uint16_t needed);
+    bool decodeNextFrame(uint32_t& changed);
+    bool restart();
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+/**
+ * @brief 紧凑二进制遥测流
+ * @details 按设定频率发送打包的二进制帧，每帧包含一组32位字段（帧耗时、计数器、
+ * 各舵机通道脉冲计数值、各灯带层实际输出颜色），相对上一帧做差分编码：
+ * 只有发生变化的字段会被写出，差值使用ZigZag + 变长整数编码。
+ * 每隔KEYFRAME_INTERVAL帧发送一次完整帧，上位机中途订阅或丢帧后可以重新同步。
+ *
+ * 帧格式（多字节整数为小端序）：
+ *   0xA5 0x5A | 长度(2) | 类型(1) | 序号(1) | 字段数(1) | 变化掩码(ceil(字段数/8)) | 变长差值... | CRC8
+ * 长度为从类型到CRC之前的字节数，CRC8（多项式0x07）覆盖同一范围。
+ * 类型0x01为完整帧（差值相对0），0x02为差分帧（差值相对上一帧）。
+ */
+class Telemetry {
+public:
+    static const uint8_t MAX_FIELDS = 64;          ///< 每帧字段数上限
+    static const uint8_t KEYFRAME_INTERVAL = 50;   ///< 完整帧间隔（帧）
+    static const uint8_t SYNC0 = 0xA5;
+    static const uint8_t SYNC1 = 0x5A;
+    static const uint8_t TYPE_KEYFRAME = 0x01;
+    static const uint8_t TYPE_DELTA = 0x02;
+
+    Telemetry();
+
+    /**
+     * @brief 设置发送频率
+     * @param hz 每秒帧数，0表示停止发送
+     */
+    void setRate(uint16_t hz);
+    uint16_t getRate() const { return rateHz; }
+
+    /**
+     * @brief 判断当前是否应当发送一帧
+     * @param now 当前millis时间
+     */
+    bool due(uint32_t now);
+
+    /**
+     * @brief 开始组装新的一帧
+     */
+    void beginFrame() { fieldCount = 0; }
+
+    /**
+     * @brief 追加一个字段
+     */
+    void addField(uint32_t value) {
+        if (fieldCount < MAX_FIELDS) fields[fieldCount++] = value;
+    }
+
+    /**
+     * @brief 编码并发送当前帧
+     * @param out 输出目标（Serial或蓝牙串口）
+     * @return 发送的字节数
+     */
+    size_t send(Print& out);
+
+    /**
+     * @brief CRC8（多项式0x07，初值0），串口像素流的压缩帧也使用
+     */
+    static uint8_t crc8(const uint8_t* data, size_t length);
+
+private:
+    uint32_t fields[MAX_FIELDS];
+    uint32_t previous[MAX_FIELDS];
+    uint8_t fieldCount;
+    uint8_t previousCount;
+    uint8_t sequence;
+    uint8_t framesSinceKeyframe;
+    uint16_t rateHz;
+    uint32_t periodMs;
+    uint32_t nextDue;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief 关键帧时间线
+ * @details 上位机预先上传带时间戳的舵机层/灯带层关键帧，设备在本地按时间插值回放，
+ * 回放期间不需要任何通信。关键帧存放在预分配的固定数组中，每条轨道用链表串联，
+ * 回放时每条轨道只保存一个游标，每帧的开销与轨道数成正比而与关键帧数无关。
+ */
+class Timeline {
+public:
+    static const uint16_t MAX_KEYFRAMES = 512;     ///< 关键帧容量
+    static const uint8_t MAX_SERVO_TRACKS = 16;    ///< 舵机层轨道数上限
+    static const uint8_t MAX_LIGHT_TRACKS = 32;    ///< 灯带层轨道数上限
+
+    /**
+     * @brief 轨道类型
+     */
+    enum TrackType : uint8_t {
+        TRACK_SERVO = 0,   ///< 舵机层，值为0-1023
+        TRACK_LIGHT = 1    ///< 灯带层，值为0xRRGGBB
+    };
+
+    Timeline();
+
+    /**
+     * @brief 清空所有关键帧并停止回放
+     */
+    void clear();
+
+    /**
+     * @brief 添加一个关键帧
+     * @param type 轨道类型
+     * @param layer 层号（从0开始）
+     * @param timeMs 相对时间线起点的时间（毫秒），同一轨道内必须不递减
+     * @param value 舵机值（0-1023）或RGB颜色
+     * @return 成功返回true，缓冲区已满或参数无效返回false
+     */
+    bool addKeyframe(TrackType type, uint8_t layer, uint32_t timeMs, uint32_t value);
+
+    /**
+     * @brief 从文本解析并添加关键帧
+     * @param args 形如"S|层|时间|值|L|层|时间|0xRRGGBB|..."的参数串，可包含多组
+     * @return 成功添加的关键帧数量；遇到无效数据时返回-1，这一行的关键帧都不添加
+     */
+    int addKeyframes(const char* args);
+
+    /**
+     * @brief 开始回放
+     * @param startTime 回放起点（millis时间）
+     * @param loop 是否循环回放
+     */
+    void play(uint32_t startTime, bool loop);
+
+    /**
+     * @brief 推进回放到指定时间，更新各轨道游标
+     * @param now 当前millis时间
+     * @return 回放仍在进行返回true，非循环时间线播放结束后返回false
+     */
+    bool update(uint32_t now);
+
+    /**
+     * @brief 获取舵机层在当前时间的插值结果
+     * @param layer 舵机层号
+     * @param value 输出0-1023的值
+     * @return 该轨道有关键帧返回true
+     */
+    bool getServoValue(uint8_t layer, int& value) const;
+
+    /**
+     * @brief 获取灯带层在当前时间的插值颜色
+     * @param layer 灯带层号
+     * @param color 输出32位RGB颜色
+     * @return 该轨道有关键帧返回true
+     */
+    bool getLightColor(uint8_t layer, uint32_t& color) const;
+
+    /**
+     * @brief 获取关键帧数量
+     */
+    uint16_t getKeyframeCount() const { return keyframeCount; }
+
+    /**
+     * @brief 获取时间线总时长（最后一个关键帧的时间）
+     */
+    uint32_t getDuration() const { return duration; }
+
+private:
+    static const uint16_t NONE = 0xFFFF;
+
+    struct Keyframe {
+        uint32_t timeMs;    ///< 关键帧时间
+        uint32_t value;     ///< 舵机值或颜色
+        uint16_t next;      ///< 同一轨道的下一个关键帧
+    };
+
+    struct Track {
+        uint16_t head;      ///< 第一个关键帧
+        uint16_t tail;      ///< 最后一个关键帧
+        uint16_t cursor;    ///< 当前时间所在区间的起始关键帧
+    };
+
+    Keyframe keyframes[MAX_KEYFRAMES];
+    Track servoTracks[MAX_SERVO_TRACKS];
+    Track lightTracks[MAX_LIGHT_TRACKS];
+    uint16_t keyframeCount;
+    uint32_t duration;
+    uint32_t startTime;
+    uint32_t position;      ///< 当前回放位置（毫秒）
+    bool looping;
+
+    int parseKeyframes(const char* args);
+    void rewind();
+    void advanceTrack(Track& track);
+    uint32_t interpolate(const Track& track, bool isColor) const;
+};
+
+#endif
@@ -7,6 +7,9 @@
  */
 
 #include "BluetoothController.h"
+#include "Profiler.h"
+#include "ShowClock.h"
+#include "BootState.h"
 
 /**
  * @brief 构造函数 - 使用内部PWM
@@ -14,6 +17,10 @@
 BluetoothController::BluetoothController(LightBelt* lightBeltPtr, ServoPlatformInter* servoPlatformPtr, uint32_t cycleTimeMs)
     : lightBelt(lightBeltPtr), servoPlatform(servoPlatformPtr), periodMs(cycleTimeMs) {
     useInternalPWM = true;
+    pixelReceiver = nullptr;
+    layerMap.build(servoPlatformPtr->getLayers(), lightBelt->getLayers(), lightBelt->getLedsPerLayer());
+    outputLatch.attach(lightBelt, servoPlatformPtr);
+    initScheduler();
     currentMode = "Disconnect";  // 初始模式设为Disconnect
     
     // 初始化参数数组
@@ -24,6 +31,8 @@ BluetoothController::BluetoothController(LightBelt* lightBeltPtr, ServoPlatformI
     isConnected = false;
     lastActivityTime = 0;
     disconnectTimeout = 5000; // 默认5秒超时
+    deviceName = nullptr;
+    transportReady = false;
 }
 
 /**
@@ -32,6 +41,10 @@ BluetoothController::BluetoothController(LightBelt* lightBeltPtr, ServoPlatformI
 BluetoothController::BluetoothController(LightBelt* lightBeltPtr, ServoPlatform* servoPlatformPtr, uint32_t cycleTimeMs)
     : lightBelt(lightBeltPtr), servoPlatform(servoPlatformPtr), periodMs(cycleTimeMs) {
     useInternalPWM = false;
+    pixelReceiver = nullptr;
+    layerMap.build(servoPlatformPtr->getLayers(), lightBelt->getLayers(), lightBelt->getLedsPerLayer());
+    outputLatch.attach(lightBelt, servoPlatformPtr);
+    initScheduler();
     currentMode = "Disconnect";  // 初始模式设为Disconnect
     
     // 初始化参数数组
@@ -42,25 +55,71 @@ BluetoothController::BluetoothController(LightBelt* lightBeltPtr, ServoPlatform*
     isConnected = false;
     lastActivityTime = 0;
     disconnectTimeout = 5000; // 默认5秒超时
+    deviceName = nullptr;
+    transportReady = false;
 }
 
 /**
  * @brief 初始化蓝牙模块并设置设备名称
  */
-void BluetoothController::begin(const char* deviceName) {
-    BT.begin(deviceName);
-    Serial.print("蓝牙设备已启动，名称: ");
-    Serial.println(deviceName);
-    Serial.println("等待连接...");
+void BluetoothController::begin(const char* name) {
+    deviceName = name;
     
     // 初始状态为断开连接
     handleDisconnect();
+    
+    // 蓝牙协议栈初始化需要数百毫秒，放到核心0的任务中，不推迟灯带和舵机的第一帧
+    transportReady = false;
+    xTaskCreatePinnedToCore(transportTask, "bt-init", 4096, this, 1, NULL, 0);
+}
+
+/**
+ * @brief 后台初始化蓝牙协议栈
+ */
+void BluetoothController::transportTask(void* arg) {
+    BluetoothController* self = (BluetoothController*)arg;
+    self->BT.begin(self->deviceName);
+    Serial.print("蓝牙设备已启动，名称: ");
+    Serial.println(self->deviceName);
+    Serial.println("等待连接...");
+    self->transportReady = true;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 连接后恢复上次保存的模式
+ */
+void BluetoothController::restoreBootMode() {
+    const BootSettings& boot = BootState::get();
+    currentMode = boot.mode;
+    if (currentMode == "Follow") {
+        memcpy(params, boot.params, sizeof(params));
+    }
+    Serial.print("自动切换到");
+    Serial.print(currentMode);
+    Serial.println("模式");
+}
+
+/**
+ * @brief 设置各任务的周期
+ */
+void BluetoothController::initScheduler() {
+    scheduler.setPeriod(JOB_COMMS, 0);
+    scheduler.setPeriod(JOB_SERVO, SERVO_FRAME_US);
+    scheduler.setPeriod(JOB_LED, LED_FRAME_US);
 }
 
 /**
  * @brief 更新处理蓝牙命令并执行当前模式的动作
+ * @details 连接状态和命令每次调用都处理；舵机或灯带到期时才运行当前模式并输出到期的一方
  */
 void BluetoothController::update() {
+    uint32_t commsStart = micros();
+    scheduler.due(JOB_COMMS, commsStart);
+    
+    // 舵机和灯带输出先暂存，到期时才释放
+    outputLatch.stage();
+    
     // 检查连接状态
     bool connectionStatus = checkConnection();
     
@@ -68,9 +127,8 @@ void BluetoothController::update() {
     if (!isConnected && connectionStatus) {
         // 从断开状态到已连接状态
         Serial.println("蓝牙已连接");
-        // 自动切换到Idle模式
-        currentMode = "Idle";
-        Serial.println("自动切换到Idle模式");
+        // 自动切换到上次保存的模式
+        restoreBootMode();
     } else if (isConnected && !connectionStatus) {
         // 从已连接到断开连接
         Serial.println("蓝牙连接已断开");
@@ -82,23 +140,55 @@ void BluetoothController::update() {
     isConnected = connectionStatus;
     
     // 处理蓝牙命令
-    if (BT.available()) {
+    if (transportReady && BT.available()) {
+        latency.arrived(micros());
         String command = BT.readStringUntil('\n');
         command.trim();
+        
+        // 开始追踪延迟，去掉"@编号 "前缀
+        size_t offset = latency.begin(command.c_str());
+        if (offset > 0) {
+            command = command.substring(offset);
+        }
         Serial.print("收到命令: ");
         Serial.println(command);
+        PROFILE_BEGIN(PROFILE_PARSE);
         processCommand(command);
+        PROFILE_END();
+        latency.parsed();
         
         // 更新活动时间
         lastActivityTime = millis();
+        governor.inputReceived();
+    }
+    
+    // 按订阅频率发送遥测帧
+    if (transportReady && telemetry.due(millis())) {
+        sendTelemetry();
+    }
+    scheduler.record(JOB_COMMS, micros() - commsStart);
+    
+    uint32_t now = micros();
+    bool servoDue = scheduler.due(JOB_SERVO, now);
+    bool ledDue = scheduler.due(JOB_LED, now);
+    if (servoDue || ledDue) {
+        renderFrame(servoDue, ledDue);
     }
+}
+
+/**
+ * @brief 运行当前模式并输出到期的舵机或灯带
+ */
+void BluetoothController::renderFrame(bool servoDue, bool ledDue) {
+    PROFILE_SCOPE(PROFILE_FRAME);
     
     // 根据当前模式和连接状态执行相应操作
+    PROFILE_BEGIN(PROFILE_EFFECT);
     if (currentMode == "Disconnect") {
         // 断开连接状态处理
         handleDisconnect();
     } else if (currentMode == "Rainbow") {
-        lightBelt->rainbowCycle(periodMs);
+        lightBelt->rainbowCycle(periodMs, Palettes::get(PALETTE_RAINBOW));
         
         // 根据舵机平台类型调用相应的方法
         if (useInternalPWM) {
@@ -108,8 +198,7 @@ void BluetoothController::update() {
         }
     } else if (currentMode == "Heatup") {
         // 执行Heatup模式
-        uint32_t timeNow = millis();
-        uint32_t onColor = 0xFF0000;  // 红色
+        uint32_t timeNow = ShowClock::now();
         
         // 获取舵机总层数
         uint8_t totalServoLayers = 0;
@@ -119,8 +208,6 @@ void BluetoothController::update() {
             totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
         }
         
-        // 获取灯带总层数，通常是舵机层数的2倍
-        uint8_t totalLightLayers = lightBelt->getLayers();
         
         // 计算各层舵机角度
         for (uint8_t servoLayer = 0; servoLayer < totalServoLayers; servoLayer++) {
@@ -146,31 +233,14 @@ void BluetoothController::update() {
                 ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(servoLayer, mappedValue);
             }
             
-            // 计算亮度值，与舵机角度同步变化
-            uint8_t brightness = map(mappedValue, 0, 1023, 0, 255);
+            // 亮度与舵机角度同步变化，在调色板上取色
+            uint32_t color = Palettes::get(PALETTE_HEATUP).sample(map(mappedValue, 0, 1023, 0, 65535));
             
             // 设置对应层的灯带颜色
-            uint32_t dimmedColor = lightBelt->dimColor(onColor, brightness);
+            uint32_t dimmedColor = lightBelt->dimColor(color, 255);
             
-            // 针对灯带层数是舵机层数的2倍的情况，将两层灯带对应一层舵机
-            if (totalLightLayers >= totalServoLayers * 2) {
-                // 每层舵机对应两层灯带
-                uint8_t lightLayer1 = servoLayer * 2;
-                uint8_t lightLayer2 = servoLayer * 2 + 1;
-                
-                if (lightLayer1 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer1, dimmedColor);
-                }
-                
-                if (lightLayer2 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer2, dimmedColor);
-                }
-            } else {
-                // 灯带层数与舵机层数相同或更少的情况
-                if (servoLayer < totalLightLayers) {
-                    lightBelt->setLayerColor(servoLayer, dimmedColor);
-                }
-            }
+            // 设置该层舵机对应的灯带
+            setServoLayerColor(servoLayer, dimmedColor);
         }
     } else if (currentMode == "Cooldown") {
         // 执行Cooldown模式
@@ -191,7 +261,7 @@ void BluetoothController::update() {
         // 计算每层冷却时间 = 总时间 / 层数
         const uint32_t totalCooldownTime = 30000;  // 总冷却时间30秒
         const uint32_t layerCooldownTime = totalCooldownTime / totalServoLayers;  // 每层冷却时间
-        const uint32_t orangeColor = 0xFF8800;  // 橙黄色
+        const Palette& palette = Palettes::get(PALETTE_COOLDOWN);  // 默认为橙黄色
         
         // 如果是第一次执行或刚刚重置
         if (currentLayer == 0 && startTime == 0) {
@@ -206,7 +276,7 @@ void BluetoothController::update() {
             
             // 设置所有灯为橙黄色最亮
             for (uint8_t layer = 0; layer < totalLightLayers; layer++) {
-                lightBelt->setLayerColor(layer, orangeColor);
+                lightBelt->setLayerColor(layer, palette.at(255));
             }
             
             // 记录开始时间
@@ -238,31 +308,14 @@ void BluetoothController::update() {
                 ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(servoLayer, angleValue);
             }
             
-            // 计算亮度值（由最亮变为最暗）
-            uint8_t brightness = 255 * (1.0f - progress);
+            // 在调色板上由最亮变为最暗
+            uint16_t position = 65535 * (1.0f - progress);
             
             // 设置对应层灯带亮度
-            uint32_t dimmedColor = lightBelt->dimColor(orangeColor, brightness);
+            uint32_t dimmedColor = lightBelt->dimColor(palette.sample(position), 255);
             
-            // 针对灯带层数是舵机层数的2倍的情况
-            if (totalLightLayers >= totalServoLayers * 2) {
-                // 每层舵机对应两层灯带
-                uint8_t lightLayer1 = servoLayer * 2;
-                uint8_t lightLayer2 = servoLayer * 2 + 1;
-                
-                if (lightLayer1 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer1, dimmedColor);
-                }
-                
-                if (lightLayer2 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer2, dimmedColor);
-                }
-            } else {
-                // 灯带层数与舵机层数相同或更少的情况
-                if (servoLayer < totalLightLayers) {
-                    lightBelt->setLayerColor(servoLayer, dimmedColor);
-                }
-            }
+            // 设置该层舵机对应的灯带
+            setServoLayerColor(servoLayer, dimmedColor);
             
             // 如果当前层完成冷却
             if (progress >= 1.0f) {
@@ -274,25 +327,7 @@ void BluetoothController::update() {
                 }
                 
                 // 确保灯光完全变暗
-                // 针对灯带层数是舵机层数的2倍的情况
-                if (totalLightLayers >= totalServoLayers * 2) {
-                    // 每层舵机对应两层灯带
-                    uint8_t lightLayer1 = servoLayer * 2;
-                    uint8_t lightLayer2 = servoLayer * 2 + 1;
-                    
-                    if (lightLayer1 < totalLightLayers) {
-                        lightBelt->setLayerColor(lightLayer1, 0);
-                    }
-                    
-                    if (lightLayer2 < totalLightLayers) {
-                        lightBelt->setLayerColor(lightLayer2, 0);
-                    }
-                } else {
-                    // 灯带层数与舵机层数相同或更少的情况
-                    if (servoLayer < totalLightLayers) {
-                        lightBelt->setLayerColor(servoLayer, 0);
-                    }
-                }
+                setServoLayerColor(servoLayer, 0);
                 
                 // 移至下一层
                 currentLayer++;
@@ -336,17 +371,13 @@ void BluetoothController::update() {
         }
         
         // 蓝色呼吸灯效果（所有层相同颜色）
-        uint32_t blueColor = 0x0000FF; // 纯蓝色
-        lightBelt->breathing(blueColor, 3000); // 3秒周期的呼吸效果
+        lightBelt->breathing(Palettes::get(PALETTE_STANDBY), 3000); // 3秒周期的呼吸效果
     }
     else if (currentMode == "Idle") {
         // Idle模式: 白色呼吸灯效果，所有舵机回到最大角度
         
-        // 创建白色 (R=255, G=255, B=255)
-        uint32_t whiteColor = lightBelt->wheel(255);  // 白色
-        
         // 实现呼吸灯效果（所有层相同颜色）
-        lightBelt->breathing(whiteColor, 3000);  // 3秒周期的呼吸效果
+        lightBelt->breathing(Palettes::get(PALETTE_IDLE), 3000);  // 3秒周期的呼吸效果
         
         // 获取舵机层数
         uint8_t totalServoLayers = 0;
@@ -364,7 +395,10 @@ void BluetoothController::update() {
                 ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, 1023);
             }
         }
-    } else if (currentMode == "Follow") {
+    } else if (currentMode == "Timeline") {
+        // 按上传的关键帧在本地插值回放，没有关键帧的层保持不变
+        timeline.update(millis());
+        
         // 获取舵机层数
         uint8_t totalServoLayers = 0;
         if (useInternalPWM) {
@@ -373,8 +407,138 @@ void BluetoothController::update() {
             totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
         }
         
-        // 获取灯带总层数
+        for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+            int value;
+            if (!timeline.getServoValue(layer, value)) continue;
+            
+            if (useInternalPWM) {
+                ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, value);
+            } else {
+                ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, value);
+            }
+        }
+        
         uint8_t totalLightLayers = lightBelt->getLayers();
+        for (uint8_t layer = 0; layer < totalLightLayers; layer++) {
+            uint32_t color;
+            if (timeline.getLightColor(layer, color)) {
+                lightBelt->setLayerColor(layer, color);
+            }
+        }
+    } else if (currentMode == "Show") {
+        // 从SPIFFS流式播放演出，灯带只更新颜色发生变化的层，播放结束后保持最后一帧
+        if (showPlayer.update(millis()) || showPlayer.getChangedLights() != 0) {
+            // 获取舵机层数
+            uint8_t totalServoLayers = 0;
+            if (useInternalPWM) {
+                totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+            } else {
+                totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+            }
+            
+            for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+                int value;
+                if (!showPlayer.getServoValue(layer, value)) continue;
+                
+                if (useInternalPWM) {
+                    ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, value);
+                } else {
+                    ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, value);
+                }
+            }
+            
+            uint32_t changed = showPlayer.getChangedLights();
+            uint8_t totalLightLayers = lightBelt->getLayers();
+            for (uint8_t layer = 0; layer < totalLightLayers && layer < 32; layer++) {
+                uint32_t color;
+                if ((changed & (1UL << layer)) && showPlayer.getLightColor(layer, color)) {
+                    lightBelt->setLayerColor(layer, color);
+                }
+            }
+        }
+    } else if (currentMode == "Network") {
+        // 只在收到完整新帧时输出，没有新帧时保持当前画面
+        if (pixelReceiver && pixelReceiver->present()) {
+            // 获取舵机层数
+            uint8_t totalServoLayers = 0;
+            if (useInternalPWM) {
+                totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+            } else {
+                totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+            }
+            
+            for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+                int value;
+                if (!pixelReceiver->getServoValue(layer, value)) continue;
+                
+                if (useInternalPWM) {
+                    ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, value);
+                } else {
+                    ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, value);
+                }
+            }
+        }
+    } else if (currentMode == "Layers") {
+        // 舵机与Rainbow模式相同做相位差往复运动，灯带为多个效果层的叠加
+        uint8_t totalServoLayers = 0;
+        if (useInternalPWM) {
+            ((ServoPlatformInter*)servoPlatform)->sweepAllLayers(periodMs, 30.0);
+            totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+        } else {
+            ((ServoPlatform*)servoPlatform)->sweepAllLayers(periodMs, 30.0);
+            totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+        }
+        
+        // 每层取第一个舵机的输出，供Highlight层找出正在运动的层
+        uint16_t ticks[LAYER_MAP_MAX_SERVO_LAYERS];
+        totalServoLayers = min(totalServoLayers, (uint8_t)LAYER_MAP_MAX_SERVO_LAYERS);
+        for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+            if (useInternalPWM) {
+                ticks[layer] = ((ServoPlatformInter*)servoPlatform)->getServoTicks(layer * 2);
+            } else {
+                ticks[layer] = ((ServoPlatform*)servoPlatform)->getServoTicks(layer * 2);
+            }
+        }
+        compositor.trackServos(ticks, totalServoLayers);
+        
+        lightBelt->compose(compositor, layerMap);
+    } else if (currentMode == "Effect") {
+        // 运行上传的用户效果程序计算舵机输出和每个LED的颜色
+        if (effectVM.hasServoProgram()) {
+            uint8_t totalServoLayers = 0;
+            if (useInternalPWM) {
+                totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+            } else {
+                totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+            }
+            
+            int32_t inputs[INPUT_COUNT] = {0};
+            inputs[INPUT_TIME] = ShowClock::now() & 0x7FFFFFFF;
+            inputs[INPUT_LAYERS] = totalServoLayers;
+            for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+                inputs[INPUT_LAYER] = layer;
+                if (useInternalPWM) {
+                    ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, effectVM.runServo(inputs));
+                } else {
+                    ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, effectVM.runServo(inputs));
+                }
+            }
+        }
+        
+        lightBelt->renderEffect(effectVM);
+    } else if (currentMode == "Follow") {
+        // 带时间戳的Follow参数经抖动缓冲区延迟插值后输出
+        if (followBuffer.isActive()) {
+            followBuffer.sample(millis(), params);
+        }
+        
+        // 获取舵机层数
+        uint8_t totalServoLayers = 0;
+        if (useInternalPWM) {
+            totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+        } else {
+            totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+        }
         
         // 在Follow模式下，根据接收到的参数实时设置舵机角度和灯光效果
         for (int i = 0; i < totalServoLayers && i < 6; i++) {
@@ -388,42 +552,36 @@ void BluetoothController::update() {
                 ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(reversedLayer, params[i]);
             }
             
-            // 添加灯带灯光效果
-            // 1. 亮度和Follow参数成正比
-            uint8_t brightness = map(params[i], 0, 1023, 0, 255);
-            
-            // 2. 蓝色程度和参数成正比，越大越蓝，越小越白
-            // 从白色(0xFFFFFF)到蓝色(0x0000FF)的渐变
-            uint8_t blueValue = 255;  // 蓝色分量保持255
-            uint8_t whiteValue = 255 - map(params[i], 0, 1023, 0, 255);  // 红绿分量随参数减小
-            
-            // 构建RGB颜色
-            uint32_t color = (whiteValue << 16) | (whiteValue << 8) | blueValue;
+            // 添加灯带灯光效果：参数越大越亮越蓝，越小越暗越白
+            uint32_t color = Palettes::get(PALETTE_FOLLOW).sample(map(params[i], 0, 1023, 0, 65535));
             
-            // 调整亮度
-            uint32_t adjustedColor = lightBelt->dimColor(color, brightness);
+            // 调色板中已包含亮度，这里只应用最大亮度限制
+            uint32_t adjustedColor = lightBelt->dimColor(color, 255);
             
-            // 设置灯带颜色，每层舵机对应两层灯带
-            if (totalLightLayers >= totalServoLayers * 2) {
-                // 层号反向映射，对应两层灯带
-                uint8_t lightLayer1 = reversedLayer * 2;
-                uint8_t lightLayer2 = reversedLayer * 2 + 1;
-                
-                if (lightLayer1 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer1, adjustedColor);
-                }
-                
-                if (lightLayer2 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer2, adjustedColor);
-                }
-            } else {
-                // 灯带层数与舵机层数相同或更少的情况
-                if (reversedLayer < totalLightLayers) {
-                    lightBelt->setLayerColor(reversedLayer, adjustedColor);
-                }
-            }
+            // 设置该层舵机对应的灯带
+            setServoLayerColor(reversedLayer, adjustedColor);
         }
     }
+    PROFILE_END();
+    latency.effectDone();
+    
+    outputLatch.commit(servoDue, ledDue);
+    if (servoDue) scheduler.record(JOB_SERVO, outputLatch.getServoCommitMicros());
+    if (ledDue) scheduler.record(JOB_LED, outputLatch.getLedCommitMicros());
+    latency.outputDone(servoDue, ledDue, outputLatch.getServoDoneAt(), outputLatch.getLedDoneAt());
+    governor.frameDone(frameActivity(), outputLatch.outputChanged());
+    scheduler.setPeriodFloor((uint32_t)governor.getIntervalMs() * 1000);
+}
+
+/**
+ * @brief 当前模式对帧率的需求
+ * @details 订阅了遥测时保持正常帧率；Standby和断开状态为缓慢或静止的效果；Follow的输出只随命令变化
+ */
+FrameActivity BluetoothController::frameActivity() const {
+    if (telemetry.getRate() > 0) return FRAME_ACTIVE;
+    if (currentMode == "Standby" || currentMode == "Disconnect") return FRAME_SLOW;
+    if (currentMode == "Follow") return FRAME_ADAPTIVE;
+    return FRAME_ACTIVE;
 }
 
 /**
@@ -460,6 +618,220 @@ void BluetoothController::processCommand(String command) {
         return;
     }
     
+    // 输出并清空分阶段耗时统计
+    if (modeName == "Stats") {
+        Profiler::report(BT);
+        Profiler::reset();
+        followBuffer.report(BT);
+        followBuffer.resetCounters();
+        outputLatch.report(BT);
+        outputLatch.resetCounters();
+        governor.report(BT);
+        governor.resetCounters();
+        scheduler.report(BT);
+        scheduler.resetCounters();
+        latency.report(BT);
+        latency.resetCounters();
+        if (pixelReceiver) {
+            pixelReceiver->report(BT);
+        }
+        return;
+    }
+    
+    // 时间线命令：清空、上传关键帧、开始回放
+    if (modeName == "TimelineClear") {
+        timeline.clear();
+        BT.println("Timeline=Cleared");
+        return;
+    }
+    
+    if (modeName == "TimelineKey") {
+        String keys = command.substring(firstSeparator + 1);
+        if (timeline.addKeyframes(keys.c_str()) < 0) {
+            BT.println("Error=InvalidKeyframe");
+        }
+        BT.println("Timeline=" + String(timeline.getKeyframeCount()));
+        return;
+    }
+    
+    if (modeName == "TimelinePlay") {
+        timeline.play(millis(), newParams[0] != 0);
+        setPresetMode("Timeline");
+        return;
+    }
+    
+    // 播放SPIFFS中的演出文件：ShowPlay|/文件名.show|是否循环
+    if (modeName == "ShowPlay") {
+        String path = command.substring(firstSeparator + 1);
+        int pathEnd = path.indexOf('|');
+        if (pathEnd != -1) {
+            path = path.substring(0, pathEnd);
+        }
+        if (showPlayer.open(path.c_str(), millis(), newParams[1] != 0)) {
+            setPresetMode("Show");
+        } else {
+            BT.println("Error=ShowUnavailable");
+        }
+        return;
+    }
+    
+    // 查询多机时钟同步状态
+    if (modeName == "Clock") {
+        ShowClock::report(BT);
+        return;
+    }
+    
+    // 切换时钟同步角色：ClockLeader|1为主机，0为从机
+    if (modeName == "ClockLeader") {
+        ShowClock::setLeader(newParams[0] != 0);
+        ShowClock::report(BT);
+        return;
+    }
+    
+    // 由E1.31/Art-Net网络数据驱动
+    if (modeName == "Network") {
+        if (pixelReceiver) {
+            setPresetMode("Network");
+        } else {
+            BT.println("Error=NetworkDisabled");
+        }
+        return;
+    }
+    
+    // 带时间戳的控制模式：FollowT|时间戳ms|参数1|...|参数6，经抖动缓冲区平滑后输出
+    if (modeName == "FollowT") {
+        String remaining = command.substring(firstSeparator + 1);
+        uint32_t hostTime = strtoul(remaining.c_str(), NULL, 10);
+        int values[6] = {0};
+        
+        for (int i = 0; i < 6; i++) {
+            int separator = remaining.indexOf('|');
+            if (separator == -1) break;
+            remaining = remaining.substring(separator + 1);
+            values[i] = remaining.toInt();
+        }
+        
+        // 第一个带时间戳的样本切换到Follow模式，后续样本不再逐条确认以节省带宽
+        if (currentMode != "Follow" || !followBuffer.isActive()) {
+            setControlMode("Follow", values);
+        }
+        if (followBuffer.push(hostTime, values, millis())) {
+            latency.deferUntil(followBuffer.getLastPlayAt());
+        }
+        isConnected = true;
+        lastActivityTime = millis();
+        return;
+    }
+    
+    // 订阅二进制遥测流：Telemetry|每秒帧数，0为停止
+    if (modeName == "Telemetry") {
+        telemetry.setRate(constrain(newParams[0], 0, 100));
+        BT.println("Telemetry=" + String(telemetry.getRate()));
+        return;
+    }
+    
+    // 延迟追踪回显：Trace|1开启，Trace|0关闭
+    if (modeName == "Trace") {
+        latency.setEcho(newParams[0] != 0 ? &BT : NULL);
+        BT.println(latency.isEchoing() ? "Trace=On" : "Trace=Off");
+        return;
+    }
+    
+    // 设置抖动缓冲区延迟：FollowDelay|毫秒
+    if (modeName == "FollowDelay") {
+        followBuffer.setDelay(constrain(newParams[0], 0, 1000));
+        BT.println("FollowDelay=" + String(followBuffer.getDelay()));
+        return;
+    }
+    
+    // 调色板命令：PaletteClear|槽位|是否感知插值，PaletteStop|槽位|位置|颜色|...，PaletteUse|模式编号|槽位
+    if (modeName == "PaletteClear") {
+        int slot = newParams[0];
+        if (Palettes::clear(slot, newParams[1] != 0)) {
+            BT.println("PaletteClear=" + String(slot));
+        } else {
+            BT.println("Error=InvalidPalette");
+        }
+        return;
+    }
+    
+    if (modeName == "PaletteStop") {
+        int slot = newParams[0];
+        String stops = command.substring(firstSeparator + 1);
+        int stopsStart = stops.indexOf('|');
+        stops = stopsStart == -1 ? String("") : stops.substring(stopsStart + 1);
+        if (Palettes::addStops(slot, stops.c_str()) < 0) {
+            BT.println("Error=InvalidPalette");
+        } else {
+            BT.println("PaletteStops=" + String(Palettes::slot(slot).getStopCount()));
+        }
+        return;
+    }
+    
+    if (modeName == "PaletteUse") {
+        int role = newParams[0];
+        int slot = newParams[1];
+        if (Palettes::assign(role, slot)) {
+            BT.println("PaletteUse=" + String(role) + "," + String(slot));
+        } else {
+            BT.println("Error=InvalidPalette");
+        }
+        return;
+    }
+    
+    // 效果层命令：Layer|编号|效果|混合|不透明度|槽位|周期ms，LayersClear关闭全部效果层
+    if (modeName == "Layer") {
+        String args = command.substring(firstSeparator + 1);
+        int index = compositor.setLayer(args.c_str());
+        if (index < 0) {
+            BT.println("Error=InvalidLayer");
+        } else {
+            const EffectLayer& layer = compositor.getLayer(index);
+            BT.println("Layer=" + String(index) + "," + Compositor::effectName(layer.effect) + "," +
+                       Compositor::blendName(layer.blend) + "," + String(layer.opacity));
+        }
+        return;
+    }
+    
+    if (modeName == "LayersClear") {
+        compositor.clear();
+        BT.println("Layers=Cleared");
+        return;
+    }
+    
+    // 用户效果命令：EffectClear清空，EffectCode|十六进制分段上传，EffectRun校验后切换到Effect模式
+    if (modeName == "EffectClear") {
+        effectVM.clear();
+        BT.println("Effect=Cleared");
+        return;
+    }
+    
+    if (modeName == "EffectCode") {
+        String hex = command.substring(firstSeparator + 1);
+        if (effectVM.append(hex.c_str())) {
+            BT.println("EffectBytes=" + String(effectVM.getSize()));
+        } else {
+            BT.println("Error=InvalidEffectCode");
+        }
+        return;
+    }
+    
+    if (modeName == "EffectRun") {
+        uint8_t totalServoLayers = 0;
+        if (useInternalPWM) {
+            totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+        } else {
+            totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+        }
+        if (effectVM.load(totalServoLayers, lightBelt->getLedCount())) {
+            BT.println("Effect=" + String(effectVM.getFrameInstructions()));
+            setPresetMode("Effect");
+        } else {
+            BT.println("Error=InvalidEffect," + String(effectVM.getError()));
+        }
+        return;
+    }
+    
     // 舵机角度反转命令
     if (modeName == "ReverseAngle") {
         if (firstSeparator + 1 < command.length()) {
@@ -472,6 +844,7 @@ void BluetoothController::processCommand(String command) {
             }
             Serial.print("舵机角度反转模式: ");
             Serial.println(reverse ? "开启" : "关闭");
+            BootState::setReverseAngle(reverse);
             String response = "ReverseAngle=" + String(reverse ? "ON" : "OFF");
             BT.println(response);
         }
@@ -485,6 +858,7 @@ void BluetoothController::processCommand(String command) {
             lightBelt->setMaxBrightness(brightness);
             Serial.print("LED亮度设置为: ");
             Serial.println(brightness);
+            BootState::setBrightness(lightBelt->getMaxBrightness());
             String response = "Brightness=" + String(brightness);
             BT.println(response);
         }
@@ -493,7 +867,7 @@ void BluetoothController::processCommand(String command) {
     
     // 预设模式处理
     if (modeName == "Rainbow" || modeName == "Idle" || modeName == "Heatup" || 
-        modeName == "Cooldown" || modeName == "Standby") {
+        modeName == "Cooldown" || modeName == "Standby" || modeName == "Layers") {
         setPresetMode(modeName);
     }
     // 控制模式处理
@@ -514,6 +888,10 @@ void BluetoothController::processCommand(String command) {
  * @brief 设置预设模式（Rainbow或Idle）
  */
 void BluetoothController::setPresetMode(String modeName) {
+    // 离开Show模式时关闭演出文件
+    if (modeName != "Show") {
+        showPlayer.close();
+    }
     currentMode = modeName;
     Serial.print("设置预设模式: ");
     Serial.println(modeName);
@@ -521,12 +899,16 @@ void BluetoothController::setPresetMode(String modeName) {
     // 确认模式已设置
     String response = "Mode=" + modeName;
     BT.println(response);
+    
+    BootState::setMode(modeName.c_str(), NULL);
 }
 
 /**
  * @brief 设置控制模式（Follow）并更新控制参数
  */
 void BluetoothController::setControlMode(String modeName, int* parameters) {
+    showPlayer.close();
+    followBuffer.reset();
     currentMode = modeName;
     // 更新参数
     for (int i = 0; i < 6; i++) {
@@ -545,6 +927,8 @@ void BluetoothController::setControlMode(String modeName, int* parameters) {
     // 确认模式已设置
     String response = "Mode=" + modeName;
     BT.println(response);
+    
+    BootState::setMode("Follow", params);
 }
 
 /**
@@ -562,6 +946,44 @@ void BluetoothController::sendStatus() {
     Serial.println(response);
 }
 
+/**
+ * @brief 采集当前状态并发送一帧遥测数据
+ * 
+ * @details 字段顺序：帧耗时us、累计帧数、Follow接收数、过期丢弃数、欠载数、演出跳帧数，
+ * 随后为每个舵机通道的脉冲计数值和每个灯带层实际输出的颜色
+ */
+void BluetoothController::sendTelemetry() {
+    telemetry.beginFrame();
+    
+    const Profiler::StageStats& frameStats = Profiler::getStats(PROFILE_FRAME);
+    telemetry.addField(Profiler::cyclesToMicros(frameStats.lastCycles));
+    telemetry.addField(frameStats.count);
+    telemetry.addField(followBuffer.getReceived());
+    telemetry.addField(followBuffer.getLateDrops());
+    telemetry.addField(followBuffer.getUnderruns());
+    telemetry.addField(showPlayer.getLateFrames());
+    
+    uint8_t channels;
+    if (useInternalPWM) {
+        channels = ((ServoPlatformInter*)servoPlatform)->getChannelCount();
+    } else {
+        channels = ((ServoPlatform*)servoPlatform)->getChannelCount();
+    }
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        if (useInternalPWM) {
+            telemetry.addField(((ServoPlatformInter*)servoPlatform)->getServoTicks(ch));
+        } else {
+            telemetry.addField(((ServoPlatform*)servoPlatform)->getServoTicks(ch));
+        }
+    }
+    
+    for (uint8_t layer = 0; layer < lightBelt->getLayers(); layer++) {
+        telemetry.addField(lightBelt->getLayerColor(layer));
+    }
+    
+    telemetry.send(BT);
+}
+
 /**
  * @brief 检查蓝牙连接状态
  * 
@@ -569,6 +991,11 @@ void BluetoothController::sendStatus() {
  * @return false 如果连接已断开
  */
 bool BluetoothController::checkConnection() {
+    // 蓝牙协议栈尚未初始化完成
+    if (!transportReady) {
+        return false;
+    }
+    
     // 在实际连接上有活动
     if (BT.available()) {
         lastActivityTime = millis();
@@ -584,6 +1011,17 @@ bool BluetoothController::checkConnection() {
     return isConnected;
 }
 
+/**
+ * @brief 按映射表设置一层舵机对应的全部灯带
+ */
+void BluetoothController::setServoLayerColor(uint8_t servoLayer, uint32_t color) {
+    if (servoLayer >= layerMap.getServoLayers()) return;
+    
+    for (const LedSpan* span = layerMap.begin(servoLayer); span != layerMap.end(servoLayer); span++) {
+        lightBelt->setRangeColor(span->first, span->count, color);
+    }
+}
+
 /**
  * @brief 处理蓝牙断开连接状态
  */
@@ -606,8 +1044,7 @@ void BluetoothController::handleDisconnect() {
     }
     
     // 设置所有LED为蓝色常亮
-    uint32_t blueColor = lightBelt->wheel(170); // 蓝色对应wheel大约170
-    lightBelt->setAllLayersColor(blueColor);
+    lightBelt->setAllLayersColor(Palettes::get(PALETTE_STANDBY).at(255));
 }
 
 /**
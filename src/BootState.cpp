@@ -0,0 +1,109 @@
+#include "BootState.h"
+
+#if USE_BOOT_STATE
+#include <Preferences.h>
+#endif
+
+static const char* BOOT_STATE_NAMESPACE = "lightbelt";
+
+static const BootSettings BOOT_STATE_DEFAULTS = {
+    0, MAX_LED_BRIGHTNESS, REVERSE_SERVO_ANGLE, "Idle", {512, 512, 512, 512, 512, 512}
+};
+
+BootSettings BootState::settings = BOOT_STATE_DEFAULTS;
+bool BootState::dirty = false;
+uint32_t BootState::lastChange = 0;
+
+void BootState::begin() {
+    settings = BOOT_STATE_DEFAULTS;
+    dirty = false;
+    
+#if USE_BOOT_STATE
+    Preferences prefs;
+    if (!prefs.begin(BOOT_STATE_NAMESPACE, true)) {
+        // 首次启动命名空间还不存在
+        return;
+    }
+
+    settings.i2cAddress = prefs.getUChar("i2c", settings.i2cAddress);
+    float brightness = prefs.getFloat("bright", settings.brightness);
+    if (brightness >= 0.0f && brightness <= 1.0f) {
+        settings.brightness = brightness;
+    }
+    settings.reverseAngle = prefs.getBool("reverse", settings.reverseAngle);
+
+    char mode[sizeof(settings.mode)];
+    if (prefs.getString("mode", mode, sizeof(mode)) > 0 && isRestorable(mode)) {
+        strcpy(settings.mode, mode);
+    }
+    if (prefs.getBytesLength("params") == sizeof(settings.params)) {
+        prefs.getBytes("params", settings.params, sizeof(settings.params));
+    }
+    prefs.end();
+#endif
+}
+
+void BootState::update() {
+    if (dirty && millis() - lastChange >= BOOT_STATE_SAVE_DELAY_MS) {
+        flush();
+    }
+}
+
+void BootState::flush() {
+    if (!dirty) return;
+    dirty = false;
+
+#if USE_BOOT_STATE
+    Preferences prefs;
+    if (!prefs.begin(BOOT_STATE_NAMESPACE, false)) return;
+    prefs.putUChar("i2c", settings.i2cAddress);
+    prefs.putFloat("bright", settings.brightness);
+    prefs.putBool("reverse", settings.reverseAngle);
+    prefs.putString("mode", settings.mode);
+    prefs.putBytes("params", settings.params, sizeof(settings.params));
+    prefs.end();
+#endif
+}
+
+void BootState::setI2CAddress(uint8_t address) {
+    if (address == settings.i2cAddress) return;
+    settings.i2cAddress = address;
+    markDirty();
+}
+
+void BootState::setBrightness(float brightness) {
+    if (brightness == settings.brightness) return;
+    settings.brightness = brightness;
+    markDirty();
+}
+
+void BootState::setReverseAngle(bool reverse) {
+    if (reverse == settings.reverseAngle) return;
+    settings.reverseAngle = reverse;
+    markDirty();
+}
+
+void BootState::setMode(const char* mode, const int* params) {
+    if (!isRestorable(mode)) return;
+
+    bool changed = strcmp(mode, settings.mode) != 0;
+    strcpy(settings.mode, mode);
+    if (params) {
+        changed = changed || memcmp(params, settings.params, sizeof(settings.params)) != 0;
+        memcpy(settings.params, params, sizeof(settings.params));
+    }
+    if (changed) markDirty();
+}
+
+bool BootState::isRestorable(const char* mode) {
+    // 时间线、演出文件和网络数据重启后不在内存中，不恢复
+    return strcmp(mode, "Rainbow") == 0 || strcmp(mode, "Idle") == 0 ||
+           strcmp(mode, "Heatup") == 0 || strcmp(mode, "Cooldown") == 0 ||
+           strcmp(mode, "Standby") == 0 || strcmp(mode, "Follow") == 0;
+}
+
+void BootState::markDirty() {
+    // 每次变化都重新计时，设置静默一段时间后才写入
+    dirty = true;
+    lastChange = millis();
+}
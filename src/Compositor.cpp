@@ -0,0 +1,300 @@
+/**
+ * @file Compositor.cpp
+ * @brief 效果层设置、每帧颜色计算和混合
+ */
+
+#include "Compositor.h"
+#include "PixelKernels.h"
+
+static const char* const EFFECT_NAMES[EFFECT_COUNT] = {
+    "Off", "Solid", "Rainbow", "Breathing", "Pulse", "Highlight"
+};
+
+static const char* const BLEND_NAMES[BLEND_COUNT] = {
+    "Replace", "Add", "Multiply", "Alpha"
+};
+
+// 各效果默认使用的内置调色板
+static const uint8_t EFFECT_PALETTES[EFFECT_COUNT] = {
+    PALETTE_RAINBOW, PALETTE_IDLE, PALETTE_RAINBOW, PALETTE_IDLE, PALETTE_HEATUP, PALETTE_IDLE
+};
+
+static const uint32_t DEFAULT_PERIOD_MS = 3000;
+
+static void unpackColor(uint32_t color, uint8_t* rgb) {
+    rgb[0] = color >> 16;
+    rgb[1] = color >> 8;
+    rgb[2] = color;
+}
+
+/**
+ * @brief 按最大亮度缩放后拆分，与LightBelt::dimColor(color, 255)相同
+ */
+static void unpackDimmed(uint32_t color, float maxBrightness, uint8_t* rgb) {
+    rgb[0] = (uint8_t)(color >> 16) * maxBrightness;
+    rgb[1] = (uint8_t)(color >> 8) * maxBrightness;
+    rgb[2] = (uint8_t)color * maxBrightness;
+}
+
+/**
+ * @brief 0-255的不透明度转为PixelKernels使用的0-256
+ */
+static uint16_t kernelAlpha(uint8_t alpha) {
+    return alpha + (alpha >> 7);
+}
+
+/**
+ * @brief 在名称表中查找'|'或字符串结尾之前的名称
+ * @return 序号，找不到时返回-1
+ */
+static int findName(const char* const* names, uint8_t count, const char* text, const char** end) {
+    const char* stop = strchr(text, '|');
+    if (!stop) stop = text + strlen(text);
+    *end = stop;
+    size_t length = stop - text;
+    for (uint8_t i = 0; i < count; i++) {
+        if (strlen(names[i]) == length && strncmp(names[i], text, length) == 0) return i;
+    }
+    return -1;
+}
+
+Compositor::Compositor()
+    : layerMap(NULL), lightLayers(0), ledsPerLayer(0), ledCount(0), trackedLayers(0), movingLayer(-1) {
+    memset(frameColor, 0, sizeof(frameColor));
+    memset(servoColor, 0, sizeof(servoColor));
+    memset(wheelPos, 0, sizeof(wheelPos));
+    memset(lastTicks, 0, sizeof(lastTicks));
+
+    clear();
+    setLayer(0, EFFECT_RAINBOW, BLEND_REPLACE, 255, PALETTE_RAINBOW, 10000);
+    setLayer(1, EFFECT_PULSE, BLEND_ADD, 160, PALETTE_HEATUP, DEFAULT_PERIOD_MS);
+}
+
+void Compositor::clear() {
+    for (uint8_t i = 0; i < MAX_LAYERS; i++) {
+        layers[i].effect = EFFECT_OFF;
+        layers[i].blend = BLEND_REPLACE;
+        layers[i].opacity = 255;
+        layers[i].paletteSlot = 0;
+        layers[i].periodMs = DEFAULT_PERIOD_MS;
+    }
+}
+
+bool Compositor::setLayer(int index, int effect, int blend, int opacity, int paletteSlot, uint32_t periodMs) {
+    if (index < 0 || index >= MAX_LAYERS) return false;
+    if (effect < 0 || effect >= EFFECT_COUNT || blend < 0 || blend >= BLEND_COUNT) return false;
+    if (paletteSlot < 0 || paletteSlot >= Palettes::SLOT_COUNT) return false;
+
+    EffectLayer& layer = layers[index];
+    layer.effect = (LayerEffect)effect;
+    layer.blend = (BlendMode)blend;
+    layer.opacity = constrain(opacity, 0, 255);
+    layer.paletteSlot = paletteSlot;
+    layer.periodMs = periodMs > 0 ? periodMs : DEFAULT_PERIOD_MS;
+    return true;
+}
+
+int Compositor::setLayer(const char* args) {
+    if (!args) return -1;
+
+    char* end;
+    long index = strtol(args, &end, 10);
+    if (end == args || *end != '|') return -1;
+
+    const char* stop;
+    int effect = findName(EFFECT_NAMES, EFFECT_COUNT, end + 1, &stop);
+    if (effect < 0) return -1;
+
+    int blend = BLEND_REPLACE;
+    if (*stop == '|') {
+        blend = findName(BLEND_NAMES, BLEND_COUNT, stop + 1, &stop);
+        if (blend < 0) return -1;
+    }
+
+    // 不透明度、槽位和周期可以省略
+    long values[3] = {255, EFFECT_PALETTES[effect], DEFAULT_PERIOD_MS};
+    const char* p = stop;
+    for (uint8_t i = 0; i < 3 && *p == '|'; i++) {
+        values[i] = strtol(p + 1, &end, 0);
+        if (end == p + 1) return -1;
+        p = end;
+    }
+    if (*p != '\0') return -1;
+    if (values[0] < 0 || values[0] > 255 || values[2] < 0) return -1;
+
+    if (!setLayer(index, effect, blend, values[0], values[1], values[2])) return -1;
+    return index;
+}
+
+uint8_t Compositor::getLayerCount() const {
+    uint8_t count = MAX_LAYERS;
+    while (count > 0 && layers[count - 1].effect == EFFECT_OFF) count--;
+    return count;
+}
+
+void Compositor::trackServos(const uint16_t* ticks, uint8_t servoLayers) {
+    servoLayers = min(servoLayers, (uint8_t)LAYER_MAP_MAX_SERVO_LAYERS);
+
+    if (servoLayers == trackedLayers) {
+        uint16_t largest = 0;
+        for (uint8_t i = 0; i < servoLayers; i++) {
+            uint16_t delta = ticks[i] > lastTicks[i] ? ticks[i] - lastTicks[i] : lastTicks[i] - ticks[i];
+            if (delta > largest) {
+                largest = delta;
+                movingLayer = i;
+            }
+        }
+    } else {
+        // 层数变化时只记录，下一帧再比较
+        movingLayer = -1;
+    }
+
+    memcpy(lastTicks, ticks, servoLayers * sizeof(uint16_t));
+    trackedLayers = servoLayers;
+}
+
+void Compositor::prepare(uint32_t now, const LayerMap& map, uint8_t numLightLayers, uint8_t numLedsPerLayer,
+                         float maxBrightness) {
+    layerMap = &map;
+    lightLayers = numLightLayers;
+    ledsPerLayer = numLedsPerLayer;
+    ledCount = (uint16_t)numLightLayers * numLedsPerLayer;
+
+    uint8_t count = getLayerCount();
+    for (uint8_t i = 0; i < count; i++) {
+        const EffectLayer& layer = layers[i];
+        const Palette& palette = Palettes::slot(layer.paletteSlot);
+        uint32_t elapsed = now % layer.periodMs;
+
+        switch (layer.effect) {
+        case EFFECT_SOLID:
+        case EFFECT_HIGHLIGHT:
+            unpackColor(palette.at(255), frameColor[i]);
+            break;
+
+        case EFFECT_RAINBOW:
+            wheelPos[i] = ((uint64_t)elapsed * 256) / layer.periodMs;
+            break;
+
+        case EFFECT_BREATHING: {
+            // 与LightBelt::breathing()相同的正弦位置和亮度
+            float sinValue = sin(elapsed / (float)layer.periodMs * 2 * PI);
+            unpackDimmed(palette.sample((sinValue + 1.0) * 32767.5), maxBrightness, frameColor[i]);
+            break;
+        }
+
+        case EFFECT_PULSE: {
+            // 与Heatup模式相同的三角波和亮度，奇数层相差半个周期
+            uint16_t phase = ((uint64_t)elapsed << 16) / layer.periodMs;
+            for (uint8_t s = 0; s < map.getServoLayers(); s++) {
+                uint16_t layerPhase = s % 2 == 1 ? phase ^ 0x8000 : phase;
+                uint16_t position = layerPhase < 0x8000 ? layerPhase * 2 : (0xFFFF - layerPhase) * 2;
+                unpackDimmed(palette.sample(position), maxBrightness, servoColor[i][s]);
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
+void Compositor::run(uint8_t index, uint16_t led, CompositorRun& out) const {
+    const EffectLayer& layer = layers[index];
+    out.end = ledCount;
+    out.coverage = 255;
+
+    switch (layer.effect) {
+    case EFFECT_SOLID:
+    case EFFECT_BREATHING:
+        memcpy(out.rgb, frameColor[index], 3);
+        break;
+
+    case EFFECT_RAINBOW: {
+        uint8_t lightLayer = led / ledsPerLayer;
+        uint8_t position = (wheelPos[index] + (lightLayer * 256 / lightLayers)) & 255;
+        unpackColor(Palettes::slot(layer.paletteSlot).at(position), out.rgb);
+        out.end = (uint16_t)(lightLayer + 1) * ledsPerLayer;
+        break;
+    }
+
+    case EFFECT_PULSE:
+    case EFFECT_HIGHLIGHT:
+        servoRun(index, led, out);
+        break;
+
+    default:
+        out.coverage = 0;
+        break;
+    }
+}
+
+void Compositor::servoRun(uint8_t index, uint16_t led, CompositorRun& out) const {
+    const EffectLayer& layer = layers[index];
+
+    // 没有舵机层覆盖的LED透明，直到下一段开始
+    out.coverage = 0;
+    for (uint8_t s = 0; s < layerMap->getServoLayers(); s++) {
+        for (const LedSpan* span = layerMap->begin(s); span != layerMap->end(s); span++) {
+            uint16_t spanEnd = span->first + span->count;
+            if (led >= span->first && led < spanEnd) {
+                out.end = spanEnd;
+                if (layer.effect == EFFECT_PULSE) {
+                    memcpy(out.rgb, servoColor[index][s], 3);
+                    out.coverage = 255;
+                } else if (s == movingLayer) {
+                    memcpy(out.rgb, frameColor[index], 3);
+                    out.coverage = 255;
+                }
+                return;
+            }
+            if (span->first > led && span->first < out.end) {
+                out.end = span->first;
+            }
+        }
+    }
+}
+
+void Compositor::apply(uint8_t index, const CompositorRun& run, uint8_t* rgb) const {
+    if (run.coverage == 0) return;
+
+    const EffectLayer& layer = layers[index];
+    uint8_t alpha = (layer.opacity * run.coverage + 127) / 255;
+    uint8_t src[3];
+
+    switch (layer.blend) {
+    case BLEND_REPLACE:
+        memcpy(rgb, run.rgb, 3);
+        PixelKernels::scale(rgb, 3, kernelAlpha(alpha));
+        break;
+
+    case BLEND_ADD:
+        memcpy(src, run.rgb, 3);
+        PixelKernels::scale(src, 3, kernelAlpha(alpha));
+        PixelKernels::addSaturate(rgb, src, 3);
+        break;
+
+    case BLEND_MULTIPLY:
+        for (uint8_t c = 0; c < 3; c++) {
+            src[c] = (rgb[c] * run.rgb[c] + 127) / 255;
+        }
+        PixelKernels::blend(rgb, src, 3, kernelAlpha(alpha));
+        break;
+
+    case BLEND_ALPHA:
+        PixelKernels::blend(rgb, run.rgb, 3, kernelAlpha(alpha));
+        break;
+
+    default:
+        break;
+    }
+}
+
+const char* Compositor::effectName(uint8_t effect) {
+    return effect < EFFECT_COUNT ? EFFECT_NAMES[effect] : "";
+}
+
+const char* Compositor::blendName(uint8_t blend) {
+    return blend < BLEND_COUNT ? BLEND_NAMES[blend] : "";
+}
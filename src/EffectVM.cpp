@@ -0,0 +1,301 @@
+/**
+ * @file EffectVM.cpp
+ * @brief 效果字节码的加载校验与解释执行
+ */
+
+#include "EffectVM.h"
+
+/**
+ * @brief 每个操作码的立即数字节数和栈效果
+ */
+struct OpInfo {
+    uint8_t immediate;
+    uint8_t pops;
+    uint8_t pushes;
+};
+
+static const OpInfo OP_INFO[OP_COUNT] = {
+    {0, 1, 0},  // END
+    {1, 0, 1},  // PUSH8
+    {2, 0, 1},  // PUSH16
+    {4, 0, 1},  // PUSH32
+    {1, 0, 1},  // IN
+    {1, 0, 1},  // GET
+    {1, 1, 0},  // SET
+    {0, 2, 1},  // ADD
+    {0, 2, 1},  // SUB
+    {0, 2, 1},  // MUL
+    {0, 2, 1},  // DIV
+    {0, 2, 1},  // MOD
+    {0, 2, 1},  // AND
+    {0, 2, 1},  // OR
+    {0, 2, 1},  // XOR
+    {0, 2, 1},  // SHL
+    {0, 2, 1},  // SHR
+    {0, 2, 1},  // EQ
+    {0, 2, 1},  // NE
+    {0, 2, 1},  // LT
+    {0, 2, 1},  // LE
+    {0, 2, 1},  // GT
+    {0, 2, 1},  // GE
+    {0, 1, 1},  // NEG
+    {0, 1, 1},  // NOT
+    {0, 1, 1},  // LNOT
+    {0, 2, 1},  // MIN
+    {0, 2, 1},  // MAX
+    {0, 1, 1},  // ABS
+    {0, 1, 1},  // SIN8
+    {0, 1, 1},  // TRI8
+    {0, 3, 1},  // CLAMP
+    {0, 3, 1},  // RGB
+    {1, 1, 0},  // JZ
+    {1, 0, 0},  // JMP
+};
+
+// 四分之一周期的正弦表，幅度127
+static const uint8_t SINE_QUARTER[65] = {
+    0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46, 49, 51, 54, 57, 60, 63,
+    65, 68, 71, 73, 76, 78, 81, 83, 85, 88, 90, 92, 94, 96, 98, 100, 102, 104, 106, 107,
+    109, 111, 112, 113, 115, 116, 117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126,
+    126, 126, 127, 127, 127, 127
+};
+
+static inline int32_t sine8(int32_t x) {
+    uint8_t phase = x;
+    uint8_t quarter = phase & 63;
+    uint8_t value = (phase & 64) ? SINE_QUARTER[64 - quarter] : SINE_QUARTER[quarter];
+    return (phase & 128) ? 128 - value : 128 + value;
+}
+
+static inline int32_t triangle8(int32_t x) {
+    uint8_t phase = x;
+    return phase < 128 ? phase * 2 : (255 - phase) * 2;
+}
+
+static inline int32_t clampByte(int32_t v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+EffectVM::EffectVM() {
+    clear();
+}
+
+void EffectVM::clear() {
+    size = 0;
+    loaded = false;
+    servoCode = NULL;
+    pixelCode = NULL;
+    frameInstructions = 0;
+    error = NULL;
+}
+
+bool EffectVM::append(const char* hex) {
+    if (!hex) return false;
+
+    // 先检查整段，格式正确后再写入
+    size_t length = strlen(hex);
+    if (length == 0 || length % 2 != 0 || size + length / 2 > EFFECT_VM_MAX_CODE) return false;
+    for (size_t i = 0; i < length; i++) {
+        if (hexDigit(hex[i]) < 0) return false;
+    }
+
+    // 缓冲区将被改写，已加载的程序失效，重新EffectRun之前不再运行
+    loaded = false;
+    servoCode = NULL;
+    pixelCode = NULL;
+    for (size_t i = 0; i < length; i += 2) {
+        code[size++] = (hexDigit(hex[i]) << 4) | hexDigit(hex[i + 1]);
+    }
+    return true;
+}
+
+bool EffectVM::load(uint8_t servoLayers, uint16_t ledCount) {
+    loaded = false;
+    servoCode = NULL;
+    pixelCode = NULL;
+
+    if (size < 2 || code[0] != VERSION) {
+        error = "header";
+        return false;
+    }
+    uint8_t servoSize = code[1];
+    if (2 + servoSize >= size) {
+        error = "header";
+        return false;
+    }
+
+    uint16_t servoInstructions = 0;
+    if (servoSize > 0) {
+        error = verify(code + 2, servoSize, &servoInstructions);
+        if (error) return false;
+    }
+
+    uint16_t pixelInstructions = 0;
+    error = verify(code + 2 + servoSize, size - 2 - servoSize, &pixelInstructions);
+    if (error) return false;
+
+    frameInstructions = (uint32_t)servoInstructions * servoLayers + (uint32_t)pixelInstructions * ledCount;
+    if (frameInstructions > EFFECT_VM_FRAME_BUDGET) {
+        error = "budget";
+        return false;
+    }
+
+    servoCode = servoSize > 0 ? code + 2 : NULL;
+    pixelCode = code + 2 + servoSize;
+    loaded = true;
+    return true;
+}
+
+const char* EffectVM::verify(const uint8_t* code, uint16_t length, uint16_t* instructions) {
+    // 每个字节位置由跳转确定的栈深度，-1为还没有跳转到达
+    int8_t targetDepth[EFFECT_VM_MAX_CODE];
+    memset(targetDepth, -1, sizeof(targetDepth));
+
+    int depth = 0;
+    bool reachable = true;
+    uint16_t count = 0;
+    uint16_t pc = 0;
+    while (pc < length) {
+        // 跳转目标处的深度必须与顺序执行到达时一致
+        if (targetDepth[pc] >= 0) {
+            if (reachable && targetDepth[pc] != depth) return "stack";
+            depth = targetDepth[pc];
+            reachable = true;
+        }
+        if (!reachable) return "unreachable";
+
+        uint8_t op = code[pc];
+        if (op >= OP_COUNT) return "opcode";
+        const OpInfo& info = OP_INFO[op];
+        if (pc + 1 + info.immediate > length) return "truncated";
+
+        if (depth < info.pops) return "stack";
+        depth += info.pushes - info.pops;
+        if (depth > EFFECT_VM_STACK) return "stack";
+
+        uint8_t immediate = info.immediate > 0 ? code[pc + 1] : 0;
+        if (op == OP_IN && immediate >= INPUT_COUNT) return "input";
+        if ((op == OP_GET || op == OP_SET) && immediate >= EFFECT_VM_LOCALS) return "local";
+
+        count++;
+        uint16_t next = pc + 1 + info.immediate;
+        for (uint16_t i = pc + 1; i < next; i++) {
+            // 跳转不能落在立即数中间
+            if (targetDepth[i] >= 0) return "jump";
+        }
+        if (op == OP_JZ || op == OP_JMP) {
+            uint16_t target = next + immediate;
+            if (target >= length) return "jump";
+            if (targetDepth[target] >= 0 && targetDepth[target] != depth) return "stack";
+            targetDepth[target] = depth;
+            if (op == OP_JMP) reachable = false;
+        }
+        if (op == OP_END) {
+            // END弹出结果后栈必须为空，且为段的最后一条指令
+            if (depth != 0) return "stack";
+            if (next != length) return "trailing";
+            *instructions = count;
+            return NULL;
+        }
+        pc = next;
+    }
+    return "missing end";
+}
+
+int32_t EffectVM::runServo(const int32_t* inputs) const {
+    int32_t value = run(servoCode, inputs);
+    return value < 0 ? 0 : (value > 1023 ? 1023 : value);
+}
+
+int32_t EffectVM::run(const uint8_t* pc, const int32_t* inputs) const {
+    if (!pc) return 0;
+
+    // 已校验：栈不会越界，跳转都在段内
+    int32_t stack[EFFECT_VM_STACK];
+    int32_t locals[EFFECT_VM_LOCALS] = {0};
+    int32_t* sp = stack;
+
+    for (;;) {
+        uint8_t op = *pc++;
+        switch (op) {
+        case OP_END:
+            return sp[-1];
+        case OP_PUSH8:
+            *sp++ = (int8_t)*pc++;
+            break;
+        case OP_PUSH16:
+            *sp++ = (int16_t)(pc[0] | (pc[1] << 8));
+            pc += 2;
+            break;
+        case OP_PUSH32:
+            *sp++ = (int32_t)((uint32_t)pc[0] | ((uint32_t)pc[1] << 8) | ((uint32_t)pc[2] << 16) | ((uint32_t)pc[3] << 24));
+            pc += 4;
+            break;
+        case OP_IN:
+            *sp++ = inputs[*pc++];
+            break;
+        case OP_GET:
+            *sp++ = locals[*pc++];
+            break;
+        case OP_SET:
+            locals[*pc++] = *--sp;
+            break;
+        case OP_ADD: sp--; sp[-1] = (int32_t)((uint32_t)sp[-1] + (uint32_t)sp[0]); break;
+        case OP_SUB: sp--; sp[-1] = (int32_t)((uint32_t)sp[-1] - (uint32_t)sp[0]); break;
+        case OP_MUL: sp--; sp[-1] = (int32_t)((uint32_t)sp[-1] * (uint32_t)sp[0]); break;
+        case OP_DIV:
+            sp--;
+            // 除0为0，INT32_MIN / -1按回绕处理
+            sp[-1] = sp[0] == 0 ? 0 : (sp[0] == -1 ? (int32_t)(0u - (uint32_t)sp[-1]) : sp[-1] / sp[0]);
+            break;
+        case OP_MOD:
+            sp--;
+            sp[-1] = (sp[0] == 0 || sp[0] == -1) ? 0 : sp[-1] % sp[0];
+            break;
+        case OP_AND: sp--; sp[-1] &= sp[0]; break;
+        case OP_OR:  sp--; sp[-1] |= sp[0]; break;
+        case OP_XOR: sp--; sp[-1] ^= sp[0]; break;
+        case OP_SHL: sp--; sp[-1] = (int32_t)((uint32_t)sp[-1] << (sp[0] & 31)); break;
+        case OP_SHR: sp--; sp[-1] = sp[-1] >> (sp[0] & 31); break;
+        case OP_EQ:  sp--; sp[-1] = sp[-1] == sp[0]; break;
+        case OP_NE:  sp--; sp[-1] = sp[-1] != sp[0]; break;
+        case OP_LT:  sp--; sp[-1] = sp[-1] < sp[0]; break;
+        case OP_LE:  sp--; sp[-1] = sp[-1] <= sp[0]; break;
+        case OP_GT:  sp--; sp[-1] = sp[-1] > sp[0]; break;
+        case OP_GE:  sp--; sp[-1] = sp[-1] >= sp[0]; break;
+        case OP_NEG: sp[-1] = (int32_t)(0u - (uint32_t)sp[-1]); break;
+        case OP_NOT: sp[-1] = ~sp[-1]; break;
+        case OP_LNOT: sp[-1] = !sp[-1]; break;
+        case OP_MIN: sp--; sp[-1] = sp[0] < sp[-1] ? sp[0] : sp[-1]; break;
+        case OP_MAX: sp--; sp[-1] = sp[0] > sp[-1] ? sp[0] : sp[-1]; break;
+        case OP_ABS: sp[-1] = sp[-1] < 0 ? (int32_t)(0u - (uint32_t)sp[-1]) : sp[-1]; break;
+        case OP_SIN8: sp[-1] = sine8(sp[-1]); break;
+        case OP_TRI8: sp[-1] = triangle8(sp[-1]); break;
+        case OP_CLAMP:
+            sp -= 2;
+            sp[-1] = sp[-1] < sp[0] ? sp[0] : (sp[-1] > sp[1] ? sp[1] : sp[-1]);
+            break;
+        case OP_RGB:
+            sp -= 2;
+            sp[-1] = (clampByte(sp[-1]) << 16) | (clampByte(sp[0]) << 8) | clampByte(sp[1]);
+            break;
+        case OP_JZ: {
+            uint8_t offset = *pc++;
+            if (*--sp == 0) pc += offset;
+            break;
+        }
+        case OP_JMP:
+            pc += *pc + 1;
+            break;
+        default:
+            return 0;
+        }
+    }
+}
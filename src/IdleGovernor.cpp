@@ -0,0 +1,136 @@
+/**
+ * @file IdleGovernor.cpp
+ * @brief 按模式和输出变化调整帧间隔，空闲时浅睡眠
+ */
+
+#include "IdleGovernor.h"
+#include "esp_sleep.h"
+#include "driver/uart.h"
+
+// 估算功耗用的电流（mA）：ESP32数据手册中240MHz双核运行约68mA，
+// 延时期间CPU在空闲任务中停在WAITI约30mA，浅睡眠约0.8mA
+static const float ACTIVE_MILLIAMPS = 68.0f;
+static const float WAIT_MILLIAMPS = 30.0f;
+static const float SLEEP_MILLIAMPS = 0.8f;
+static const float SUPPLY_VOLTS = 3.3f;
+
+// 串口RX上多少个上升沿唤醒浅睡眠，用于唤醒的字节会丢失
+static const int UART_WAKEUP_EDGES = 3;
+
+IdleGovernor::IdleGovernor() {
+    activity = FRAME_ACTIVE;
+    intervalMs = 0;
+    sleepAllowed = false;
+    lastInputMs = 0;
+    frameStart = micros();
+    resetCounters();
+}
+
+void IdleGovernor::setLightSleep(bool allowed) {
+#if IDLE_GOVERNOR && IDLE_LIGHT_SLEEP
+    sleepAllowed = allowed;
+    if (allowed) {
+        uart_set_wakeup_threshold(UART_NUM_0, UART_WAKEUP_EDGES);
+        esp_sleep_enable_uart_wakeup(UART_NUM_0);
+    }
+#else
+    (void)allowed;
+#endif
+}
+
+void IdleGovernor::frameDone(FrameActivity frameActivity, bool outputChanged) {
+    frames++;
+#if IDLE_GOVERNOR
+    uint16_t base = frameActivity == FRAME_SLOW ? IDLE_SLOW_FRAME_MS : 0;
+    if (frameActivity == FRAME_ACTIVE || outputChanged || frameActivity != activity) {
+        intervalMs = base;
+    } else {
+        // 输出连续不变，下一帧推迟一倍，从灯带的输出周期开始
+        uint16_t current = intervalMs > LED_FRAME_US / 1000 ? intervalMs : LED_FRAME_US / 1000;
+        intervalMs = current * 2 > IDLE_MAX_FRAME_MS ? IDLE_MAX_FRAME_MS : current * 2;
+    }
+    activity = frameActivity;
+#else
+    (void)frameActivity;
+    (void)outputChanged;
+#endif
+}
+
+void IdleGovernor::inputReceived() {
+    intervalMs = 0;
+    lastInputMs = millis();
+}
+
+void IdleGovernor::wait(Stream& input, uint32_t durationMicros) {
+    uint32_t start = micros();
+    activeMicros += start - frameStart;
+
+#if IDLE_GOVERNOR
+    // 唤醒的字节会丢失，只在缓慢变化的模式中睡眠，Follow和Stream的输入不能截断
+    if (durationMicros > 0 && sleepAllowed && activity == FRAME_SLOW &&
+        millis() - lastInputMs >= IDLE_SLEEP_AFTER_MS) {
+        // 回复发送完再睡眠，否则会被截断
+        Serial.flush();
+        esp_sleep_enable_timer_wakeup(durationMicros);
+        esp_light_sleep_start();
+        if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UART) inputReceived();
+        frameStart = micros();
+        sleepMicros += frameStart - start;
+        return;
+    }
+#endif
+
+    // 每毫秒检查一次输入，收到数据立即返回处理命令；最后不足1ms的部分精确等待，任务按时到期
+    uint32_t elapsed;
+    while ((elapsed = micros() - start) < durationMicros) {
+        if (input.available()) break;
+        uint32_t remaining = durationMicros - elapsed;
+        if (remaining >= 1000) {
+            delay(1);
+        } else {
+            delayMicroseconds(remaining);
+        }
+    }
+
+    frameStart = micros();
+    waitMicros += frameStart - start;
+}
+
+void IdleGovernor::resetCounters() {
+    frames = 0;
+    activeMicros = 0;
+    waitMicros = 0;
+    sleepMicros = 0;
+}
+
+float IdleGovernor::getFrameRate() const {
+    uint64_t total = activeMicros + waitMicros + sleepMicros;
+    return total ? frames * 1e6f / total : 0;
+}
+
+float IdleGovernor::energyPerHour(uint64_t activeMicros, uint64_t waitMicros, uint64_t sleepMicros) {
+    uint64_t total = activeMicros + waitMicros + sleepMicros;
+    if (total == 0) return 0;
+    float milliamps = (activeMicros * ACTIVE_MILLIAMPS + waitMicros * WAIT_MILLIAMPS +
+                       sleepMicros * SLEEP_MILLIAMPS) / total;
+    return milliamps * SUPPLY_VOLTS;
+}
+
+void IdleGovernor::report(Print& out) const {
+    uint64_t total = activeMicros + waitMicros + sleepMicros;
+    // Governor|帧数|帧率|当前间隔ms|运行%|等待%|睡眠%|mWh每小时
+    out.print("Governor|");
+    out.print(frames);
+    out.print("|");
+    out.print(getFrameRate(), 1);
+    out.print("|");
+    out.print(intervalMs);
+    out.print("|");
+    out.print(total ? (unsigned)(activeMicros * 100 / total) : 0u);
+    out.print("|");
+    out.print(total ? (unsigned)(waitMicros * 100 / total) : 0u);
+    out.print("|");
+    out.print(total ? (unsigned)(sleepMicros * 100 / total) : 0u);
+    out.print("|");
+    out.println(getEnergyPerHour(), 1);
+}
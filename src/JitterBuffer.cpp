@@ -0,0 +1,142 @@
+/**
+ * @file JitterBuffer.cpp
+ * @brief Follow设定值抖动缓冲区实现
+ */
+
+#include "JitterBuffer.h"
+
+JitterBuffer::JitterBuffer() {
+    delayMs = 100;
+    maxExtrapolationMs = 50;
+    reset();
+    resetCounters();
+}
+
+void JitterBuffer::reset() {
+    head = 0;
+    count = 0;
+    offset = 0;
+    offsetValid = false;
+    previousValid = false;
+    lastPlayTime = 0;
+    inUnderrun = false;
+}
+
+void JitterBuffer::resetCounters() {
+    received = 0;
+    lateDrops = 0;
+    underruns = 0;
+    overflows = 0;
+}
+
+bool JitterBuffer::push(uint32_t hostTime, const int* values, uint32_t now) {
+    // 用最小传输延迟估计两端时钟差：到达得更早的样本说明之前的估计偏大
+    int32_t sampleOffset = (int32_t)(now - hostTime);
+    if (!offsetValid) {
+        offset = sampleOffset;
+        offsetValid = true;
+    } else if (sampleOffset < offset) {
+        // 已缓存的样本随估计一起平移，保持相互间隔不变
+        int32_t shift = offset - sampleOffset;
+        for (uint8_t i = 0; i < count; i++) {
+            samples[(head + i) % CAPACITY].localTime -= shift;
+        }
+        offset = sampleOffset;
+    } else if ((received & 31) == 31) {
+        // 缓慢上调估计，吸收两端时钟的漂移
+        offset++;
+    }
+
+    uint32_t localTime = hostTime + offset;
+
+    // 乱序或已经回放过的时间点直接丢弃
+    if ((count > 0 && (int32_t)(localTime - at(count - 1).localTime) <= 0) ||
+        (lastPlayTime != 0 && (int32_t)(localTime - lastPlayTime) <= 0)) {
+        lateDrops++;
+        return false;
+    }
+
+    if (count == CAPACITY) {
+        previous = samples[head];
+        previousValid = true;
+        head = (head + 1) % CAPACITY;
+        count--;
+        overflows++;
+    }
+
+    Sample& slot = samples[(head + count) % CAPACITY];
+    slot.localTime = localTime;
+    for (uint8_t i = 0; i < CHANNELS; i++) {
+        slot.values[i] = constrain(values[i], 0, 1023);
+    }
+    count++;
+    received++;
+    return true;
+}
+
+bool JitterBuffer::sample(uint32_t now, int* values) {
+    if (count == 0) return false;
+
+    uint32_t playTime = now - delayMs;
+    if (playTime == 0) playTime = 1;  // 0保留为"尚未回放"
+
+    // 出队回放点之前的样本，只保留回放点所在区间的起点
+    while (count >= 2 && (int32_t)(at(1).localTime - playTime) <= 0) {
+        previous = samples[head];
+        previousValid = true;
+        head = (head + 1) % CAPACITY;
+        count--;
+    }
+
+    const Sample& a = at(0);
+    lastPlayTime = playTime;
+
+    // 回放点还没到第一个样本：保持第一个样本的值
+    if ((int32_t)(playTime - a.localTime) <= 0) {
+        for (uint8_t i = 0; i < CHANNELS; i++) values[i] = a.values[i];
+        return true;
+    }
+
+    // 正常情况：在相邻两个样本之间线性插值
+    if (count >= 2) {
+        const Sample& b = at(1);
+        int32_t span = b.localTime - a.localTime;
+        int32_t offsetInSpan = playTime - a.localTime;
+        for (uint8_t i = 0; i < CHANNELS; i++) {
+            values[i] = a.values[i] + (int32_t)((int64_t)(b.values[i] - a.values[i]) * offsetInSpan / span);
+        }
+        inUnderrun = false;
+        return true;
+    }
+
+    // 欠载：按最后两个样本的斜率短暂外推，超过外推时间后保持
+    if (!inUnderrun) {
+        underruns++;
+        inUnderrun = true;
+    }
+
+    int32_t ahead = min((int32_t)(playTime - a.localTime), (int32_t)maxExtrapolationMs);
+    int32_t span = previousValid ? (int32_t)(a.localTime - previous.localTime) : 0;
+    for (uint8_t i = 0; i < CHANNELS; i++) {
+        int32_t value = a.values[i];
+        if (span > 0) {
+            value += (a.values[i] - previous.values[i]) * ahead / span;
+        }
+        values[i] = constrain(value, 0, 1023);
+    }
+    return true;
+}
+
+void JitterBuffer::report(Print& out) const {
+    // Jitter|延迟ms|接收|过期丢弃|欠载|溢出
+    out.print("Jitter|");
+    out.print(delayMs);
+    out.print("|");
+    out.print(received);
+    out.print("|");
+    out.print(lateDrops);
+    out.print("|");
+    out.print(underruns);
+    out.print("|");
+    out.println(overflows);
+}
@@ -0,0 +1,210 @@
+/**
+ * @file LatencyTrace.cpp
+ * @brief 命令到舵机和灯带输出的延迟追踪与统计
+ */
+
+#include "LatencyTrace.h"
+
+static const char* const TYPE_NAMES[TRACE_TYPE_COUNT] = {"Follow", "FollowT", "Mode", "Other"};
+
+static const char* const MODE_COMMANDS[] = {"Rainbow", "Idle", "Heatup", "Cooldown", "Standby", "Layers"};
+
+/**
+ * @brief 按命令名（第一个'|'之前）判断类型
+ */
+static TraceType classify(const char* command) {
+    size_t length = strcspn(command, "|");
+    if (length == 6 && strncmp(command, "Follow", 6) == 0) return TRACE_FOLLOW;
+    if (length == 7 && strncmp(command, "FollowT", 7) == 0) return TRACE_FOLLOW_T;
+    for (const char* mode : MODE_COMMANDS) {
+        if (strlen(mode) == length && strncmp(command, mode, length) == 0) return TRACE_MODE;
+    }
+    return TRACE_OTHER;
+}
+
+LatencyTrace::LatencyTrace() {
+    pendingCount = 0;
+    arrival = 0;
+    nextId = 0;
+    echo = NULL;
+    resetCounters();
+}
+
+size_t LatencyTrace::begin(const char* line) {
+    // 可选的"@编号 "前缀
+    size_t offset = 0;
+    uint32_t id = nextId++;
+    if (line[0] == '@') {
+        char* end;
+        uint32_t hostId = strtoul(line + 1, &end, 10);
+        if (end != line + 1 && *end == ' ') {
+            id = hostId;
+            offset = end - line;
+            while (line[offset] == ' ') offset++;
+        }
+    }
+
+#if LATENCY_TRACE
+    // 槽位已满时丢弃最早的命令
+    if (pendingCount == LATENCY_TRACE_PENDING) {
+        memmove(pending, pending + 1, sizeof(Pending) * (LATENCY_TRACE_PENDING - 1));
+        pendingCount--;
+        dropped++;
+    }
+    Pending& p = pending[pendingCount++];
+    memset(&p, 0, sizeof(p));
+    p.id = id;
+    p.arrival = arrival;
+    p.type = classify(line + offset);
+#endif
+    return offset;
+}
+
+void LatencyTrace::parsed() {
+#if LATENCY_TRACE
+    if (pendingCount == 0) return;
+    Pending& p = pending[pendingCount - 1];
+    p.parsed = true;
+    p.parseMicros = micros() - p.arrival;
+#endif
+}
+
+void LatencyTrace::deferUntil(uint32_t playAtMs) {
+#if LATENCY_TRACE
+    if (pendingCount == 0) return;
+    Pending& p = pending[pendingCount - 1];
+    p.deferred = true;
+    p.playAtMs = playAtMs;
+#else
+    (void)playAtMs;
+#endif
+}
+
+void LatencyTrace::effectDone() {
+#if LATENCY_TRACE
+    uint32_t now = micros();
+    uint32_t nowMs = millis();
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        Pending& p = pending[i];
+        // 抖动缓冲区还没有回放到该样本
+        if (p.deferred && (int32_t)(nowMs - p.playAtMs) < 0) continue;
+        if (p.parsed && !p.effect) {
+            p.effect = true;
+            p.effectMicros = now - p.arrival;
+        }
+    }
+#endif
+}
+
+void LatencyTrace::outputDone(bool servoDue, bool ledDue, uint32_t servoDoneAt, uint32_t ledDoneAt) {
+#if LATENCY_TRACE
+    // 效果计算之后的第一次舵机输出和第一次灯带输出
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < pendingCount; i++) {
+        Pending& p = pending[i];
+        if (p.effect && servoDue && !p.servo) {
+            p.servo = true;
+            p.servoMicros = servoDoneAt - p.arrival;
+        }
+        if (p.effect && ledDue && !p.led) {
+            p.led = true;
+            p.ledMicros = ledDoneAt - p.arrival;
+        }
+        if (p.servo && p.led) {
+            complete(p);
+        } else {
+            pending[kept++] = p;
+        }
+    }
+    pendingCount = kept;
+#else
+    (void)servoDue;
+    (void)ledDue;
+    (void)servoDoneAt;
+    (void)ledDoneAt;
+#endif
+}
+
+void LatencyTrace::complete(const Pending& p) {
+    TypeStats& s = stats[p.type];
+    s.count++;
+    s.totalParse += p.parseMicros;
+    s.totalEffect += p.effectMicros;
+    s.totalServo += p.servoMicros;
+    s.totalLed += p.ledMicros;
+    if (p.servoMicros > s.maxServo) s.maxServo = p.servoMicros;
+    if (p.ledMicros > s.maxLed) s.maxLed = p.ledMicros;
+    addToHistogram(s.servoHistogram, p.servoMicros);
+    addToHistogram(s.ledHistogram, p.ledMicros);
+
+    if (echo) {
+        // Trace|编号|解析us|效果us|舵机us|灯带us
+        echo->print("Trace|");
+        echo->print(p.id);
+        echo->print("|");
+        echo->print(p.parseMicros);
+        echo->print("|");
+        echo->print(p.effectMicros);
+        echo->print("|");
+        echo->print(p.servoMicros);
+        echo->print("|");
+        echo->println(p.ledMicros);
+    }
+}
+
+void LatencyTrace::addToHistogram(uint16_t* histogram, uint32_t micros) {
+    // 与Profiler相同，按微秒数的二进制位数选择桶
+    uint8_t bucket = 0;
+    while (micros > 1 && bucket < HISTOGRAM_BUCKETS - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    if (histogram[bucket] < 0xFFFF) {
+        histogram[bucket]++;
+    }
+}
+
+void LatencyTrace::resetCounters() {
+    dropped = 0;
+    memset(stats, 0, sizeof(stats));
+}
+
+void LatencyTrace::report(Print& out) const {
+    for (uint8_t i = 0; i < TRACE_TYPE_COUNT; i++) {
+        const TypeStats& s = stats[i];
+        uint32_t n = s.count ? s.count : 1;
+
+        // Latency|类型|次数|平均解析us|平均效果us|平均舵机us|最大舵机us|平均灯带us|最大灯带us
+        out.print("Latency|");
+        out.print(TYPE_NAMES[i]);
+        out.print("|");
+        out.print(s.count);
+        out.print("|");
+        out.print((uint32_t)(s.totalParse / n));
+        out.print("|");
+        out.print((uint32_t)(s.totalEffect / n));
+        out.print("|");
+        out.print((uint32_t)(s.totalServo / n));
+        out.print("|");
+        out.print(s.maxServo);
+        out.print("|");
+        out.print((uint32_t)(s.totalLed / n));
+        out.print("|");
+        out.println(s.maxLed);
+
+        const uint16_t* histograms[2] = {s.servoHistogram, s.ledHistogram};
+        const char* outputs[2] = {"Servo", "LED"};
+        for (uint8_t h = 0; h < 2; h++) {
+            out.print("LatHist|");
+            out.print(TYPE_NAMES[i]);
+            out.print("|");
+            out.print(outputs[h]);
+            out.print("|");
+            for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                if (b > 0) out.print(",");
+                out.print(histograms[h][b]);
+            }
+            out.println();
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#include "LayerMap.h"
+
+LayerMap::LayerMap() {
+    clear(0);
+}
+
+void LayerMap::build(uint8_t servoLayerCount, uint8_t lightLayers, uint16_t ledsPerLayer) {
+    clear(servoLayerCount);
+    if (servoLayers == 0 || lightLayers == 0) return;
+
+    if (lightLayers >= servoLayers) {
+        // 每层舵机分到整数层灯带，相邻舵机层的灯带连续，合成一段
+        for (uint8_t s = 0; s < servoLayers; s++) {
+            uint8_t firstLayer = (uint16_t)s * lightLayers / servoLayers;
+            uint8_t endLayer = (uint16_t)(s + 1) * lightLayers / servoLayers;
+            add(s, firstLayer * ledsPerLayer, (endLayer - firstLayer) * ledsPerLayer);
+        }
+    } else {
+        // 灯带层数少于舵机层数时按LED数平分，一层灯带由几层舵机分段控制
+        uint32_t totalLeds = (uint32_t)lightLayers * ledsPerLayer;
+        for (uint8_t s = 0; s < servoLayers; s++) {
+            uint16_t first = s * totalLeds / servoLayers;
+            uint16_t end = (s + 1) * totalLeds / servoLayers;
+            add(s, first, end - first);
+        }
+    }
+}
+
+void LayerMap::clear(uint8_t servoLayerCount) {
+    servoLayers = min(servoLayerCount, (uint8_t)LAYER_MAP_MAX_SERVO_LAYERS);
+    memset(offsets, 0, sizeof(offsets));
+}
+
+bool LayerMap::add(uint8_t servoLayer, uint16_t first, uint16_t count) {
+    uint8_t used = offsets[servoLayers];
+    if (servoLayer >= servoLayers || used >= LAYER_MAP_MAX_SPANS) return false;
+    // 之后的舵机层已经有段时说明添加顺序错误
+    if (offsets[servoLayer + 1] != used) return false;
+    if (count == 0) return true;
+
+    spans[used].first = first;
+    spans[used].count = count;
+    for (uint8_t i = servoLayer + 1; i <= servoLayers; i++) {
+        offsets[i] = used + 1;
+    }
+    return true;
+}
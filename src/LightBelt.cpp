@@ -1,30 +1,112 @@
 #include "LightBelt.h"
 #include "GlobalConfig.h"
+#include "Profiler.h"
+#include "ShowClock.h"
+#include "PixelKernels.h"
+#include "Compositor.h"
+#include "EffectVM.h"
 
 LightBelt::LightBelt(uint8_t pin, uint8_t numLayers, uint8_t ledsInLayer) 
-    : layers(numLayers), ledsPerLayer(ledsInLayer) {
+    : strip((uint16_t)numLayers * ledsInLayer, pin), layers(numLayers), ledsPerLayer(ledsInLayer) {
     totalLeds = numLayers * ledsInLayer;
-    strip = Adafruit_NeoPixel(totalLeds, pin, NEO_GRB + NEO_KHZ800);
     maxBrightness = MAX_LED_BRIGHTNESS;  // 从全局配置设置默认亮度
+    holding = false;
+    pending = false;
+    parallelActive = false;
+    shown = NULL;
+    shownOwned = false;
+    shownValid = false;
+}
+
+LightBelt::LightBelt(uint8_t pin, uint8_t numLayers, uint8_t ledsInLayer, uint8_t* pixelBuffer, uint8_t* shownBuffer)
+    : strip(pixelBuffer, (uint16_t)numLayers * ledsInLayer, pin), layers(numLayers), ledsPerLayer(ledsInLayer) {
+    totalLeds = numLayers * ledsInLayer;
+    maxBrightness = MAX_LED_BRIGHTNESS;  // 从全局配置设置默认亮度
+    holding = false;
+    pending = false;
+    parallelActive = false;
+    shown = shownBuffer;
+    shownOwned = false;
+    shownValid = false;
+}
+
+LightBelt::~LightBelt() {
+    if (shownOwned) free(shown);
+}
+
+bool LightBelt::setSegments(const LedSegment* segments, uint8_t count) {
+    if (!parallel.configure(segments, count, layers, ledsPerLayer)) return false;
+    strip.setPin(segments[0].pin);
+    return true;
 }
 
 void LightBelt::begin() {
-    strip.begin();
+    if (parallel.getSegmentCount() > 1) {
+        parallelActive = parallel.begin();
+        if (!parallelActive) {
+            // RMT通道不可用时退回单引脚，至少第一段可以点亮
+            Serial.println("Error: LED segment outputs unavailable, using first pin only");
+        }
+    }
+    if (!parallelActive) strip.begin();
     // 设置整体亮度限制
     strip.setBrightness(255 * maxBrightness);
-    strip.show();
+    showStrip();
 }
 
 void LightBelt::setLayerColor(uint8_t layer, uint32_t color) {
     if (layer >= layers) return;
     
-    uint16_t startLed = layer * ledsPerLayer;
-    uint16_t endLed = startLed + ledsPerLayer;
+    // 每层只做一次亮度缩放，之后直接写缓冲区
+    uint8_t grb[3];
+    scaleColor(color, grb);
+    fillLayer(layer, grb);
+    showStrip();
+}
+
+void LightBelt::setRangeColor(uint16_t first, uint16_t count, uint32_t color) {
+    if (first >= totalLeds) return;
+    if (count > totalLeds - first) count = totalLeds - first;
     
-    for (uint16_t i = startLed; i < endLed; i++) {
-        strip.setPixelColor(i, color);
+    uint8_t grb[3];
+    scaleColor(color, grb);
+    PixelKernels::fill(strip.getPixels() + (uint32_t)first * 3, count, grb);
+    showStrip();
+}
+
+bool BrightnessLut::update(uint8_t outputBrightness) {
+    if (outputBrightness == brightness) return false;
+    uint16_t scale = outputBrightness + 1;
+    for (uint16_t v = 0; v < 256; v++) {
+        table[v] = (v * scale) >> 8;
     }
-    strip.show();
+    brightness = outputBrightness;
+    return true;
+}
+
+void LightBelt::scaleColor(uint32_t color, uint8_t* grb) const {
+    uint8_t r = (color >> 16) & 0xFF;
+    uint8_t g = (color >> 8) & 0xFF;
+    uint8_t b = color & 0xFF;
+    
+    // Adafruit_NeoPixel内部保存亮度+1，0表示不缩放
+    uint8_t scale = strip.getBrightness() + 1;
+    if (scale) {
+        r = (r * scale) >> 8;
+        g = (g * scale) >> 8;
+        b = (b * scale) >> 8;
+    }
+    grb[0] = g;
+    grb[1] = r;
+    grb[2] = b;
+}
+
+void LightBelt::fillLayer(uint8_t layer, const uint8_t* grb) {
+    PixelKernels::fill(strip.getPixels() + (uint32_t)layer * ledsPerLayer * 3, ledsPerLayer, grb);
+}
+
+void LightBelt::fillAll(const uint8_t* grb) {
+    PixelKernels::fill(strip.getPixels(), totalLeds, grb);
 }
 
 void LightBelt::setAllLayersColor(uint32_t color) {
@@ -33,46 +115,87 @@ void LightBelt::setAllLayersColor(uint32_t color) {
     }
 }
 
-void LightBelt::rainbowCycle(uint32_t periodMs) {
-    uint32_t timeNow = millis();
+void LightBelt::rainbowCycle(uint32_t periodMs, const Palette& palette) {
+    uint32_t timeNow = ShowClock::now();
     uint8_t wheelPos = ((timeNow % periodMs) * 256) / periodMs;
     
     for (uint8_t layer = 0; layer < layers; layer++) {
         uint8_t adjustedWheelPos = (wheelPos + (layer * 256 / layers)) & 255;
-        setLayerColor(layer, wheel(adjustedWheelPos));
+        setLayerColor(layer, palette.at(adjustedWheelPos));
     }
 }
 
 uint32_t LightBelt::wheel(byte wheelPos) {
-    wheelPos = 255 - wheelPos;
-    if (wheelPos < 85) {
-        return strip.Color(255 - wheelPos * 3, 0, wheelPos * 3);
-    }
-    if (wheelPos < 170) {
-        wheelPos -= 85;
-        return strip.Color(0, wheelPos * 3, 255 - wheelPos * 3);
-    }
-    wheelPos -= 170;
-    return strip.Color(wheelPos * 3, 255 - wheelPos * 3, 0);
+    return Palettes::slot(PALETTE_RAINBOW).at(wheelPos);
 }
 
-void LightBelt::breathing(uint32_t color, uint32_t periodMs) {
-    uint32_t timeNow = millis();
+void LightBelt::breathing(const Palette& palette, uint32_t periodMs) {
+    uint32_t timeNow = ShowClock::now();
     float phase = (timeNow % periodMs) / (float)periodMs;
     
     // 使用正弦波产生平滑的呼吸效果
-    // sin值的范围是-1到1，需要映射到0到255的亮度范围
+    // sin值的范围是-1到1，映射到调色板的0到65535位置
     float sinValue = sin(phase * 2 * PI);
-    uint8_t brightness = (sinValue + 1.0) * 127.5; // 映射到0-255
+    uint16_t position = (sinValue + 1.0) * 32767.5;
     
-    // 根据亮度调整颜色
-    uint32_t dimmedColor = dimColor(color, brightness);
+    // 调色板中已包含呼吸亮度，这里只应用最大亮度限制
+    uint32_t dimmedColor = dimColor(palette.sample(position), 255);
     
     // 应用到所有LED
-    for (uint16_t i = 0; i < totalLeds; i++) {
-        strip.setPixelColor(i, dimmedColor);
+    uint8_t grb[3];
+    scaleColor(dimmedColor, grb);
+    fillAll(grb);
+    showStrip();
+}
+
+void LightBelt::compose(Compositor& compositor, const LayerMap& map) {
+    compositor.prepare(ShowClock::now(), map, layers, ledsPerLayer, maxBrightness);
+    
+    uint8_t count = compositor.getLayerCount();
+    CompositorRun runs[Compositor::MAX_LAYERS];
+    for (uint8_t i = 0; i < count; i++) {
+        runs[i].end = 0;
     }
-    strip.show();
+    
+    uint8_t* pixels = strip.getPixels();
+    uint16_t led = 0;
+    while (led < totalLeds) {
+        // 各层从当前LED起颜色不变的最短一段，整段只混合一次
+        uint16_t end = totalLeds;
+        uint8_t rgb[3] = {0, 0, 0};
+        for (uint8_t i = 0; i < count; i++) {
+            if (runs[i].end <= led) {
+                compositor.run(i, led, runs[i]);
+            }
+            end = min(end, runs[i].end);
+            compositor.apply(i, runs[i], rgb);
+        }
+        
+        uint8_t grb[3];
+        scaleColor(strip.Color(rgb[0], rgb[1], rgb[2]), grb);
+        PixelKernels::fill(pixels + (uint32_t)led * 3, end - led, grb);
+        led = end;
+    }
+    showStrip();
+}
+
+void LightBelt::renderEffect(const EffectVM& vm) {
+    int32_t inputs[INPUT_COUNT] = {0};
+    inputs[INPUT_TIME] = ShowClock::now() & 0x7FFFFFFF;
+    inputs[INPUT_LAYERS] = layers;
+    inputs[INPUT_SIZE] = ledsPerLayer;
+    
+    uint8_t* p = strip.getPixels();
+    uint16_t led = 0;
+    for (uint8_t layer = 0; layer < layers; layer++) {
+        inputs[INPUT_LAYER] = layer;
+        for (uint8_t i = 0; i < ledsPerLayer; i++, led++, p += 3) {
+            inputs[INPUT_PIXEL] = led;
+            inputs[INPUT_INDEX] = i;
+            scaleColor(vm.runPixel(inputs), p);
+        }
+    }
+    showStrip();
 }
 
 uint32_t LightBelt::dimColor(uint32_t color, uint8_t brightness) {
@@ -96,9 +219,57 @@ void LightBelt::setMaxBrightness(float brightness) {
     maxBrightness = constrain(brightness, 0.0f, 1.0f);
     // 立即更新灯带整体亮度
     strip.setBrightness(255 * maxBrightness);
-    strip.show();
+    showStrip();
 }
 
 float LightBelt::getMaxBrightness() const {
     return maxBrightness;
 }
+
+uint32_t LightBelt::getLayerColor(uint8_t layer) const {
+    if (layer >= layers) return 0;
+    
+    // 直接读取缓冲区中的GRB字节，即实际发送到灯带的值
+    const uint8_t* pixel = strip.getPixels() + (uint32_t)layer * ledsPerLayer * 3;
+    return ((uint32_t)pixel[1] << 16) | ((uint32_t)pixel[0] << 8) | pixel[2];
+}
+
+bool LightBelt::commitFrame() {
+    holding = false;
+    if (!pending) return false;
+    pending = false;
+
+    const uint8_t* pixels = strip.getPixels();
+    uint32_t bytes = totalLeds * 3;
+    if (shown == NULL) {
+        shown = (uint8_t*)malloc(bytes);
+        shownOwned = shown != NULL;
+    }
+    if (shownValid && memcmp(pixels, shown, bytes) == 0) return false;
+    outputStrip();
+    // 分配失败时每次都输出
+    if (shown) {
+        memcpy(shown, pixels, bytes);
+        shownValid = true;
+    }
+    return true;
+}
+
+void LightBelt::showStrip() {
+    if (holding) {
+        pending = true;
+        return;
+    }
+    // 不经过暂存的输出不做比较，之后的commitFrame()总是输出
+    outputStrip();
+    shownValid = false;
+}
+
+void LightBelt::outputStrip() {
+    PROFILE_SCOPE(PROFILE_LED_OUTPUT);
+    if (parallelActive) {
+        parallel.show(strip.getPixels());
+    } else {
+        strip.show();
+    }
+}
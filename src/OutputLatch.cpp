@@ -0,0 +1,116 @@
+/**
+ * @file OutputLatch.cpp
+ * @brief 舵机与灯带输出的同步释放和时间差统计
+ */
+
+#include "OutputLatch.h"
+
+OutputLatch::OutputLatch() : belt(NULL), pca(NULL), ledc(NULL) {
+    // 灯带传输通常比舵机写入长，第一帧先输出灯带
+    ledFirst = true;
+    ledMicros = 0;
+    servoMicros = 0;
+    ledCommitMicros = 0;
+    servoCommitMicros = 0;
+    ledDoneAt = 0;
+    servoDoneAt = 0;
+    changed = true;
+    resetCounters();
+}
+
+void OutputLatch::attach(LightBelt* beltPtr, ServoPlatform* servo) {
+    belt = beltPtr;
+    pca = servo;
+    ledc = NULL;
+}
+
+void OutputLatch::attach(LightBelt* beltPtr, ServoPlatformInter* servo) {
+    belt = beltPtr;
+    pca = NULL;
+    ledc = servo;
+}
+
+void OutputLatch::stage() {
+#if OUTPUT_LATCH
+    if (!belt) return;
+    belt->beginFrame();
+    if (pca) pca->beginFrame();
+    if (ledc) ledc->beginFrame();
+#endif
+}
+
+bool OutputLatch::commitServo() {
+    if (pca) return pca->commitFrame();
+    if (ledc) return ledc->commitFrame();
+    return false;
+}
+
+void OutputLatch::commit(bool servoDue, bool ledDue) {
+#if OUTPUT_LATCH
+    if (!belt) return;
+
+    // 各自输出完成的时刻即生效时刻：PCA9685在STOP时更新，WS2812在数据结束后锁存
+    uint32_t start = micros();
+    bool ledOutput = false, servoOutput = false;
+    uint32_t ledDone, servoDone;
+    if (ledFirst) {
+        if (ledDue) ledOutput = belt->commitFrame();
+        ledDone = micros();
+        if (servoDue) servoOutput = commitServo();
+        servoDone = micros();
+        ledCommitMicros = ledDone - start;
+        servoCommitMicros = servoDone - ledDone;
+    } else {
+        if (servoDue) servoOutput = commitServo();
+        servoDone = micros();
+        if (ledDue) ledOutput = belt->commitFrame();
+        ledDone = micros();
+        servoCommitMicros = servoDone - start;
+        ledCommitMicros = ledDone - servoDone;
+    }
+    if (ledOutput) ledMicros = ledCommitMicros;
+    if (servoOutput) servoMicros = servoCommitMicros;
+    ledDoneAt = ledDone;
+    servoDoneAt = servoDone;
+
+    changed = ledOutput || servoOutput;
+    if (ledOutput && servoOutput) {
+        lastSkew = ledFirst ? servoDone - ledDone : ledDone - servoDone;
+        frames++;
+        totalSkew += lastSkew;
+        if (lastSkew < minSkew) minSkew = lastSkew;
+        if (lastSkew > maxSkew) maxSkew = lastSkew;
+        if (ledFirst) ledFirstFrames++;
+    }
+
+    // 时间差为后输出一方的耗时，下一帧让耗时短的一方在后
+    ledFirst = servoMicros <= ledMicros;
+#else
+    // 每次设置时已立即输出
+    ledDoneAt = micros();
+    servoDoneAt = ledDoneAt;
+#endif
+}
+
+void OutputLatch::resetCounters() {
+    frames = 0;
+    lastSkew = 0;
+    minSkew = UINT32_MAX;
+    maxSkew = 0;
+    totalSkew = 0;
+    ledFirstFrames = 0;
+}
+
+void OutputLatch::report(Print& out) const {
+    // Skew|帧数|最小us|平均us|最大us|先输出灯带的帧数
+    out.print("Skew|");
+    out.print(frames);
+    out.print("|");
+    out.print(getMinSkew());
+    out.print("|");
+    out.print(getAverageSkew());
+    out.print("|");
+    out.print(maxSkew);
+    out.print("|");
+    out.println(ledFirstFrames);
+}
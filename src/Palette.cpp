@@ -0,0 +1,260 @@
+/**
+ * @file Palette.cpp
+ * @brief 调色板生成与内置调色板
+ */
+
+#include "Palette.h"
+
+// 内置调色板的关键色，与原来各模式中的固定颜色一致
+static const PaletteStop RAINBOW_STOPS[] = {
+    {0, 0xFF0000}, {85, 0x00FF00}, {170, 0x0000FF}, {255, 0xFF0000}
+};
+static const PaletteStop IDLE_STOPS[] = {
+    {0, 0x000000}, {255, 0xFFFFFF}
+};
+static const PaletteStop HEATUP_STOPS[] = {
+    {0, 0x000000}, {255, 0xFF0000}
+};
+static const PaletteStop COOLDOWN_STOPS[] = {
+    {0, 0x000000}, {255, 0xFF8800}
+};
+static const PaletteStop STANDBY_STOPS[] = {
+    {0, 0x000000}, {255, 0x0000FF}
+};
+// 白到蓝的渐变再乘以亮度，红绿分量为(255 - i) * i / 255
+static const PaletteStop FOLLOW_STOPS[] = {
+    {0, 0x000000}, {64, 0x2F2F40}, {128, 0x3F3F80}, {192, 0x2F2FC0}, {255, 0x0000FF}
+};
+
+struct BuiltinPalette {
+    const PaletteStop* stops;
+    uint8_t count;
+};
+
+static const BuiltinPalette BUILTIN_PALETTES[PALETTE_ROLE_COUNT] = {
+    {RAINBOW_STOPS, sizeof(RAINBOW_STOPS) / sizeof(PaletteStop)},
+    {IDLE_STOPS, sizeof(IDLE_STOPS) / sizeof(PaletteStop)},
+    {HEATUP_STOPS, sizeof(HEATUP_STOPS) / sizeof(PaletteStop)},
+    {COOLDOWN_STOPS, sizeof(COOLDOWN_STOPS) / sizeof(PaletteStop)},
+    {STANDBY_STOPS, sizeof(STANDBY_STOPS) / sizeof(PaletteStop)},
+    {FOLLOW_STOPS, sizeof(FOLLOW_STOPS) / sizeof(PaletteStop)},
+};
+
+/**
+ * @brief sRGB分量转为线性光强
+ */
+static float srgbToLinear(uint8_t c) {
+    float v = c / 255.0f;
+    return v <= 0.04045f ? v / 12.92f : powf((v + 0.055f) / 1.055f, 2.4f);
+}
+
+static uint8_t linearToSrgb(float v) {
+    v = constrain(v, 0.0f, 1.0f);
+    v = v <= 0.0031308f ? v * 12.92f : 1.055f * powf(v, 1.0f / 2.4f) - 0.055f;
+    return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+/**
+ * @brief 0xRRGGBB转为OKLab
+ */
+static void colorToOklab(uint32_t color, float* lab) {
+    float r = srgbToLinear(color >> 16);
+    float g = srgbToLinear(color >> 8);
+    float b = srgbToLinear(color);
+
+    float l = cbrtf(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    float m = cbrtf(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    float s = cbrtf(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+
+    lab[0] = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+    lab[1] = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+    lab[2] = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+}
+
+static void oklabToRgb(const float* lab, uint8_t* rgb) {
+    float l = lab[0] + 0.3963377774f * lab[1] + 0.2158037573f * lab[2];
+    float m = lab[0] - 0.1055613458f * lab[1] - 0.0638541728f * lab[2];
+    float s = lab[0] - 0.0894841775f * lab[1] - 1.2914855480f * lab[2];
+    l = l * l * l;
+    m = m * m * m;
+    s = s * s * s;
+
+    rgb[0] = linearToSrgb(4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s);
+    rgb[1] = linearToSrgb(-1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s);
+    rgb[2] = linearToSrgb(-0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s);
+}
+
+Palette::Palette() {
+    clear();
+}
+
+void Palette::clear(bool perceptualBlend) {
+    stopCount = 0;
+    perceptual = perceptualBlend;
+    memset(table, 0, sizeof(table));
+}
+
+bool Palette::addStop(uint8_t index, uint32_t color) {
+    PaletteStop stop = {index, color};
+    return addStops(&stop, 1);
+}
+
+bool Palette::addStops(const PaletteStop* newStops, uint8_t count) {
+    // 先统计需要新增的位置，放不下时不做任何改动
+    uint16_t added = 0;
+    for (uint8_t n = 0; n < count; n++) {
+        uint8_t index = newStops[n].index;
+        bool exists = false;
+        for (uint8_t i = 0; i < stopCount && !exists; i++) {
+            exists = stops[i].index == index;
+        }
+        for (uint8_t m = 0; m < n && !exists; m++) {
+            exists = newStops[m].index == index;
+        }
+        if (!exists) added++;
+    }
+    if (stopCount + added > MAX_STOPS) return false;
+
+    for (uint8_t n = 0; n < count; n++) {
+        uint8_t index = newStops[n].index;
+        uint32_t color = newStops[n].color & 0xFFFFFF;
+
+        // 保持按位置升序，相同位置直接替换
+        uint8_t i = 0;
+        while (i < stopCount && stops[i].index < index) i++;
+        if (i < stopCount && stops[i].index == index) {
+            stops[i].color = color;
+        } else {
+            memmove(&stops[i + 1], &stops[i], (stopCount - i) * sizeof(PaletteStop));
+            stops[i].index = index;
+            stops[i].color = color;
+            stopCount++;
+        }
+    }
+
+    render();
+    return true;
+}
+
+void Palette::setStops(const PaletteStop* newStops, uint8_t count, bool perceptualBlend) {
+    clear(perceptualBlend);
+    addStops(newStops, count < MAX_STOPS ? count : MAX_STOPS);
+}
+
+uint32_t Palette::sample(uint16_t position) const {
+    uint8_t index = position >> 8;
+    uint8_t frac = position & 0xFF;
+    if (frac == 0 || index == 255) return at(index);
+
+    const uint8_t* a = table[index];
+    const uint8_t* b = table[index + 1];
+    uint8_t rgb[3];
+    for (uint8_t c = 0; c < 3; c++) {
+        rgb[c] = a[c] + ((int16_t)(b[c] - a[c]) * frac) / 256;
+    }
+    return ((uint32_t)rgb[0] << 16) | ((uint32_t)rgb[1] << 8) | rgb[2];
+}
+
+void Palette::render() {
+    if (stopCount == 0) {
+        memset(table, 0, sizeof(table));
+        return;
+    }
+
+    // 第一个关键色之前和最后一个之后使用端点颜色
+    for (uint16_t i = 0; i < 256; i++) {
+        uint32_t color = i < stops[0].index ? stops[0].color : stops[stopCount - 1].color;
+        table[i][0] = color >> 16;
+        table[i][1] = color >> 8;
+        table[i][2] = color;
+    }
+
+    for (uint8_t s = 0; s + 1 < stopCount; s++) {
+        const PaletteStop& from = stops[s];
+        const PaletteStop& to = stops[s + 1];
+        int span = to.index - from.index;
+
+        if (perceptual) {
+            float labFrom[3], labTo[3];
+            colorToOklab(from.color, labFrom);
+            colorToOklab(to.color, labTo);
+            for (int k = 0; k <= span; k++) {
+                float t = (float)k / span;
+                float lab[3];
+                for (uint8_t c = 0; c < 3; c++) {
+                    lab[c] = labFrom[c] + (labTo[c] - labFrom[c]) * t;
+                }
+                oklabToRgb(lab, table[from.index + k]);
+            }
+        } else {
+            for (uint8_t c = 0; c < 3; c++) {
+                int a = (from.color >> (16 - 8 * c)) & 0xFF;
+                int b = (to.color >> (16 - 8 * c)) & 0xFF;
+                for (int k = 0; k <= span; k++) {
+                    table[from.index + k][c] = a + (b - a) * k / span;
+                }
+            }
+        }
+    }
+}
+
+Palette Palettes::slots[Palettes::SLOT_COUNT];
+uint8_t Palettes::roleSlots[PALETTE_ROLE_COUNT];
+
+void Palettes::begin() {
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        slots[i].clear();
+    }
+    for (uint8_t role = 0; role < PALETTE_ROLE_COUNT; role++) {
+        slots[role].setStops(BUILTIN_PALETTES[role].stops, BUILTIN_PALETTES[role].count);
+        roleSlots[role] = role;
+    }
+}
+
+bool Palettes::assign(int role, int slot) {
+    if (role < 0 || role >= PALETTE_ROLE_COUNT || slot < 0 || slot >= SLOT_COUNT) return false;
+    roleSlots[role] = slot;
+    return true;
+}
+
+bool Palettes::clear(int slot, bool perceptual) {
+    if (slot < 0 || slot >= SLOT_COUNT) return false;
+    slots[slot].clear(perceptual);
+    return true;
+}
+
+int Palettes::addStops(int slot, const char* args) {
+    if (slot < 0 || slot >= SLOT_COUNT || !args) return -1;
+
+    // 先解析全部关键色，格式正确后一次加入
+    PaletteStop stops[Palette::MAX_STOPS];
+    uint8_t count = 0;
+    const char* p = args;
+    while (*p) {
+        if (count >= Palette::MAX_STOPS) return -1;
+
+        // 依次解析位置和颜色，字段之间以'|'分隔
+        uint32_t fields[2];
+        for (uint8_t i = 0; i < 2; i++) {
+            char* end;
+            fields[i] = strtoul(p, &end, 0);
+            if (end == p) return -1;
+            p = end;
+            if (i == 0) {
+                if (*p != '|') return -1;
+                p++;
+            }
+        }
+        if (fields[0] > 255) return -1;
+
+        stops[count].index = fields[0];
+        stops[count].color = fields[1];
+        count++;
+
+        if (*p == '|') p++;
+        else if (*p != '\0') return -1;
+    }
+
+    if (count == 0) return 0;
+    return slots[slot].addStops(stops, count) ? count : -1;
+}
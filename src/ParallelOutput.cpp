@@ -0,0 +1,127 @@
+/**
+ * @file ParallelOutput.cpp
+ * @brief 基于RMT的多引脚WS2812并行输出
+ */
+
+#include "ParallelOutput.h"
+#include "driver/rmt.h"
+
+// RMT时钟80MHz两分频，每个tick 25ns
+static const uint8_t RMT_CLOCK_DIVIDER = 2;
+
+// WS2812位时序（tick）：0码 0.35us高 + 0.8us低，1码 0.7us高 + 0.6us低
+static const uint16_t T0H_TICKS = 14;
+static const uint16_t T0L_TICKS = 32;
+static const uint16_t T1H_TICKS = 28;
+static const uint16_t T1L_TICKS = 24;
+
+// 帧间低电平复位时间（微秒），与Adafruit_NeoPixel对新款WS2812的取值一致
+static const uint32_t RESET_MICROS = 300;
+
+// ESP32共8个RMT通道、8块发送内存，平分给各段，段越少每段的内存越多，中断补数据越少
+static const uint8_t RMT_MEMORY_BLOCKS = 8;
+static_assert(LIGHT_BELT_MAX_SEGMENTS >= 1 && LIGHT_BELT_MAX_SEGMENTS <= RMT_MEMORY_BLOCKS,
+              "LIGHT_BELT_MAX_SEGMENTS must be 1-8");
+
+/**
+ * @brief 把字节转换为RMT脉冲，高位先发
+ * @details 由驱动在发送中断里分批调用，每次最多转换wanted_num个脉冲
+ */
+static void IRAM_ATTR ws2812Translate(const void* src, rmt_item32_t* dest, size_t srcSize, size_t wantedNum,
+                                      size_t* translatedSize, size_t* itemNum) {
+    if (!src || !dest) {
+        *translatedSize = 0;
+        *itemNum = 0;
+        return;
+    }
+
+    rmt_item32_t bit0, bit1;
+    bit0.val = 0;
+    bit0.duration0 = T0H_TICKS;
+    bit0.level0 = 1;
+    bit0.duration1 = T0L_TICKS;
+    bit0.level1 = 0;
+    bit1.val = 0;
+    bit1.duration0 = T1H_TICKS;
+    bit1.level0 = 1;
+    bit1.duration1 = T1L_TICKS;
+    bit1.level1 = 0;
+
+    const uint8_t* p = (const uint8_t*)src;
+    size_t size = 0;
+    size_t num = 0;
+    while (size < srcSize && num + 8 <= wantedNum) {
+        uint8_t value = p[size++];
+        for (uint8_t mask = 0x80; mask; mask >>= 1) {
+            dest[num++].val = (value & mask) ? bit1.val : bit0.val;
+        }
+    }
+    *translatedSize = size;
+    *itemNum = num;
+}
+
+ParallelOutput::ParallelOutput() : count(0), ready(false), lastEnd(0) {}
+
+bool ParallelOutput::configure(const LedSegment* segments, uint8_t count, uint8_t totalLayers, uint8_t ledsPerLayer) {
+    if (!segments || count == 0 || count > LIGHT_BELT_MAX_SEGMENTS || ready) return false;
+
+    uint16_t layerSum = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (segments[i].layers == 0) return false;
+        layerSum += segments[i].layers;
+    }
+    if (layerSum != totalLayers) return false;
+
+    uint16_t offset = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        this->segments[i] = segments[i];
+        offsets[i] = offset;
+        lengths[i] = (uint16_t)segments[i].layers * ledsPerLayer * 3;
+        offset += lengths[i];
+    }
+    this->count = count;
+    return true;
+}
+
+bool ParallelOutput::begin() {
+    if (count == 0) return false;
+
+    uint8_t blocks = RMT_MEMORY_BLOCKS / LIGHT_BELT_MAX_SEGMENTS;
+    for (uint8_t i = 0; i < count; i++) {
+        // 每个通道占用blocks块内存，通道号按块数间隔，避免与后一通道的内存重叠
+        rmt_channel_t channel = (rmt_channel_t)(i * blocks);
+
+        rmt_config_t config;
+        memset(&config, 0, sizeof(config));
+        config.rmt_mode = RMT_MODE_TX;
+        config.channel = channel;
+        config.gpio_num = (gpio_num_t)segments[i].pin;
+        config.clk_div = RMT_CLOCK_DIVIDER;
+        config.mem_block_num = blocks;
+        config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+        config.tx_config.idle_output_en = true;
+
+        if (rmt_config(&config) != ESP_OK) return false;
+        if (rmt_driver_install(channel, 0, 0) != ESP_OK) return false;
+        if (rmt_translator_init(channel, ws2812Translate) != ESP_OK) return false;
+    }
+    ready = true;
+    return true;
+}
+
+void ParallelOutput::show(const uint8_t* pixels) {
+    if (!ready) return;
+
+    // 保证上一帧之后的复位低电平
+    uint32_t idle = micros() - lastEnd;
+    if (idle < RESET_MICROS) delayMicroseconds(RESET_MICROS - idle);
+
+    uint8_t blocks = RMT_MEMORY_BLOCKS / LIGHT_BELT_MAX_SEGMENTS;
+    for (uint8_t i = 0; i < count; i++) {
+        rmt_write_sample((rmt_channel_t)(i * blocks), pixels + offsets[i], lengths[i], false);
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        rmt_wait_tx_done((rmt_channel_t)(i * blocks), portMAX_DELAY);
+    }
+    lastEnd = micros();
+}
@@ -0,0 +1,121 @@
+/**
+ * @file PixelKernels.cpp
+ * @brief GRB像素缓冲区内核（SWAR）
+ */
+
+#include "PixelKernels.h"
+
+static const uint32_t EVEN_BYTES = 0x00FF00FF;
+static const uint32_t HIGH_BITS = 0x80808080;
+static const uint32_t LOW_BITS = 0x7F7F7F7F;
+
+// 已对齐地址上的32位读写，编译为单条load/store
+static inline uint32_t loadWord(const uint8_t* p) {
+    uint32_t w;
+    memcpy(&w, __builtin_assume_aligned(p, 4), 4);
+    return w;
+}
+
+static inline void storeWord(uint8_t* p, uint32_t w) {
+    memcpy(__builtin_assume_aligned(p, 4), &w, 4);
+}
+
+static inline bool isAligned(const uint8_t* p) {
+    return ((uintptr_t)p & 3) == 0;
+}
+
+/**
+ * @brief 处理到dst对齐之前的字节数，src与dst对齐方式不同时返回全部字节数
+ */
+static inline uint16_t headBytes(const uint8_t* dst, const uint8_t* src, uint16_t bytes) {
+    if (((uintptr_t)dst & 3) != ((uintptr_t)src & 3)) return bytes;
+    uint16_t head = (4 - ((uintptr_t)dst & 3)) & 3;
+    return head < bytes ? head : bytes;
+}
+
+void PixelKernels::fill(uint8_t* dst, uint16_t count, const uint8_t* grb) {
+    if (count == 0) return;
+
+    dst[0] = grb[0];
+    dst[1] = grb[1];
+    dst[2] = grb[2];
+
+    // 每次复制已填充的部分，log2(count)次memcpy完成
+    uint32_t total = (uint32_t)count * 3;
+    uint32_t filled = 3;
+    while (filled < total) {
+        uint32_t n = total - filled < filled ? total - filled : filled;
+        memcpy(dst + filled, dst, n);
+        filled += n;
+    }
+}
+
+void PixelKernels::scale(uint8_t* buf, uint16_t bytes, uint16_t scale) {
+    if (scale >= 256) return;
+
+    uint16_t i = 0;
+    uint16_t head = headBytes(buf, buf, bytes);
+    for (; i < head; i++) {
+        buf[i] = (buf[i] * scale) >> 8;
+    }
+    for (; i + 4 <= bytes; i += 4) {
+        uint32_t w = loadWord(buf + i);
+        uint32_t even = ((w & EVEN_BYTES) * scale >> 8) & EVEN_BYTES;
+        uint32_t odd = (((w >> 8) & EVEN_BYTES) * scale) & ~EVEN_BYTES;
+        storeWord(buf + i, even | odd);
+    }
+    for (; i < bytes; i++) {
+        buf[i] = (buf[i] * scale) >> 8;
+    }
+}
+
+void PixelKernels::blend(uint8_t* dst, const uint8_t* src, uint16_t bytes, uint16_t alpha) {
+    if (alpha == 0) return;
+    if (alpha >= 256) {
+        memmove(dst, src, bytes);
+        return;
+    }
+
+    uint16_t inverse = 256 - alpha;
+    uint16_t i = 0;
+    uint16_t head = headBytes(dst, src, bytes);
+    for (; i < head; i++) {
+        dst[i] = (dst[i] * inverse + src[i] * alpha) >> 8;
+    }
+    if (isAligned(dst + i) && isAligned(src + i)) {
+        for (; i + 4 <= bytes; i += 4) {
+            uint32_t d = loadWord(dst + i);
+            uint32_t s = loadWord(src + i);
+            uint32_t even = (((d & EVEN_BYTES) * inverse + (s & EVEN_BYTES) * alpha) >> 8) & EVEN_BYTES;
+            uint32_t odd = (((d >> 8) & EVEN_BYTES) * inverse + ((s >> 8) & EVEN_BYTES) * alpha) & ~EVEN_BYTES;
+            storeWord(dst + i, even | odd);
+        }
+    }
+    for (; i < bytes; i++) {
+        dst[i] = (dst[i] * inverse + src[i] * alpha) >> 8;
+    }
+}
+
+void PixelKernels::addSaturate(uint8_t* dst, const uint8_t* src, uint16_t bytes) {
+    uint16_t i = 0;
+    uint16_t head = headBytes(dst, src, bytes);
+    for (; i < head; i++) {
+        uint16_t sum = dst[i] + src[i];
+        dst[i] = sum > 255 ? 255 : sum;
+    }
+    if (isAligned(dst + i) && isAligned(src + i)) {
+        for (; i + 4 <= bytes; i += 4) {
+            uint32_t a = loadWord(dst + i);
+            uint32_t b = loadWord(src + i);
+            // 低7位相加后再补上最高位，得到不跨字节的和及每个字节的进位
+            uint32_t sum = ((a & LOW_BITS) + (b & LOW_BITS)) ^ ((a ^ b) & HIGH_BITS);
+            uint32_t carry = ((a & b) | ((a | b) & ~sum)) & HIGH_BITS;
+            // 有进位的字节置为0xFF
+            storeWord(dst + i, sum | ((carry >> 7) * 0xFF));
+        }
+    }
+    for (; i < bytes; i++) {
+        uint16_t sum = dst[i] + src[i];
+        dst[i] = sum > 255 ? 255 : sum;
+    }
+}
@@ -0,0 +1,190 @@
+/**
+ * @file PixelReceiver.cpp
+ * @brief E1.31(sACN)/Art-Net像素接收器实现
+ */
+
+#include "PixelReceiver.h"
+
+// 超过该时间没有收到同步包则退回按universe到齐输出
+static const uint32_t SYNC_TIMEOUT_MS = 1000;
+
+PixelReceiver::PixelReceiver(LightBelt* lightBeltPtr, uint8_t servoLayerCount, uint16_t universe)
+    : lightBelt(lightBeltPtr), firstUniverse(universe) {
+    pixelCount = min((uint16_t)(MAX_UNIVERSES * PIXELS_PER_UNIVERSE), lightBelt->getLedCount());
+    pixelUniverses = (pixelCount + PIXELS_PER_UNIVERSE - 1) / PIXELS_PER_UNIVERSE;
+    servoLayers = min(servoLayerCount, (uint8_t)MAX_SERVO_LAYERS);
+
+    // 像素universe之后紧跟一个舵机universe
+    expectedMask = (1u << pixelUniverses) - 1;
+    if (servoLayers > 0) {
+        expectedMask |= 1u << pixelUniverses;
+    }
+
+    memset(buffers, 0, sizeof(buffers));
+    memset(lastSequence, 0, sizeof(lastSequence));
+    writeIndex = 0;
+    readyIndex = 1;
+    frameReady = false;
+    memset(presentedServo, 0, sizeof(presentedServo));
+    servoPresented = false;
+    receivedMask = 0;
+    syncMode = false;
+    lastSyncTime = 0;
+    packets = frames = droppedFrames = sequenceErrors = invalidPackets = 0;
+    lock = portMUX_INITIALIZER_UNLOCKED;
+    brightnessLut.update(lightBelt->getOutputBrightness());
+}
+
+bool PixelReceiver::begin() {
+#if USE_WIFI
+    // sACN需由控台单播到本机IP，Art-Net支持单播和广播
+    bool ok = e131Udp.listen(E131_PORT) && artnetUdp.listen(ARTNET_PORT);
+    if (ok) {
+        e131Udp.onPacket([this](AsyncUDPPacket& packet) {
+            handlePacket(packet.data(), packet.length());
+        });
+        artnetUdp.onPacket([this](AsyncUDPPacket& packet) {
+            handlePacket(packet.data(), packet.length());
+        });
+    }
+
+    Serial.print("DMX receiver: universes ");
+    Serial.print(firstUniverse);
+    Serial.print("-");
+    Serial.print(firstUniverse + pixelUniverses - (servoLayers > 0 ? 0 : 1));
+    Serial.println(ok ? " listening" : " failed");
+    return ok;
+#else
+    return false;
+#endif
+}
+
+void PixelReceiver::decodeUniverse(uint8_t index, const DmxPacket& packet) {
+    FrameBuffer& frame = buffers[writeIndex];
+
+    if (index < pixelUniverses) {
+        // RGB通道直接解码为GRB并缩放亮度
+        uint16_t first = index * PIXELS_PER_UNIVERSE;
+        uint16_t count = min((uint16_t)(packet.length / 3), (uint16_t)(pixelCount - first));
+        count = min(count, (uint16_t)PIXELS_PER_UNIVERSE);
+        brightnessLut.decode(packet.data, frame.pixels + first * 3, count);
+    } else {
+        // 舵机通道为16位（高字节在前），映射到0-1023
+        uint8_t count = min((uint16_t)servoLayers, (uint16_t)(packet.length / 2));
+        for (uint8_t i = 0; i < count; i++) {
+            frame.servo[i] = dmxRead16BE(packet.data + i * 2) >> 6;
+        }
+        frame.hasServo = true;
+    }
+}
+
+void PixelReceiver::completeFrame() {
+    if (receivedMask == 0) return;
+
+    if (frameReady) {
+        droppedFrames++;
+    }
+
+    // 新的写入缓冲区以刚完成的帧为底，没有重发的universe保持原值
+    readyIndex = writeIndex;
+    writeIndex ^= 1;
+    memcpy(&buffers[writeIndex], &buffers[readyIndex], sizeof(FrameBuffer));
+
+    receivedMask = 0;
+    frameReady = true;
+    frames++;
+}
+
+void PixelReceiver::handlePacket(const uint8_t* data, size_t length) {
+    DmxPacket packet;
+    if (!dmxParsePacket(data, length, packet)) {
+        invalidPackets++;
+        return;
+    }
+
+    uint32_t now = millis();
+    portENTER_CRITICAL(&lock);
+    packets++;
+
+    if (packet.type == DMX_PACKET_SYNC) {
+        syncMode = true;
+        lastSyncTime = now;
+        completeFrame();
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+
+    if (syncMode && now - lastSyncTime > SYNC_TIMEOUT_MS) {
+        syncMode = false;
+    }
+
+    // 先检查范围再移位和访问序号表，其他编号的universe属于别的设备
+    if (packet.universe < firstUniverse || packet.universe - firstUniverse > pixelUniverses) {
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+    uint8_t index = packet.universe - firstUniverse;
+    if (!(expectedMask & (1u << index))) {
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+
+    // 按E1.31规定丢弃序号回退不超过20的乱序包
+    if (packet.sequence != 0 && lastSequence[index] != 0) {
+        int8_t diff = (int8_t)(packet.sequence - lastSequence[index]);
+        if (diff <= 0 && diff > -20) {
+            sequenceErrors++;
+            portEXIT_CRITICAL(&lock);
+            return;
+        }
+    }
+    lastSequence[index] = packet.sequence;
+
+    // 没有同步包时，某个universe重复出现说明发送方已开始下一帧
+    if (!syncMode && (receivedMask & (1u << index))) {
+        completeFrame();
+    }
+
+    decodeUniverse(index, packet);
+    receivedMask |= 1u << index;
+
+    if (!syncMode && receivedMask == expectedMask) {
+        completeFrame();
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+bool PixelReceiver::present() {
+    if (!frameReady) return false;
+
+    portENTER_CRITICAL(&lock);
+    const FrameBuffer& frame = buffers[readyIndex];
+    memcpy(lightBelt->getPixelBuffer(), frame.pixels, pixelCount * 3);
+    memcpy(presentedServo, frame.servo, sizeof(presentedServo));
+    servoPresented = frame.hasServo;
+    frameReady = false;
+    brightnessLut.update(lightBelt->getOutputBrightness());
+    portEXIT_CRITICAL(&lock);
+
+    lightBelt->show();
+    return true;
+}
+
+bool PixelReceiver::getServoValue(uint8_t layer, int& value) const {
+    if (!servoPresented || layer >= servoLayers) return false;
+    value = presentedServo[layer];
+    return true;
+}
+
+void PixelReceiver::report(Print& out) const {
+    out.print("Network|");
+    out.print(packets);
+    out.print("|");
+    out.print(frames);
+    out.print("|");
+    out.print(droppedFrames);
+    out.print("|");
+    out.print(sequenceErrors);
+    out.print("|");
+    out.println(invalidPackets);
+}
@@ -0,0 +1,264 @@
+/**
+ * @file PixelStream.cpp
+ * @brief 串口像素流接收器实现
+ */
+
+#include "PixelStream.h"
+#include "PixelKernels.h"
+#include "Telemetry.h"
+
+// 最近收到过像素帧的时间窗口，窗口内魔数不必在行首
+static const uint32_t RESYNC_WINDOW_MS = 1000;
+
+PixelStream::PixelStream(LightBelt* lightBeltPtr) : lightBelt(lightBeltPtr) {
+    state = STATE_SCAN;
+    history[0] = history[1] = 0;
+    lineBytes = 0;
+    kind = 0;
+    headerLength = headerNeeded = 0;
+    payloadLength = received = 0;
+    lastByteTime = lastFrameTime = 0;
+    streaming = false;
+    synced = false;
+    lastSequence = 0;
+    frameReady = false;
+    resetCounters();
+}
+
+bool PixelStream::expired(uint32_t now) {
+    if (state == STATE_SCAN || now - lastByteTime <= PIXEL_STREAM_TIMEOUT_MS) return false;
+
+    // 上位机中途停止发送，丢弃不完整的帧，之后的差分帧缺少参照
+    timeouts++;
+    synced = false;
+    finishFrame();
+    return true;
+}
+
+void PixelStream::finishFrame() {
+    // 帧结束处视为行首，紧接着的下一个帧头总能识别
+    state = STATE_SCAN;
+    history[0] = history[1] = 0;
+    lineBytes = 0;
+}
+
+bool PixelStream::feed(uint8_t c, uint32_t now) {
+    expired(now);
+
+    if (state == STATE_SCAN) {
+        bool anywhere = streaming && now - lastFrameTime < RESYNC_WINDOW_MS;
+        bool magic = history[0] == 'A' && history[1] == 'd' && (c == 'a' || c == 'z') &&
+                     (lineBytes == 2 || anywhere);
+
+        if (c == '\r' || c == '\n') {
+            lineBytes = 0;
+        } else if (lineBytes < 255) {
+            lineBytes++;
+        }
+        history[0] = history[1];
+        history[1] = c;
+        if (!magic) return false;
+
+        kind = c;
+        headerLength = 0;
+        headerNeeded = kind == 'a' ? 3 : 5;
+        state = STATE_HEADER;
+        lastByteTime = now;
+        bytes += 3;
+        return true;
+    }
+
+    lastByteTime = now;
+    bytes++;
+    if (state == STATE_HEADER) {
+        header[headerLength++] = c;
+        if (headerLength == headerNeeded) {
+            headerDone();
+        }
+        return true;
+    }
+
+    // 超出接收缓冲区的Adalight数据只计数不保存
+    if (received < sizeof(payload)) {
+        payload[received] = c;
+    }
+    received++;
+    if (received == payloadLength) {
+        payloadDone();
+    }
+    return true;
+}
+
+size_t PixelStream::receive(Stream& input, uint32_t now) {
+    if (state != STATE_PAYLOAD || expired(now) || received >= sizeof(payload)) return 0;
+
+    uint32_t wanted = min(payloadLength - received, (uint32_t)sizeof(payload) - received);
+    size_t count = min((size_t)wanted, (size_t)input.available());
+    if (count == 0) return 0;
+
+    count = input.readBytes(payload + received, count);
+    lastByteTime = now;
+    bytes += count;
+    received += count;
+    if (received == payloadLength) {
+        payloadDone();
+    }
+    return count;
+}
+
+void PixelStream::headerDone() {
+    uint8_t check = 0x55;
+    for (uint8_t i = 0; i < headerNeeded - 1; i++) {
+        check ^= header[i];
+    }
+    if (check != header[headerNeeded - 1]) {
+        invalidFrames++;
+        finishFrame();
+        return;
+    }
+
+    if (kind == 'a') {
+        payloadLength = (((uint32_t)header[0] << 8) | header[1]) + 1;
+        payloadLength *= 3;
+    } else {
+        // 负载之后的CRC8
+        payloadLength = (((uint32_t)header[2] << 8) | header[3]) + 1;
+    }
+    received = 0;
+    state = STATE_PAYLOAD;
+}
+
+void PixelStream::payloadDone() {
+    if (kind == 'a') {
+        decodeRaw(payloadLength / 3);
+        rawFrames++;
+        synced = false;
+        frameDecoded();
+        finishFrame();
+        return;
+    }
+
+    uint8_t type = header[0];
+    uint8_t sequence = header[1];
+    uint16_t length = payloadLength - 1;
+    if (payloadLength > sizeof(payload) || type > TYPE_DELTA || Telemetry::crc8(payload, length) != payload[length]) {
+        invalidFrames++;
+        synced = false;
+    } else if (type == TYPE_DELTA && (!synced || sequence != (uint8_t)(lastSequence + 1))) {
+        unsynced++;
+        synced = false;
+    } else if (!decodeCompressed(payload, length, type == TYPE_KEYFRAME)) {
+        invalidFrames++;
+        synced = false;
+    } else {
+        if (type == TYPE_KEYFRAME) {
+            keyframes++;
+        } else {
+            deltaFrames++;
+        }
+        synced = true;
+        lastSequence = sequence;
+        frameDecoded();
+    }
+    finishFrame();
+}
+
+void PixelStream::decodeRaw(uint32_t count) {
+    brightnessLut.update(lightBelt->getOutputBrightness());
+
+    // 多出的LED忽略，不足时其余LED保持
+    uint32_t leds = min((uint32_t)lightBelt->getLedCount(), (uint32_t)PIXEL_STREAM_MAX_LEDS);
+    count = min(count, leds);
+    brightnessLut.decode(payload, lightBelt->getPixelBuffer(), count);
+}
+
+bool PixelStream::decodeCompressed(const uint8_t* data, uint16_t length, bool keyframe) {
+    uint32_t leds = min((uint32_t)lightBelt->getLedCount(), (uint32_t)PIXEL_STREAM_MAX_LEDS);
+
+    // 先检查整个负载，出错时不改动灯带
+    uint32_t position = 0;
+    for (uint16_t i = 0; i < length;) {
+        uint8_t op = data[i++];
+        uint16_t count = (op & OP_COUNT_MASK) + 1;
+        uint16_t operandBytes;
+        switch (op & ~OP_COUNT_MASK) {
+        case OP_SKIP: operandBytes = 0; break;
+        case OP_RUN: operandBytes = 3; break;
+        case OP_LITERAL: operandBytes = count * 3; break;
+        default: return false;
+        }
+        if (length - i < operandBytes || position + count > leds) return false;
+        i += operandBytes;
+        position += count;
+    }
+
+    brightnessLut.update(lightBelt->getOutputBrightness());
+
+    uint8_t* pixels = lightBelt->getPixelBuffer();
+    if (keyframe) {
+        memset(pixels, 0, leds * 3);
+    }
+    uint8_t* dst = pixels;
+    for (uint16_t i = 0; i < length;) {
+        uint8_t op = data[i++];
+        uint16_t count = (op & OP_COUNT_MASK) + 1;
+        if ((op & ~OP_COUNT_MASK) == OP_RUN) {
+            uint8_t grb[3];
+            brightnessLut.decode(data + i, grb, 1);
+            PixelKernels::fill(dst, count, grb);
+            i += 3;
+        } else if ((op & ~OP_COUNT_MASK) == OP_LITERAL) {
+            brightnessLut.decode(data + i, dst, count);
+            i += count * 3;
+        }
+        dst += count * 3;
+    }
+    return true;
+}
+
+void PixelStream::frameDecoded() {
+    // 上一帧还没有输出就被新帧覆盖
+    if (frameReady) {
+        overwritten++;
+    }
+    frameReady = true;
+    streaming = true;
+    lastFrameTime = lastByteTime;
+}
+
+bool PixelStream::present() {
+    if (!frameReady) return false;
+    frameReady = false;
+    lightBelt->show();
+    return true;
+}
+
+void PixelStream::invalidate() {
+    synced = false;
+    frameReady = false;
+}
+
+void PixelStream::resetCounters() {
+    rawFrames = keyframes = deltaFrames = 0;
+    unsynced = invalidFrames = timeouts = overwritten = 0;
+    bytes = 0;
+}
+
+void PixelStream::report(Print& out) const {
+    out.print("Stream|");
+    out.print(rawFrames);
+    out.print("|");
+    out.print(keyframes);
+    out.print("|");
+    out.print(deltaFrames);
+    out.print("|");
+    out.print(unsynced);
+    out.print("|");
+    out.print(invalidFrames);
+    out.print("|");
+    out.print(timeouts);
+    out.print("|");
+    out.print(overwritten);
+    out.print("|");
+    out.println(bytes);
+}
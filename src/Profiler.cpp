@@ -0,0 +1,99 @@
+/**
+ * @file Profiler.cpp
+ * @brief 分阶段性能统计实现
+ */
+
+#include "Profiler.h"
+
+Profiler::StageStats Profiler::stats[PROFILE_STAGE_COUNT];
+Profiler::Frame Profiler::stack[Profiler::MAX_DEPTH];
+uint8_t Profiler::depth = 0;
+
+static const char* const STAGE_NAMES[PROFILE_STAGE_COUNT] = {
+    "Parse", "Effect", "LedOutput", "ServoOutput", "Frame"
+};
+
+void Profiler::enter(ProfileStage stage) {
+    // 超出最大深度时只记录深度，不再计时
+    if (depth < MAX_DEPTH) {
+        stack[depth].stage = stage;
+        stack[depth].childCycles = 0;
+        stack[depth].startCycles = now();
+    }
+    depth++;
+}
+
+void Profiler::exit() {
+    if (depth == 0) return;
+    depth--;
+    if (depth >= MAX_DEPTH) return;
+
+    uint32_t elapsed = now() - stack[depth].startCycles;
+    uint32_t exclusive = elapsed - stack[depth].childCycles;
+
+    // 整帧统计包含子阶段，其余阶段只统计独占时间
+    record(stack[depth].stage, stack[depth].stage == PROFILE_FRAME ? elapsed : exclusive);
+
+    if (depth > 0) {
+        stack[depth - 1].childCycles += elapsed;
+    }
+}
+
+void Profiler::record(ProfileStage stage, uint32_t cycles) {
+    if (stage >= PROFILE_STAGE_COUNT) return;
+    StageStats& s = stats[stage];
+
+    if (s.count == 0 || cycles < s.minCycles) s.minCycles = cycles;
+    if (cycles > s.maxCycles) s.maxCycles = cycles;
+    s.totalCycles += cycles;
+    s.lastCycles = cycles;
+    s.count++;
+
+    // 按微秒数的二进制位数选择直方图桶
+    uint32_t us = cyclesToMicros(cycles);
+    uint8_t bucket = 0;
+    while (us > 1 && bucket < HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    if (s.histogram[bucket] < 0xFFFF) {
+        s.histogram[bucket]++;
+    }
+}
+
+void Profiler::reset() {
+    memset(stats, 0, sizeof(stats));
+}
+
+uint32_t Profiler::cyclesToMicros(uint32_t cycles) {
+    return cycles / ESP.getCpuFreqMHz();
+}
+
+void Profiler::report(Print& out) {
+    // 每个阶段一行汇总：Stats|阶段|次数|最小us|平均us|最大us
+    // 紧跟一行直方图：Hist|阶段|桶0,桶1,...
+    for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        const StageStats& s = stats[i];
+        uint32_t avgCycles = s.count ? (uint32_t)(s.totalCycles / s.count) : 0;
+
+        out.print("Stats|");
+        out.print(STAGE_NAMES[i]);
+        out.print("|");
+        out.print(s.count);
+        out.print("|");
+        out.print(cyclesToMicros(s.minCycles));
+        out.print("|");
+        out.print(cyclesToMicros(avgCycles));
+        out.print("|");
+        out.println(cyclesToMicros(s.maxCycles));
+
+        out.print("Hist|");
+        out.print(STAGE_NAMES[i]);
+        out.print("|");
+        for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            if (b > 0) out.print(",");
+            out.print(s.histogram[b]);
+        }
+        out.println();
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file Scheduler.cpp
+ * @brief 多速率周期任务的到期判断和统计
+ */
+
+#include "Scheduler.h"
+
+static const char* const JOB_NAMES[JOB_COUNT] = {"Comms", "Servo", "LED"};
+
+Scheduler::Scheduler() {
+    periodFloor = 0;
+    for (uint8_t i = 0; i < JOB_COUNT; i++) {
+        periods[i] = 0;
+        next[i] = 0;
+        lastStart[i] = 0;
+        scheduled[i] = false;
+    }
+    resetCounters();
+}
+
+void Scheduler::setPeriod(SchedulerJob job, uint32_t periodMicros) {
+    periods[job] = periodMicros;
+}
+
+uint32_t Scheduler::getPeriod(SchedulerJob job) const {
+    if (job == JOB_COMMS || periods[job] >= periodFloor) return periods[job];
+    return periodFloor;
+}
+
+void Scheduler::setPeriodFloor(uint32_t periodMicros) {
+    bool shorter = periodMicros < periodFloor;
+    periodFloor = periodMicros;
+    if (!shorter) return;
+
+    // 恢复正常帧率时不必等到按旧周期安排的时间
+    for (uint8_t i = 0; i < JOB_COUNT; i++) {
+        uint32_t period = getPeriod((SchedulerJob)i);
+        if (!scheduled[i] || period == 0) continue;
+        uint32_t limit = lastStart[i] + period;
+        if ((int32_t)(next[i] - limit) > 0) next[i] = limit;
+    }
+}
+
+bool Scheduler::due(SchedulerJob job, uint32_t now) {
+    uint32_t period = getPeriod(job);
+    if (period > 0 && scheduled[job] && (int32_t)(now - next[job]) < 0) return false;
+
+    JobStats& s = stats[job];
+    if (scheduled[job]) {
+        if (period > 0) {
+            uint32_t late = now - next[job];
+            s.totalLate += late;
+            if (late > s.maxLate) s.maxLate = late;
+        }
+        uint32_t interval = now - lastStart[job];
+        s.intervals++;
+        s.totalInterval += interval;
+        if (interval < s.minInterval) s.minInterval = interval;
+        if (interval > s.maxInterval) s.maxInterval = interval;
+    }
+    s.runs++;
+
+    if (period > 0) {
+        if (!scheduled[job]) {
+            next[job] = now + period;
+        } else {
+            next[job] += period;
+            // 落后一个周期以上时跳到当前时间之后的第一个网格点
+            if ((int32_t)(now - next[job]) >= 0) {
+                uint32_t behind = (now - next[job]) / period + 1;
+                s.skipped += behind;
+                next[job] += behind * period;
+            }
+        }
+    }
+    lastStart[job] = now;
+    scheduled[job] = true;
+    return true;
+}
+
+void Scheduler::record(SchedulerJob job, uint32_t durationMicros) {
+    JobStats& s = stats[job];
+    s.totalDuration += durationMicros;
+    if (durationMicros > s.maxDuration) s.maxDuration = durationMicros;
+}
+
+uint32_t Scheduler::untilNext(uint32_t now) const {
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t i = 0; i < JOB_COUNT; i++) {
+        if (getPeriod((SchedulerJob)i) == 0) continue;
+        if (!scheduled[i]) return 0;
+        int32_t remaining = (int32_t)(next[i] - now);
+        if (remaining <= 0) return 0;
+        if ((uint32_t)remaining < wait) wait = remaining;
+    }
+    return wait == UINT32_MAX ? 0 : wait;
+}
+
+void Scheduler::resetCounters() {
+    memset(stats, 0, sizeof(stats));
+    for (uint8_t i = 0; i < JOB_COUNT; i++) {
+        stats[i].minInterval = UINT32_MAX;
+    }
+}
+
+void Scheduler::report(Print& out) const {
+    for (uint8_t i = 0; i < JOB_COUNT; i++) {
+        const JobStats& s = stats[i];
+        uint32_t intervals = s.intervals;
+        // Job|名称|周期us|次数|平均间隔us|最大间隔us|平均延迟us|最大延迟us|平均耗时us|最大耗时us|跳过
+        out.print("Job|");
+        out.print(JOB_NAMES[i]);
+        out.print("|");
+        out.print(getPeriod((SchedulerJob)i));
+        out.print("|");
+        out.print(s.runs);
+        out.print("|");
+        out.print(intervals ? (uint32_t)(s.totalInterval / intervals) : 0);
+        out.print("|");
+        out.print(s.maxInterval);
+        out.print("|");
+        out.print(intervals ? (uint32_t)(s.totalLate / intervals) : 0);
+        out.print("|");
+        out.print(s.maxLate);
+        out.print("|");
+        out.print(s.runs ? (uint32_t)(s.totalDuration / s.runs) : 0);
+        out.print("|");
+        out.print(s.maxDuration);
+        out.print("|");
+        out.println(s.skipped);
+    }
+}
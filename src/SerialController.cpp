@@ -7,13 +7,20 @@
  */
 
 #include "SerialController.h"
+#include "Profiler.h"
+#include "ShowClock.h"
+#include "BootState.h"
 
 /**
  * @brief 构造函数 - 使用内部PWM
  */
 SerialController::SerialController(LightBelt* lightBeltPtr, ServoPlatformInter* servoPlatformPtr, uint32_t cycleTimeMs)
-    : lightBelt(lightBeltPtr), servoPlatform(servoPlatformPtr), periodMs(cycleTimeMs) {
+    : lightBelt(lightBeltPtr), servoPlatform(servoPlatformPtr), periodMs(cycleTimeMs), pixelStream(lightBeltPtr) {
     useInternalPWM = true;
+    pixelReceiver = nullptr;
+    layerMap.build(servoPlatformPtr->getLayers(), lightBelt->getLayers(), lightBelt->getLedsPerLayer());
+    outputLatch.attach(lightBelt, servoPlatformPtr);
+    initScheduler();
     strcpy(currentMode, "Idle");  // 默认为Idle模式
     
     // 初始化参数
@@ -22,14 +29,19 @@ SerialController::SerialController(LightBelt* lightBeltPtr, ServoPlatformInter*
     }
     
     cmdIndex = 0;
+    cmdOverflow = false;
 }
 
 /**
  * @brief 构造函数 - 使用外部舵机驱动
  */
 SerialController::SerialController(LightBelt* lightBeltPtr, ServoPlatform* servoPlatformPtr, uint32_t cycleTimeMs)
-    : lightBelt(lightBeltPtr), servoPlatform(servoPlatformPtr), periodMs(cycleTimeMs) {
+    : lightBelt(lightBeltPtr), servoPlatform(servoPlatformPtr), periodMs(cycleTimeMs), pixelStream(lightBeltPtr) {
     useInternalPWM = false;
+    pixelReceiver = nullptr;
+    layerMap.build(servoPlatformPtr->getLayers(), lightBelt->getLayers(), lightBelt->getLedsPerLayer());
+    outputLatch.attach(lightBelt, servoPlatformPtr);
+    initScheduler();
     strcpy(currentMode, "Idle");  // 默认为Idle模式
     
     // 初始化参数
@@ -38,6 +50,7 @@ SerialController::SerialController(LightBelt* lightBeltPtr, ServoPlatform* servo
     }
     
     cmdIndex = 0;
+    cmdOverflow = false;
 }
 
 /**
@@ -46,32 +59,90 @@ SerialController::SerialController(LightBelt* lightBeltPtr, ServoPlatform* servo
 void SerialController::begin() {
     // Serial已在main.cpp中初始化，这里无需再次初始化
     Serial.println("Serial control initialized");
+    
+    // 内部PWM在浅睡眠中停止输出，Wi-Fi需要射频持续工作
+    governor.setLightSleep(!useInternalPWM && !USE_WIFI);
     Serial.println("You can control the device by sending commands via serial");
     Serial.println("Command format: Mode|param1|param2|...");
     Serial.println("Default mode is Idle");
     
-    // 立即执行Idle模式
-    executeIdleMode();
+    // 恢复上次保存的模式，未保存过时为Idle
+    const BootSettings& boot = BootState::get();
+    if (strcmp(boot.mode, "Follow") == 0) {
+        int restoredParams[6];
+        memcpy(restoredParams, boot.params, sizeof(restoredParams));
+        setControlMode("Follow", restoredParams);
+    } else if (strcmp(boot.mode, "Idle") != 0) {
+        setPresetMode(boot.mode);
+    }
+    
+    // Idle模式立即执行
+    if (modeEquals("Idle")) {
+        executeIdleMode();
+    }
+}
+
+/**
+ * @brief 设置各任务的周期
+ */
+void SerialController::initScheduler() {
+    scheduler.setPeriod(JOB_COMMS, 0);
+    scheduler.setPeriod(JOB_SERVO, SERVO_FRAME_US);
+    scheduler.setPeriod(JOB_LED, LED_FRAME_US);
 }
 
 /**
  * @brief 更新处理串口命令
+ * @details 命令每次调用都处理；舵机或灯带到期时才运行当前模式并输出到期的一方
  */
 void SerialController::update() {
+    uint32_t commsStart = micros();
+    scheduler.due(JOB_COMMS, commsStart);
+    
+    // 舵机和灯带输出先暂存，到期时才释放
+    outputLatch.stage();
+    
     // 处理串口数据 (非阻塞)
+    uint32_t nowMs = millis();
     while (Serial.available()) {
+        // 像素帧的负载整块读入
+        if (pixelStream.receive(Serial, nowMs) > 0) continue;
+        
         char c = Serial.read();
         
+        // 像素帧的字节不进入命令解析，识别到帧头时丢弃本行已收到的"Ad"
+        if (pixelStream.feed(c, nowMs)) {
+            cmdIndex = 0;
+            cmdOverflow = false;
+            continue;
+        }
+        
         // 回车或换行表示命令结束
         if (c == '\r' || c == '\n') {
-            if (cmdIndex > 0) {
+            if (cmdOverflow) {
+                // 截断后的命令可能带着错误的参数生效，整行丢弃
+                Serial.println("Error: Command too long!");
+                cmdOverflow = false;
+                cmdIndex = 0;
+            }
+            else if (cmdIndex > 0) {
                 // 添加字符串结束符
                 cmdBuffer[cmdIndex] = '\0';
                 
+                // 开始追踪延迟，去掉"@编号 "前缀
+                size_t offset = latency.begin(cmdBuffer);
+                if (offset > 0) {
+                    memmove(cmdBuffer, cmdBuffer + offset, cmdIndex - offset + 1);
+                }
+                
                 // 处理命令
                 Serial.print("Command received: ");
                 Serial.println(cmdBuffer);
+                governor.inputReceived();
+                PROFILE_BEGIN(PROFILE_PARSE);
                 processCommand();
+                PROFILE_END();
+                latency.parsed();
                 
                 // 重置命令缓冲区
                 cmdIndex = 0;
@@ -79,13 +150,47 @@ void SerialController::update() {
         } 
         // 添加字符到缓冲区
         else if (cmdIndex < sizeof(cmdBuffer) - 1) {
+            if (cmdIndex == 0) latency.arrived(micros());
             cmdBuffer[cmdIndex++] = c;
         }
+        else {
+            cmdOverflow = true;
+        }
     }
     
+    // 收到完整的像素帧时切换到Stream模式，灯带不再按放慢后的周期等待
+    if (pixelStream.hasFrame()) {
+        governor.inputReceived();
+        scheduler.setPeriodFloor((uint32_t)governor.getIntervalMs() * 1000);
+        if (!modeEquals("Stream")) {
+            setPresetMode("Stream");
+        }
+    }
+    
+    // 按订阅频率发送遥测帧
+    if (telemetry.due(millis())) {
+        sendTelemetry();
+    }
+    scheduler.record(JOB_COMMS, micros() - commsStart);
+    
+    uint32_t now = micros();
+    bool servoDue = scheduler.due(JOB_SERVO, now);
+    bool ledDue = scheduler.due(JOB_LED, now);
+    if (servoDue || ledDue) {
+        renderFrame(servoDue, ledDue);
+    }
+}
+
+/**
+ * @brief 运行当前模式并输出到期的舵机或灯带
+ */
+void SerialController::renderFrame(bool servoDue, bool ledDue) {
+    PROFILE_SCOPE(PROFILE_FRAME);
+    
     // 根据当前模式执行对应操作
+    PROFILE_BEGIN(PROFILE_EFFECT);
     if (modeEquals("Rainbow")) {
-        lightBelt->rainbowCycle(periodMs);
+        lightBelt->rainbowCycle(periodMs, Palettes::get(PALETTE_RAINBOW));
         
         if (useInternalPWM) {
             ((ServoPlatformInter*)servoPlatform)->sweepAllLayers(periodMs, 30.0);
@@ -105,7 +210,30 @@ void SerialController::update() {
     else if (modeEquals("Standby")) {
         executeStandbyMode();
     }
+    else if (modeEquals("Timeline")) {
+        executeTimelineMode();
+    }
+    else if (modeEquals("Show")) {
+        executeShowMode();
+    }
+    else if (modeEquals("Network")) {
+        executeNetworkMode();
+    }
+    else if (modeEquals("Stream")) {
+        executeStreamMode(ledDue);
+    }
+    else if (modeEquals("Layers")) {
+        executeLayersMode();
+    }
+    else if (modeEquals("Effect")) {
+        executeEffectMode();
+    }
     else if (modeEquals("Follow")) {
+        // 带时间戳的Follow参数经抖动缓冲区延迟插值后输出
+        if (followBuffer.isActive()) {
+            followBuffer.sample(millis(), params);
+        }
+        
         // 获取舵机层数
         uint8_t totalServoLayers = 0;
         if (useInternalPWM) {
@@ -114,9 +242,6 @@ void SerialController::update() {
             totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
         }
         
-        // 获取灯带总层数
-        uint8_t totalLightLayers = lightBelt->getLayers();
-        
         // 实时控制舵机角度和灯光效果
         for (int i = 0; i < totalServoLayers && i < 6; i++) {
             // 层号反向映射：第一位对应最后一层，以此类推
@@ -129,42 +254,48 @@ void SerialController::update() {
                 ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(reversedLayer, params[i]);
             }
             
-            // 添加灯带灯光效果
-            // 1. 亮度和Follow参数成正比
-            uint8_t brightness = map(params[i], 0, 1023, 0, 255);
-            
-            // 2. 蓝色程度和参数成正比，越大越蓝，越小越白
-            // 从白色(0xFFFFFF)到蓝色(0x0000FF)的渐变
-            uint8_t blueValue = 255;  // 蓝色分量保持255
-            uint8_t whiteValue = 255 - map(params[i], 0, 1023, 0, 255);  // 红绿分量随参数减小
-            
-            // 构建RGB颜色
-            uint32_t color = (whiteValue << 16) | (whiteValue << 8) | blueValue;
+            // 添加灯带灯光效果：参数越大越亮越蓝，越小越暗越白
+            uint32_t color = Palettes::get(PALETTE_FOLLOW).sample(map(params[i], 0, 1023, 0, 65535));
             
-            // 调整亮度
-            uint32_t adjustedColor = lightBelt->dimColor(color, brightness);
+            // 调色板中已包含亮度，这里只应用最大亮度限制
+            uint32_t adjustedColor = lightBelt->dimColor(color, 255);
             
-            // 设置灯带颜色，每层舵机对应两层灯带
-            if (totalLightLayers >= totalServoLayers * 2) {
-                // 层号反向映射，对应两层灯带
-                uint8_t lightLayer1 = reversedLayer * 2;
-                uint8_t lightLayer2 = reversedLayer * 2 + 1;
-                
-                if (lightLayer1 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer1, adjustedColor);
-                }
-                
-                if (lightLayer2 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer2, adjustedColor);
-                }
-            } else {
-                // 灯带层数与舵机层数相同或更少的情况
-                if (reversedLayer < totalLightLayers) {
-                    lightBelt->setLayerColor(reversedLayer, adjustedColor);
-                }
-            }
+            // 设置该层舵机对应的灯带
+            setServoLayerColor(reversedLayer, adjustedColor);
         }
     }
+    PROFILE_END();
+    latency.effectDone();
+    
+    outputLatch.commit(servoDue, ledDue);
+    if (servoDue) scheduler.record(JOB_SERVO, outputLatch.getServoCommitMicros());
+    if (ledDue) scheduler.record(JOB_LED, outputLatch.getLedCommitMicros());
+    latency.outputDone(servoDue, ledDue, outputLatch.getServoDoneAt(), outputLatch.getLedDoneAt());
+    governor.frameDone(frameActivity(), outputLatch.outputChanged());
+    scheduler.setPeriodFloor((uint32_t)governor.getIntervalMs() * 1000);
+}
+
+/**
+ * @brief 当前模式对帧率的需求
+ * @details 订阅了遥测时保持正常帧率；Standby为缓慢的呼吸效果；Follow和Stream的输出只随输入变化
+ */
+FrameActivity SerialController::frameActivity() const {
+    if (telemetry.getRate() > 0) return FRAME_ACTIVE;
+    if (strcmp(currentMode, "Standby") == 0) return FRAME_SLOW;
+    if (strcmp(currentMode, "Follow") == 0) return FRAME_ADAPTIVE;
+    if (strcmp(currentMode, "Stream") == 0) return FRAME_ADAPTIVE;
+    return FRAME_ACTIVE;
+}
+
+/**
+ * @brief 按映射表设置一层舵机对应的全部灯带
+ */
+void SerialController::setServoLayerColor(uint8_t servoLayer, uint32_t color) {
+    if (servoLayer >= layerMap.getServoLayers()) return;
+    
+    for (const LedSpan* span = layerMap.begin(servoLayer); span != layerMap.end(servoLayer); span++) {
+        lightBelt->setRangeColor(span->first, span->count, color);
+    }
 }
 
 /**
@@ -183,8 +314,7 @@ void SerialController::executeIdleMode() {
     }
     
     // 白色呼吸灯效果（所有层相同颜色）
-    uint32_t whiteColor = 0xFFFFFF;
-    lightBelt->breathing(whiteColor, 3000);
+    lightBelt->breathing(Palettes::get(PALETTE_IDLE), 3000);
     
     // 如果是第一次进入Idle模式，或者模式刚刚切换为Idle
     if (isInitialReset) {
@@ -225,10 +355,9 @@ void SerialController::executeIdleMode() {
  * @details 舵机相位差半个周期往返运动，灯带呼吸效果与对应舵机同步
  */
 void SerialController::executeHeatupMode() {
-    uint32_t timeNow = millis();
+    uint32_t timeNow = ShowClock::now();
     
     // 定义颜色 - 使用红色表示热量
-    uint32_t onColor = 0xFF0000;  // 红色
     
     // 获取舵机总层数
     uint8_t totalServoLayers = 0;
@@ -238,8 +367,6 @@ void SerialController::executeHeatupMode() {
         totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
     }
     
-    // 获取灯带总层数，通常是舵机层数的2倍
-    uint8_t totalLightLayers = lightBelt->getLayers();
     
     // 计算各层舵机角度
     for (uint8_t servoLayer = 0; servoLayer < totalServoLayers; servoLayer++) {
@@ -265,31 +392,14 @@ void SerialController::executeHeatupMode() {
             ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(servoLayer, mappedValue);
         }
         
-        // 计算亮度值，与舵机角度同步变化
-        uint8_t brightness = map(mappedValue, 0, 1023, 0, 255);
+        // 亮度与舵机角度同步变化，在调色板上取色
+        uint32_t color = Palettes::get(PALETTE_HEATUP).sample(map(mappedValue, 0, 1023, 0, 65535));
         
         // 设置对应层的灯带颜色
-        uint32_t dimmedColor = lightBelt->dimColor(onColor, brightness);
+        uint32_t dimmedColor = lightBelt->dimColor(color, 255);
         
-        // 针对灯带层数是舵机层数的2倍的情况，将两层灯带对应一层舵机
-        if (totalLightLayers >= totalServoLayers * 2) {
-            // 每层舵机对应两层灯带
-            uint8_t lightLayer1 = servoLayer * 2;
-            uint8_t lightLayer2 = servoLayer * 2 + 1;
-            
-            if (lightLayer1 < totalLightLayers) {
-                lightBelt->setLayerColor(lightLayer1, dimmedColor);
-            }
-            
-            if (lightLayer2 < totalLightLayers) {
-                lightBelt->setLayerColor(lightLayer2, dimmedColor);
-            }
-        } else {
-            // 灯带层数与舵机层数相同或更少的情况
-            if (servoLayer < totalLightLayers) {
-                lightBelt->setLayerColor(servoLayer, dimmedColor);
-            }
-        }
+        // 设置该层舵机对应的灯带
+        setServoLayerColor(servoLayer, dimmedColor);
     }
 }
 
@@ -319,7 +429,7 @@ void SerialController::executeCooldownMode() {
     // 计算每层冷却时间 = 总时间 / 层数
     const uint32_t totalCooldownTime = 30000;  // 总冷却时间30秒
     const uint32_t layerCooldownTime = totalCooldownTime / totalServoLayers;  // 每层冷却时间
-    const uint32_t orangeColor = 0xFF8800;  // 橙黄色
+    const Palette& palette = Palettes::get(PALETTE_COOLDOWN);  // 默认为橙黄色
     
     // 如果是第一次执行或刚刚重置
     if (currentLayer == 0 && *pStartTime == 0) {
@@ -334,7 +444,7 @@ void SerialController::executeCooldownMode() {
         
         // 设置所有灯为橙黄色最亮
         for (uint8_t layer = 0; layer < totalLightLayers; layer++) {
-            lightBelt->setLayerColor(layer, orangeColor);
+            lightBelt->setLayerColor(layer, palette.at(255));
         }
         
         // 记录开始时间
@@ -366,31 +476,14 @@ void SerialController::executeCooldownMode() {
             ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(servoLayer, angleValue);
         }
         
-        // 计算亮度值（由最亮变为最暗）
-        uint8_t brightness = 255 * (1.0f - progress);
+        // 在调色板上由最亮变为最暗
+        uint16_t position = 65535 * (1.0f - progress);
         
         // 设置对应层灯带亮度
-        uint32_t dimmedColor = lightBelt->dimColor(orangeColor, brightness);
+        uint32_t dimmedColor = lightBelt->dimColor(palette.sample(position), 255);
         
-        // 针对灯带层数是舵机层数的2倍的情况
-        if (totalLightLayers >= totalServoLayers * 2) {
-            // 每层舵机对应两层灯带
-            uint8_t lightLayer1 = servoLayer * 2;
-            uint8_t lightLayer2 = servoLayer * 2 + 1;
-            
-            if (lightLayer1 < totalLightLayers) {
-                lightBelt->setLayerColor(lightLayer1, dimmedColor);
-            }
-            
-            if (lightLayer2 < totalLightLayers) {
-                lightBelt->setLayerColor(lightLayer2, dimmedColor);
-            }
-        } else {
-            // 灯带层数与舵机层数相同或更少的情况
-            if (servoLayer < totalLightLayers) {
-                lightBelt->setLayerColor(servoLayer, dimmedColor);
-            }
-        }
+        // 设置该层舵机对应的灯带
+        setServoLayerColor(servoLayer, dimmedColor);
         
         // 如果当前层完成冷却
         if (progress >= 1.0f) {
@@ -402,25 +495,7 @@ void SerialController::executeCooldownMode() {
             }
             
             // 确保灯光完全变暗
-            // 针对灯带层数是舵机层数的2倍的情况
-            if (totalLightLayers >= totalServoLayers * 2) {
-                // 每层舵机对应两层灯带
-                uint8_t lightLayer1 = servoLayer * 2;
-                uint8_t lightLayer2 = servoLayer * 2 + 1;
-                
-                if (lightLayer1 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer1, 0);
-                }
-                
-                if (lightLayer2 < totalLightLayers) {
-                    lightBelt->setLayerColor(lightLayer2, 0);
-                }
-            } else {
-                // 灯带层数与舵机层数相同或更少的情况
-                if (servoLayer < totalLightLayers) {
-                    lightBelt->setLayerColor(servoLayer, 0);
-                }
-            }
+            setServoLayerColor(servoLayer, 0);
             
             // 移至下一层
             (*pCurrentLayer)++;
@@ -470,8 +545,171 @@ void SerialController::executeStandbyMode() {
     }
     
     // 蓝色呼吸灯效果（所有层相同颜色）
-    uint32_t blueColor = 0x0000FF; // 纯蓝色
-    lightBelt->breathing(blueColor, 3000); // 3秒周期的呼吸效果
+    lightBelt->breathing(Palettes::get(PALETTE_STANDBY), 3000); // 3秒周期的呼吸效果
+}
+
+/**
+ * @brief 执行Timeline模式
+ * @details 按上传的关键帧在本地插值回放舵机和灯带，没有关键帧的层保持不变
+ */
+void SerialController::executeTimelineMode() {
+    timeline.update(millis());
+    
+    // 获取舵机层数
+    uint8_t totalServoLayers = 0;
+    if (useInternalPWM) {
+        totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+    } else {
+        totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+    }
+    
+    for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+        int value;
+        if (!timeline.getServoValue(layer, value)) continue;
+        
+        if (useInternalPWM) {
+            ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, value);
+        } else {
+            ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, value);
+        }
+    }
+    
+    uint8_t totalLightLayers = lightBelt->getLayers();
+    for (uint8_t layer = 0; layer < totalLightLayers; layer++) {
+        uint32_t color;
+        if (timeline.getLightColor(layer, color)) {
+            lightBelt->setLayerColor(layer, color);
+        }
+    }
+}
+
+/**
+ * @brief 执行Show模式
+ * @details 舵机每帧更新，灯带只更新颜色发生变化的层；播放结束后保持最后一帧
+ */
+void SerialController::executeShowMode() {
+    if (!showPlayer.update(millis()) && showPlayer.getChangedLights() == 0) return;
+    
+    // 获取舵机层数
+    uint8_t totalServoLayers = 0;
+    if (useInternalPWM) {
+        totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+    } else {
+        totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+    }
+    
+    for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+        int value;
+        if (!showPlayer.getServoValue(layer, value)) continue;
+        
+        if (useInternalPWM) {
+            ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, value);
+        } else {
+            ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, value);
+        }
+    }
+    
+    uint32_t changed = showPlayer.getChangedLights();
+    uint8_t totalLightLayers = lightBelt->getLayers();
+    for (uint8_t layer = 0; layer < totalLightLayers && layer < 32; layer++) {
+        uint32_t color;
+        if ((changed & (1UL << layer)) && showPlayer.getLightColor(layer, color)) {
+            lightBelt->setLayerColor(layer, color);
+        }
+    }
+}
+
+/**
+ * @brief 执行Network模式
+ * @details 只在收到完整新帧时输出，没有新帧时保持当前画面
+ */
+void SerialController::executeNetworkMode() {
+    if (!pixelReceiver || !pixelReceiver->present()) return;
+    
+    // 获取舵机层数
+    uint8_t totalServoLayers = 0;
+    if (useInternalPWM) {
+        totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+    } else {
+        totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+    }
+    
+    for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+        int value;
+        if (!pixelReceiver->getServoValue(layer, value)) continue;
+        
+        if (useInternalPWM) {
+            ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, value);
+        } else {
+            ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, value);
+        }
+    }
+}
+
+/**
+ * @brief 执行Stream模式
+ * @details 像素帧在收到时已解码到灯带缓冲区，这里只标记输出，每次灯带输出一帧；没有新帧时保持当前画面
+ */
+void SerialController::executeStreamMode(bool ledDue) {
+    if (ledDue) {
+        pixelStream.present();
+    }
+}
+
+/**
+ * @brief 执行Layers模式
+ */
+void SerialController::executeLayersMode() {
+    uint8_t totalServoLayers = 0;
+    if (useInternalPWM) {
+        ((ServoPlatformInter*)servoPlatform)->sweepAllLayers(periodMs, 30.0);
+        totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+    } else {
+        ((ServoPlatform*)servoPlatform)->sweepAllLayers(periodMs, 30.0);
+        totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+    }
+    
+    // 每层取第一个舵机的输出，供Highlight层找出正在运动的层
+    uint16_t ticks[LAYER_MAP_MAX_SERVO_LAYERS];
+    totalServoLayers = min(totalServoLayers, (uint8_t)LAYER_MAP_MAX_SERVO_LAYERS);
+    for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+        if (useInternalPWM) {
+            ticks[layer] = ((ServoPlatformInter*)servoPlatform)->getServoTicks(layer * 2);
+        } else {
+            ticks[layer] = ((ServoPlatform*)servoPlatform)->getServoTicks(layer * 2);
+        }
+    }
+    compositor.trackServos(ticks, totalServoLayers);
+    
+    lightBelt->compose(compositor, layerMap);
+}
+
+/**
+ * @brief 执行Effect模式
+ */
+void SerialController::executeEffectMode() {
+    if (effectVM.hasServoProgram()) {
+        uint8_t totalServoLayers = 0;
+        if (useInternalPWM) {
+            totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+        } else {
+            totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+        }
+        
+        int32_t inputs[INPUT_COUNT] = {0};
+        inputs[INPUT_TIME] = ShowClock::now() & 0x7FFFFFFF;
+        inputs[INPUT_LAYERS] = totalServoLayers;
+        for (uint8_t layer = 0; layer < totalServoLayers; layer++) {
+            inputs[INPUT_LAYER] = layer;
+            if (useInternalPWM) {
+                ((ServoPlatformInter*)servoPlatform)->setLayerAngleFromValue(layer, effectVM.runServo(inputs));
+            } else {
+                ((ServoPlatform*)servoPlatform)->setLayerAngleFromValue(layer, effectVM.runServo(inputs));
+            }
+        }
+    }
+    
+    lightBelt->renderEffect(effectVM);
 }
 
 /**
@@ -491,6 +729,199 @@ void SerialController::processCommand() {
         return;
     }
     
+    // 输出并清空分阶段耗时统计
+    if (strcmp(token, "Stats") == 0) {
+        Profiler::report(Serial);
+        Profiler::reset();
+        followBuffer.report(Serial);
+        followBuffer.resetCounters();
+        outputLatch.report(Serial);
+        outputLatch.resetCounters();
+        governor.report(Serial);
+        governor.resetCounters();
+        scheduler.report(Serial);
+        scheduler.resetCounters();
+        latency.report(Serial);
+        latency.resetCounters();
+        pixelStream.report(Serial);
+        pixelStream.resetCounters();
+        if (pixelReceiver) {
+            pixelReceiver->report(Serial);
+        }
+        return;
+    }
+    
+    // 时间线命令：清空、上传关键帧、开始回放
+    if (strcmp(token, "TimelineClear") == 0) {
+        timeline.clear();
+        Serial.println("Timeline cleared");
+        return;
+    }
+    
+    if (strcmp(token, "TimelineKey") == 0) {
+        token = strtok(NULL, "");  // 取出剩余的全部关键帧参数
+        int added = token ? timeline.addKeyframes(token) : -1;
+        if (added < 0) {
+            Serial.println("Error: Invalid keyframe!");
+        }
+        Serial.print("Timeline keyframes: ");
+        Serial.println(timeline.getKeyframeCount());
+        return;
+    }
+    
+    if (strcmp(token, "TimelinePlay") == 0) {
+        token = strtok(NULL, "|");
+        bool loop = token && parseIntParam(token) != 0;
+        timeline.play(millis(), loop);
+        setPresetMode("Timeline");
+        return;
+    }
+    
+    // 播放SPIFFS中的演出文件：ShowPlay|/文件名.show|是否循环
+    if (strcmp(token, "ShowPlay") == 0) {
+        char* path = strtok(NULL, "|");
+        token = strtok(NULL, "|");
+        bool loop = token && parseIntParam(token) != 0;
+        if (path && showPlayer.open(path, millis(), loop)) {
+            setPresetMode("Show");
+        } else {
+            Serial.println("Error: Unable to play show!");
+        }
+        return;
+    }
+    
+    // 查询多机时钟同步状态
+    if (strcmp(token, "Clock") == 0) {
+        ShowClock::report(Serial);
+        return;
+    }
+    
+    // 切换时钟同步角色：ClockLeader|1为主机，0为从机
+    if (strcmp(token, "ClockLeader") == 0) {
+        token = strtok(NULL, "|");
+        if (token) {
+            ShowClock::setLeader(parseIntParam(token) != 0);
+        }
+        ShowClock::report(Serial);
+        return;
+    }
+    
+    // 由E1.31/Art-Net网络数据驱动
+    if (strcmp(token, "Network") == 0) {
+        if (pixelReceiver) {
+            setPresetMode("Network");
+        } else {
+            Serial.println("Error: Network receiver not enabled!");
+        }
+        return;
+    }
+    
+    // 调色板命令：PaletteClear|槽位|是否感知插值，PaletteStop|槽位|位置|颜色|...，PaletteUse|模式编号|槽位
+    if (strcmp(token, "PaletteClear") == 0) {
+        token = strtok(NULL, "|");
+        int slot = token ? parseIntParam(token) : -1;
+        token = strtok(NULL, "|");
+        bool perceptual = token && parseIntParam(token) != 0;
+        if (!Palettes::clear(slot, perceptual)) {
+            Serial.println("Error: Invalid palette!");
+            return;
+        }
+        Serial.print("Palette cleared: ");
+        Serial.println(slot);
+        return;
+    }
+    
+    if (strcmp(token, "PaletteStop") == 0) {
+        token = strtok(NULL, "|");
+        int slot = token ? parseIntParam(token) : -1;
+        token = strtok(NULL, "");  // 取出剩余的全部关键色
+        if (Palettes::addStops(slot, token) < 0) {
+            Serial.println("Error: Invalid palette!");
+            return;
+        }
+        Serial.print("Palette stops: ");
+        Serial.println(Palettes::slot(slot).getStopCount());
+        return;
+    }
+    
+    if (strcmp(token, "PaletteUse") == 0) {
+        token = strtok(NULL, "|");
+        int role = token ? parseIntParam(token) : -1;
+        token = strtok(NULL, "|");
+        int slot = token ? parseIntParam(token) : -1;
+        if (!Palettes::assign(role, slot)) {
+            Serial.println("Error: Invalid palette!");
+            return;
+        }
+        Serial.print("Palette for mode ");
+        Serial.print(role);
+        Serial.print(": ");
+        Serial.println(slot);
+        return;
+    }
+    
+    // 效果层命令：Layer|编号|效果|混合|不透明度|槽位|周期ms，LayersClear关闭全部效果层
+    if (strcmp(token, "Layer") == 0) {
+        token = strtok(NULL, "");  // 取出剩余的全部参数
+        int index = compositor.setLayer(token);
+        if (index < 0) {
+            Serial.println("Error: Invalid layer!");
+            return;
+        }
+        const EffectLayer& layer = compositor.getLayer(index);
+        Serial.print("Layer ");
+        Serial.print(index);
+        Serial.print(": ");
+        Serial.print(Compositor::effectName(layer.effect));
+        Serial.print(" ");
+        Serial.print(Compositor::blendName(layer.blend));
+        Serial.print(" ");
+        Serial.println(layer.opacity);
+        return;
+    }
+    
+    if (strcmp(token, "LayersClear") == 0) {
+        compositor.clear();
+        Serial.println("Layers cleared");
+        return;
+    }
+    
+    // 用户效果命令：EffectClear清空，EffectCode|十六进制分段上传，EffectRun校验后切换到Effect模式
+    if (strcmp(token, "EffectClear") == 0) {
+        effectVM.clear();
+        Serial.println("Effect cleared");
+        return;
+    }
+    
+    if (strcmp(token, "EffectCode") == 0) {
+        token = strtok(NULL, "|");
+        if (!effectVM.append(token)) {
+            Serial.println("Error: Invalid effect code!");
+            return;
+        }
+        Serial.print("Effect bytes: ");
+        Serial.println(effectVM.getSize());
+        return;
+    }
+    
+    if (strcmp(token, "EffectRun") == 0) {
+        uint8_t totalServoLayers = 0;
+        if (useInternalPWM) {
+            totalServoLayers = ((ServoPlatformInter*)servoPlatform)->getLayers();
+        } else {
+            totalServoLayers = ((ServoPlatform*)servoPlatform)->getLayers();
+        }
+        if (!effectVM.load(totalServoLayers, lightBelt->getLedCount())) {
+            Serial.print("Error: Invalid effect: ");
+            Serial.println(effectVM.getError());
+            return;
+        }
+        Serial.print("Effect instructions per frame: ");
+        Serial.println(effectVM.getFrameInstructions());
+        setPresetMode("Effect");
+        return;
+    }
+    
     // 舵机角度反转命令
     if (strcmp(token, "ReverseAngle") == 0) {
         token = strtok(NULL, "|");
@@ -503,6 +934,7 @@ void SerialController::processCommand() {
             }
             Serial.print("Servo angle reverse mode: ");
             Serial.println(reverse ? "ON" : "OFF");
+            BootState::setReverseAngle(reverse);
         }
         return;
     }
@@ -515,6 +947,7 @@ void SerialController::processCommand() {
             lightBelt->setMaxBrightness(brightness);
             Serial.print("LED max brightness set to: ");
             Serial.println(brightness);
+            BootState::setBrightness(lightBelt->getMaxBrightness());
         }
         return;
     }
@@ -522,7 +955,7 @@ void SerialController::processCommand() {
     // 预设模式
     if (strcmp(token, "Rainbow") == 0 || strcmp(token, "Idle") == 0 || 
         strcmp(token, "Heatup") == 0 || strcmp(token, "Cooldown") == 0 ||
-        strcmp(token, "Standby") == 0) {
+        strcmp(token, "Standby") == 0 || strcmp(token, "Layers") == 0) {
         setPresetMode(token);
         return;
     }
@@ -542,6 +975,65 @@ void SerialController::processCommand() {
         }
         
         setControlMode("Follow", newParams);
+        return;
+    }
+    
+    // 带时间戳的控制模式：FollowT|时间戳ms|参数1|...|参数6，经抖动缓冲区平滑后输出
+    if (strcmp(token, "FollowT") == 0) {
+        token = strtok(NULL, "|");
+        if (!token) {
+            Serial.println("Error: Missing timestamp!");
+            return;
+        }
+        uint32_t hostTime = strtoul(token, NULL, 10);
+        int newParams[6] = {0};
+        
+        for (int i = 0; i < 6; i++) {
+            token = strtok(NULL, "|");
+            if (token) {
+                newParams[i] = parseIntParam(token);
+            } else {
+                break;
+            }
+        }
+        
+        // 第一个带时间戳的样本切换到Follow模式，后续样本不再逐条确认以节省带宽
+        if (!modeEquals("Follow") || !followBuffer.isActive()) {
+            setControlMode("Follow", newParams);
+        }
+        if (followBuffer.push(hostTime, newParams, millis())) {
+            latency.deferUntil(followBuffer.getLastPlayAt());
+        }
+        return;
+    }
+    
+    // 订阅二进制遥测流：Telemetry|每秒帧数，0为停止
+    if (strcmp(token, "Telemetry") == 0) {
+        token = strtok(NULL, "|");
+        telemetry.setRate(token ? constrain(parseIntParam(token), 0, 100) : 0);
+        Serial.print("Telemetry rate: ");
+        Serial.println(telemetry.getRate());
+        return;
+    }
+    
+    // 延迟追踪回显：Trace|1开启，Trace|0关闭
+    if (strcmp(token, "Trace") == 0) {
+        token = strtok(NULL, "|");
+        latency.setEcho(token && parseIntParam(token) != 0 ? &Serial : NULL);
+        Serial.print("Latency trace echo: ");
+        Serial.println(latency.isEchoing() ? "ON" : "OFF");
+        return;
+    }
+    
+    // 设置抖动缓冲区延迟：FollowDelay|毫秒
+    if (strcmp(token, "FollowDelay") == 0) {
+        token = strtok(NULL, "|");
+        if (token) {
+            followBuffer.setDelay(constrain(parseIntParam(token), 0, 1000));
+            Serial.print("Follow delay set to: ");
+            Serial.println(followBuffer.getDelay());
+        }
+        return;
     }
 }
 
@@ -567,6 +1059,16 @@ void SerialController::setPresetMode(const char* modeName) {
         *pStartTime = 0;
     }
     
+    // 离开Show模式时关闭演出文件
+    if (strcmp(modeName, "Show") != 0) {
+        showPlayer.close();
+    }
+    
+    // 离开Stream模式后灯带缓冲区由其他模式改写，差分帧须等下一个关键帧
+    if (strcmp(modeName, "Stream") != 0 && modeEquals("Stream")) {
+        pixelStream.invalidate();
+    }
+    
     strcpy(currentMode, modeName);
     
     Serial.print("Setting preset mode: ");
@@ -576,12 +1078,19 @@ void SerialController::setPresetMode(const char* modeName) {
     char response[20] = "Mode=";
     strcat(response, modeName);
     Serial.println(response);
+    
+    BootState::setMode(modeName, NULL);
 }
 
 /**
  * @brief 设置控制模式
  */
 void SerialController::setControlMode(const char* modeName, int* parameters) {
+    showPlayer.close();
+    followBuffer.reset();
+    if (modeEquals("Stream")) {
+        pixelStream.invalidate();
+    }
     strcpy(currentMode, "Follow");
     
     // 更新参数
@@ -598,6 +1107,8 @@ void SerialController::setControlMode(const char* modeName, int* parameters) {
     
     // 发送确认
     Serial.println("Mode=Follow");
+    
+    BootState::setMode("Follow", params);
 }
 
 /**
@@ -605,13 +1116,12 @@ void SerialController::setControlMode(const char* modeName, int* parameters) {
  */
 void SerialController::sendStatus() {
     // 构建响应
-    char response[64] = {0};
-    strcpy(response, currentMode);
+    // 参数未经范围检查，按int最长11个字符预留空间
+    char response[sizeof(currentMode) + 6 * 12] = {0};
+    size_t length = snprintf(response, sizeof(response), "%s", currentMode);
     
-    for (int i = 0; i < 6; i++) {
-        char paramStr[8];
-        sprintf(paramStr, "|%d", params[i]);
-        strcat(response, paramStr);
+    for (int i = 0; i < 6 && length < sizeof(response); i++) {
+        length += snprintf(response + length, sizeof(response) - length, "|%d", params[i]);
     }
     
     Serial.println(response);
@@ -619,6 +1129,44 @@ void SerialController::sendStatus() {
     Serial.println(response);
 }
 
+/**
+ * @brief 采集当前状态并发送一帧遥测数据
+ * 
+ * @details 字段顺序：帧耗时us、累计帧数、Follow接收数、过期丢弃数、欠载数、演出跳帧数，
+ * 随后为每个舵机通道的脉冲计数值和每个灯带层实际输出的颜色
+ */
+void SerialController::sendTelemetry() {
+    telemetry.beginFrame();
+    
+    const Profiler::StageStats& frameStats = Profiler::getStats(PROFILE_FRAME);
+    telemetry.addField(Profiler::cyclesToMicros(frameStats.lastCycles));
+    telemetry.addField(frameStats.count);
+    telemetry.addField(followBuffer.getReceived());
+    telemetry.addField(followBuffer.getLateDrops());
+    telemetry.addField(followBuffer.getUnderruns());
+    telemetry.addField(showPlayer.getLateFrames());
+    
+    uint8_t channels;
+    if (useInternalPWM) {
+        channels = ((ServoPlatformInter*)servoPlatform)->getChannelCount();
+    } else {
+        channels = ((ServoPlatform*)servoPlatform)->getChannelCount();
+    }
+    for (uint8_t ch = 0; ch < channels; ch++) {
+        if (useInternalPWM) {
+            telemetry.addField(((ServoPlatformInter*)servoPlatform)->getServoTicks(ch));
+        } else {
+            telemetry.addField(((ServoPlatform*)servoPlatform)->getServoTicks(ch));
+        }
+    }
+    
+    for (uint8_t layer = 0; layer < lightBelt->getLayers(); layer++) {
+        telemetry.addField(lightBelt->getLayerColor(layer));
+    }
+    
+    telemetry.send(Serial);
+}
+
 /**
  * @brief 比较模式名称
  */
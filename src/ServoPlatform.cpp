@@ -1,5 +1,9 @@
 #include "ServoPlatform.h"
 #include "GlobalConfig.h"
+#include "Profiler.h"
+#include "ShowClock.h"
+
+static const uint8_t LED0_ON_L = 0x06;  // 通道0的第一个寄存器，每个通道4个寄存器
 
 ServoPlatform::ServoPlatform(uint8_t numLayers, uint8_t i2cAddress, uint8_t minAng, uint8_t maxAng)
     : layers(numLayers), minAngle(minAng), maxAngle(maxAng), i2cAddress(i2cAddress) {
@@ -8,6 +12,7 @@ ServoPlatform::ServoPlatform(uint8_t numLayers, uint8_t i2cAddress, uint8_t minA
     
     for(int i = 0; i < 16; i++) {
         currentAngles[i] = minAngle;
+        currentTicks[i] = 0;
     }
     
     sweepCompleted = false;
@@ -15,6 +20,8 @@ ServoPlatform::ServoPlatform(uint8_t numLayers, uint8_t i2cAddress, uint8_t minA
     
     // 从全局配置初始化角度反转状态
     reverseAngle = REVERSE_SERVO_ANGLE;
+    holding = false;
+    dirtyChannels = 0;
 }
 
 uint8_t ServoPlatform::scanI2CAddress() {
@@ -56,21 +63,31 @@ void ServoPlatform::begin() {
     Wire.setPins(21, 22);  // 初始化I2C，设置SDA和SCL引脚
     Wire.begin();  // 开始I2C通信
     
-    // 扫描并更新I2C地址
-    uint8_t scannedAddress = scanI2CAddress();
-    if (scannedAddress != 0) {
-        i2cAddress = scannedAddress;
-        Serial.print("Using scanned I2C address: 0x");
+    // 先探测已知地址，只有没有应答时才扫描全部126个地址
+    bool knownAddressFound = false;
+    if (i2cAddress != 0) {
+        Wire.beginTransmission(i2cAddress);
+        knownAddressFound = (Wire.endTransmission() == 0);
+    }
+    
+    if (knownAddressFound) {
+        Serial.print("Using known I2C address: 0x");
         Serial.println(i2cAddress, HEX);
-        pwm = Adafruit_PWMServoDriver(i2cAddress);
     } else {
-        Serial.println("Using default I2C address: 0x40");
-        pwm = Adafruit_PWMServoDriver(0x40);
+        uint8_t scannedAddress = scanI2CAddress();
+        if (scannedAddress != 0) {
+            i2cAddress = scannedAddress;
+            Serial.print("Using scanned I2C address: 0x");
+            Serial.println(i2cAddress, HEX);
+        } else {
+            i2cAddress = 0x40;
+            Serial.println("Using default I2C address: 0x40");
+        }
     }
+    pwm = Adafruit_PWMServoDriver(i2cAddress);
     
     pwm.begin();
-    pwm.setPWMFreq(50);  // 标准舵机PWM频率
-    delay(10);
+    pwm.setPWMFreq(SERVO_PWM_FREQ);  // 标准舵机PWM频率
     
     // 移除了自检程序调用
 }
@@ -81,8 +98,40 @@ uint16_t ServoPlatform::angleToMicros(uint8_t angle) {
 
 void ServoPlatform::setServoAngle(uint8_t servoNum, uint8_t angle) {
     if(servoNum >= layers * 2) return;
-    pwm.setPWM(servoNum, 0, angleToMicros(angle));
+    uint16_t ticks = angleToMicros(angle);
     currentAngles[servoNum] = angle;
+    if (holding) {
+        if (ticks != currentTicks[servoNum]) dirtyChannels |= 1 << servoNum;
+        currentTicks[servoNum] = ticks;
+        return;
+    }
+    PROFILE_SCOPE(PROFILE_SERVO_OUTPUT);
+    pwm.setPWM(servoNum, 0, ticks);
+    currentTicks[servoNum] = ticks;
+}
+
+bool ServoPlatform::commitFrame() {
+    holding = false;
+    if (dirtyChannels == 0) return false;
+    PROFILE_SCOPE(PROFILE_SERVO_OUTPUT);
+    
+    // 从第一个到最后一个改变的通道连续写入，中间未改变的通道写入原值
+    uint8_t first = 0;
+    while (!(dirtyChannels & (1 << first))) first++;
+    uint8_t last = 15;
+    while (!(dirtyChannels & (1 << last))) last--;
+    
+    Wire.beginTransmission(i2cAddress);
+    Wire.write(LED0_ON_L + 4 * first);
+    for (uint8_t ch = first; ch <= last; ch++) {
+        Wire.write((uint8_t)0);
+        Wire.write((uint8_t)0);
+        Wire.write(currentTicks[ch] & 0xFF);
+        Wire.write(currentTicks[ch] >> 8);
+    }
+    Wire.endTransmission();
+    dirtyChannels = 0;
+    return true;
 }
 
 void ServoPlatform::setLayerAngle(uint8_t layer, uint8_t angle) {
@@ -100,7 +149,7 @@ void ServoPlatform::setLayerAngle(uint8_t layer, uint8_t angle) {
 void ServoPlatform::sweepLayer(uint8_t layer, uint32_t periodMs) {
     if(layer >= layers) return;
     
-    uint32_t timeNow = millis();
+    uint32_t timeNow = ShowClock::now();
     float phase = (timeNow % periodMs) / (float)periodMs;
     float angle;
     
@@ -119,7 +168,7 @@ void ServoPlatform::sweepLayer(uint8_t layer, uint32_t periodMs) {
 
 void ServoPlatform::sweepAllLayers(uint32_t periodMs, float phaseDiff) {
     for(uint8_t layer = 0; layer < layers; layer++) {
-        uint32_t timeNow = millis();
+        uint32_t timeNow = ShowClock::now();
         float layerPhaseOffset = (phaseDiff * layer) / 360.0f;  // 将相位差转换为0-1范围
         float adjustedTime = fmod(timeNow + (layerPhaseOffset * periodMs), periodMs);
         
@@ -1,5 +1,7 @@
 #include "ServoPlatformInter.h"
 #include "GlobalConfig.h"
+#include "Profiler.h"
+#include "ShowClock.h"
 
 // 定义舵机引脚，避开GPIO5
 // 每层两个舵机，编号对应关系：
@@ -26,6 +28,7 @@ ServoPlatformInter::ServoPlatformInter(uint8_t numLayers, uint8_t minAng, uint8_
     for(int i = 0; i < 12; i++) {  // 初始化12个舵机
         currentAngles[i] = minAngle;
         servoPins[i] = SERVO_PINS[i];
+        currentDuty[i] = 0;
     }
     
     sweepCompleted = false;
@@ -33,18 +36,38 @@ ServoPlatformInter::ServoPlatformInter(uint8_t numLayers, uint8_t minAng, uint8_
     
     // 从全局配置初始化角度反转状态
     reverseAngle = REVERSE_SERVO_ANGLE;
+    holding = false;
+    dirtyChannels = 0;
 }
 
 void ServoPlatformInter::initPWM() {
     for(int i = 0; i < layers * 2; i++) {
-        ledcSetup(i, 50, 16);  // 通道i，50Hz，16位分辨率
+        ledcSetup(i, SERVO_PWM_FREQ, 16);  // 通道i，50Hz，16位分辨率
         ledcAttachPin(servoPins[i], i);
     }
 }
 
 void ServoPlatformInter::setServoPWM(uint8_t channel, uint16_t pulseWidth) {
-    uint32_t duty = (uint32_t)(pulseWidth * 65536 / 20000);  // 将脉冲宽度转换为占空比
+    uint32_t duty = (uint32_t)(pulseWidth * 65536 / SERVO_FRAME_US);  // 将脉冲宽度转换为占空比
+    if (holding && channel < 12) {
+        if (duty != currentDuty[channel]) dirtyChannels |= 1 << channel;
+        currentDuty[channel] = duty;
+        return;
+    }
+    PROFILE_SCOPE(PROFILE_SERVO_OUTPUT);
     ledcWrite(channel, duty);
+    if (channel < 12) currentDuty[channel] = duty;
+}
+
+bool ServoPlatformInter::commitFrame() {
+    holding = false;
+    if (dirtyChannels == 0) return false;
+    PROFILE_SCOPE(PROFILE_SERVO_OUTPUT);
+    for (uint8_t ch = 0; ch < 12; ch++) {
+        if (dirtyChannels & (1 << ch)) ledcWrite(ch, currentDuty[ch]);
+    }
+    dirtyChannels = 0;
+    return true;
 }
 
 uint16_t ServoPlatformInter::angleToPulseWidth(uint8_t angle) {
@@ -80,7 +103,7 @@ void ServoPlatformInter::begin() {
 void ServoPlatformInter::sweepLayer(uint8_t layer, uint32_t periodMs) {
     if(layer >= layers) return;
     
-    uint32_t timeNow = millis();
+    uint32_t timeNow = ShowClock::now();
     float phase = (timeNow % periodMs) / (float)periodMs;
     float angle;
     
@@ -95,7 +118,7 @@ void ServoPlatformInter::sweepLayer(uint8_t layer, uint32_t periodMs) {
 
 void ServoPlatformInter::sweepAllLayers(uint32_t periodMs, float phaseDiff) {
     for(uint8_t layer = 0; layer < layers; layer++) {
-        uint32_t timeNow = millis();
+        uint32_t timeNow = ShowClock::now();
         float layerPhaseOffset = (phaseDiff * layer) / 360.0f;
         float adjustedTime = fmod(timeNow + (layerPhaseOffset * periodMs), periodMs);
         
@@ -0,0 +1,112 @@
+/**
+ * @file ShowClock.cpp
+ * @brief 多机共享演出时钟实现
+ */
+
+#include "ShowClock.h"
+#include <esp_timer.h>
+
+bool ShowClock::leader = false;
+bool ShowClock::active = false;
+uint8_t ShowClock::sequence = 0;
+uint32_t ShowClock::lastSend = 0;
+int64_t ShowClock::lastShowUs = 0;
+ClockSync ShowClock::sync;
+portMUX_TYPE ShowClock::lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if USE_WIFI && USE_CLOCK_SYNC
+AsyncUDP ShowClock::udp;
+#endif
+
+bool ShowClock::begin(bool isLeader) {
+    leader = isLeader;
+#if USE_WIFI && USE_CLOCK_SYNC
+    active = udp.listen(CLOCK_SYNC_PORT);
+    if (active) {
+        // 在回调入口立即记录本地时钟，减小网络任务调度带来的误差
+        udp.onPacket([](AsyncUDPPacket& packet) {
+            int64_t localUs = esp_timer_get_time();
+            handlePacket(packet.data(), packet.length(), localUs);
+        });
+    }
+
+    Serial.print("Clock sync: ");
+    Serial.println(active ? (leader ? "leader" : "follower") : "failed");
+#endif
+    return active;
+}
+
+void ShowClock::setLeader(bool isLeader) {
+    portENTER_CRITICAL(&lock);
+    leader = isLeader;
+    sync.reset();
+    portEXIT_CRITICAL(&lock);
+}
+
+void ShowClock::update() {
+#if USE_WIFI && USE_CLOCK_SYNC
+    if (!active || !leader) return;
+
+    uint32_t now = millis();
+    if (now - lastSend < CLOCK_SYNC_INTERVAL_MS) return;
+    lastSend = now;
+
+    uint8_t packet[CLOCK_SYNC_PACKET_SIZE];
+    clockSyncWritePacket(packet, sequence++, esp_timer_get_time());
+    udp.broadcastTo(packet, sizeof(packet), CLOCK_SYNC_PORT);
+#endif
+}
+
+void ShowClock::handlePacket(const uint8_t* data, size_t length, int64_t localUs) {
+    uint8_t seq;
+    int64_t leaderUs;
+    if (!clockSyncParsePacket(data, length, seq, leaderUs)) return;
+
+    portENTER_CRITICAL(&lock);
+    // 主机也会收到自己的广播，忽略
+    if (!leader) {
+        sync.addSample(leaderUs, localUs);
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+int64_t ShowClock::nowMicros() {
+    int64_t localUs = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lock);
+    int64_t showUs = leader ? localUs : sync.toShow(localUs);
+    // 估计值更新时时钟可能小幅后退，保持不变直到追上，避免效果倒退；
+    // 切换到新的主机时直接跟随，否则可能长时间停住
+    if (showUs < lastShowUs && lastShowUs - showUs < 100000) {
+        showUs = lastShowUs;
+    }
+    lastShowUs = showUs;
+    portEXIT_CRITICAL(&lock);
+
+    return showUs;
+}
+
+void ShowClock::report(Print& out) {
+    int64_t localUs = esp_timer_get_time();
+
+    portENTER_CRITICAL(&lock);
+    uint8_t samples = sync.getSampleCount();
+    int64_t offsetUs = sync.getOffset(localUs);
+    int32_t skew = sync.getSkewPpb();
+    int32_t residual = sync.getLastResidual();
+    uint32_t rejected = sync.getRejected();
+    portEXIT_CRITICAL(&lock);
+
+    out.print("Clock|");
+    out.print(leader ? "Leader" : (active ? "Follower" : "Local"));
+    out.print("|");
+    out.print(samples);
+    out.print("|");
+    out.print((long long)offsetUs);
+    out.print("|");
+    out.print(skew);
+    out.print("|");
+    out.print(residual);
+    out.print("|");
+    out.println(rejected);
+}
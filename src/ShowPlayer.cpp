@@ -0,0 +1,162 @@
+/**
+ * @file ShowPlayer.cpp
+ * @brief SPIFFS演出文件流式播放器实现
+ */
+
+#include "ShowPlayer.h"
+#include <SPIFFS.h>
+
+// 每次update最多追赶的帧数，避免长时间阻塞主循环
+static const uint8_t MAX_CATCH_UP_FRAMES = 32;
+
+ShowPlayer::ShowPlayer() {
+    memset(&header, 0, sizeof(header));
+    memset(&frame, 0, sizeof(frame));
+    bufferStart = 0;
+    bufferEnd = 0;
+    startTime = 0;
+    frameIndex = 0;
+    changedLights = 0;
+    lateFrames = 0;
+    looping = false;
+    playing = false;
+    mounted = false;
+}
+
+bool ShowPlayer::open(const char* path, uint32_t now, bool loop) {
+    close();
+
+    // 首次使用时挂载SPIFFS，挂载失败不格式化，避免误删演出文件
+    if (!mounted) {
+        mounted = SPIFFS.begin(false);
+        if (!mounted) {
+            Serial.println("SPIFFS mount failed");
+            return false;
+        }
+    }
+
+    file = SPIFFS.open(path, "r");
+    if (!file) {
+        Serial.print("Show file not found: ");
+        Serial.println(path);
+        return false;
+    }
+
+    uint8_t raw[SHOW_HEADER_SIZE];
+    if (file.read(raw, SHOW_HEADER_SIZE) != SHOW_HEADER_SIZE || !showParseHeader(raw, header)) {
+        Serial.println("Invalid show file header");
+        file.close();
+        return false;
+    }
+
+    memset(&frame, 0, sizeof(frame));
+    bufferStart = 0;
+    bufferEnd = 0;
+    startTime = now;
+    frameIndex = 0;
+    changedLights = 0;
+    lateFrames = 0;
+    looping = loop;
+    playing = true;
+
+    Serial.print("Show opened: ");
+    Serial.print(header.frameCount);
+    Serial.print(" frames @ ");
+    Serial.print(header.frameIntervalMs);
+    Serial.println("ms");
+    return true;
+}
+
+void ShowPlayer::close() {
+    if (file) {
+        file.close();
+    }
+    playing = false;
+}
+
+bool ShowPlayer::fill(uint16_t needed) {
+    if (bufferEnd - bufferStart >= needed) return true;
+
+    // 把未处理的数据移到缓冲区开头，再尽量读满，减少flash读取次数
+    uint16_t remaining = bufferEnd - bufferStart;
+    memmove(buffer, buffer + bufferStart, remaining);
+    bufferStart = 0;
+    bufferEnd = remaining;
+
+    int readBytes = file.read(buffer + bufferEnd, READ_AHEAD_SIZE - bufferEnd);
+    if (readBytes > 0) {
+        bufferEnd += readBytes;
+    }
+    return bufferEnd - bufferStart >= needed;
+}
+
+bool ShowPlayer::decodeNextFrame(uint32_t& changed) {
+    if (!fill(SHOW_CHUNK_HEADER_SIZE)) return false;
+
+    uint8_t type = buffer[bufferStart];
+    uint16_t length = showRead16(buffer + bufferStart + 1);
+    if (length > SHOW_MAX_PAYLOAD) return false;
+    if (!fill(SHOW_CHUNK_HEADER_SIZE + length)) return false;
+
+    uint32_t frameChanged;
+    if (!showApplyChunk(type, buffer + bufferStart + SHOW_CHUNK_HEADER_SIZE, length,
+                        header, frame, frameChanged)) {
+        return false;
+    }
+    bufferStart += SHOW_CHUNK_HEADER_SIZE + length;
+
+    if (type == SHOW_CHUNK_END) {
+        return false;
+    }
+
+    changed |= frameChanged;
+    frameIndex++;
+    return true;
+}
+
+bool ShowPlayer::restart() {
+    // 第一帧总是关键帧，直接回到文件头之后即可
+    if (!file.seek(SHOW_HEADER_SIZE)) return false;
+    bufferStart = 0;
+    bufferEnd = 0;
+    startTime += frameIndex * header.frameIntervalMs;
+    frameIndex = 0;
+    return true;
+}
+
+bool ShowPlayer::update(uint32_t now) {
+    changedLights = 0;
+    if (!playing) return false;
+
+    uint8_t decoded = 0;
+    while (decoded < MAX_CATCH_UP_FRAMES) {
+        // 应当已经显示的帧数
+        uint32_t target = (now - startTime) / header.frameIntervalMs + 1;
+        if (frameIndex >= target) break;
+
+        if (!decodeNextFrame(changedLights)) {
+            // 到达结束块或文件损坏
+            if (looping && frameIndex > 0 && restart()) continue;
+            close();
+            break;
+        }
+        decoded++;
+    }
+
+    if (decoded > 1) {
+        lateFrames += decoded - 1;
+    }
+    return playing;
+}
+
+bool ShowPlayer::getServoValue(uint8_t layer, int& value) const {
+    if (frameIndex == 0 || layer >= header.servoLayers) return false;
+    value = frame.servo[layer];
+    return true;
+}
+
+bool ShowPlayer::getLightColor(uint8_t layer, uint32_t& color) const {
+    if (frameIndex == 0 || layer >= header.lightLayers) return false;
+    color = frame.light[layer];
+    return true;
+}
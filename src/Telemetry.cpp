@@ -0,0 +1,95 @@
+/**
+ * @file Telemetry.cpp
+ * @brief 紧凑二进制遥测流实现
+ */
+
+#include "Telemetry.h"
+
+Telemetry::Telemetry() {
+    fieldCount = 0;
+    previousCount = 0;
+    sequence = 0;
+    framesSinceKeyframe = 0;
+    rateHz = 0;
+    periodMs = 0;
+    nextDue = 0;
+}
+
+void Telemetry::setRate(uint16_t hz) {
+    rateHz = min(hz, (uint16_t)100);
+    periodMs = rateHz ? 1000 / rateHz : 0;
+    nextDue = millis();
+    // 重新订阅后先发送完整帧
+    previousCount = 0;
+}
+
+bool Telemetry::due(uint32_t now) {
+    if (rateHz == 0) return false;
+    if ((int32_t)(now - nextDue) < 0) return false;
+
+    nextDue += periodMs;
+    // 落后超过一个周期时不再补发
+    if ((int32_t)(now - nextDue) >= 0) {
+        nextDue = now + periodMs;
+    }
+    return true;
+}
+
+uint8_t Telemetry::crc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t Telemetry::send(Print& out) {
+    // 字段数变化或到达间隔时发送完整帧
+    bool keyframe = (fieldCount != previousCount) || (framesSinceKeyframe >= KEYFRAME_INTERVAL);
+    if (keyframe) {
+        memset(previous, 0, sizeof(previous));
+        framesSinceKeyframe = 0;
+    }
+
+    uint8_t packet[4 + 3 + MAX_FIELDS / 8 + MAX_FIELDS * 5 + 1];
+    uint8_t* body = packet + 4;
+    uint8_t maskBytes = (fieldCount + 7) / 8;
+
+    body[0] = keyframe ? TYPE_KEYFRAME : TYPE_DELTA;
+    body[1] = sequence++;
+    body[2] = fieldCount;
+    uint8_t* mask = body + 3;
+    memset(mask, 0, maskBytes);
+    uint8_t* p = mask + maskBytes;
+
+    for (uint8_t i = 0; i < fieldCount; i++) {
+        int32_t delta = (int32_t)(fields[i] - previous[i]);
+        if (delta == 0) continue;
+        mask[i / 8] |= 1 << (i % 8);
+
+        // ZigZag编码后按7位一组写出
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        while (zigzag >= 0x80) {
+            *p++ = (zigzag & 0x7F) | 0x80;
+            zigzag >>= 7;
+        }
+        *p++ = zigzag;
+    }
+
+    uint16_t bodyLength = p - body;
+    *p++ = crc8(body, bodyLength);
+
+    packet[0] = SYNC0;
+    packet[1] = SYNC1;
+    packet[2] = bodyLength & 0xFF;
+    packet[3] = bodyLength >> 8;
+
+    memcpy(previous, fields, sizeof(uint32_t) * fieldCount);
+    previousCount = fieldCount;
+    framesSinceKeyframe++;
+
+    return out.write(packet, p - packet);
+}
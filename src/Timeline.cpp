@@ -0,0 +1,220 @@
+/**
+ * @file Timeline.cpp
+ * @brief 关键帧时间线实现
+ */
+
+#include "Timeline.h"
+
+Timeline::Timeline() {
+    clear();
+}
+
+void Timeline::clear() {
+    keyframeCount = 0;
+    duration = 0;
+    startTime = 0;
+    position = 0;
+    looping = false;
+
+    for (uint8_t i = 0; i < MAX_SERVO_TRACKS; i++) {
+        servoTracks[i].head = servoTracks[i].tail = servoTracks[i].cursor = NONE;
+    }
+    for (uint8_t i = 0; i < MAX_LIGHT_TRACKS; i++) {
+        lightTracks[i].head = lightTracks[i].tail = lightTracks[i].cursor = NONE;
+    }
+}
+
+bool Timeline::addKeyframe(TrackType type, uint8_t layer, uint32_t timeMs, uint32_t value) {
+    if (keyframeCount >= MAX_KEYFRAMES) return false;
+
+    Track* track;
+    if (type == TRACK_SERVO) {
+        if (layer >= MAX_SERVO_TRACKS) return false;
+        track = &servoTracks[layer];
+        value = constrain(value, 0u, 1023u);
+    } else {
+        if (layer >= MAX_LIGHT_TRACKS) return false;
+        track = &lightTracks[layer];
+        value &= 0xFFFFFF;
+    }
+
+    // 同一轨道内时间必须不递减，保证回放时游标只需向前移动
+    if (track->tail != NONE && timeMs < keyframes[track->tail].timeMs) return false;
+
+    uint16_t index = keyframeCount++;
+    keyframes[index].timeMs = timeMs;
+    keyframes[index].value = value;
+    keyframes[index].next = NONE;
+
+    if (track->tail == NONE) {
+        track->head = index;
+        track->cursor = index;
+    } else {
+        keyframes[track->tail].next = index;
+    }
+    track->tail = index;
+
+    if (timeMs > duration) duration = timeMs;
+    return true;
+}
+
+int Timeline::addKeyframes(const char* args) {
+    // 出错时恢复到解析前的状态，一行关键帧要么全部添加，要么都不添加
+    Track savedServo[MAX_SERVO_TRACKS];
+    Track savedLight[MAX_LIGHT_TRACKS];
+    memcpy(savedServo, servoTracks, sizeof(servoTracks));
+    memcpy(savedLight, lightTracks, sizeof(lightTracks));
+    uint16_t savedCount = keyframeCount;
+    uint32_t savedDuration = duration;
+
+    int added = parseKeyframes(args);
+    if (added < 0) {
+        memcpy(servoTracks, savedServo, sizeof(servoTracks));
+        memcpy(lightTracks, savedLight, sizeof(lightTracks));
+        keyframeCount = savedCount;
+        duration = savedDuration;
+
+        // 原来的轨道末尾可能已链接到新关键帧
+        for (uint8_t i = 0; i < MAX_SERVO_TRACKS; i++) {
+            if (servoTracks[i].tail != NONE) keyframes[servoTracks[i].tail].next = NONE;
+        }
+        for (uint8_t i = 0; i < MAX_LIGHT_TRACKS; i++) {
+            if (lightTracks[i].tail != NONE) keyframes[lightTracks[i].tail].next = NONE;
+        }
+    }
+    return added;
+}
+
+int Timeline::parseKeyframes(const char* args) {
+    int added = 0;
+    const char* p = args;
+
+    while (p && *p) {
+        // 轨道类型：S为舵机层，L为灯带层
+        TrackType type;
+        if (*p == 'S' || *p == 's') {
+            type = TRACK_SERVO;
+        } else if (*p == 'L' || *p == 'l') {
+            type = TRACK_LIGHT;
+        } else {
+            return -1;
+        }
+        p++;
+
+        // 依次解析层号、时间和值，字段之间以'|'分隔
+        uint32_t fields[3];
+        for (uint8_t i = 0; i < 3; i++) {
+            if (*p != '|') return -1;
+            char* end;
+            fields[i] = strtoul(p + 1, &end, 0);
+            if (end == p + 1) return -1;
+            p = end;
+        }
+
+        // 层号在转换为uint8_t之前检查，避免256等大数回绕成有效的层
+        if (fields[0] >= (type == TRACK_SERVO ? MAX_SERVO_TRACKS : MAX_LIGHT_TRACKS)) return -1;
+        if (!addKeyframe(type, fields[0], fields[1], fields[2])) return -1;
+        added++;
+
+        // 跳过组之间的分隔符
+        if (*p == '|') p++;
+        else if (*p != '\0') return -1;
+    }
+
+    return added;
+}
+
+void Timeline::play(uint32_t now, bool loop) {
+    startTime = now;
+    looping = loop;
+    position = 0;
+    rewind();
+}
+
+void Timeline::rewind() {
+    for (uint8_t i = 0; i < MAX_SERVO_TRACKS; i++) {
+        servoTracks[i].cursor = servoTracks[i].head;
+    }
+    for (uint8_t i = 0; i < MAX_LIGHT_TRACKS; i++) {
+        lightTracks[i].cursor = lightTracks[i].head;
+    }
+}
+
+void Timeline::advanceTrack(Track& track) {
+    if (track.cursor == NONE) return;
+    while (keyframes[track.cursor].next != NONE &&
+           keyframes[keyframes[track.cursor].next].timeMs <= position) {
+        track.cursor = keyframes[track.cursor].next;
+    }
+}
+
+bool Timeline::update(uint32_t now) {
+    uint32_t elapsed = now - startTime;
+    bool running = true;
+    uint32_t newPosition;
+
+    if (looping && duration > 0) {
+        newPosition = elapsed % duration;
+    } else if (elapsed >= duration) {
+        newPosition = duration;
+        running = false;
+    } else {
+        newPosition = elapsed;
+    }
+
+    // 循环回到起点时游标需要复位
+    if (newPosition < position) {
+        rewind();
+    }
+    position = newPosition;
+
+    for (uint8_t i = 0; i < MAX_SERVO_TRACKS; i++) {
+        advanceTrack(servoTracks[i]);
+    }
+    for (uint8_t i = 0; i < MAX_LIGHT_TRACKS; i++) {
+        advanceTrack(lightTracks[i]);
+    }
+
+    return running;
+}
+
+uint32_t Timeline::interpolate(const Track& track, bool isColor) const {
+    const Keyframe& from = keyframes[track.cursor];
+
+    // 第一个关键帧之前或最后一个关键帧之后保持端点值
+    if (position <= from.timeMs || from.next == NONE) {
+        return from.value;
+    }
+
+    const Keyframe& to = keyframes[from.next];
+    uint32_t span = to.timeMs - from.timeMs;
+    if (span == 0) return to.value;
+    uint32_t offset = position - from.timeMs;
+
+    if (!isColor) {
+        int64_t delta = (int64_t)to.value - (int64_t)from.value;
+        return from.value + delta * offset / span;
+    }
+
+    // 颜色按RGB三个通道分别线性插值
+    uint32_t result = 0;
+    for (uint8_t shift = 0; shift <= 16; shift += 8) {
+        int32_t a = (from.value >> shift) & 0xFF;
+        int32_t b = (to.value >> shift) & 0xFF;
+        uint32_t channel = a + (int64_t)(b - a) * offset / span;
+        result |= channel << shift;
+    }
+    return result;
+}
+
+bool Timeline::getServoValue(uint8_t layer, int& value) const {
+    if (layer >= MAX_SERVO_TRACKS || servoTracks[layer].cursor == NONE) return false;
+    value = interpolate(servoTracks[layer], false);
+    return true;
+}
+
+bool Timeline::getLightColor(uint8_t layer, uint32_t& color) const {
+    if (layer >= MAX_LIGHT_TRACKS || lightTracks[layer].cursor == NONE) return false;
+    color = interpolate(lightTracks[layer], true);
+    return true;
+}
@@ -4,15 +4,28 @@
 #include <ServoPlatform.h>
 #include <BluetoothController.h>
 #include <SerialController.h>
+#include <BootState.h>
 #include "GlobalConfig.h"
 
+#if USE_WIFI
+#include <WiFi.h>
+#include <PixelReceiver.h>
+#include <ShowClock.h>
+#endif
+
 #define LED_PIN 5   // LED灯带数据引脚
 #define SERVO_LAYER_COUNT 6 // 舵机层数
 #define LED_LAYER_COUNT 12 // 每层舵机数量
 #define LEDS_PER_LAYER 33 // 每层LED数量
 #define CYCLE_TIME 5000  // 5秒周期
 
-LightBelt belt(LED_PIN, LED_LAYER_COUNT, LEDS_PER_LAYER);
+StaticLightBelt<LED_LAYER_COUNT, LEDS_PER_LAYER> belt(LED_PIN);
+
+// 灯带分段：每段的数据引脚和层数，层数之和为LED_LAYER_COUNT。
+// 多段时各引脚同时输出，例如{{5, 6}, {18, 6}}把上下6层分别接到GPIO5和GPIO18，传输时间减半
+static const LedSegment LED_SEGMENTS[] = {
+    {LED_PIN, LED_LAYER_COUNT},
+};
 
 // 根据配置选择不同的舵机平台
 #if USE_INTERNAL_PWM
@@ -28,23 +41,50 @@ BluetoothController controller(&belt, &platform, CYCLE_TIME);
 SerialController controller(&belt, &platform, CYCLE_TIME);
 #endif
 
+#if USE_WIFI
+PixelReceiver receiver(&belt, SERVO_LAYER_COUNT);
+#endif
+
 void setup() {
+    // 接收缓冲区须在begin()之前设置，灯带输出期间到达的像素流数据暂存在这里
+    Serial.setRxBufferSize(SERIAL_RX_BUFFER);
     Serial.begin(115200);
-    delay(1000);
     
     Serial.println("Starting initialization...");
     
+    // 读取上次保存的I2C地址、亮度、反转设置和模式
+    BootState::begin();
+    const BootSettings& boot = BootState::get();
+    
+    // 生成各模式的内置调色板
+    Palettes::begin();
+    
     // 初始化LED灯带
+    if (!belt.setSegments(LED_SEGMENTS, sizeof(LED_SEGMENTS) / sizeof(LED_SEGMENTS[0]))) {
+        Serial.println("Error: Invalid LED segments, using single pin");
+    }
     belt.begin();
+    if (boot.brightness != belt.getMaxBrightness()) {
+        belt.setMaxBrightness(boot.brightness);
+    }
     Serial.print("LED max brightness set to: ");
-    Serial.println(MAX_LED_BRIGHTNESS);
+    Serial.println(belt.getMaxBrightness());
     
     // 设置舵机角度反转状态
-    platform.setReverseAngle(REVERSE_SERVO_ANGLE);
+    platform.setReverseAngle(boot.reverseAngle);
     Serial.print("Servo angle reverse mode: ");
-    Serial.println(REVERSE_SERVO_ANGLE ? "ON" : "OFF");
+    Serial.println(boot.reverseAngle ? "ON" : "OFF");
     
+    // 优先探测上次找到的PCA9685地址，避免每次启动扫描整条I2C总线
+    #if !USE_INTERNAL_PWM
+    if (boot.i2cAddress != 0) {
+        platform.setI2CAddress(boot.i2cAddress);
+    }
     platform.begin();
+    BootState::setI2CAddress(platform.getI2CAddress());
+    #else
+    platform.begin();
+    #endif
     
     // 初始化控制器
     #if USE_BLUETOOTH
@@ -55,10 +95,29 @@ void setup() {
     Serial.println("Using Serial control mode");
     #endif
     
+    // 连接Wi-Fi并开始接收E1.31/Art-Net数据，连接在后台进行
+    #if USE_WIFI
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    receiver.begin();
+    controller.setPixelReceiver(&receiver);
+    Serial.println("Network pixel receiver enabled");
+    
+    // 多机时钟同步，效果相位以主机的演出时钟为准
+    #if USE_CLOCK_SYNC
+    ShowClock::begin(CLOCK_SYNC_LEADER);
+    #endif
+    #endif
+    
     Serial.println("Initialization completed!");
 }
 
 void loop() {
+    #if USE_WIFI && USE_CLOCK_SYNC
+    ShowClock::update();  // 主机广播演出时钟
+    #endif
     controller.update();  // 处理命令并执行相应操作
-    delay(10);  // 小延时防止过度刷新
+    BootState::update();  // 设置静默一段时间后写入NVS
+    controller.waitForNextFrame();  // 等到舵机或灯带下一次到期，收到命令立即返回
 }
\ No newline at end of file
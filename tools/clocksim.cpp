@@ -0,0 +1,156 @@
+/**
+ * @file clocksim.cpp
+ * @brief 多机时钟同步模拟（上位机）
+ *
+ * @details 编译：g++ -std=c++11 -O2 -Iinclude tools/clocksim.cpp -o clocksim
+ *
+ * 用法：
+ *   clocksim [设备数] [秒数] [随机种子] [误差上限us]
+ *
+ * 在一台电脑上模拟一台主机和若干台从机：每台设备的晶振有±50ppm漂移和任意的开机时间，
+ * 主机按CLOCK_SYNC_INTERVAL_MS广播同步包（使用固件相同的编解码和ClockSync估计器），
+ * 网络延迟为固定延迟加指数分布抖动，并混入丢包和几十毫秒的延迟尖峰。
+ * 每100ms比较各从机的演出时钟与主机时钟，输出收敛时间和收敛后的误差；
+ * 收敛后误差超过上限时返回1，可以用于回归检查。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "ClockSync.h"
+
+#ifndef CLOCK_SYNC_INTERVAL_MS
+#define CLOCK_SYNC_INTERVAL_MS 1000
+#endif
+
+static uint64_t rngState = 1;
+
+static double randomUnit() {
+    // xorshift64*，保证不同平台结果一致
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return ((rngState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct Node {
+    double driftPpm;        ///< 晶振漂移
+    int64_t bootOffsetUs;   ///< 本地时钟起点
+    ClockSync sync;
+    int64_t pendingRxUs;    ///< 下一个同步包到达的真实时间，-1表示没有
+    uint8_t pendingPacket[CLOCK_SYNC_PACKET_SIZE];
+
+    double convergedAt;
+    double maxError;
+    double sumSquares;
+    uint32_t samples;
+
+    int64_t localAt(int64_t trueUs) const {
+        return bootOffsetUs + trueUs + (int64_t)(trueUs * driftPpm * 1e-6);
+    }
+};
+
+static int64_t networkDelayUs() {
+    // 固定延迟300us + 平均200us的指数抖动，5%的包额外延迟5-50ms
+    double delay = 300 - 200 * log(1.0 - randomUnit());
+    if (randomUnit() < 0.05) {
+        delay += 5000 + 45000 * randomUnit();
+    }
+    return (int64_t)delay;
+}
+
+int main(int argc, char** argv) {
+    int nodeCount = argc >= 2 ? atoi(argv[1]) : 6;
+    int seconds = argc >= 3 ? atoi(argv[2]) : 600;
+    rngState = argc >= 4 ? strtoull(argv[3], NULL, 10) | 1 : 1;
+    double limitUs = argc >= 5 ? atof(argv[4]) : 2000;
+
+    if (nodeCount < 2 || seconds < 1) {
+        fprintf(stderr, "usage: clocksim [nodes>=2] [seconds] [seed] [limit-us]\n");
+        return 2;
+    }
+
+    std::vector<Node> nodes(nodeCount);
+    for (int i = 0; i < nodeCount; i++) {
+        nodes[i].driftPpm = -50 + 100 * randomUnit();
+        nodes[i].bootOffsetUs = (int64_t)(60e6 * randomUnit());
+        nodes[i].pendingRxUs = -1;
+        nodes[i].convergedAt = -1;
+        nodes[i].maxError = 0;
+        nodes[i].sumSquares = 0;
+        nodes[i].samples = 0;
+    }
+
+    // 节点0为主机，按自己的本地时钟间隔广播
+    const int64_t stepUs = 100;
+    const int64_t endUs = (int64_t)seconds * 1000000;
+    const double warmupS = 10;
+    int64_t nextSendLocal = nodes[0].localAt(0);
+    uint8_t sequence = 0;
+    uint32_t sent = 0, lost = 0;
+
+    for (int64_t t = 0; t <= endUs; t += stepUs) {
+        int64_t leaderLocal = nodes[0].localAt(t);
+
+        if (leaderLocal >= nextSendLocal) {
+            nextSendLocal += CLOCK_SYNC_INTERVAL_MS * 1000;
+            uint8_t packet[CLOCK_SYNC_PACKET_SIZE];
+            clockSyncWritePacket(packet, sequence++, leaderLocal);
+            sent++;
+            for (int i = 1; i < nodeCount; i++) {
+                if (randomUnit() < 0.02) {
+                    lost++;
+                    continue;
+                }
+                nodes[i].pendingRxUs = t + networkDelayUs();
+                memcpy(nodes[i].pendingPacket, packet, sizeof(packet));
+            }
+        }
+
+        for (int i = 1; i < nodeCount; i++) {
+            Node& node = nodes[i];
+            if (node.pendingRxUs >= 0 && t >= node.pendingRxUs) {
+                uint8_t seq;
+                int64_t leaderUs;
+                if (clockSyncParsePacket(node.pendingPacket, CLOCK_SYNC_PACKET_SIZE, seq, leaderUs)) {
+                    node.sync.addSample(leaderUs, node.localAt(t));
+                }
+                node.pendingRxUs = -1;
+            }
+
+            if (t % 100000 != 0 || !node.sync.isSynced()) continue;
+
+            double error = (double)(node.sync.toShow(node.localAt(t)) - leaderLocal);
+            double seconds = t / 1e6;
+            if (node.convergedAt < 0) {
+                if (fabs(error) < 1000) node.convergedAt = seconds;
+                continue;
+            }
+            if (seconds < node.convergedAt + warmupS) continue;
+
+            if (fabs(error) > node.maxError) node.maxError = fabs(error);
+            node.sumSquares += error * error;
+            node.samples++;
+        }
+    }
+
+    printf("packets sent %u, lost %u\n", sent, lost);
+    printf("node  drift(ppm)  skew(ppm)  est(ppm)  converged(s)  max|err|(us)  rms(us)  rejected\n");
+    printf("%4d  %10.2f  %9s  %8s  %12s  %12s  %7s  %8s\n", 0, nodes[0].driftPpm, "leader", "-", "-", "-", "-", "-");
+
+    bool ok = true;
+    for (int i = 1; i < nodeCount; i++) {
+        const Node& node = nodes[i];
+        // 从机相对主机的实际漂移率与估计值
+        double relative = ((1 + nodes[0].driftPpm * 1e-6) / (1 + node.driftPpm * 1e-6) - 1) * 1e6;
+        double rms = node.samples ? sqrt(node.sumSquares / node.samples) : 0;
+        printf("%4d  %10.2f  %9.2f  %8.2f  %12.1f  %12.0f  %7.0f  %8u\n",
+               i, node.driftPpm, relative, node.sync.getSkewPpb() / 1000.0,
+               node.convergedAt, node.maxError, rms, node.sync.getRejected());
+        if (node.convergedAt < 0 || node.maxError > limitUs) ok = false;
+    }
+
+    printf("%s (limit %.0f us)\n", ok ? "PASS" : "FAIL", limitUs);
+    return ok ? 0 : 1;
+}
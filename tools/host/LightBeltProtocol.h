@@ -0,0 +1,486 @@
+#ifndef LIGHT_BELT_PROTOCOL_H
+#define LIGHT_BELT_PROTOCOL_H
+
+/**
+ * @file LightBeltProtocol.h
+ * @brief 上位机控制库（仅头文件）：设备命令和像素帧的编码，文本回复和二进制遥测帧的解码
+ *
+ * @details 不依赖固件源码和具体的传输方式，串口、蓝牙SPP或伪终端读到的字节交给StreamDecoder，
+ * 发送的字符串由各编码函数生成（已含换行）。
+ *
+ *     lightbelt::StreamDecoder decoder;
+ *     write(fd, lightbelt::tagged(7, lightbelt::follow(values)));
+ *     decoder.feed(buffer, n);
+ *     lightbelt::StreamEvent event;
+ *     while (decoder.next(event)) {
+ *         lightbelt::TraceAck ack;
+ *         if (event.kind == lightbelt::StreamEvent::LINE &&
+ *             lightbelt::parseTrace(lightbelt::parseReply(event.line), ack)) { ... }
+ *     }
+ *
+ * 命令格式为"名称|参数|..."，串口命令最长63个字符，蓝牙命令中至少要有一个'|'。
+ * 命令前的"@编号 "前缀由设备去掉，开启Trace|1后设备以Trace|编号|解析us|效果us|舵机us|灯带us确认。
+ * 遥测帧格式见include/Telemetry.h，像素帧格式见include/PixelStream.h。
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace lightbelt {
+
+static const int FOLLOW_CHANNELS = 6;           ///< Follow命令的参数个数
+static const int FOLLOW_MAX = 1023;             ///< Follow参数上限
+static const size_t SERIAL_MAX_COMMAND = 63;    ///< 串口命令缓冲区能容纳的最长命令（不含换行）
+
+/**
+ * @brief CRC8（多项式0x07，初值0），遥测帧和压缩像素帧使用
+ */
+inline uint8_t crc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------------------------
+// 命令编码
+
+/**
+ * @brief 编码一条命令："名称|参数1|参数2|...\n"
+ * @param bluetooth 蓝牙控制时没有参数的命令也要带'|'
+ */
+inline std::string command(const std::string& name, const std::vector<long>& params = std::vector<long>(),
+                           bool bluetooth = false) {
+    std::string line = name;
+    for (size_t i = 0; i < params.size(); i++) {
+        line += "|" + std::to_string(params[i]);
+    }
+    if (bluetooth && params.empty()) line += "|";
+    return line + "\n";
+}
+
+/**
+ * @brief 预设模式：Rainbow、Idle、Heatup、Cooldown、Standby、Layers
+ */
+inline std::string mode(const std::string& name, bool bluetooth = false) {
+    return command(name, std::vector<long>(), bluetooth);
+}
+
+/**
+ * @brief Follow|p1|...|p6，参数限制在0-1023，第一个参数对应最高层
+ */
+inline std::string follow(const int values[FOLLOW_CHANNELS]) {
+    std::vector<long> params;
+    for (int i = 0; i < FOLLOW_CHANNELS; i++) {
+        params.push_back(values[i] < 0 ? 0 : (values[i] > FOLLOW_MAX ? FOLLOW_MAX : values[i]));
+    }
+    return command("Follow", params);
+}
+
+/**
+ * @brief FollowT|时间戳ms|p1|...|p6，经设备的抖动缓冲区延迟回放
+ */
+inline std::string followTimed(uint32_t hostMs, const int values[FOLLOW_CHANNELS]) {
+    std::vector<long> params(1, (long)hostMs);
+    for (int i = 0; i < FOLLOW_CHANNELS; i++) {
+        params.push_back(values[i] < 0 ? 0 : (values[i] > FOLLOW_MAX ? FOLLOW_MAX : values[i]));
+    }
+    return command("FollowT", params);
+}
+
+/**
+ * @brief 开关延迟追踪回显
+ */
+inline std::string trace(bool echo) {
+    return command("Trace", std::vector<long>(1, echo ? 1 : 0));
+}
+
+/**
+ * @brief 给命令加"@编号 "前缀，设备在Trace回显中带回编号
+ * @param line 编码好的命令（含换行）
+ */
+inline std::string tagged(uint32_t id, const std::string& line) {
+    return "@" + std::to_string(id) + " " + line;
+}
+
+/**
+ * @brief 命令是否能放进设备的串口命令缓冲区，过长的命令整行被丢弃
+ */
+inline bool fitsSerial(const std::string& line) {
+    size_t length = line.size();
+    if (length > 0 && line[length - 1] == '\n') length--;
+    return length <= SERIAL_MAX_COMMAND;
+}
+
+// ---------------------------------------------------------------------------
+// 文本回复解码
+
+/**
+ * @brief 按'|'拆分的一行回复，如Stats|Frame|100|...、Trace|7|...、Lookup的Follow|512|...
+ */
+struct Reply {
+    std::string name;
+    std::vector<std::string> fields;
+
+    /**
+     * @brief 第i个字段的整数值，不存在时返回fallback
+     */
+    long number(size_t i, long fallback = 0) const {
+        if (i >= fields.size() || fields[i].empty()) return fallback;
+        char* end;
+        long value = strtol(fields[i].c_str(), &end, 10);
+        return *end == '\0' ? value : fallback;
+    }
+};
+
+inline Reply parseReply(const std::string& line) {
+    Reply reply;
+    size_t start = 0;
+    bool first = true;
+    while (true) {
+        size_t bar = line.find('|', start);
+        std::string part = line.substr(start, bar == std::string::npos ? std::string::npos : bar - start);
+        if (first) {
+            reply.name = part;
+            first = false;
+        } else {
+            reply.fields.push_back(part);
+        }
+        if (bar == std::string::npos) break;
+        start = bar + 1;
+    }
+    return reply;
+}
+
+/**
+ * @brief 延迟追踪回显，时间均从命令到达算起（微秒）
+ */
+struct TraceAck {
+    uint32_t id;
+    uint32_t parseMicros;
+    uint32_t effectMicros;
+    uint32_t servoMicros;
+    uint32_t ledMicros;
+};
+
+inline bool parseTrace(const Reply& reply, TraceAck& ack) {
+    if (reply.name != "Trace" || reply.fields.size() != 5) return false;
+    for (size_t i = 0; i < 5; i++) {
+        if (reply.number(i, -1) < 0) return false;
+    }
+    ack.id = reply.number(0);
+    ack.parseMicros = reply.number(1);
+    ack.effectMicros = reply.number(2);
+    ack.servoMicros = reply.number(3);
+    ack.ledMicros = reply.number(4);
+    return true;
+}
+
+/**
+ * @brief Lookup的回复：模式|p1|...|p6
+ */
+struct Status {
+    std::string mode;
+    int params[FOLLOW_CHANNELS];
+};
+
+inline bool parseStatus(const Reply& reply, Status& status) {
+    if (reply.name.empty() || reply.fields.size() != FOLLOW_CHANNELS) return false;
+    for (int i = 0; i < FOLLOW_CHANNELS; i++) {
+        if (reply.number(i, -1) < 0) return false;
+        status.params[i] = reply.number(i);
+    }
+    status.mode = reply.name;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// 像素流（只支持串口）
+
+/**
+ * @brief 编码一帧Adalight数据："Ada" | LED数-1（高字节在前） | 校验 | RGB...
+ * @param rgb 每个LED 3字节RGB
+ * @param count LED数（1-65536）
+ */
+inline std::string adalight(const uint8_t* rgb, uint32_t count) {
+    uint8_t hi = (count - 1) >> 8;
+    uint8_t lo = (count - 1) & 0xFF;
+    std::string out = "Ada";
+    out += (char)hi;
+    out += (char)lo;
+    out += (char)(hi ^ lo ^ 0x55);
+    out.append((const char*)rgb, count * 3);
+    return out;
+}
+
+/**
+ * @brief 压缩像素帧编码器
+ * @details 与上一帧相同的LED跳过，连续相同的颜色写成一段，其余逐个写出。
+ * 第一帧、每keyframeInterval帧和差分帧不比关键帧小时发送关键帧（相对全黑），
+ * 设备丢帧后最迟在下一个关键帧恢复。
+ */
+class PixelEncoder {
+public:
+    static const uint8_t TYPE_KEYFRAME = 0;
+    static const uint8_t TYPE_DELTA = 1;
+
+    explicit PixelEncoder(uint16_t ledCount, uint16_t keyframeInterval = 30)
+        : count(ledCount), interval(keyframeInterval ? keyframeInterval : 1), sinceKeyframe(0), sequence(0),
+          keyframe(false), hasPrevious(false) {}
+
+    /**
+     * @brief 编码一帧
+     * @param rgb ledCount个LED的RGB
+     * @return 可直接写入串口的完整帧
+     */
+    std::string encode(const uint8_t* rgb) {
+        std::vector<uint8_t> black(count * 3, 0);
+        std::string payload;
+        appendOps(payload, rgb, &black[0]);
+        keyframe = true;
+        if (hasPrevious && sinceKeyframe + 1 < interval) {
+            std::string delta;
+            appendOps(delta, rgb, &previous[0]);
+            if (delta.size() < payload.size()) {
+                payload.swap(delta);
+                keyframe = false;
+            }
+        }
+        sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+        previous.assign(rgb, rgb + count * 3);
+        hasPrevious = true;
+
+        uint8_t header[5] = {keyframe ? TYPE_KEYFRAME : TYPE_DELTA, sequence++, (uint8_t)(payload.size() >> 8),
+                             (uint8_t)(payload.size() & 0xFF), 0x55};
+        for (int i = 0; i < 4; i++) header[4] ^= header[i];
+        std::string out = "Adz";
+        out.append((const char*)header, sizeof(header));
+        out += payload;
+        out += (char)crc8((const uint8_t*)payload.data(), payload.size());
+        return out;
+    }
+
+    /**
+     * @brief 下一帧发送关键帧，例如设备报告了未同步丢弃之后
+     */
+    void forceKeyframe() { hasPrevious = false; }
+
+    bool lastWasKeyframe() const { return keyframe; }
+
+private:
+    static const uint8_t OP_SKIP = 0x00;
+    static const uint8_t OP_RUN = 0x40;
+    static const uint8_t OP_LITERAL = 0x80;
+    static const uint16_t MAX_OP = 64;
+
+    static bool same(const uint8_t* a, const uint8_t* b) { return a[0] == b[0] && a[1] == b[1] && a[2] == b[2]; }
+
+    void appendOps(std::string& out, const uint8_t* rgb, const uint8_t* reference) const {
+        // 末尾与参照相同的部分不用写出
+        uint16_t end = count;
+        while (end > 0 && same(rgb + (end - 1) * 3, reference + (end - 1) * 3)) end--;
+
+        uint16_t i = 0;
+        while (i < end) {
+            uint16_t j = i;
+            if (same(rgb + i * 3, reference + i * 3)) {
+                while (j < end && j - i < MAX_OP && same(rgb + j * 3, reference + j * 3)) j++;
+                out += (char)(OP_SKIP | (j - i - 1));
+            } else {
+                while (j < end && j - i < MAX_OP && same(rgb + j * 3, rgb + i * 3)) j++;
+                if (j - i >= 2) {
+                    out += (char)(OP_RUN | (j - i - 1));
+                    out.append((const char*)rgb + i * 3, 3);
+                } else {
+                    // 逐个写出，遇到可跳过的LED或两个以上相同的颜色时结束
+                    j = i + 1;
+                    while (j < end && j - i < MAX_OP && !same(rgb + j * 3, reference + j * 3) &&
+                           !(j + 1 < end && same(rgb + j * 3, rgb + (j + 1) * 3))) {
+                        j++;
+                    }
+                    out += (char)(OP_LITERAL | (j - i - 1));
+                    out.append((const char*)rgb + i * 3, (j - i) * 3);
+                }
+            }
+            i = j;
+        }
+    }
+
+    uint16_t count;
+    uint16_t interval;
+    uint16_t sinceKeyframe;
+    uint8_t sequence;
+    bool keyframe;
+    bool hasPrevious;
+    std::vector<uint8_t> previous;
+};
+
+// ---------------------------------------------------------------------------
+// 字节流：文本行与遥测帧交错
+
+/**
+ * @brief 解码后的一帧遥测，fields为还原后的全部字段
+ */
+struct TelemetryFrame {
+    uint8_t sequence;
+    bool keyframe;
+    std::vector<uint32_t> fields;
+};
+
+/**
+ * @brief 字节流中的一个事件
+ */
+struct StreamEvent {
+    enum Kind { LINE, TELEMETRY };
+    Kind kind;
+    std::string line;           ///< LINE：去掉行尾\r\n的文本
+    TelemetryFrame telemetry;   ///< TELEMETRY：还原后的遥测帧
+};
+
+/**
+ * @brief 把设备发来的字节流拆成文本行和遥测帧
+ * @details 遥测帧以0xA5 0x5A开头，按长度和CRC8确认，校验失败的字节当作文本。
+ * 差分帧在收到第一个完整帧之前、或序号不连续之后被丢弃，直到下一个完整帧。
+ */
+class StreamDecoder {
+public:
+    StreamDecoder() : synced(false), lastSequence(0), crcErrors(0), droppedDeltas(0) {}
+
+    void feed(const uint8_t* data, size_t length) { buffer.insert(buffer.end(), data, data + length); }
+    void feed(const std::string& data) { feed((const uint8_t*)data.data(), data.size()); }
+
+    /**
+     * @brief 取出下一个完整的事件
+     * @return 没有完整的行或帧时返回false，剩余字节留到下次
+     */
+    bool next(StreamEvent& event) {
+        size_t pos = 0;
+        while (pos < buffer.size()) {
+            uint8_t c = buffer[pos];
+            if (c == SYNC0 && pos + 1 < buffer.size() && buffer[pos + 1] == SYNC1) {
+                int result = tryFrame(pos, event);
+                if (result < 0) break;          // 帧还不完整
+                if (result > 0) {
+                    // 帧之前的文本留在缓冲区头部，属于同一行
+                    return true;
+                }
+            } else if (c == SYNC0 && pos + 1 == buffer.size()) {
+                break;
+            }
+            if (c == '\n') {
+                event.kind = StreamEvent::LINE;
+                event.line.assign(buffer.begin(), buffer.begin() + pos);
+                if (!event.line.empty() && event.line[event.line.size() - 1] == '\r') {
+                    event.line.erase(event.line.size() - 1);
+                }
+                buffer.erase(buffer.begin(), buffer.begin() + pos + 1);
+                return true;
+            }
+            pos++;
+        }
+        return false;
+    }
+
+    uint32_t getCrcErrors() const { return crcErrors; }         ///< 同步字节之后校验失败的次数
+    uint32_t getDroppedDeltas() const { return droppedDeltas; } ///< 未同步时丢弃的差分帧数
+
+private:
+    static const uint8_t SYNC0 = 0xA5;
+    static const uint8_t SYNC1 = 0x5A;
+    static const uint8_t TYPE_KEYFRAME = 0x01;
+    static const uint8_t TYPE_DELTA = 0x02;
+    static const uint16_t MAX_BODY = 3 + 8 + 64 * 5;
+
+    /**
+     * @brief 尝试在pos处解码一帧
+     * @return 1为得到一帧（已从缓冲区移除），0为不是帧，-1为需要更多字节
+     */
+    int tryFrame(size_t pos, StreamEvent& event) {
+        if (pos + 4 > buffer.size()) return -1;
+        uint16_t length = buffer[pos + 2] | (buffer[pos + 3] << 8);
+        if (length < 3 || length > MAX_BODY) return 0;
+        if (pos + 4 + length + 1 > buffer.size()) return -1;
+
+        const uint8_t* body = &buffer[pos + 4];
+        if (crc8(body, length) != body[length]) {
+            crcErrors++;
+            return 0;
+        }
+
+        uint8_t type = body[0];
+        uint8_t sequence = body[1];
+        uint8_t count = body[2];
+        uint8_t maskBytes = (count + 7) / 8;
+        bool valid = (type == TYPE_KEYFRAME || type == TYPE_DELTA) && 3 + maskBytes <= length;
+        std::vector<uint32_t> fields;
+        if (valid) {
+            if (type == TYPE_KEYFRAME) {
+                fields.assign(count, 0);
+            } else if (synced && (uint8_t)(lastSequence + 1) == sequence && previous.size() == count) {
+                fields = previous;
+            } else {
+                synced = false;
+                droppedDeltas++;
+                valid = false;
+            }
+        }
+
+        // 按变化掩码读取ZigZag变长差值
+        const uint8_t* p = body + 3 + maskBytes;
+        const uint8_t* end = body + length;
+        for (uint8_t i = 0; valid && i < count; i++) {
+            if (!(body[3 + i / 8] & (1 << (i % 8)))) continue;
+            uint32_t zigzag = 0;
+            int shift = 0;
+            while (p < end && shift < 35) {
+                uint8_t b = *p++;
+                zigzag |= (uint32_t)(b & 0x7F) << shift;
+                shift += 7;
+                if (!(b & 0x80)) break;
+            }
+            int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            fields[i] += (uint32_t)delta;
+        }
+
+        size_t frameEnd = pos + 4 + length + 1;
+        std::vector<uint8_t> text(buffer.begin(), buffer.begin() + pos);
+        buffer.erase(buffer.begin(), buffer.begin() + frameEnd);
+        buffer.insert(buffer.begin(), text.begin(), text.end());
+        if (!valid) return tryAgain(event);
+
+        synced = true;
+        lastSequence = sequence;
+        previous = fields;
+        event.kind = StreamEvent::TELEMETRY;
+        event.telemetry.sequence = sequence;
+        event.telemetry.keyframe = type == TYPE_KEYFRAME;
+        event.telemetry.fields = fields;
+        return 1;
+    }
+
+    /**
+     * @brief 丢弃的帧已从缓冲区移除，从头继续找下一个事件
+     */
+    int tryAgain(StreamEvent& event) {
+        return next(event) ? 1 : -1;
+    }
+
+    std::vector<uint8_t> buffer;
+    std::vector<uint32_t> previous;
+    bool synced;
+    uint8_t lastSequence;
+    uint32_t crcErrors;
+    uint32_t droppedDeltas;
+};
+
+}
+
+#endif
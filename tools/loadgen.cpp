@@ -0,0 +1,330 @@
+/**
+ * @file loadgen.cpp
+ * @brief Follow流负载发生器（上位机）
+ *
+ * @details 编译：g++ -std=c++11 -O2 -Itools/host tools/loadgen.cpp -o loadgen
+ *
+ * 用法：
+ *   loadgen --port <串口> [--baud N] [--rate HZ | --sweep 起始:结束:步长] [--seconds N]
+ *   loadgen --spawn "<命令>" [...]      启动lightbelt_native serve，从其输出中读取伪终端路径
+ *
+ * 开启设备的延迟追踪回显（Trace|1），以固定频率发送带"@编号 "前缀的Follow命令，
+ * 按编号匹配Trace确认，统计确认率、确认吞吐量、往返时间和设备侧的舵机/灯带延迟。
+ * --sweep依次测试多个频率，确认率低于95%或往返时间在测试期间持续增长（后四分之一的中位数
+ * 超过前四分之一的两倍）时判定为饱和，输出第一个饱和的频率。
+ *
+ * 不需要硬件：先运行`.pio/build/native/program serve`在伪终端上实时运行固件，或者直接
+ *   loadgen --spawn ".pio/build/native/program serve --quiet" --sweep 10:100:10
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <map>
+#include "LightBeltProtocol.h"
+
+static uint64_t wallMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static speed_t baudConstant(uint32_t baud) {
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B115200;
+    }
+}
+
+static int openPort(const char* path, uint32_t baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) return -1;
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, baudConstant(baud));
+        cfsetospeed(&tio, baudConstant(baud));
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/**
+ * @brief 结束spawnServer()启动的进程组并回收子进程
+ */
+static void stopServer(pid_t pid) {
+    kill(-pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+/**
+ * @brief 启动serve子进程，读取其打印的"pty: 路径"
+ * @details 子进程为新进程组的组长，命令由sh以exec方式运行（不留下中间的shell），
+ * stopServer()向整个进程组发送SIGTERM，命令行中即使有管道或多个进程也不会遗留
+ */
+static pid_t spawnServer(const char* commandLine, std::string& ptyPath) {
+    int pipes[2];
+    if (pipe(pipes) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        dup2(pipes[1], STDOUT_FILENO);
+        close(pipes[0]);
+        close(pipes[1]);
+        std::string script = std::string("exec ") + commandLine;
+        execl("/bin/sh", "sh", "-c", script.c_str(), (char*)NULL);
+        _exit(127);
+    }
+    if (pid < 0) {
+        close(pipes[0]);
+        close(pipes[1]);
+        return -1;
+    }
+    // 父子进程都设置，避免在子进程设置之前就发送信号
+    setpgid(pid, pid);
+    close(pipes[1]);
+    FILE* out = fdopen(pipes[0], "r");
+    char line[256];
+    while (out && fgets(line, sizeof(line), out)) {
+        if (strncmp(line, "pty: ", 5) == 0) {
+            ptyPath = line + 5;
+            ptyPath.erase(ptyPath.find_last_not_of("\r\n") + 1);
+            break;
+        }
+    }
+    if (ptyPath.empty()) {
+        stopServer(pid);
+        return -1;
+    }
+    return pid;
+}
+
+static void writeAll(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n > 0) {
+            done += n;
+        } else if (n < 0 && errno != EAGAIN) {
+            return;
+        } else {
+            struct pollfd pfd = {fd, POLLOUT, 0};
+            poll(&pfd, 1, 10);
+        }
+    }
+}
+
+struct RunResult {
+    uint32_t sent;
+    uint32_t acked;
+    uint64_t bytesOut;
+    uint64_t bytesIn;
+    double elapsed;                     // 发送期间加上之后收到最后一个确认的时间，秒；不含空等的时间
+    std::vector<uint32_t> roundTrip;    // 按确认顺序
+    std::vector<uint32_t> servo;
+    std::vector<uint32_t> led;
+};
+
+static uint32_t percentile(std::vector<uint32_t> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(p * (values.size() - 1) + 0.5)];
+}
+
+/**
+ * @brief 读取并处理已到达的回复
+ */
+static void readReplies(int fd, lightbelt::StreamDecoder& decoder, std::map<uint32_t, uint64_t>& pending,
+                        RunResult& result) {
+    uint8_t buffer[1024];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        result.bytesIn += n;
+        decoder.feed(buffer, n);
+    }
+    uint64_t now = wallMicros();
+    lightbelt::StreamEvent event;
+    while (decoder.next(event)) {
+        lightbelt::TraceAck ack;
+        if (event.kind != lightbelt::StreamEvent::LINE ||
+            !lightbelt::parseTrace(lightbelt::parseReply(event.line), ack)) {
+            continue;
+        }
+        std::map<uint32_t, uint64_t>::iterator it = pending.find(ack.id);
+        if (it == pending.end()) continue;
+        result.acked++;
+        result.roundTrip.push_back((uint32_t)(now - it->second));
+        result.servo.push_back(ack.servoMicros);
+        result.led.push_back(ack.ledMicros);
+        pending.erase(it);
+    }
+}
+
+static RunResult runRate(int fd, uint32_t rate, uint32_t seconds, uint32_t& nextId) {
+    RunResult result = RunResult();
+    lightbelt::StreamDecoder decoder;
+    std::map<uint32_t, uint64_t> pending;
+
+    uint64_t start = wallMicros();
+    uint64_t end = start + seconds * 1000000ULL;
+    uint64_t period = 1000000 / rate;
+    uint64_t nextSend = start;
+    while (true) {
+        uint64_t now = wallMicros();
+        if (now >= end) break;
+        if (now >= nextSend) {
+            int values[lightbelt::FOLLOW_CHANNELS];
+            double t = (now - start) / 1e6;
+            for (int i = 0; i < lightbelt::FOLLOW_CHANNELS; i++) {
+                values[i] = 512 + (int)(511 * sin((t + i * 0.3) * 2 * M_PI / 3));
+            }
+            uint32_t id = nextId++;
+            std::string line = lightbelt::tagged(id, lightbelt::follow(values));
+            pending[id] = now;
+            writeAll(fd, line);
+            result.sent++;
+            result.bytesOut += line.size();
+            nextSend += period;
+        }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        uint64_t untilSend = nextSend > now ? nextSend - now : 0;
+        poll(&pfd, 1, (int)(untilSend / 1000));
+        readReplies(fd, decoder, pending, result);
+    }
+
+    // 等待剩余的确认，最多2秒；吞吐量只算到最后一个确认，丢失的确认不会拉长统计时间
+    uint64_t lastAck = end;
+    uint64_t drainEnd = wallMicros() + 2000000;
+    while (!pending.empty() && wallMicros() < drainEnd) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        poll(&pfd, 1, 20);
+        uint32_t acked = result.acked;
+        readReplies(fd, decoder, pending, result);
+        if (result.acked > acked) lastAck = wallMicros();
+    }
+    result.elapsed = (lastAck - start) / 1e6;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* usage =
+        "usage: loadgen (--port PATH | --spawn COMMAND) [--baud N] [--rate HZ | --sweep START:STOP:STEP] [--seconds N]\n";
+    const char* port = NULL;
+    const char* spawn = NULL;
+    uint32_t baud = 115200;
+    uint32_t rateStart = 50, rateStop = 50, rateStep = 1;
+    uint32_t seconds = 5;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--port") == 0 && hasValue) {
+            port = argv[++i];
+        } else if (strcmp(argv[i], "--spawn") == 0 && hasValue) {
+            spawn = argv[++i];
+        } else if (strcmp(argv[i], "--baud") == 0 && hasValue) {
+            baud = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && hasValue) {
+            rateStart = rateStop = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--sweep") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%u:%u:%u", &rateStart, &rateStop, &rateStep) != 3 || rateStart == 0 ||
+                rateStep == 0 || rateStop < rateStart) {
+                fprintf(stderr, "%s", usage);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+    if (!port == !spawn) {
+        fprintf(stderr, "%s", usage);
+        return 2;
+    }
+
+    pid_t server = -1;
+    std::string ptyPath;
+    if (spawn) {
+        server = spawnServer(spawn, ptyPath);
+        if (server < 0) {
+            fprintf(stderr, "loadgen: '%s' did not report a pty\n", spawn);
+            return 1;
+        }
+        port = ptyPath.c_str();
+    }
+
+    int fd = openPort(port, baud);
+    if (fd < 0) {
+        fprintf(stderr, "loadgen: cannot open %s: %s\n", port, strerror(errno));
+        if (server > 0) stopServer(server);
+        return 1;
+    }
+
+    // 开启确认回显，丢弃之前积压的输出
+    writeAll(fd, lightbelt::trace(true));
+    usleep(300000);
+    tcflush(fd, TCIFLUSH);
+
+    printf("%s at %u baud, %u s per rate; rtt and device latency in ms (p50/p95/max).\n", port, baud, seconds);
+    printf("%6s %6s %6s %6s %8s %8s %20s %14s %14s\n", "rate", "sent", "acked", "ack%", "ack/s", "rx B/s",
+           "rtt", "servo", "led");
+
+    uint32_t nextId = 0;
+    uint32_t saturatedAt = 0;
+    for (uint32_t rate = rateStart; rate <= rateStop; rate += rateStep) {
+        RunResult r = runRate(fd, rate, seconds, nextId);
+        double ackRatio = r.sent ? (double)r.acked / r.sent : 0;
+
+        // 往返时间持续增长说明回复在链路上积压
+        size_t quarter = r.roundTrip.size() / 4;
+        bool growing = false;
+        if (quarter > 0) {
+            std::vector<uint32_t> head(r.roundTrip.begin(), r.roundTrip.begin() + quarter);
+            std::vector<uint32_t> tail(r.roundTrip.end() - quarter, r.roundTrip.end());
+            growing = percentile(tail, 0.5) > 2 * percentile(head, 0.5) && percentile(tail, 0.5) > 50000;
+        }
+        bool saturated = ackRatio < 0.95 || growing;
+        if (saturated && !saturatedAt) saturatedAt = rate;
+
+        char rtt[32], servo[32], led[32];
+        snprintf(rtt, sizeof(rtt), "%.1f/%.1f/%.1f", percentile(r.roundTrip, 0.5) / 1e3,
+                 percentile(r.roundTrip, 0.95) / 1e3, percentile(r.roundTrip, 1.0) / 1e3);
+        snprintf(servo, sizeof(servo), "%.1f/%.1f", percentile(r.servo, 0.5) / 1e3, percentile(r.servo, 0.95) / 1e3);
+        snprintf(led, sizeof(led), "%.1f/%.1f", percentile(r.led, 0.5) / 1e3, percentile(r.led, 0.95) / 1e3);
+        printf("%6u %6u %6u %5.1f%% %8.1f %8.0f %20s %14s %14s%s\n", rate, r.sent, r.acked, ackRatio * 100,
+               (double)r.acked / r.elapsed, (double)r.bytesIn / r.elapsed, rtt, servo, led,
+               saturated ? "  saturated" : "");
+        fflush(stdout);
+
+        // 下一个频率之前让积压的回复排空
+        usleep(500000);
+        tcflush(fd, TCIFLUSH);
+    }
+
+    if (rateStop > rateStart) {
+        if (saturatedAt) {
+            printf("First saturated rate: %u Hz\n", saturatedAt);
+        } else {
+            printf("No saturation up to %u Hz\n", rateStop);
+        }
+    }
+
+    writeAll(fd, lightbelt::trace(false));
+    close(fd);
+    if (server > 0) stopServer(server);
+    return saturatedAt && rateStop == rateStart ? 1 : 0;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file EffectCompiler.cpp
+ * @brief 用户效果源码的词法分析、递归下降解析和字节码生成
+ */
+
+#include "EffectCompiler.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "EffectVM.h"
+
+namespace {
+
+struct Builtin {
+    const char* name;
+    uint8_t args;
+    EffectOp op;
+};
+
+const Builtin BUILTINS[] = {
+    {"sin8", 1, OP_SIN8},
+    {"tri8", 1, OP_TRI8},
+    {"abs", 1, OP_ABS},
+    {"min", 2, OP_MIN},
+    {"max", 2, OP_MAX},
+    {"clamp", 3, OP_CLAMP},
+    {"rgb", 3, OP_RGB},
+};
+
+const char* const INPUT_NAMES[INPUT_COUNT] = {"t", "layer", "pixel", "index", "layers", "size"};
+
+/**
+ * @brief 一个块的编译器，出错时抛出std::string
+ */
+class BlockCompiler {
+public:
+    BlockCompiler(const char* text, int line) : p(text), line(line) {}
+
+    std::vector<uint8_t> compile() {
+        skipSpace();
+        while (true) {
+            // "名称 ="为赋值语句，否则为结果表达式
+            const char* save = p;
+            int saveLine = line;
+            std::string name = identifier();
+            skipSpace();
+            if (!name.empty() && *p == '=' && p[1] != '=') {
+                p++;
+                expression();
+                expect(';');
+                emit(OP_SET);
+                emit(localIndex(name, true));
+                continue;
+            }
+            p = save;
+            line = saveLine;
+            break;
+        }
+
+        expression();
+        skipSpace();
+        if (*p == ';') p++;
+        skipSpace();
+        if (*p != '\0') fail("unexpected text after result expression");
+        emit(OP_END);
+        return code;
+    }
+
+private:
+    void fail(const std::string& message) {
+        throw "line " + std::to_string(line) + ": " + message;
+    }
+
+    void skipSpace() {
+        while (*p) {
+            if (*p == '#') {
+                while (*p && *p != '\n') p++;
+            } else if (isspace((unsigned char)*p)) {
+                if (*p == '\n') line++;
+                p++;
+            } else {
+                break;
+            }
+        }
+    }
+
+    std::string identifier() {
+        skipSpace();
+        std::string name;
+        if (isalpha((unsigned char)*p) || *p == '_') {
+            while (isalnum((unsigned char)*p) || *p == '_') name += *p++;
+        }
+        return name;
+    }
+
+    bool accept(const char* token) {
+        static const char* const LONG_TOKENS[] = {"==", "!=", "<=", ">=", "<<", ">>"};
+        skipSpace();
+        size_t length = strlen(token);
+        if (strncmp(p, token, length) != 0) return false;
+        // 单字符运算符不能是双字符运算符的前半部分，如"<"与"<<"
+        if (length == 1) {
+            for (const char* t : LONG_TOKENS) {
+                if (p[0] == t[0] && p[1] == t[1]) return false;
+            }
+        }
+        p += length;
+        return true;
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (*p != c) fail(std::string("expected '") + c + "'");
+        p++;
+    }
+
+    void emit(uint8_t byte) { code.push_back(byte); }
+
+    uint8_t localIndex(const std::string& name, bool assign) {
+        for (uint8_t i = 0; i < INPUT_COUNT; i++) {
+            if (name == INPUT_NAMES[i]) fail("cannot assign to input '" + name + "'");
+        }
+        for (size_t i = 0; i < locals.size(); i++) {
+            if (locals[i] == name) return i;
+        }
+        if (!assign) fail("unknown name '" + name + "'");
+        if (locals.size() >= EFFECT_VM_LOCALS) fail("too many variables");
+        locals.push_back(name);
+        return locals.size() - 1;
+    }
+
+    void pushConstant(long value) {
+        if (value >= -128 && value <= 127) {
+            emit(OP_PUSH8);
+            emit(value & 0xFF);
+        } else if (value >= -32768 && value <= 32767) {
+            emit(OP_PUSH16);
+            emit(value & 0xFF);
+            emit((value >> 8) & 0xFF);
+        } else {
+            emit(OP_PUSH32);
+            for (int i = 0; i < 4; i++) emit((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    /**
+     * @brief 回填向前跳转的偏移
+     */
+    void patchJump(size_t offsetAt) {
+        size_t distance = code.size() - (offsetAt + 1);
+        if (distance > 255) fail("conditional expression too long");
+        code[offsetAt] = distance;
+    }
+
+    void expression() {
+        binary(0);
+        if (accept("?")) {
+            emit(OP_JZ);
+            size_t elseJump = code.size();
+            emit(0);
+            expression();
+            expect(':');
+            emit(OP_JMP);
+            size_t endJump = code.size();
+            emit(0);
+            patchJump(elseJump);
+            expression();
+            patchJump(endJump);
+        }
+    }
+
+    /**
+     * @brief 按优先级解析二元运算，level越大优先级越高
+     */
+    void binary(int level) {
+        struct Operator {
+            const char* token;
+            EffectOp op;
+        };
+        static const Operator LEVELS[][4] = {
+            {{"|", OP_OR}},
+            {{"^", OP_XOR}},
+            {{"&", OP_AND}},
+            {{"==", OP_EQ}, {"!=", OP_NE}},
+            {{"<=", OP_LE}, {">=", OP_GE}, {"<", OP_LT}, {">", OP_GT}},
+            {{"<<", OP_SHL}, {">>", OP_SHR}},
+            {{"+", OP_ADD}, {"-", OP_SUB}},
+            {{"*", OP_MUL}, {"/", OP_DIV}, {"%", OP_MOD}},
+        };
+        const int levelCount = sizeof(LEVELS) / sizeof(LEVELS[0]);
+        if (level == levelCount) {
+            unary();
+            return;
+        }
+
+        binary(level + 1);
+        while (true) {
+            const Operator* matched = NULL;
+            for (const Operator& o : LEVELS[level]) {
+                if (o.token && accept(o.token)) {
+                    matched = &o;
+                    break;
+                }
+            }
+            if (!matched) return;
+            binary(level + 1);
+            emit(matched->op);
+        }
+    }
+
+    void unary() {
+        if (accept("-")) {
+            unary();
+            emit(OP_NEG);
+        } else if (accept("~")) {
+            unary();
+            emit(OP_NOT);
+        } else if (accept("!")) {
+            unary();
+            emit(OP_LNOT);
+        } else {
+            primary();
+        }
+    }
+
+    void primary() {
+        skipSpace();
+        if (*p == '(') {
+            p++;
+            expression();
+            expect(')');
+            return;
+        }
+
+        if (isdigit((unsigned char)*p)) {
+            char* end;
+            unsigned long value = strtoul(p, &end, 0);
+            if (value > 0xFFFFFFFFul) fail("number too large");
+            p = end;
+            pushConstant((long)(int32_t)(uint32_t)value);
+            return;
+        }
+
+        std::string name = identifier();
+        if (name.empty()) fail(*p ? std::string("unexpected '") + *p + "'" : "unexpected end of block");
+
+        for (const Builtin& b : BUILTINS) {
+            if (name != b.name) continue;
+            expect('(');
+            for (uint8_t i = 0; i < b.args; i++) {
+                if (i > 0) expect(',');
+                expression();
+            }
+            expect(')');
+            emit(b.op);
+            return;
+        }
+
+        for (uint8_t i = 0; i < INPUT_COUNT; i++) {
+            if (name == INPUT_NAMES[i]) {
+                emit(OP_IN);
+                emit(i);
+                return;
+            }
+        }
+
+        emit(OP_GET);
+        emit(localIndex(name, false));
+    }
+
+    const char* p;
+    int line;
+    std::vector<uint8_t> code;
+    std::vector<std::string> locals;
+};
+
+/**
+ * @brief 找出"名称 { ... }"块的内容
+ */
+bool findBlock(const std::string& source, const char* name, std::string& body, int& line) {
+    size_t pos = 0;
+    while ((pos = source.find(name, pos)) != std::string::npos) {
+        bool startOk = pos == 0 || !isalnum((unsigned char)source[pos - 1]);
+        size_t brace = source.find_first_not_of(" \t\r\n", pos + strlen(name));
+        if (startOk && brace != std::string::npos && source[brace] == '{') {
+            size_t close = source.find('}', brace);
+            if (close == std::string::npos) throw std::string(name) + ": missing '}'";
+            body = source.substr(brace + 1, close - brace - 1);
+            line = 1;
+            for (size_t i = 0; i < brace; i++) {
+                if (source[i] == '\n') line++;
+            }
+            return true;
+        }
+        pos += strlen(name);
+    }
+    return false;
+}
+
+/**
+ * @brief 去掉注释，避免注释中的块名被当作块
+ */
+std::string stripComments(const std::string& source) {
+    std::string result;
+    bool comment = false;
+    for (char c : source) {
+        if (c == '#') comment = true;
+        if (c == '\n') comment = false;
+        result += comment ? ' ' : c;
+    }
+    return result;
+}
+
+}
+
+bool compileEffect(const std::string& source, std::vector<uint8_t>& program, std::string& error) {
+    try {
+        std::string text = stripComments(source);
+        std::string servoBody, pixelBody;
+        int servoLine = 0, pixelLine = 0;
+        bool hasServo = findBlock(text, "servo", servoBody, servoLine);
+        if (!findBlock(text, "pixel", pixelBody, pixelLine)) {
+            error = "missing pixel block";
+            return false;
+        }
+
+        std::vector<uint8_t> servo;
+        if (hasServo) servo = BlockCompiler(servoBody.c_str(), servoLine).compile();
+        std::vector<uint8_t> pixel = BlockCompiler(pixelBody.c_str(), pixelLine).compile();
+        if (servo.size() > 255) {
+            error = "servo block too long";
+            return false;
+        }
+
+        program.clear();
+        program.push_back((uint8_t)EffectVM::VERSION);
+        program.push_back(servo.size());
+        program.insert(program.end(), servo.begin(), servo.end());
+        program.insert(program.end(), pixel.begin(), pixel.end());
+        if (program.size() > EFFECT_VM_MAX_CODE) {
+            error = "program is " + std::to_string(program.size()) + " bytes, limit " +
+                    std::to_string(EFFECT_VM_MAX_CODE);
+            return false;
+        }
+
+        // 与设备加载时相同的校验，编译器的问题在上位机上就能发现
+        uint16_t instructions;
+        const char* problem = NULL;
+        if (!servo.empty()) problem = EffectVM::verify(servo.data(), servo.size(), &instructions);
+        if (!problem) problem = EffectVM::verify(pixel.data(), pixel.size(), &instructions);
+        if (problem) {
+            error = std::string("generated code failed verification: ") + problem;
+            return false;
+        }
+        return true;
+    } catch (const std::string& message) {
+        error = message;
+        return false;
+    }
+}
+
+std::vector<std::string> effectUploadCommands(const std::vector<uint8_t>& program, size_t maxLine) {
+    static const char* prefix = "EffectCode|";
+    size_t bytesPerLine = (maxLine - strlen(prefix)) / 2;
+
+    std::vector<std::string> commands;
+    commands.push_back("EffectClear");
+    for (size_t i = 0; i < program.size(); i += bytesPerLine) {
+        std::string line = prefix;
+        for (size_t j = i; j < program.size() && j < i + bytesPerLine; j++) {
+            char hex[3];
+            snprintf(hex, sizeof(hex), "%02X", program[j]);
+            line += hex;
+        }
+        commands.push_back(line);
+    }
+    commands.push_back("EffectRun");
+    return commands;
+}
@@ -0,0 +1,44 @@
+#ifndef EFFECT_COMPILER_H
+#define EFFECT_COMPILER_H
+
+/**
+ * @file EffectCompiler.h
+ * @brief 用户效果的上位机编译器：把类C表达式源码编译为EffectVM字节码
+ *
+ * @details 源码由servo和pixel两个块组成，servo块可以省略（不控制舵机）：
+ *
+ *     # 注释到行尾
+ *     servo {
+ *         512 + (sin8(t / 8 + layer * 40) - 128) * 4
+ *     }
+ *     pixel {
+ *         x = t / 4 + index * 8;
+ *         rgb(sin8(x), sin8(x + 85), sin8(x + 170))
+ *     }
+ *
+ * 每个块是若干条"变量 = 表达式;"之后跟一个结果表达式。输入量为t、layer、pixel、index、layers、size
+ * （含义见EffectInput），函数有sin8、tri8、abs、min、max、clamp、rgb，运算符与C相同
+ * （?:、|、^、&、==、!=、<、<=、>、>=、<<、>>、+、-、*、/、%和一元-、~、!）。
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 编译源码
+ * @param source 源码
+ * @param program 输出完整的程序（含版本和舵机段长度）
+ * @param error 失败时的原因（含行号）
+ * @return 成功返回true
+ */
+bool compileEffect(const std::string& source, std::vector<uint8_t>& program, std::string& error);
+
+/**
+ * @brief 生成上传程序的命令：EffectClear、若干EffectCode|十六进制、EffectRun
+ * @param program 编译结果
+ * @param maxLine 每条命令的最大长度（串口为63）
+ */
+std::vector<std::string> effectUploadCommands(const std::vector<uint8_t>& program, size_t maxLine = 63);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef NATIVE_TOOLS_H
+#define NATIVE_TOOLS_H
+
+/**
+ * @file NativeTools.h
+ * @brief 上位机工具的子命令入口，argv不含子命令本身
+ */
+
+int benchMain(int argc, char** argv);
+int goldenMain(int argc, char** argv);
+int parseBenchMain(int argc, char** argv);
+int fuzzMain(int argc, char** argv);
+int planMain(int argc, char** argv);
+int kernelsMain(int argc, char** argv);
+int effectMain(int argc, char** argv);
+int skewMain(int argc, char** argv);
+int governorMain(int argc, char** argv);
+int scheduleMain(int argc, char** argv);
+int latencyMain(int argc, char** argv);
+int serveMain(int argc, char** argv);
+int streamMain(int argc, char** argv);
+int dmxMain(int argc, char** argv);
+
+#endif
@@ -0,0 +1,283 @@
+/**
+ * @file Rig.cpp
+ * @brief 模拟设备与测试场景
+ */
+
+#include "Rig.h"
+#include "ShowFormat.h"
+#include "EffectCompiler.h"
+
+WireTime estimateWireTime(const sim::BusCounters& bus, uint32_t i2cClock) {
+    WireTime time;
+    // WS2812：800kHz每位1.25us，每字节10us；每次show后至少300us的复位低电平
+    time.ledMicros = (uint32_t)(bus.ledPathBytes * 10 + (uint64_t)bus.showCalls * 300);
+    // I2C：每字节8位数据加1位应答，另加起始/停止条件约2位
+    time.i2cMicros = (uint32_t)((bus.i2cBytes * 9 + (uint64_t)bus.i2cTransactions * 2) * 1000000 / i2cClock);
+    // LEDC：每次写入为两次寄存器访问，约1us
+    time.ledcMicros = bus.ledcWrites;
+    return time;
+}
+
+uint32_t estimateWireMicros(const sim::BusCounters& bus, uint32_t i2cClock) {
+    WireTime time = estimateWireTime(bus, i2cClock);
+    return time.ledMicros + time.i2cMicros + time.ledcMicros;
+}
+
+static LightBelt* createBelt(const RigConfig& config) {
+    // 模板参数必须是编译期常量，这里列出defaultConfigs中的LED布局
+    if (config.staticBelt) {
+        uint16_t layout = config.ledLayers << 8 | config.ledsPerLayer;
+        switch (layout) {
+        case 6 << 8 | 33: return new StaticLightBelt<6, 33>(5);
+        case 12 << 8 | 33: return new StaticLightBelt<12, 33>(5);
+        case 12 << 8 | 60: return new StaticLightBelt<12, 60>(5);
+        case 16 << 8 | 60: return new StaticLightBelt<16, 60>(5);
+        default: break;
+        }
+    }
+    return new LightBelt(5, config.ledLayers, config.ledsPerLayer);
+}
+
+/**
+ * @brief 按引脚数把层平均分段，除不尽的层分给前面的段
+ */
+static void splitSegments(LightBelt* belt, uint8_t pins) {
+    static const uint8_t SEGMENT_PINS[LIGHT_BELT_MAX_SEGMENTS] = {5, 18, 19, 21};
+    pins = std::min<uint8_t>(std::min<uint8_t>(pins, LIGHT_BELT_MAX_SEGMENTS), belt->getLayers());
+    if (pins <= 1) return;
+
+    LedSegment segments[LIGHT_BELT_MAX_SEGMENTS];
+    for (uint8_t i = 0; i < pins; i++) {
+        segments[i].pin = SEGMENT_PINS[i];
+        segments[i].layers = belt->getLayers() / pins + (i < belt->getLayers() % pins ? 1 : 0);
+    }
+    belt->setSegments(segments, pins);
+}
+
+Rig::Rig(const RigConfig& cfg) : config(cfg), pca(NULL), ledc(NULL), serial(NULL), bluetooth(NULL) {
+    sim::reset();
+
+    belt = createBelt(config);
+    splitSegments(belt, config.ledPins);
+    if (config.internalPWM) {
+        ledc = new ServoPlatformInter(config.servoLayers);
+    } else {
+        pca = new ServoPlatform(config.servoLayers);
+    }
+
+    if (config.bluetooth) {
+        bluetooth = ledc ? new BluetoothController(belt, ledc, config.cycleMs)
+                         : new BluetoothController(belt, pca, config.cycleMs);
+        // 模拟时只在命令之间推进时钟，避免超时断开
+        bluetooth->setDisconnectTimeout(0xFFFFFFFF);
+    } else {
+        serial = ledc ? new SerialController(belt, ledc, config.cycleMs)
+                      : new SerialController(belt, pca, config.cycleMs);
+    }
+
+    // 与main.cpp的setup()顺序一致
+    BootState::begin();
+    const BootSettings& boot = BootState::get();
+    Palettes::begin();
+    belt->begin();
+    if (ledc) ledc->begin();
+    if (pca) {
+        if (boot.i2cAddress != 0) pca->setI2CAddress(boot.i2cAddress);
+        pca->begin();
+        BootState::setI2CAddress(pca->getI2CAddress());
+    }
+    if (bluetooth) bluetooth->begin();
+    if (serial) serial->begin();
+
+    // 第一帧由第一次update()输出
+    step(0);
+    bootMicros = (uint32_t)sim::nowMicros() + estimateWireMicros(sim::counters());
+}
+
+Rig::~Rig() {
+    delete serial;
+    delete bluetooth;
+    delete pca;
+    delete ledc;
+    delete belt;
+}
+
+void Rig::command(const char* line) {
+    std::string text = line;
+    // 蓝牙控制器要求命令中至少有一个分隔符
+    if (config.bluetooth && text.find('|') == std::string::npos) {
+        text += '|';
+    }
+    text += '\n';
+
+    if (config.bluetooth) {
+        sim::feedBluetooth(text.c_str());
+    } else {
+        sim::feedSerial(text.c_str());
+    }
+}
+
+void Rig::feedRaw(const uint8_t* data, size_t length) {
+    if (config.bluetooth) {
+        sim::feedBluetooth(data, length);
+    } else {
+        sim::feedSerial(data, length);
+    }
+}
+
+FrameCost Rig::step(uint32_t stepMs) {
+    FrameCost cost;
+    sim::BusCounters before = sim::counters();
+
+    uint64_t start = sim::hostNanos();
+    if (serial) serial->update();
+    if (bluetooth) bluetooth->update();
+    BootState::update();
+    cost.hostNanos = sim::hostNanos() - start;
+
+    const sim::BusCounters& after = sim::counters();
+    cost.bus.showCalls = after.showCalls - before.showCalls;
+    cost.bus.ledBytes = after.ledBytes - before.ledBytes;
+    cost.bus.ledPathBytes = after.ledPathBytes - before.ledPathBytes;
+    cost.bus.i2cTransactions = after.i2cTransactions - before.i2cTransactions;
+    cost.bus.i2cBytes = after.i2cBytes - before.i2cBytes;
+    cost.bus.ledcWrites = after.ledcWrites - before.ledcWrites;
+    cost.bus.serialBytes = after.serialBytes - before.serialBytes;
+    cost.bus.bluetoothBytes = after.bluetoothBytes - before.bluetoothBytes;
+
+    sim::advanceMicros((uint64_t)stepMs * 1000);
+    return cost;
+}
+
+void Rig::run(uint32_t frames, uint32_t stepMs) {
+    for (uint32_t i = 0; i < frames; i++) {
+        step(stepMs);
+    }
+}
+
+const OutputLatch& Rig::getOutputLatch() const {
+    return serial ? serial->getOutputLatch() : bluetooth->getOutputLatch();
+}
+
+FrameCost Rig::stepGoverned() {
+    FrameCost cost = step(0);
+    if (serial) serial->waitForNextFrame();
+    if (bluetooth) bluetooth->waitForNextFrame();
+    return cost;
+}
+
+const IdleGovernor& Rig::getIdleGovernor() const {
+    return serial ? serial->getIdleGovernor() : bluetooth->getIdleGovernor();
+}
+
+const Scheduler& Rig::getScheduler() const {
+    return serial ? serial->getScheduler() : bluetooth->getScheduler();
+}
+
+const PixelStream* Rig::getPixelStream() const {
+    return serial ? &serial->getPixelStream() : NULL;
+}
+
+void Rig::setPixelReceiver(PixelReceiver* receiver) {
+    if (serial) serial->setPixelReceiver(receiver);
+    if (bluetooth) bluetooth->setPixelReceiver(receiver);
+}
+
+/**
+ * @brief 生成覆盖最大层数的演出文件，与showtool demo的波形一致
+ */
+static bool writeScenarioShow(const std::string& path) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+
+    ShowHeader header;
+    header.servoLayers = 8;
+    header.lightLayers = SHOW_MAX_LIGHT_LAYERS;
+    header.frameIntervalMs = 20;
+    header.keyframeInterval = 250;
+    header.frameCount = 500;
+
+    uint8_t raw[SHOW_HEADER_SIZE];
+    showWriteHeader(raw, header);
+    fwrite(raw, 1, sizeof(raw), out);
+
+    ShowFrame prev, frame;
+    memset(&prev, 0, sizeof(prev));
+    uint8_t chunk[SHOW_CHUNK_HEADER_SIZE + SHOW_MAX_PAYLOAD];
+
+    for (uint32_t f = 0; f < header.frameCount; f++) {
+        memset(&frame, 0, sizeof(frame));
+        double t = f * header.frameIntervalMs / 1000.0;
+        for (int i = 0; i < header.servoLayers; i++) {
+            frame.servo[i] = (uint16_t)((0.5 + 0.5 * sin(2 * PI * (t / 4.0 - i / 12.0))) * 1023);
+        }
+        for (int i = 0; i < header.lightLayers; i++) {
+            uint8_t white = 255 - (frame.servo[i * header.servoLayers / header.lightLayers] >> 2);
+            frame.light[i] = ((uint32_t)white << 16) | (white << 8) | 255;
+        }
+        bool keyframe = f % header.keyframeInterval == 0;
+        fwrite(chunk, 1, showEncodeFrame(keyframe, header, prev, frame, chunk), out);
+        prev = frame;
+    }
+
+    uint8_t end[SHOW_CHUNK_HEADER_SIZE] = {SHOW_CHUNK_END, 0, 0};
+    fwrite(end, 1, sizeof(end), out);
+    fclose(out);
+    return true;
+}
+
+std::vector<Scenario> defaultScenarios(const char* assetDir) {
+    std::vector<Scenario> scenarios;
+
+    const char* presets[] = {"Rainbow", "Idle", "Heatup", "Cooldown", "Standby"};
+    for (const char* name : presets) {
+        scenarios.push_back(Scenario{name, {name}});
+    }
+
+    scenarios.push_back(Scenario{"Follow", {"Follow|100|300|500|700|900|1023"}});
+
+    // 默认的Rainbow底层和Heatup脉冲之上再叠加跟随运动舵机层的高亮
+    scenarios.push_back(Scenario{"Layers", {"Layer|2|Highlight|Alpha|200", "Layers"}});
+
+    // 上传并运行一个用户效果：舵机随三角波起伏，灯带为逐像素的正弦波
+    static const char* effectSource =
+        "servo { tri8(t / 12 + layer * 43) * 4 }\n"
+        "pixel { v = sin8(index * 8 + t / 6 + layer * 21); rgb(v, v / 2, 255 - v) }\n";
+    std::vector<uint8_t> program;
+    std::string error;
+    if (compileEffect(effectSource, program, error)) {
+        scenarios.push_back(Scenario{"Effect", effectUploadCommands(program)});
+    }
+
+    scenarios.push_back(Scenario{"Timeline", {
+        "TimelineClear",
+        "TimelineKey|S|0|0|0|S|0|1000|1023|S|5|0|1023|S|5|1000|0",
+        "TimelineKey|L|0|0|0xFF0000|L|0|1000|0x0000FF",
+        "TimelineKey|L|11|0|0x00FF00|L|11|1000|0xFFFFFF",
+        "TimelinePlay|1"
+    }});
+
+    sim::setFilesystemRoot(assetDir);
+    if (writeScenarioShow(std::string(assetDir) + "/scenario.show")) {
+        scenarios.push_back(Scenario{"Show", {"ShowPlay|/scenario.show|1"}});
+    }
+
+    return scenarios;
+}
+
+std::vector<RigConfig> defaultConfigs(bool bluetooth, bool internalPWM) {
+    // 内部PWM最多6层（12个LEDC通道）
+    static const uint8_t layouts[][3] = {
+        {6, 33, 3},
+        {12, 33, 6},
+        {12, 60, 6},
+        {16, 60, 8},
+    };
+
+    std::vector<RigConfig> configs;
+    for (const auto& layout : layouts) {
+        if (internalPWM && layout[2] > 6) continue;
+        configs.push_back(RigConfig{bluetooth, internalPWM, layout[0], layout[1], layout[2], 5000});
+    }
+    return configs;
+}
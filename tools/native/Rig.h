@@ -0,0 +1,148 @@
+#ifndef RIG_H
+#define RIG_H
+
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include "SimHardware.h"
+#include "LightBelt.h"
+#include "ServoPlatform.h"
+#include "ServoPlatformInter.h"
+#include "SerialController.h"
+#include "BluetoothController.h"
+#include "BootState.h"
+
+/**
+ * @brief 一台模拟设备的硬件配置
+ */
+struct RigConfig {
+    bool bluetooth;             ///< true使用BluetoothController，false使用SerialController
+    bool internalPWM;           ///< true使用ServoPlatformInter（LEDC），false使用PCA9685
+    uint8_t ledLayers;
+    uint8_t ledsPerLayer;
+    uint8_t servoLayers;
+    uint32_t cycleMs;
+    bool staticBelt = false;    ///< true使用StaticLightBelt（仅defaultConfigs中的LED布局，其他布局仍用LightBelt）
+    uint8_t ledPins = 0;        ///< 灯带数据引脚数，层数平均分段并行输出；0或1为单引脚
+};
+
+/**
+ * @brief 一帧的开销：宿主机CPU时间和总线计数增量
+ */
+struct FrameCost {
+    uint64_t hostNanos;
+    sim::BusCounters bus;
+};
+
+/**
+ * @brief 各输出通道的估算占用时间（微秒）
+ */
+struct WireTime {
+    uint32_t ledMicros;
+    uint32_t i2cMicros;
+    uint32_t ledcMicros;
+};
+
+/**
+ * @brief 按固件时序分别估算各总线的占用时间
+ * @details WS2812每字节10us（800kHz）加每次show的复位时间，I2C每字节9位，LEDC写入按寄存器访问计
+ */
+WireTime estimateWireTime(const sim::BusCounters& bus, uint32_t i2cClock = 100000);
+
+/**
+ * @brief 按固件时序估算总线占用时间（微秒），即estimateWireTime()各项之和
+ */
+uint32_t estimateWireMicros(const sim::BusCounters& bus, uint32_t i2cClock = 100000);
+
+/**
+ * @brief 模拟设备：按配置组装灯带、舵机平台和控制器，逐帧驱动并统计开销
+ * @details 每个Rig构造时复位模拟时钟和计数器，同一时刻只能存在一个Rig。
+ */
+class Rig {
+public:
+    explicit Rig(const RigConfig& config);
+    ~Rig();
+
+    /**
+     * @brief 通过对应的串口/蓝牙发送一行命令（不需要换行符）
+     */
+    void command(const char* line);
+
+    /**
+     * @brief 写入原始字节，不追加换行，用于模糊测试
+     */
+    void feedRaw(const uint8_t* data, size_t length);
+
+    /**
+     * @brief 运行一次控制器update()，再推进模拟时钟
+     * @param stepMs 推进的毫秒数，对应main.cpp主循环中的delay
+     */
+    FrameCost step(uint32_t stepMs = 10);
+
+    /**
+     * @brief 连续运行若干帧，不统计
+     */
+    void run(uint32_t frames, uint32_t stepMs = 10);
+
+    /**
+     * @brief 运行一次控制器update()，再按空闲调速等待（与main.cpp的loop()相同）
+     */
+    FrameCost stepGoverned();
+
+    /**
+     * @brief 从复位到第一帧输出完成的估算时间（微秒）
+     * @details 与main.cpp的setup()顺序一致，为模拟时钟经过的延时加上启动期间的总线占用时间
+     */
+    uint32_t getBootMicros() const { return bootMicros; }
+
+    LightBelt& getBelt() { return *belt; }
+    const OutputLatch& getOutputLatch() const;
+    const IdleGovernor& getIdleGovernor() const;
+
+    /**
+     * @brief 控制器的多速率调度统计
+     */
+    const Scheduler& getScheduler() const;
+
+    /**
+     * @brief 串口像素流的接收统计，蓝牙控制时为NULL
+     */
+    const PixelStream* getPixelStream() const;
+
+    /**
+     * @brief 把网络像素接收器交给控制器，之后可以用Network命令切换到该模式
+     */
+    void setPixelReceiver(PixelReceiver* receiver);
+    uint8_t getServoChannels() const { return config.servoLayers * 2; }
+    const RigConfig& getConfig() const { return config; }
+
+private:
+    RigConfig config;
+    LightBelt* belt;
+    ServoPlatform* pca;
+    ServoPlatformInter* ledc;
+    SerialController* serial;
+    BluetoothController* bluetooth;
+    uint32_t bootMicros;
+};
+
+/**
+ * @brief 一种被测模式：进入模式所需的命令序列
+ */
+struct Scenario {
+    const char* name;
+    std::vector<std::string> setup;
+};
+
+/**
+ * @brief 覆盖全部预设和控制模式的场景列表
+ * @param assetDir 存放演出文件等资源的目录（作为SPIFFS根目录）
+ */
+std::vector<Scenario> defaultScenarios(const char* assetDir);
+
+/**
+ * @brief 默认的层数/LED数/舵机层数组合，第二项为main.cpp中的实际配置
+ */
+std::vector<RigConfig> defaultConfigs(bool bluetooth, bool internalPWM);
+
+#endif
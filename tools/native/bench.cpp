@@ -0,0 +1,132 @@
+/**
+ * @file bench.cpp
+ * @brief 帧开销微基准：每种控制器、舵机驱动、层数/LED数组合下各模式的每帧CPU时间和总线开销
+ */
+
+#include <algorithm>
+#include "Rig.h"
+#include "NativeTools.h"
+
+struct BenchResult {
+    double meanMicros;
+    double p99Micros;
+    double maxMicros;
+    double showsPerFrame;
+    double ledBytesPerFrame;
+    double i2cBytesPerFrame;
+    double ledcWritesPerFrame;
+    double txBytesPerFrame;
+    double wireMicrosPerFrame;
+};
+
+static BenchResult benchScenario(const RigConfig& config, const Scenario& scenario,
+                                 uint32_t warmup, uint32_t frames) {
+    Rig rig(config);
+    for (const std::string& line : scenario.setup) {
+        rig.command(line.c_str());
+        rig.step();
+    }
+    rig.run(warmup);
+
+    std::vector<double> samples;
+    samples.reserve(frames);
+    sim::BusCounters total;
+    memset(&total, 0, sizeof(total));
+
+    for (uint32_t i = 0; i < frames; i++) {
+        FrameCost cost = rig.step();
+        samples.push_back(cost.hostNanos / 1000.0);
+        total.showCalls += cost.bus.showCalls;
+        total.ledBytes += cost.bus.ledBytes;
+        total.i2cTransactions += cost.bus.i2cTransactions;
+        total.i2cBytes += cost.bus.i2cBytes;
+        total.ledcWrites += cost.bus.ledcWrites;
+        total.serialBytes += cost.bus.serialBytes;
+        total.bluetoothBytes += cost.bus.bluetoothBytes;
+    }
+
+    BenchResult result;
+    double sum = 0;
+    for (double s : samples) sum += s;
+    std::sort(samples.begin(), samples.end());
+    result.meanMicros = sum / frames;
+    result.p99Micros = samples[(size_t)(frames * 0.99)];
+    result.maxMicros = samples.back();
+    result.showsPerFrame = (double)total.showCalls / frames;
+    result.ledBytesPerFrame = (double)total.ledBytes / frames;
+    result.i2cBytesPerFrame = (double)total.i2cBytes / frames;
+    result.ledcWritesPerFrame = (double)total.ledcWrites / frames;
+    result.txBytesPerFrame = (double)(total.serialBytes + total.bluetoothBytes) / frames;
+    result.wireMicrosPerFrame = (double)estimateWireMicros(total) / frames;
+    return result;
+}
+
+int benchMain(int argc, char** argv) {
+    bool csv = false;
+    uint32_t frames = 500;
+    const char* modeFilter = NULL;
+    const char* assetDir = "/tmp";
+    bool staticBelt = false;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[i], "--static") == 0) {
+            staticBelt = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            modeFilter = argv[++i];
+        } else if (strcmp(argv[i], "--assets") == 0 && i + 1 < argc) {
+            assetDir = argv[++i];
+        } else {
+            fprintf(stderr, "usage: lightbelt_native bench [--csv] [--static] [--frames N] [--mode NAME] [--assets DIR]\n");
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    std::vector<Scenario> scenarios = defaultScenarios(assetDir);
+
+    if (csv) {
+        printf("controller,servo,layers,leds_per_layer,servo_layers,mode,"
+               "mean_us,p99_us,max_us,show_per_frame,led_bytes,i2c_bytes,ledc_writes,tx_bytes,wire_us\n");
+    } else {
+        printf("CPU time is host time; bus columns are per frame (10 ms loop step).\n");
+        printf("%-9s %-5s %-9s %-9s %8s %8s %8s %6s %8s %7s %6s %6s %8s\n",
+               "ctrl", "servo", "layout", "mode", "mean_us", "p99_us", "max_us",
+               "show", "led_B", "i2c_B", "ledc", "tx_B", "wire_us");
+    }
+
+    for (int controller = 0; controller < 2; controller++) {
+        for (int platform = 0; platform < 2; platform++) {
+            for (RigConfig config : defaultConfigs(controller == 1, platform == 1)) {
+                config.staticBelt = staticBelt;
+                for (const Scenario& scenario : scenarios) {
+                    if (modeFilter && strcmp(modeFilter, scenario.name) != 0) continue;
+
+                    BenchResult r = benchScenario(config, scenario, 50, frames);
+                    const char* ctrl = controller ? "Bluetooth" : "Serial";
+                    const char* servo = platform ? "LEDC" : "PCA";
+
+                    if (csv) {
+                        printf("%s,%s,%u,%u,%u,%s,%.2f,%.2f,%.2f,%.3f,%.1f,%.1f,%.2f,%.1f,%.1f\n",
+                               ctrl, servo, config.ledLayers, config.ledsPerLayer, config.servoLayers,
+                               scenario.name, r.meanMicros, r.p99Micros, r.maxMicros, r.showsPerFrame,
+                               r.ledBytesPerFrame, r.i2cBytesPerFrame, r.ledcWritesPerFrame,
+                               r.txBytesPerFrame, r.wireMicrosPerFrame);
+                    } else {
+                        char layout[16];
+                        snprintf(layout, sizeof(layout), "%ux%u/%u",
+                                 config.ledLayers, config.ledsPerLayer, config.servoLayers);
+                        printf("%-9s %-5s %-9s %-9s %8.1f %8.1f %8.1f %6.2f %8.0f %7.1f %6.1f %6.1f %8.0f\n",
+                               ctrl, servo, layout, scenario.name, r.meanMicros, r.p99Micros, r.maxMicros,
+                               r.showsPerFrame, r.ledBytesPerFrame, r.i2cBytesPerFrame,
+                               r.ledcWritesPerFrame, r.txBytesPerFrame, r.wireMicrosPerFrame);
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,621 @@
+/**
+ * @file dmx.cpp
+ * @brief 网络像素接收：按控台的发包方式把E1.31/Art-Net数据包交给PixelReceiver，在Network模式下逐帧核对输出
+ *
+ * @details 默认布局（12层×33 LED、6层舵机）占用3个像素universe和1个舵机universe。每个场景按--fps在模拟时间上
+ * 逐帧发送一组数据包，开启总线计时（sim::setBusTiming），主循环与stream相同等到下一个任务到期。
+ * 每次灯带输出后把灯带缓冲区与最近一个完整帧的期望画面（GRB，按输出亮度缩放）比较，并核对舵机设定值，
+ * 不一致计入错误；Network统计中的乱序包、无效包数与场景注入的数量不符同样判为失败。
+ *
+ * --loopback时每个数据包经127.0.0.1上的UDP套接字收发后再交给handlePacket()。
+ * --capture回放pcap抓包（以太网、Linux cooked或BSD loopback链路，IPv4 UDP 5568和6454端口），按抓包时间戳送入，
+ * 只统计不核对画面；--save把--scenario指定的场景（默认第一个）生成的数据包写成pcap，可用tcpreplay等工具在真机上重放。
+ */
+
+#include <math.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include "Rig.h"
+#include "NativeTools.h"
+#include "PixelReceiver.h"
+
+/**
+ * @brief 一种发送方式
+ */
+struct DmxScenario {
+    const char* name;
+    bool artnet;        ///< Art-Net，否则为E1.31
+    bool sync;          ///< 每帧最后发送同步包
+    bool reorder;       ///< universe逆序到达，中间夹一个上一帧的像素包（序号回退）
+    bool foreign;       ///< 每帧夹杂范围外的universe和损坏的包
+};
+
+static const DmxScenario SCENARIOS[] = {
+    {"sACN+sync", false, true, false, false},
+    {"sACN", false, false, false, false},
+    {"ArtNet+sync", true, true, false, false},
+    {"ArtNet", true, false, false, false},
+    {"Reorder", false, false, true, false},
+    {"Foreign", false, true, false, true},
+};
+
+// 网络控制的目标：整条灯带至少40帧/秒
+static const uint32_t TARGET_FPS = 40;
+// 每帧注入的损坏包数，见framePackets()
+static const uint32_t MALFORMED_PER_FRAME = 5;
+static const uint16_t SYNC_ADDRESS = 7962;
+
+/**
+ * @brief 带发送时刻的UDP负载
+ */
+struct TimedPacket {
+    uint64_t micros;
+    uint16_t port;
+    std::string data;
+};
+
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    put16(p, v >> 16);
+    put16(p + 2, v & 0xFFFF);
+}
+
+static void e131Preamble(uint8_t* b, uint16_t total, uint32_t rootVector, uint32_t frameVector) {
+    static const uint8_t ACN_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    put16(b, 0x0010);
+    memcpy(b + 4, ACN_ID, 12);
+    put16(b + 16, 0x7000 | (total - 16));
+    put32(b + 18, rootVector);
+    memset(b + 22, 0x4C, 16);   // CID
+    put16(b + 38, 0x7000 | (total - 38));
+    put32(b + 40, frameVector);
+}
+
+static std::string e131Data(uint16_t universe, uint8_t sequence, const uint8_t* data, uint16_t length) {
+    std::string packet(126 + length, '\0');
+    uint8_t* b = (uint8_t*)&packet[0];
+    e131Preamble(b, packet.size(), 0x00000004, 0x00000002);
+    strcpy((char*)b + 44, "lightbelt_native");
+    b[108] = 100;               // 优先级
+    put16(b + 109, SYNC_ADDRESS);
+    b[111] = sequence;
+    put16(b + 113, universe);
+    put16(b + 115, 0x7000 | (packet.size() - 115));
+    b[117] = 0x02;
+    b[118] = 0xA1;
+    put16(b + 121, 1);
+    put16(b + 123, length + 1);
+    memcpy(b + 126, data, length);
+    return packet;
+}
+
+static std::string e131Sync(uint8_t sequence) {
+    std::string packet(49, '\0');
+    uint8_t* b = (uint8_t*)&packet[0];
+    e131Preamble(b, packet.size(), 0x00000008, 0x00000001);
+    b[44] = sequence;
+    put16(b + 45, SYNC_ADDRESS);
+    return packet;
+}
+
+static std::string artnetHeader(uint16_t opcode) {
+    std::string packet("Art-Net\0", 8);
+    packet += (char)(opcode & 0xFF);
+    packet += (char)(opcode >> 8);
+    packet += (char)0;
+    packet += (char)14;         // 协议版本
+    return packet;
+}
+
+static std::string artnetDmx(uint16_t universe, uint8_t sequence, const uint8_t* data, uint16_t length) {
+    std::string packet = artnetHeader(0x5000);
+    packet += (char)sequence;
+    packet += (char)0;
+    packet += (char)(universe & 0xFF);
+    packet += (char)((universe >> 8) & 0x7F);
+    packet += (char)(length >> 8);
+    packet += (char)(length & 0xFF);
+    packet.append((const char*)data, length);
+    return packet;
+}
+
+static std::string artnetSync() {
+    return artnetHeader(0x5200) + std::string(2, '\0');
+}
+
+/**
+ * @brief 第frame帧的画面：彩虹沿灯带滚动，舵机为相位错开的正弦
+ */
+static void renderFrame(uint32_t frame, uint16_t leds, uint8_t servoLayers, uint8_t* rgb, uint16_t* servo) {
+    for (uint16_t i = 0; i < leds; i++) {
+        uint8_t hue = i * 2 + frame * 5;
+        uint8_t sector = hue / 43;
+        uint8_t f = (hue - sector * 43) * 6;
+        const uint8_t table[6][3] = {{255, f, 0}, {(uint8_t)(255 - f), 255, 0}, {0, 255, f},
+                                     {0, (uint8_t)(255 - f), 255}, {f, 0, 255}, {255, 0, (uint8_t)(255 - f)}};
+        memcpy(rgb + i * 3, table[sector % 6], 3);
+    }
+    for (uint8_t layer = 0; layer < servoLayers; layer++) {
+        servo[layer] = 32768 + (int)(32000 * sin((frame + layer * 10) * 2 * M_PI / 100));
+    }
+}
+
+/**
+ * @brief 一帧要发送的全部数据包，返回其中序号回退的包数
+ */
+static uint32_t framePackets(const DmxScenario& scenario, uint32_t frame, uint16_t firstUniverse, uint16_t leds,
+                             const uint8_t* rgb, const uint8_t* previousRgb, const uint16_t* servo,
+                             uint8_t servoLayers, std::vector<TimedPacket>& out) {
+    uint8_t pixelUniverses = (leds + PixelReceiver::PIXELS_PER_UNIVERSE - 1) / PixelReceiver::PIXELS_PER_UNIVERSE;
+    uint16_t port = scenario.artnet ? ARTNET_PORT : E131_PORT;
+    // 0表示发送方未启用序号，按E1.31的习惯从1开始循环
+    uint8_t sequence = frame % 255 + 1;
+    uint8_t previousSequence = (frame + 254) % 255 + 1;
+
+    uint8_t servoData[PixelReceiver::MAX_SERVO_LAYERS * 2];
+    for (uint8_t layer = 0; layer < servoLayers; layer++) {
+        put16(servoData + layer * 2, servo[layer]);
+    }
+
+    std::vector<std::string> universes;
+    for (uint8_t u = 0; u <= pixelUniverses; u++) {
+        const uint8_t* data;
+        uint16_t length;
+        if (u < pixelUniverses) {
+            uint16_t first = u * PixelReceiver::PIXELS_PER_UNIVERSE;
+            data = rgb + first * 3;
+            length = std::min<uint16_t>(PixelReceiver::PIXELS_PER_UNIVERSE, leds - first) * 3;
+        } else {
+            data = servoData;
+            length = servoLayers * 2;
+        }
+        universes.push_back(scenario.artnet ? artnetDmx(firstUniverse + u, sequence, data, length)
+                                            : e131Data(firstUniverse + u, sequence, data, length));
+    }
+
+    uint32_t stale = 0;
+    if (scenario.reorder) {
+        std::reverse(universes.begin(), universes.end());
+        if (frame > 0) {
+            // 网络中滞留的上一帧第一个像素universe
+            uint16_t length = PixelReceiver::PIXELS_PER_UNIVERSE * 3;
+            universes.insert(universes.begin() + 1, e131Data(firstUniverse, previousSequence, previousRgb, length));
+            stale++;
+        }
+    }
+    if (scenario.foreign) {
+        // 其他设备的universe：应当被忽略，不计入无效包
+        const uint16_t others[] = {(uint16_t)(firstUniverse - 1), (uint16_t)(firstUniverse + pixelUniverses + 1),
+                                   (uint16_t)(firstUniverse + 32), (uint16_t)(firstUniverse + 255), 63999};
+        for (uint16_t universe : others) {
+            universes.push_back(e131Data(universe, sequence, rgb, 510));
+        }
+        // 损坏的包：截断、通道数超出负载、预览数据、Art-Net长度超出负载、无法识别
+        std::string truncated = universes[0].substr(0, 100);
+        std::string overlong = universes[0];
+        put16((uint8_t*)&overlong[123], overlong.size());
+        std::string preview = universes[0];
+        preview[112] = 0x40;
+        std::string artnet = artnetDmx(firstUniverse, sequence, rgb, 510);
+        artnet.resize(200);
+        std::string garbage(20, '\x5A');
+        const std::string malformed[MALFORMED_PER_FRAME] = {truncated, overlong, preview, artnet, garbage};
+        for (uint32_t i = 0; i < MALFORMED_PER_FRAME; i++) {
+            universes.insert(universes.begin() + 1 + i * 2, malformed[i]);
+        }
+    }
+    if (scenario.sync) {
+        universes.push_back(scenario.artnet ? artnetSync() : e131Sync(sequence));
+    }
+
+    for (const std::string& data : universes) {
+        TimedPacket packet;
+        packet.micros = 0;
+        packet.port = data.compare(0, 8, std::string("Art-Net\0", 8)) == 0 ? ARTNET_PORT : port;
+        packet.data = data;
+        out.push_back(packet);
+    }
+    return stale;
+}
+
+/**
+ * @brief 经本机UDP套接字收发数据包
+ */
+class Loopback {
+public:
+    Loopback() : fd(-1) {}
+    ~Loopback() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool open() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) return false;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        return bind(fd, (sockaddr*)&address, sizeof(address)) == 0 &&
+               getsockname(fd, (sockaddr*)&address, &length) == 0;
+    }
+
+    /**
+     * @brief 发送一个数据包并收回，返回收到的负载，丢失时为空
+     */
+    std::string roundTrip(const std::string& data) {
+        if (sendto(fd, data.data(), data.size(), 0, (sockaddr*)&address, sizeof(address)) < 0) return "";
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) return "";
+        uint8_t buffer[2048];
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        return n > 0 ? std::string((const char*)buffer, n) : "";
+    }
+
+private:
+    int fd;
+    sockaddr_in address;
+};
+
+/**
+ * @brief 把Print的输出收集到字符串，用于读取Network统计行
+ */
+class StringPrint : public Print {
+public:
+    std::string text;
+    size_t write(uint8_t c) override {
+        text += (char)c;
+        return 1;
+    }
+};
+
+struct NetworkStats {
+    unsigned packets, frames, dropped, sequenceErrors, invalid;
+};
+
+static NetworkStats networkStats(const PixelReceiver& receiver) {
+    StringPrint out;
+    receiver.report(out);
+    NetworkStats stats = NetworkStats();
+    sscanf(out.text.c_str(), "Network|%u|%u|%u|%u|%u", &stats.packets, &stats.frames, &stats.dropped,
+           &stats.sequenceErrors, &stats.invalid);
+    return stats;
+}
+
+/**
+ * @brief 灯带缓冲区和舵机设定值是否等于期望的一帧
+ */
+static bool matches(LightBelt& belt, const PixelReceiver& receiver, const uint8_t* rgb, const uint16_t* servo,
+                    uint8_t servoLayers) {
+    uint16_t scale = belt.getOutputBrightness() + 1;
+    const uint8_t* pixels = belt.getPixelBuffer();
+    for (uint16_t i = 0; i < belt.getLedCount(); i++) {
+        if (pixels[i * 3] != ((rgb[i * 3 + 1] * scale) >> 8) || pixels[i * 3 + 1] != ((rgb[i * 3] * scale) >> 8) ||
+            pixels[i * 3 + 2] != ((rgb[i * 3 + 2] * scale) >> 8)) {
+            return false;
+        }
+    }
+    for (uint8_t layer = 0; layer < servoLayers; layer++) {
+        int value;
+        if (!receiver.getServoValue(layer, value) || value != servo[layer] >> 6) return false;
+    }
+    return true;
+}
+
+struct DmxResult {
+    uint32_t sentFrames;
+    uint32_t shownFrames;
+    uint32_t errors;
+    uint32_t lost;              ///< 经本机UDP收发时丢失的包
+    uint32_t expectedStale;
+    uint32_t expectedInvalid;
+    double seconds;
+    NetworkStats stats;
+};
+
+/**
+ * @brief 在Network模式下按时刻送入数据包并运行主循环
+ * @param packets 按时刻排序的数据包，frameEnds[k]为第k帧最后一个包之后的下标
+ * @param frames 每帧的期望画面，为空时不核对
+ */
+static DmxResult replay(const std::vector<TimedPacket>& packets, const std::vector<size_t>& frameEnds,
+                        const std::vector<std::vector<uint8_t> >& frames,
+                        const std::vector<std::vector<uint16_t> >& servoFrames, uint64_t duration,
+                        Loopback* loopback) {
+    RigConfig config = {false, false, 12, 33, 6, 5000};
+    Rig rig(config);
+    LightBelt& belt = rig.getBelt();
+    PixelReceiver receiver(&belt, config.servoLayers);
+    rig.setPixelReceiver(&receiver);
+    rig.command("Network");
+    for (int i = 0; i < 20; i++) rig.stepGoverned();
+
+    sim::setOutputCapture(true);
+    sim::setBusTiming(true);
+    DmxResult result = DmxResult();
+    uint64_t start = sim::nowMicros();
+    size_t next = 0;
+    size_t frame = 0;
+    int64_t completed = -1;     // 最近一个全部数据包已送入的帧
+    uint32_t showCalls = sim::counters().showCalls;
+    while (sim::nowMicros() < start + duration) {
+        while (next < packets.size() && start + packets[next].micros <= sim::nowMicros()) {
+            const std::string* data = &packets[next].data;
+            std::string received;
+            if (loopback) {
+                received = loopback->roundTrip(*data);
+                if (received.empty()) result.lost++;
+                data = &received;
+            }
+            if (!data->empty()) receiver.handlePacket((const uint8_t*)data->data(), data->size());
+            next++;
+            if (frame < frameEnds.size() && next == frameEnds[frame]) {
+                completed = frame++;
+                result.sentFrames++;
+            }
+        }
+
+        rig.step(0);
+        sim::takeOutput();
+        // Network模式只在present()输出新帧时刷新灯带
+        if (sim::counters().showCalls != showCalls) {
+            result.shownFrames++;
+            if (!frames.empty() && (completed < 0 || !matches(belt, receiver, &frames[completed][0],
+                                                                &servoFrames[completed][0], config.servoLayers))) {
+                result.errors++;
+            }
+        }
+        showCalls = sim::counters().showCalls;
+
+        uint64_t wake = sim::nowMicros() + rig.getScheduler().untilNext(micros());
+        if (next < packets.size()) wake = std::min(wake, start + packets[next].micros);
+        if (wake > sim::nowMicros()) sim::advanceMicros(wake - sim::nowMicros());
+    }
+    sim::setBusTiming(false);
+    sim::setOutputCapture(false);
+
+    result.seconds = (sim::nowMicros() - start) / 1e6;
+    result.stats = networkStats(receiver);
+    return result;
+}
+
+/**
+ * @brief 读取pcap中发往E1.31/Art-Net端口的UDP负载
+ */
+static bool readPcap(const char* path, std::vector<TimedPacket>& packets) {
+    FILE* in = fopen(path, "rb");
+    if (!in) return false;
+    uint8_t header[24];
+    if (fread(header, 1, sizeof(header), in) != sizeof(header)) {
+        fclose(in);
+        return false;
+    }
+    uint32_t magic = header[0] | header[1] << 8 | header[2] << 16 | (uint32_t)header[3] << 24;
+    bool swapped = magic == 0xD4C3B2A1 || magic == 0x4D3CB2A1;
+    bool nanos = magic == 0xA1B23C4D || magic == 0x4D3CB2A1;
+    if (!swapped && magic != 0xA1B2C3D4 && !nanos) {
+        fclose(in);
+        return false;
+    }
+    auto read32 = [swapped](const uint8_t* p) {
+        return swapped ? ((uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3])
+                       : (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+    };
+    uint32_t linkType = read32(header + 20);
+
+    uint64_t first = 0;
+    uint8_t record[16];
+    std::vector<uint8_t> frame;
+    while (fread(record, 1, sizeof(record), in) == sizeof(record)) {
+        uint64_t micros = read32(record) * 1000000ULL + read32(record + 4) / (nanos ? 1000 : 1);
+        uint32_t length = read32(record + 8);
+        if (length > 65535) break;
+        frame.resize(length);
+        if (fread(frame.data(), 1, length, in) != length) break;
+
+        // 链路层到IPv4头
+        size_t ip;
+        if (linkType == 1 && length >= 14) {
+            ip = 14;
+            uint16_t etherType = frame[12] << 8 | frame[13];
+            if (etherType == 0x8100 && length >= 18) {
+                etherType = frame[16] << 8 | frame[17];
+                ip = 18;
+            }
+            if (etherType != 0x0800) continue;
+        } else if (linkType == 113 && length >= 16) {
+            if ((frame[14] << 8 | frame[15]) != 0x0800) continue;
+            ip = 16;
+        } else if (linkType == 0 && length >= 4) {
+            ip = 4;
+        } else {
+            continue;
+        }
+        if (length < ip + 20 || (frame[ip] >> 4) != 4 || frame[ip + 9] != 17) continue;
+        // 只取未分片的包
+        if ((frame[ip + 6] & 0x3F) != 0 || frame[ip + 7] != 0) continue;
+        size_t udp = ip + (frame[ip] & 0x0F) * 4;
+        if (length < udp + 8) continue;
+        uint16_t port = frame[udp + 2] << 8 | frame[udp + 3];
+        uint16_t udpLength = frame[udp + 4] << 8 | frame[udp + 5];
+        if ((port != E131_PORT && port != ARTNET_PORT) || udpLength < 8 || udp + udpLength > length) continue;
+
+        if (packets.empty()) first = micros;
+        TimedPacket packet;
+        packet.micros = micros - first;
+        packet.port = port;
+        packet.data.assign((const char*)&frame[udp + 8], udpLength - 8);
+        packets.push_back(packet);
+    }
+    fclose(in);
+    return true;
+}
+
+/**
+ * @brief 把数据包写成以太网链路的pcap，源地址192.168.1.10，目的地址192.168.1.20
+ */
+static bool writePcap(const char* path, const std::vector<TimedPacket>& packets) {
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+    auto write32 = [out](uint32_t v) {
+        uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+        fwrite(b, 1, 4, out);
+    };
+    write32(0xA1B2C3D4);
+    write32(2 | 4 << 16);       // 版本2.4
+    write32(0);
+    write32(0);
+    write32(65535);
+    write32(1);                 // 以太网
+
+    for (const TimedPacket& packet : packets) {
+        uint16_t udpLength = 8 + packet.data.size();
+        uint16_t ipLength = 20 + udpLength;
+        uint8_t frame[42] = {0x02, 0, 0, 0, 0, 0x20, 0x02, 0, 0, 0, 0, 0x10, 0x08, 0x00};
+        uint8_t* ip = frame + 14;
+        ip[0] = 0x45;
+        put16(ip + 2, ipLength);
+        ip[8] = 64;
+        ip[9] = 17;
+        const uint8_t addresses[8] = {192, 168, 1, 10, 192, 168, 1, 20};
+        memcpy(ip + 12, addresses, 8);
+        uint32_t sum = 0;
+        for (int i = 0; i < 20; i += 2) sum += ip[i] << 8 | ip[i + 1];
+        while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+        put16(ip + 10, ~sum);
+        uint8_t* udp = ip + 20;
+        put16(udp, packet.port);
+        put16(udp + 2, packet.port);
+        put16(udp + 4, udpLength);
+
+        write32(packet.micros / 1000000);
+        write32(packet.micros % 1000000);
+        write32(14 + ipLength);
+        write32(14 + ipLength);
+        fwrite(frame, 1, sizeof(frame), out);
+        fwrite(packet.data.data(), 1, packet.data.size(), out);
+    }
+    return fclose(out) == 0;
+}
+
+int dmxMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native dmx [--seconds N] [--fps N] [--scenario NAME] [--loopback] [--save FILE.pcap]\n"
+        "       lightbelt_native dmx --capture FILE.pcap [--loopback]\n";
+    uint32_t seconds = 5;
+    uint32_t fps = 44;
+    const char* onlyScenario = NULL;
+    const char* capturePath = NULL;
+    const char* savePath = NULL;
+    bool useLoopback = false;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--fps") == 0 && hasValue) {
+            fps = std::min(std::max(1, atoi(argv[++i])), 1000);
+        } else if (strcmp(argv[i], "--scenario") == 0 && hasValue) {
+            onlyScenario = argv[++i];
+        } else if (strcmp(argv[i], "--capture") == 0 && hasValue) {
+            capturePath = argv[++i];
+        } else if (strcmp(argv[i], "--save") == 0 && hasValue) {
+            savePath = argv[++i];
+        } else if (strcmp(argv[i], "--loopback") == 0) {
+            useLoopback = true;
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    Loopback loopback;
+    if (useLoopback && !loopback.open()) {
+        fprintf(stderr, "cannot open UDP socket on 127.0.0.1\n");
+        return 1;
+    }
+    sim::setConsoleEcho(false);
+
+    if (capturePath) {
+        std::vector<TimedPacket> packets;
+        if (!readPcap(capturePath, packets)) {
+            fprintf(stderr, "cannot read pcap %s\n", capturePath);
+            return 1;
+        }
+        if (packets.empty()) {
+            fprintf(stderr, "no E1.31/Art-Net packets in %s\n", capturePath);
+            return 1;
+        }
+        uint64_t duration = packets.back().micros + 100000;
+        DmxResult result = replay(packets, std::vector<size_t>(), std::vector<std::vector<uint8_t> >(),
+                                  std::vector<std::vector<uint16_t> >(), duration, useLoopback ? &loopback : NULL);
+        printf("%zu packets over %.2f s%s\n", packets.size(), result.seconds, useLoopback ? " via loopback" : "");
+        printf("Network|%u|%u|%u|%u|%u\n", result.stats.packets, result.stats.frames, result.stats.dropped,
+               result.stats.sequenceErrors, result.stats.invalid);
+        printf("frames %.1f/s, shown %.1f/s, lost %u\n", result.stats.frames / result.seconds,
+               result.shownFrames / result.seconds, result.lost);
+        return result.lost ? 1 : 0;
+    }
+
+    const uint16_t leds = 12 * 33;
+    const uint8_t servoLayers = 6;
+    printf("12x33 LEDs (%u universes + servo universe from %u), host at %u fps%s; bus timing on.\n",
+           (leds + PixelReceiver::PIXELS_PER_UNIVERSE - 1) / PixelReceiver::PIXELS_PER_UNIVERSE, DMX_START_UNIVERSE,
+           fps, useLoopback ? ", via UDP loopback" : "");
+    printf("Each scenario must show every frame intact at %u fps or more.\n", std::min(fps, TARGET_FPS));
+    printf("%-12s %8s %8s %8s %8s %8s %8s %8s\n", "scenario", "pkts/s", "sent/s", "shown/s", "dropped", "seq_err",
+           "invalid", "errors");
+
+    int failures = 0;
+    bool saved = false;
+    for (const DmxScenario& scenario : SCENARIOS) {
+        if (onlyScenario && strcmp(onlyScenario, scenario.name) != 0) continue;
+
+        std::vector<TimedPacket> packets;
+        std::vector<size_t> frameEnds;
+        std::vector<std::vector<uint8_t> > frames;
+        std::vector<std::vector<uint16_t> > servoFrames;
+        uint32_t frameCount = seconds * fps;
+        uint32_t expectedStale = 0;
+        for (uint32_t k = 0; k < frameCount; k++) {
+            frames.push_back(std::vector<uint8_t>(leds * 3));
+            servoFrames.push_back(std::vector<uint16_t>(servoLayers));
+            renderFrame(k, leds, servoLayers, &frames[k][0], &servoFrames[k][0]);
+            size_t begin = packets.size();
+            const uint8_t* previous = k > 0 ? &frames[k - 1][0] : NULL;
+            expectedStale += framePackets(scenario, k, DMX_START_UNIVERSE, leds, &frames[k][0], previous,
+                                          &servoFrames[k][0], servoLayers, packets);
+            for (size_t i = begin; i < packets.size(); i++) {
+                packets[i].micros = (uint64_t)k * 1000000 / fps;
+            }
+            frameEnds.push_back(packets.size());
+        }
+
+        if (savePath && !saved) {
+            if (!writePcap(savePath, packets)) {
+                fprintf(stderr, "cannot write %s\n", savePath);
+                return 1;
+            }
+            saved = true;
+        }
+
+        DmxResult result = replay(packets, frameEnds, frames, servoFrames, seconds * 1000000ULL,
+                                  useLoopback ? &loopback : NULL);
+        uint32_t expectedInvalid = scenario.foreign ? result.sentFrames * MALFORMED_PER_FRAME : 0;
+        // 发送帧率超过灯带刷新能力时多出的帧计入丢帧，只要求达到目标帧率
+        double required = std::min(fps, TARGET_FPS) * 0.95;
+        bool ok = result.errors == 0 && result.lost == 0 && result.stats.sequenceErrors == expectedStale &&
+                  result.stats.invalid == expectedInvalid && result.shownFrames / result.seconds >= required;
+        printf("%-12s %8.0f %8.1f %8.1f %8u %8u %8u %8u%s\n", scenario.name, result.stats.packets / result.seconds,
+               result.sentFrames / result.seconds, result.shownFrames / result.seconds, result.stats.dropped,
+               result.stats.sequenceErrors, result.stats.invalid, result.errors, ok ? "" : "  FAIL");
+        if (!ok) failures++;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file effect.cpp
+ * @brief 用户效果的编译和吞吐量基准
+ *
+ * @details compile：把效果源码编译为EffectVM字节码，输出可以直接逐行发送到串口或蓝牙的上传命令。
+ *
+ * bench：在指定布局下逐帧运行每个效果的像素段（LightBelt::renderEffect）和舵机段，
+ * 输出程序字节数、每像素指令数、每帧指令数（与EFFECT_VM_FRAME_BUDGET比较）和每毫秒像素数，
+ * 并以固件内置的Rainbow效果（LightBelt::rainbowCycle）作为对照。耗时为上位机时间。
+ */
+
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include "Rig.h"
+#include "NativeTools.h"
+#include "EffectCompiler.h"
+#include "EffectVM.h"
+
+static bool readFile(const std::string& path, std::string& text) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+static std::vector<std::string> listEffects(const std::string& dir) {
+    std::vector<std::string> files;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return files;
+    while (struct dirent* entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".fx") == 0) {
+            files.push_back(dir + "/" + name);
+        }
+    }
+    closedir(d);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * @brief 把编译结果装入EffectVM（与上传命令相同的路径）
+ */
+static bool loadProgram(EffectVM& vm, const std::vector<uint8_t>& program, uint8_t servoLayers, uint16_t ledCount) {
+    vm.clear();
+    for (const std::string& command : effectUploadCommands(program)) {
+        if (command.compare(0, 11, "EffectCode|") == 0 && !vm.append(command.c_str() + 11)) return false;
+    }
+    return vm.load(servoLayers, ledCount);
+}
+
+static int compileMain(int argc, char** argv) {
+    size_t maxLine = 63;
+    const char* path = NULL;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--max-line") == 0 && i + 1 < argc) {
+            maxLine = std::max(16, atoi(argv[++i]));
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: lightbelt_native effect compile FILE [--max-line N]\n");
+        return 2;
+    }
+
+    std::string source, error;
+    std::vector<uint8_t> program;
+    if (!readFile(path, source)) {
+        fprintf(stderr, "effect: cannot read %s\n", path);
+        return 1;
+    }
+    if (!compileEffect(source, program, error)) {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return 1;
+    }
+
+    for (const std::string& command : effectUploadCommands(program, maxLine)) {
+        printf("%s\n", command.c_str());
+    }
+    fprintf(stderr, "%s: %zu bytes\n", path, program.size());
+    return 0;
+}
+
+static int benchEffectsMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native effect bench [--frames N] [--layers N] [--leds N] [--servo-layers N] [FILE...]\n";
+    uint32_t frames = 500;
+    uint8_t layers = 12, leds = 33, servoLayers = 6;
+    std::vector<std::string> files;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--layers") == 0 && i + 1 < argc) {
+            layers = std::min(std::max(1, atoi(argv[++i])), 255);
+        } else if (strcmp(argv[i], "--leds") == 0 && i + 1 < argc) {
+            leds = std::min(std::max(1, atoi(argv[++i])), 255);
+        } else if (strcmp(argv[i], "--servo-layers") == 0 && i + 1 < argc) {
+            servoLayers = std::min(std::max(1, atoi(argv[++i])), LAYER_MAP_MAX_SERVO_LAYERS);
+        } else if (argv[i][0] != '-') {
+            files.push_back(argv[i]);
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+    if (files.empty()) files = listEffects("tools/native/effects");
+    if (files.empty()) {
+        fprintf(stderr, "effect: no .fx files in tools/native/effects\n");
+        return 1;
+    }
+
+    sim::reset();
+    sim::setConsoleEcho(false);
+    Palettes::begin();
+    LightBelt belt(5, layers, leds);
+    belt.begin();
+    uint16_t ledCount = belt.getLedCount();
+
+    printf("Layout %ux%u, %u servo layers; host time; budget %u instructions/frame.\n",
+           layers, leds, servoLayers, (unsigned)EFFECT_VM_FRAME_BUDGET);
+    printf("%-16s %6s %8s %10s %12s %12s\n", "effect", "bytes", "ins/px", "ins/frame", "us/frame", "pixels/ms");
+
+    // 对照：内置Rainbow效果
+    uint64_t start = sim::hostNanos();
+    for (uint32_t f = 0; f < frames; f++) {
+        sim::advanceMicros(10000);
+        belt.rainbowCycle(10000, Palettes::get(PALETTE_RAINBOW));
+    }
+    double nanos = (double)(sim::hostNanos() - start) / frames;
+    printf("%-16s %6s %8s %10s %12.1f %12.0f\n", "(rainbowCycle)", "-", "-", "-", nanos / 1000, ledCount / (nanos / 1e6));
+
+    int failures = 0;
+    for (const std::string& path : files) {
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        std::string source, error;
+        std::vector<uint8_t> program;
+        if (!readFile(path, source) || !compileEffect(source, program, error)) {
+            printf("%-16s %s\n", name.c_str(), error.empty() ? "cannot read" : error.c_str());
+            failures++;
+            continue;
+        }
+
+        EffectVM vm;
+        if (!loadProgram(vm, program, servoLayers, ledCount)) {
+            printf("%-16s rejected: %s\n", name.c_str(), vm.getError() ? vm.getError() : "code");
+            failures++;
+            continue;
+        }
+
+        uint16_t servoSize = program[1];
+        uint16_t pixelInstructions = 0;
+        EffectVM::verify(program.data() + 2 + servoSize, program.size() - 2 - servoSize, &pixelInstructions);
+
+        int32_t inputs[INPUT_COUNT] = {0};
+        inputs[INPUT_LAYERS] = servoLayers;
+        int32_t servoSum = 0;
+        start = sim::hostNanos();
+        for (uint32_t f = 0; f < frames; f++) {
+            sim::advanceMicros(10000);
+            if (vm.hasServoProgram()) {
+                inputs[INPUT_TIME] = millis();
+                for (uint8_t s = 0; s < servoLayers; s++) {
+                    inputs[INPUT_LAYER] = s;
+                    servoSum += vm.runServo(inputs);
+                }
+            }
+            belt.renderEffect(vm);
+        }
+        nanos = (double)(sim::hostNanos() - start) / frames;
+        printf("%-16s %6zu %8u %10u %12.1f %12.0f\n", name.c_str(), program.size(), pixelInstructions,
+               vm.getFrameInstructions(), nanos / 1000, ledCount / (nanos / 1e6));
+        (void)servoSum;
+    }
+    return failures ? 1 : 0;
+}
+
+int effectMain(int argc, char** argv) {
+    if (argc >= 1 && strcmp(argv[0], "compile") == 0) {
+        return compileMain(argc - 1, argv + 1);
+    }
+    if (argc >= 1 && strcmp(argv[0], "bench") == 0) {
+        return benchEffectsMain(argc - 1, argv + 1);
+    }
+    fprintf(stderr, "usage: lightbelt_native effect compile FILE [--max-line N]\n"
+                    "       lightbelt_native effect bench [--frames N] [--layers N] [--leds N] [FILE...]\n");
+    return 2;
+}
@@ -0,0 +1,6 @@
+# 一个亮点沿每层灯带循环追逐，拖尾逐渐变暗；不控制舵机
+pixel {
+    head = (t / 20 + layer * 3) % size;
+    d = (head - index + size) % size;
+    d < 8 ? rgb(255 - d * 32, 96 - d * 12, 0) : 0
+}
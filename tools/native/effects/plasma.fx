@@ -0,0 +1,10 @@
+# 逐像素的等离子效果，舵机随同一波形起伏
+servo {
+    tri8(t / 12 + layer * 43) * 4
+}
+pixel {
+    a = sin8(index * 8 + t / 6);
+    b = sin8(layer * 21 - t / 9);
+    v = (a + b) / 2;
+    rgb(sin8(v), sin8(v + 85) / 2, sin8(v + 170))
+}
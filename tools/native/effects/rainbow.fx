@@ -0,0 +1,10 @@
+# 与Rainbow模式相同的外观：各层在色轮上错开，约10秒一圈
+servo {
+    512 + (sin8(t / 20 + layer * 256 / layers) - 128) * 3
+}
+pixel {
+    x = (t / 39 + layer * 256 / layers) & 255;
+    x < 85 ? rgb(255 - x * 3, x * 3, 0) :
+    x < 170 ? rgb(0, 255 - (x - 85) * 3, (x - 85) * 3) :
+              rgb((x - 170) * 3, 0, 255 - (x - 170) * 3)
+}
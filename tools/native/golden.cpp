@@ -0,0 +1,357 @@
+/**
+ * @file golden.cpp
+ * @brief 黄金输出回归：逐帧记录灯带缓冲区和舵机输出，与保存的结果按容差比较，并检查每帧开销预算
+ *
+ * @details 黄金文件为文本格式，每个采样点一行：
+ *   F <帧号> S <舵机输出...> L <连续LED数>*<RRGGBB> ...
+ * 灯带按连续相同颜色压缩，层内颜色一致时一行只有层数个段。
+ *
+ * 预算文件budgets.txt每行一个模式：<模式> <每帧show次数> <每帧总线字节> <每帧总线时间us>，
+ * 按所有用例中单帧的最大值检查。控制器的部分状态保存在函数静态变量中，
+ * 因此每个用例在独立的子进程中运行，结果与运行顺序无关。
+ */
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <map>
+#include <algorithm>
+#include "Rig.h"
+#include "NativeTools.h"
+
+static const uint32_t GOLDEN_FRAMES = 300;      // 3秒
+static const uint32_t GOLDEN_EVERY = 10;        // 每100ms采样一次
+
+struct GoldenSample {
+    uint32_t frame;
+    std::vector<uint32_t> servo;
+    std::vector<uint32_t> pixels;   // 0xRRGGBB
+};
+
+struct GoldenBudget {
+    double showCalls;
+    double busBytes;
+    double wireMicros;
+};
+
+struct GoldenCase {
+    RigConfig config;
+    const Scenario* scenario;
+    std::string name;
+};
+
+struct GoldenOptions {
+    std::string dir;
+    int ledTolerance;
+    int servoTolerance;
+    bool staticBelt;
+};
+
+static std::vector<GoldenCase> goldenCases(const std::vector<Scenario>& scenarios, bool staticBelt) {
+    // 默认布局下两种控制器配PCA9685，再加串口配内部PWM
+    const RigConfig configs[] = {
+        {false, false, 12, 33, 6, 5000},
+        {true, false, 12, 33, 6, 5000},
+        {false, true, 12, 33, 6, 5000},
+    };
+
+    std::vector<GoldenCase> cases;
+    for (const RigConfig& config : configs) {
+        for (const Scenario& scenario : scenarios) {
+            GoldenCase c;
+            c.config = config;
+            c.config.staticBelt = staticBelt;
+            c.scenario = &scenario;
+            c.name = std::string(config.bluetooth ? "bluetooth" : "serial") +
+                     (config.internalPWM ? "_ledc_" : "_pca_") + scenario.name;
+            cases.push_back(c);
+        }
+    }
+    return cases;
+}
+
+static void runCase(const GoldenCase& c, std::vector<GoldenSample>& samples, GoldenBudget& peak) {
+    Rig rig(c.config);
+    for (const std::string& line : c.scenario->setup) {
+        rig.command(line.c_str());
+        rig.step();
+    }
+
+    peak.showCalls = peak.busBytes = peak.wireMicros = 0;
+    LightBelt& belt = rig.getBelt();
+
+    for (uint32_t f = 1; f <= GOLDEN_FRAMES; f++) {
+        FrameCost cost = rig.step();
+        peak.showCalls = std::max(peak.showCalls, (double)cost.bus.showCalls);
+        peak.busBytes = std::max(peak.busBytes, (double)(cost.bus.ledBytes + cost.bus.i2cBytes));
+        peak.wireMicros = std::max(peak.wireMicros, (double)estimateWireMicros(cost.bus));
+
+        if (f % GOLDEN_EVERY != 0) continue;
+
+        GoldenSample sample;
+        sample.frame = f;
+        for (uint8_t ch = 0; ch < rig.getServoChannels(); ch++) {
+            sample.servo.push_back(sim::servoOutput(ch));
+        }
+        const uint8_t* p = belt.getPixelBuffer();
+        for (uint16_t i = 0; i < belt.getLedCount(); i++, p += 3) {
+            sample.pixels.push_back(((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8) | p[2]);
+        }
+        samples.push_back(sample);
+    }
+}
+
+static bool writeGolden(const std::string& path, const GoldenCase& c, const std::vector<GoldenSample>& samples) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    fprintf(out, "# %s layout=%ux%u/%u frames=%u every=%u\n", c.name.c_str(),
+            c.config.ledLayers, c.config.ledsPerLayer, c.config.servoLayers, GOLDEN_FRAMES, GOLDEN_EVERY);
+
+    for (const GoldenSample& s : samples) {
+        fprintf(out, "F %u S", s.frame);
+        for (uint32_t v : s.servo) fprintf(out, " %u", v);
+        fprintf(out, " L");
+        for (size_t i = 0; i < s.pixels.size();) {
+            size_t run = 1;
+            while (i + run < s.pixels.size() && s.pixels[i + run] == s.pixels[i]) run++;
+            fprintf(out, " %zu*%06X", run, s.pixels[i]);
+            i += run;
+        }
+        fprintf(out, "\n");
+    }
+    fclose(out);
+    return true;
+}
+
+static bool readGolden(const std::string& path, std::vector<GoldenSample>& samples) {
+    FILE* in = fopen(path.c_str(), "r");
+    if (!in) return false;
+
+    char token[32];
+    GoldenSample* current = NULL;
+    char section = 0;
+
+    while (fscanf(in, "%31s", token) == 1) {
+        if (token[0] == '#') {
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF) {}
+            continue;
+        }
+        if (strcmp(token, "F") == 0) {
+            samples.push_back(GoldenSample());
+            current = &samples.back();
+            if (fscanf(in, "%u", &current->frame) != 1) break;
+            section = 0;
+        } else if (strcmp(token, "S") == 0 || strcmp(token, "L") == 0) {
+            section = token[0];
+        } else if (current && section == 'S') {
+            current->servo.push_back(strtoul(token, NULL, 10));
+        } else if (current && section == 'L') {
+            char* star;
+            unsigned long run = strtoul(token, &star, 10);
+            if (*star != '*') break;
+            current->pixels.insert(current->pixels.end(), run, strtoul(star + 1, NULL, 16));
+        }
+    }
+    fclose(in);
+    return !samples.empty();
+}
+
+static int channelDiff(uint32_t a, uint32_t b) {
+    int d = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        d = std::max(d, abs((int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF)));
+    }
+    return d;
+}
+
+/**
+ * @return 超出容差的数量，前几处差异输出到标准输出
+ */
+static uint32_t compareGolden(const std::vector<GoldenSample>& expected, const std::vector<GoldenSample>& actual,
+                              const GoldenOptions& options) {
+    uint32_t mismatches = 0;
+    const uint32_t maxReports = 5;
+
+    if (expected.size() != actual.size()) {
+        printf("    sample count %zu != %zu\n", actual.size(), expected.size());
+        return 1;
+    }
+
+    for (size_t s = 0; s < expected.size(); s++) {
+        const GoldenSample& e = expected[s];
+        const GoldenSample& a = actual[s];
+        if (e.servo.size() != a.servo.size() || e.pixels.size() != a.pixels.size()) {
+            printf("    frame %u: layout changed\n", a.frame);
+            return mismatches + 1;
+        }
+
+        for (size_t ch = 0; ch < e.servo.size(); ch++) {
+            if (abs((int)e.servo[ch] - (int)a.servo[ch]) > options.servoTolerance) {
+                if (mismatches++ < maxReports) {
+                    printf("    frame %u servo %zu: %u (expected %u)\n", a.frame, ch, a.servo[ch], e.servo[ch]);
+                }
+            }
+        }
+        for (size_t i = 0; i < e.pixels.size(); i++) {
+            if (channelDiff(e.pixels[i], a.pixels[i]) > options.ledTolerance) {
+                if (mismatches++ < maxReports) {
+                    printf("    frame %u led %zu: %06X (expected %06X)\n", a.frame, i, a.pixels[i], e.pixels[i]);
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+static std::map<std::string, GoldenBudget> readBudgets(const std::string& path) {
+    std::map<std::string, GoldenBudget> budgets;
+    FILE* in = fopen(path.c_str(), "r");
+    if (!in) return budgets;
+
+    char line[256];
+    while (fgets(line, sizeof(line), in)) {
+        char mode[32];
+        GoldenBudget b;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%31s %lf %lf %lf", mode, &b.showCalls, &b.busBytes, &b.wireMicros) == 4) {
+            budgets[mode] = b;
+        }
+    }
+    fclose(in);
+    return budgets;
+}
+
+/**
+ * @brief 在子进程中运行一个用例，通过管道返回单帧峰值开销
+ * @return 子进程退出码：0通过，1输出不一致，2无法读写黄金文件
+ */
+static int runCaseIsolated(const GoldenCase& c, const char* action, const GoldenOptions& options, GoldenBudget& peak) {
+    int fds[2];
+    if (pipe(fds) != 0) return 2;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        std::vector<GoldenSample> samples;
+        GoldenBudget measured;
+        runCase(c, samples, measured);
+        if (write(fds[1], &measured, sizeof(measured)) != (ssize_t)sizeof(measured)) _exit(2);
+
+        std::string path = options.dir + "/" + c.name + ".golden";
+        if (strcmp(action, "record") == 0) {
+            _exit(writeGolden(path, c, samples) ? 0 : 2);
+        }
+        if (strcmp(action, "check") == 0) {
+            std::vector<GoldenSample> expected;
+            if (!readGolden(path, expected)) {
+                printf("    missing %s\n", path.c_str());
+                fflush(stdout);
+                _exit(2);
+            }
+            uint32_t mismatches = compareGolden(expected, samples, options);
+            if (mismatches) printf("    %u values outside tolerance\n", mismatches);
+            fflush(stdout);
+            _exit(mismatches ? 1 : 0);
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    memset(&peak, 0, sizeof(peak));
+    bool received = read(fds[0], &peak, sizeof(peak)) == (ssize_t)sizeof(peak);
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!received || !WIFEXITED(status)) return 2;
+    return WEXITSTATUS(status);
+}
+
+int goldenMain(int argc, char** argv) {
+    const char* usage = "usage: lightbelt_native golden record|check|budgets [--dir DIR] [--led-tol N] [--servo-tol N] [--static]\n";
+    if (argc < 1) {
+        fprintf(stderr, "%s", usage);
+        return 2;
+    }
+
+    const char* action = argv[0];
+    GoldenOptions options;
+    options.dir = "tools/native/golden";
+    options.ledTolerance = 2;
+    options.servoTolerance = 2;
+    options.staticBelt = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            options.dir = argv[++i];
+        } else if (strcmp(argv[i], "--led-tol") == 0 && i + 1 < argc) {
+            options.ledTolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--servo-tol") == 0 && i + 1 < argc) {
+            options.servoTolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--static") == 0) {
+            // 用StaticLightBelt运行同样的用例，输出应与LightBelt完全一致
+            options.staticBelt = true;
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+    if (strcmp(action, "record") != 0 && strcmp(action, "check") != 0 && strcmp(action, "budgets") != 0) {
+        fprintf(stderr, "%s", usage);
+        return 2;
+    }
+
+    sim::setConsoleEcho(false);
+    std::vector<Scenario> scenarios = defaultScenarios("/tmp");
+    std::vector<GoldenCase> cases = goldenCases(scenarios, options.staticBelt);
+    std::map<std::string, GoldenBudget> budgets = readBudgets(options.dir + "/budgets.txt");
+    std::map<std::string, GoldenBudget> peaks;
+    int failures = 0;
+
+    for (const GoldenCase& c : cases) {
+        fflush(stdout);
+        GoldenBudget peak;
+        int result = runCaseIsolated(c, action, options, peak);
+
+        GoldenBudget& modePeak = peaks[c.scenario->name];
+        modePeak.showCalls = std::max(modePeak.showCalls, peak.showCalls);
+        modePeak.busBytes = std::max(modePeak.busBytes, peak.busBytes);
+        modePeak.wireMicros = std::max(modePeak.wireMicros, peak.wireMicros);
+
+        if (strcmp(action, "budgets") == 0) continue;
+
+        // 超出预算同样视为失败
+        bool overBudget = false;
+        if (strcmp(action, "check") == 0) {
+            auto it = budgets.find(c.scenario->name);
+            if (it == budgets.end()) {
+                printf("    no budget for %s\n", c.scenario->name);
+                overBudget = true;
+            } else if (peak.showCalls > it->second.showCalls || peak.busBytes > it->second.busBytes ||
+                       peak.wireMicros > it->second.wireMicros) {
+                printf("    over budget: show %.0f/%.0f, bus %.0f/%.0f B, wire %.0f/%.0f us\n",
+                       peak.showCalls, it->second.showCalls, peak.busBytes, it->second.busBytes,
+                       peak.wireMicros, it->second.wireMicros);
+                overBudget = true;
+            }
+        }
+
+        bool ok = result == 0 && !overBudget;
+        printf("%-4s %s\n", ok ? "ok" : "FAIL", c.name.c_str());
+        if (!ok) failures++;
+    }
+
+    if (strcmp(action, "budgets") == 0) {
+        // 输出当前测得的峰值，可作为budgets.txt的起点
+        printf("# mode show_per_frame bus_bytes_per_frame wire_us_per_frame\n");
+        for (const Scenario& s : scenarios) {
+            const GoldenBudget& p = peaks[s.name];
+            printf("%-9s %4.0f %7.0f %8.0f\n", s.name, p.showCalls, p.busBytes, p.wireMicros);
+        }
+        return 0;
+    }
+
+    printf("%s: %zu cases, %d failed\n", action, cases.size(), failures);
+    return failures ? 1 : 0;
+}
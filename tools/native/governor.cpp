@@ -0,0 +1,107 @@
+/**
+ * @file governor.cpp
+ * @brief 空闲调速的效果：按main.cpp的loop()逐帧运行各模式，统计帧率、各状态时间比例和估算能耗
+ *
+ * @details 开启总线计时（sim::setBusTiming），灯带和舵机输出按传输时间计入运行时间；CPU计算时间不计入。
+ * 进入模式后先运行IDLE_SLEEP_AFTER_MS加5秒，使浅睡眠条件成立，再统计--seconds秒。
+ * 蓝牙控制器额外统计没有连接时的Disconnect状态。
+ */
+
+#include "Rig.h"
+#include "NativeTools.h"
+
+struct GovernorSample {
+    uint32_t frames;
+    uint64_t active;
+    uint64_t wait;
+    uint64_t sleep;
+};
+
+static GovernorSample sampleGovernor(const IdleGovernor& governor) {
+    GovernorSample s = {governor.getFrames(), governor.getActiveMicros(), governor.getWaitMicros(),
+                        governor.getSleepMicros()};
+    return s;
+}
+
+static void runFor(Rig& rig, uint64_t micros) {
+    uint64_t end = sim::nowMicros() + micros;
+    while (sim::nowMicros() < end) {
+        rig.stepGoverned();
+    }
+}
+
+static void printRow(const char* controller, const char* mode, Rig& rig, uint32_t seconds) {
+    runFor(rig, (IDLE_SLEEP_AFTER_MS + 5000) * 1000ULL);
+    GovernorSample before = sampleGovernor(rig.getIdleGovernor());
+    runFor(rig, seconds * 1000000ULL);
+    GovernorSample after = sampleGovernor(rig.getIdleGovernor());
+
+    uint64_t active = after.active - before.active;
+    uint64_t wait = after.wait - before.wait;
+    uint64_t sleep = after.sleep - before.sleep;
+    uint64_t total = active + wait + sleep;
+    if (total == 0) total = 1;
+    printf("%-9s %-10s %7.1f %6u %7.1f %7.1f %7.1f %8.1f\n", controller, mode,
+           (after.frames - before.frames) * 1e6 / total, rig.getIdleGovernor().getIntervalMs(),
+           100.0 * active / total, 100.0 * wait / total, 100.0 * sleep / total,
+           IdleGovernor::energyPerHour(active, wait, sleep));
+}
+
+int governorMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native governor [--seconds N] [--controller serial|bluetooth] [--mode NAME] [--assets DIR]\n";
+    uint32_t seconds = 60;
+    int controllers = 3;    // 1串口，2蓝牙
+    const char* onlyMode = NULL;
+    const char* assetDir = "/tmp";
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--controller") == 0 && hasValue) {
+            controllers = strcmp(argv[++i], "bluetooth") == 0 ? 2 : 1;
+        } else if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            onlyMode = argv[++i];
+        } else if (strcmp(argv[i], "--assets") == 0 && hasValue) {
+            assetDir = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    std::vector<Scenario> scenarios = defaultScenarios(assetDir);
+
+    printf("12x33 LEDs, 6 PCA9685 servo layers; bus time counted as active, CPU time not modeled.\n");
+    printf("Energy: chip only, %s.\n", IDLE_GOVERNOR ? "governor on" : "governor off (IDLE_GOVERNOR false)");
+    printf("%-9s %-10s %7s %6s %7s %7s %7s %8s\n", "control", "mode", "fps", "int_ms", "active%", "wait%",
+           "sleep%", "mWh/h");
+
+    for (int bluetooth = 0; bluetooth < 2; bluetooth++) {
+        if (!(controllers & (1 << bluetooth))) continue;
+        const char* controller = bluetooth ? "bluetooth" : "serial";
+        RigConfig config = {bluetooth != 0, false, 12, 33, 6, 5000};
+
+        // 没有连接时为Disconnect状态
+        if (bluetooth && (!onlyMode || strcmp(onlyMode, "Disconnect") == 0)) {
+            Rig rig(config);
+            sim::setBusTiming(true);
+            printRow(controller, "Disconnect", rig, seconds);
+            sim::setBusTiming(false);
+        }
+
+        for (const Scenario& scenario : scenarios) {
+            if (onlyMode && strcmp(scenario.name, onlyMode) != 0) continue;
+            Rig rig(config);
+            for (const std::string& line : scenario.setup) {
+                rig.command(line.c_str());
+                rig.stepGoverned();
+            }
+            sim::setBusTiming(true);
+            printRow(controller, scenario.name, rig, seconds);
+            sim::setBusTiming(false);
+        }
+    }
+    return 0;
+}
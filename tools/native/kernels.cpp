@@ -0,0 +1,219 @@
+/**
+ * @file kernels.cpp
+ * @brief 像素内核基准：PixelKernels与逐像素/逐字节写法的耗时对比和结果校验
+ *
+ * @details 对每种LED数量分别测量：
+ *   fill   Adafruit_NeoPixel::setPixelColor逐像素填充 vs PixelKernels::fill
+ *   scale  逐字节(c * s) >> 8 vs PixelKernels::scale
+ *   blend  逐字节混合 vs PixelKernels::blend
+ *   add    逐字节饱和加法 vs PixelKernels::addSaturate
+ * 计时前先用随机数据在0-3字节的各种起始偏移上比较两种写法的结果，并比较fill<Count>与fill()，不一致时返回1。
+ * 耗时为上位机时间，只用于比较两种写法；设备上的差距需在ESP32上确认。
+ */
+
+#include <algorithm>
+#include <vector>
+#include "Rig.h"
+#include "NativeTools.h"
+#include "PixelKernels.h"
+
+// ---------------------------------------------------------------------------
+// 逐字节参考实现
+
+static void referenceScale(uint8_t* buf, uint16_t bytes, uint16_t scale) {
+    if (scale >= 256) return;
+    for (uint16_t i = 0; i < bytes; i++) buf[i] = (buf[i] * scale) >> 8;
+}
+
+static void referenceBlend(uint8_t* dst, const uint8_t* src, uint16_t bytes, uint16_t alpha) {
+    for (uint16_t i = 0; i < bytes; i++) dst[i] = (dst[i] * (256 - alpha) + src[i] * alpha) >> 8;
+}
+
+static void referenceAdd(uint8_t* dst, const uint8_t* src, uint16_t bytes) {
+    for (uint16_t i = 0; i < bytes; i++) dst[i] = std::min(dst[i] + src[i], 255);
+}
+
+static void randomBytes(uint8_t* p, size_t n, uint32_t& seed) {
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        p[i] = seed >> 24;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 校验
+
+/**
+ * @brief 在各种对齐组合和长度上比较内核与参考实现
+ * @return 不一致的用例数
+ */
+static int verifyKernels() {
+    int failures = 0;
+    uint32_t seed = 12345;
+    uint8_t a[256 + 8], b[256 + 8], expect[256 + 8];
+    const uint16_t factors[] = {0, 1, 77, 128, 255, 256};
+
+    for (uint8_t dstOffset = 0; dstOffset < 4; dstOffset++) {
+        for (uint8_t srcOffset = 0; srcOffset < 4; srcOffset++) {
+            for (uint16_t bytes = 0; bytes <= 256; bytes += (bytes < 16 ? 1 : 37)) {
+                uint8_t* dst = a + dstOffset;
+                uint8_t* src = b + srcOffset;
+
+                for (uint16_t factor : factors) {
+                    randomBytes(a, sizeof(a), seed);
+                    randomBytes(b, sizeof(b), seed);
+                    memcpy(expect, a, sizeof(a));
+                    referenceBlend(expect + dstOffset, src, bytes, factor);
+                    PixelKernels::blend(dst, src, bytes, factor);
+                    if (memcmp(a, expect, sizeof(a)) != 0) {
+                        printf("FAIL blend dst+%u src+%u bytes %u alpha %u\n", dstOffset, srcOffset, bytes, factor);
+                        failures++;
+                    }
+
+                    if (srcOffset == 0) {
+                        memcpy(expect, a, sizeof(a));
+                        referenceScale(expect + dstOffset, bytes, factor);
+                        PixelKernels::scale(dst, bytes, factor);
+                        if (memcmp(a, expect, sizeof(a)) != 0) {
+                            printf("FAIL scale dst+%u bytes %u scale %u\n", dstOffset, bytes, factor);
+                            failures++;
+                        }
+                    }
+                }
+
+                randomBytes(a, sizeof(a), seed);
+                randomBytes(b, sizeof(b), seed);
+                memcpy(expect, a, sizeof(a));
+                referenceAdd(expect + dstOffset, src, bytes);
+                PixelKernels::addSaturate(dst, src, bytes);
+                if (memcmp(a, expect, sizeof(a)) != 0) {
+                    printf("FAIL add dst+%u src+%u bytes %u\n", dstOffset, srcOffset, bytes);
+                    failures++;
+                }
+
+                if (srcOffset == 0 && bytes % 3 == 0) {
+                    uint8_t grb[3];
+                    randomBytes(grb, 3, seed);
+                    randomBytes(a, sizeof(a), seed);
+                    memcpy(expect, a, sizeof(a));
+                    for (uint16_t i = 0; i < bytes; i++) expect[dstOffset + i] = grb[i % 3];
+                    PixelKernels::fill(dst, bytes / 3, grb);
+                    if (memcmp(a, expect, sizeof(a)) != 0) {
+                        printf("FAIL fill dst+%u pixels %u\n", dstOffset, bytes / 3);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief 在各种起始偏移上比较编译期展开的fill<Count>与fill()
+ * @return 不一致的用例数
+ */
+template <uint16_t Count>
+static int verifyFixedFill(uint32_t& seed) {
+    int failures = 0;
+    static uint8_t a[Count * 3 + 8], expect[Count * 3 + 8];
+    for (uint8_t offset = 0; offset < 4; offset++) {
+        uint8_t grb[3];
+        randomBytes(grb, 3, seed);
+        randomBytes(a, sizeof(a), seed);
+        memcpy(expect, a, sizeof(a));
+        PixelKernels::fill(expect + offset, Count, grb);
+        PixelKernels::fill<Count>(a + offset, grb);
+        if (memcmp(a, expect, sizeof(a)) != 0) {
+            printf("FAIL fill<%u> dst+%u\n", Count, offset);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+static int verifyFixedFills() {
+    uint32_t seed = 54321;
+    return verifyFixedFill<1>(seed) + verifyFixedFill<2>(seed) + verifyFixedFill<5>(seed) +
+           verifyFixedFill<33>(seed) + verifyFixedFill<60>(seed) + verifyFixedFill<396>(seed) +
+           verifyFixedFill<960>(seed);
+}
+
+// ---------------------------------------------------------------------------
+// 计时
+
+/**
+ * @brief 重复执行并返回每次的平均纳秒数
+ */
+template <typename F>
+static double timeNanos(uint32_t iterations, F body) {
+    uint64_t start = sim::hostNanos();
+    for (uint32_t i = 0; i < iterations; i++) body(i);
+    return (double)(sim::hostNanos() - start) / iterations;
+}
+
+static void printRow(uint16_t leds, const char* kernel, double perPixel, double swar) {
+    printf("%6u %-6s %12.1f %12.1f %8.2fx\n", leds, kernel, perPixel, swar, perPixel / swar);
+}
+
+int kernelsMain(int argc, char** argv) {
+    uint32_t iterations = 20000;
+    std::vector<uint16_t> ledCounts = {33, 396, 960};
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--leds") == 0 && i + 1 < argc) {
+            ledCounts.assign(1, (uint16_t)std::min(std::max(1, atoi(argv[++i])), 21845));
+        } else {
+            fprintf(stderr, "usage: lightbelt_native kernels [--iterations N] [--leds N]\n");
+            return 2;
+        }
+    }
+
+    int failures = verifyKernels() + verifyFixedFills();
+    printf("verify: %d failures\n", failures);
+    if (failures) return 1;
+
+    printf("Host ns per call; per-pixel is setPixelColor/byte loops, swar is PixelKernels.\n");
+    printf("%6s %-6s %12s %12s %9s\n", "leds", "kernel", "per-pixel", "swar", "speedup");
+
+    uint32_t checksum = 0;
+    for (uint16_t leds : ledCounts) {
+        uint16_t bytes = leds * 3;
+        Adafruit_NeoPixel strip(leds, 0, NEO_GRB + NEO_KHZ800);
+        std::vector<uint8_t> layer(bytes);
+        uint32_t seed = leds;
+        randomBytes(layer.data(), bytes, seed);
+        uint8_t* pixels = strip.getPixels();
+        randomBytes(pixels, bytes, seed);
+
+        double perPixel = timeNanos(iterations, [&](uint32_t i) {
+            for (uint16_t n = 0; n < leds; n++) strip.setPixelColor(n, i & 0xFFFFFF);
+        });
+        double swar = timeNanos(iterations, [&](uint32_t i) {
+            uint8_t grb[3] = {(uint8_t)(i >> 8), (uint8_t)(i >> 16), (uint8_t)i};
+            PixelKernels::fill(pixels, leds, grb);
+        });
+        checksum += pixels[bytes - 1];
+        printRow(leds, "fill", perPixel, swar);
+
+        perPixel = timeNanos(iterations, [&](uint32_t i) { referenceScale(pixels, bytes, 255 - (i & 1)); });
+        swar = timeNanos(iterations, [&](uint32_t i) { PixelKernels::scale(pixels, bytes, 255 - (i & 1)); });
+        checksum += pixels[bytes - 1];
+        printRow(leds, "scale", perPixel, swar);
+
+        perPixel = timeNanos(iterations, [&](uint32_t i) { referenceBlend(pixels, layer.data(), bytes, 1 + (i & 127)); });
+        swar = timeNanos(iterations, [&](uint32_t i) { PixelKernels::blend(pixels, layer.data(), bytes, 1 + (i & 127)); });
+        checksum += pixels[bytes - 1];
+        printRow(leds, "blend", perPixel, swar);
+
+        perPixel = timeNanos(iterations, [&](uint32_t) { referenceAdd(pixels, layer.data(), bytes); });
+        swar = timeNanos(iterations, [&](uint32_t) { PixelKernels::addSaturate(pixels, layer.data(), bytes); });
+        checksum += pixels[bytes - 1];
+        printRow(leds, "add", perPixel, swar);
+    }
+
+    // 输出校验和，避免编译器把结果未被使用的循环优化掉
+    printf("checksum %u\n", checksum);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file latency.cpp
+ * @brief 命令到执行的延迟：按main.cpp的loop()运行，以固定频率发送带编号的命令，收集Trace回显
+ *
+ * @details 开启总线计时（sim::setBusTiming）和延迟追踪回显（Trace|1），每条命令加"@编号 "前缀。
+ * 设备侧的解析、效果、舵机、灯带延迟取自回显，往返时间为发送到收到回显的模拟时间，
+ * 加上命令和回显两行按--baud计算的串口传输时间（替身的串口本身不计时）。
+ * Follow行每条命令都是新的Follow参数；FollowT行发送同样的带时间戳样本，延迟含抖动缓冲区的回放延迟（默认100ms）；
+ * Mode行每秒在Rainbow和Heatup之间切换一次。
+ */
+
+#include <math.h>
+#include <map>
+#include <algorithm>
+#include "Rig.h"
+#include "NativeTools.h"
+
+struct LatencySamples {
+    std::vector<uint32_t> parse;
+    std::vector<uint32_t> servo;
+    std::vector<uint32_t> led;
+    std::vector<uint32_t> roundTrip;
+};
+
+static uint32_t percentile(std::vector<uint32_t>& values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+/**
+ * @brief 从捕获的输出中取出Trace回显，计入样本
+ */
+static void collectReplies(const std::string& output, std::map<uint32_t, uint64_t>& sent, uint32_t baud,
+                           LatencySamples& samples) {
+    size_t pos = 0;
+    while ((pos = output.find("Trace|", pos)) != std::string::npos) {
+        size_t end = output.find('\n', pos);
+        if (end == std::string::npos) end = output.size();
+        unsigned id, parse, effect, servo, led;
+        if (sscanf(output.c_str() + pos, "Trace|%u|%u|%u|%u|%u", &id, &parse, &effect, &servo, &led) == 5) {
+            std::map<uint32_t, uint64_t>::iterator it = sent.find(id);
+            if (it != sent.end()) {
+                // it->second已提前了命令的传输时间
+                uint32_t replyWire = (uint32_t)((end - pos + 1) * 10 * 1000000ULL / baud);
+                samples.parse.push_back(parse);
+                samples.servo.push_back(servo);
+                samples.led.push_back(led);
+                samples.roundTrip.push_back((uint32_t)(sim::nowMicros() - it->second) + replyWire);
+                sent.erase(it);
+            }
+        }
+        pos = end;
+    }
+}
+
+int latencyMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native latency [--seconds N] [--rate HZ] [--baud N] [--internal-pwm] [--mode Follow|FollowT|Mode]\n";
+    uint32_t seconds = 10;
+    uint32_t rate = 50;
+    uint32_t baud = 115200;
+    bool internalPWM = false;
+    const char* onlyMode = NULL;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--rate") == 0 && hasValue) {
+            rate = std::min(std::max(1, atoi(argv[++i])), 1000);
+        } else if (strcmp(argv[i], "--baud") == 0 && hasValue) {
+            baud = std::max(1200, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--internal-pwm") == 0) {
+            internalPWM = true;
+        } else if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            onlyMode = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    printf("12x33 LEDs, 6 %s servo layers, serial control at %u baud; bus timing on.\n",
+           internalPWM ? "LEDC" : "PCA9685", baud);
+    printf("Latency from first byte received; rtt adds both lines' UART time. Values are p50/p95/max in us.\n");
+    printf("%-7s %6s %20s %20s %20s %20s\n", "stream", "cmds", "parse", "servo", "led", "rtt");
+
+    const char* streams[3] = {"Follow", "FollowT", "Mode"};
+    for (const char* stream : streams) {
+        if (onlyMode && strcmp(onlyMode, stream) != 0) continue;
+        bool timestamped = strcmp(stream, "FollowT") == 0;
+        bool follow = timestamped || strcmp(stream, "Follow") == 0;
+
+        RigConfig config = {false, internalPWM, 12, 33, 6, 5000};
+        Rig rig(config);
+        rig.command(follow ? "Follow|512|512|512|512|512|512" : "Rainbow");
+        rig.command("Trace|1");
+        for (int i = 0; i < 100; i++) rig.stepGoverned();
+
+        sim::setOutputCapture(true);
+        sim::takeOutput();
+        sim::setBusTiming(true);
+        LatencySamples samples;
+        std::map<uint32_t, uint64_t> sent;
+        uint32_t period = 1000000 / (follow ? rate : 1);
+        uint64_t start = sim::nowMicros();
+        uint64_t end = start + seconds * 1000000ULL;
+        uint64_t nextSend = start;
+        uint32_t id = 0;
+        while (sim::nowMicros() < end) {
+            if (sim::nowMicros() >= nextSend) {
+                char line[64];
+                if (follow) {
+                    int values[6];
+                    uint32_t t = sim::nowMicros() / 1000;
+                    for (int i = 0; i < 6; i++) {
+                        values[i] = 512 + (int)(511 * sin((t + i * 300) * 2 * M_PI / 3000));
+                    }
+                    if (timestamped) {
+                        snprintf(line, sizeof(line), "@%u FollowT|%u|%d|%d|%d|%d|%d|%d", id, t,
+                                 values[0], values[1], values[2], values[3], values[4], values[5]);
+                    } else {
+                        snprintf(line, sizeof(line), "@%u Follow|%d|%d|%d|%d|%d|%d", id,
+                                 values[0], values[1], values[2], values[3], values[4], values[5]);
+                    }
+                } else {
+                    snprintf(line, sizeof(line), "@%u %s", id, id % 2 ? "Rainbow" : "Heatup");
+                }
+                // 替身立即收到整行，发送时刻按串口传输时间提前
+                sent[id] = sim::nowMicros() - (strlen(line) + 1) * 10 * 1000000ULL / baud;
+                rig.command(line);
+                id++;
+                nextSend += period;
+            }
+            rig.stepGoverned();
+            collectReplies(sim::takeOutput(), sent, baud, samples);
+        }
+        sim::setBusTiming(false);
+        sim::setOutputCapture(false);
+
+        char columns[4][32];
+        std::vector<uint32_t>* series[4] = {&samples.parse, &samples.servo, &samples.led, &samples.roundTrip};
+        for (int c = 0; c < 4; c++) {
+            std::vector<uint32_t>& values = *series[c];
+            snprintf(columns[c], sizeof(columns[c]), "%u/%u/%u", percentile(values, 0.5), percentile(values, 0.95),
+                     values.empty() ? 0 : *std::max_element(values.begin(), values.end()));
+        }
+        printf("%-7s %6zu %20s %20s %20s %20s\n", stream, samples.servo.size(),
+               columns[0], columns[1], columns[2], columns[3]);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file main.cpp
+ * @brief 上位机工具入口（[env:native]）
+ *
+ * @details 使用tools/native/stubs中的硬件替身编译src/下的固件源码（main.cpp除外），
+ * 在电脑上以模拟时钟运行控制器。
+ *
+ * 编译：pio run -e native，生成.pio/build/native/program
+ * 或直接：g++ -std=gnu++17 -O2 -Iinclude -Itools/native/stubs -Itools/native -Itools/host \
+ *           $(find src tools/native -name '*.cpp' ! -path src/main.cpp) -o lightbelt_native
+ *
+ * 用法：
+ *   lightbelt_native bench [--csv] [--frames N] [--mode 模式]    各模式每帧CPU时间和总线开销
+ *   lightbelt_native golden record|check|budgets [--dir 目录]     黄金输出回归与每帧开销预算
+ *   lightbelt_native parse [--count N]                             命令解析吞吐量
+ *   lightbelt_native fuzz [--corpus 目录] [--iterations N]          命令解析模糊测试
+ *   lightbelt_native plan [--layers N] [--leds N] [--servo-layers N] 指定配置下的可达帧率和瓶颈
+ *   lightbelt_native kernels [--iterations N] [--leds N]            像素内核与逐像素写法的耗时对比
+ *   lightbelt_native effect compile|bench [文件...]                 用户效果的编译和吞吐量
+ *   lightbelt_native skew [--i2c-clock HZ] [--mode 模式]             舵机与灯带输出的生效时间差
+ *   lightbelt_native governor [--seconds N] [--mode 模式]             空闲调速下各模式的帧率和估算能耗
+ *   lightbelt_native schedule [--seconds N] [--mode 模式]             命令、舵机、灯带任务的实际周期、延迟和耗时
+ *   lightbelt_native latency [--rate HZ] [--baud N]                   命令到舵机和灯带输出的延迟和往返时间
+ *   lightbelt_native serve [--baud N] [--link PATH]                   在伪终端上实时运行固件，供tools/loadgen连接
+ *   lightbelt_native stream [--baud N] [--keyframe N]                 串口像素流各编码的可达帧率，逐帧核对解码结果
+ *   lightbelt_native dmx [--fps N] [--loopback] [--capture FILE]      E1.31/Art-Net接收的帧率，逐帧核对输出，回放pcap抓包
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "NativeTools.h"
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return benchMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "golden") == 0) {
+        return goldenMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "parse") == 0) {
+        return parseBenchMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "fuzz") == 0) {
+        return fuzzMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "plan") == 0) {
+        return planMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "kernels") == 0) {
+        return kernelsMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "effect") == 0) {
+        return effectMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "skew") == 0) {
+        return skewMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "governor") == 0) {
+        return governorMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "schedule") == 0) {
+        return scheduleMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "latency") == 0) {
+        return latencyMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        return serveMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "stream") == 0) {
+        return streamMain(argc - 2, argv + 2);
+    }
+    if (argc >= 2 && strcmp(argv[1], "dmx") == 0) {
+        return dmxMain(argc - 2, argv + 2);
+    }
+
+    fprintf(stderr,
+            "usage: lightbelt_native bench [--csv] [--frames N] [--mode NAME] [--assets DIR]\n"
+            "       lightbelt_native golden record|check|budgets [--dir DIR] [--led-tol N] [--servo-tol N]\n"
+            "       lightbelt_native parse [--count N]\n"
+            "       lightbelt_native fuzz [--corpus DIR] [--iterations N] [--seed S] [--save DIR]\n"
+            "       lightbelt_native plan [--layers N] [--leds N] [--servo-layers N] [--servo pca|ledc] ...\n"
+            "       lightbelt_native kernels [--iterations N] [--leds N]\n"
+            "       lightbelt_native effect compile FILE | bench [FILE...]\n"
+            "       lightbelt_native skew [--frames N] [--i2c-clock HZ] [--pins N] [--mode NAME]\n"
+            "       lightbelt_native governor [--seconds N] [--controller serial|bluetooth] [--mode NAME]\n"
+            "       lightbelt_native schedule [--seconds N] [--internal-pwm] [--mode NAME]\n"
+            "       lightbelt_native latency [--seconds N] [--rate HZ] [--baud N] [--internal-pwm] [--mode Follow|Mode]\n"
+            "       lightbelt_native serve [--baud N] [--internal-pwm] [--link PATH] [--seconds N] [--quiet]\n"
+            "       lightbelt_native stream [--seconds N] [--baud N] [--keyframe N] [--max-fps N] [--content NAME]\n"
+            "       lightbelt_native dmx [--seconds N] [--fps N] [--scenario NAME] [--loopback] [--save|--capture FILE]\n");
+    return 2;
+}
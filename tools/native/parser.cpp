@@ -0,0 +1,334 @@
+/**
+ * @file parser.cpp
+ * @brief 命令解析器的吞吐量基准和模糊测试
+ *
+ * @details parse：逐类命令测量两种控制器的每秒命令数（按Profiler的PROFILE_PARSE阶段计时，
+ * 需要ENABLE_PROFILER）、每条命令的输入和回复字节数。
+ *
+ * fuzz：先完整回放语料目录中的每个文件，再对语料做随机变异（字节翻转、插入分隔符/换行、
+ * 超长行、超大数字、两条输入交错拼接等）。每个输入之后检查：
+ *   1. 控制器仍能响应Lookup并回复状态
+ *   2. 舵机输出不超出合法命令能达到的范围
+ * 建议用-fsanitize=address,undefined编译，内存错误由sanitizer直接报告。每个输入运行前先写入
+ * fuzz-current.txt，进程异常终止时该文件即为触发问题的输入，复现后可加入语料。
+ */
+
+#include <dirent.h>
+#include <algorithm>
+#include "Rig.h"
+#include "NativeTools.h"
+#include "Profiler.h"
+
+static const size_t FUZZ_MAX_INPUT = 4096;
+
+// ---------------------------------------------------------------------------
+// 吞吐量
+
+struct ParseCase {
+    const char* name;
+    const char* line;
+};
+
+static const ParseCase PARSE_CASES[] = {
+    {"Follow", "Follow|100|300|500|700|900|1023"},
+    {"FollowT", "FollowT|123456|100|300|500|700|900|1023"},
+    {"Preset", "Standby"},
+    {"SetBrightness", "SetBrightness|0.8"},
+    {"ReverseAngle", "ReverseAngle|0"},
+    {"FollowDelay", "FollowDelay|40"},
+    {"Telemetry", "Telemetry|0"},
+    {"TimelineKey", "TimelineKey|S|0|0|512|L|0|0|0xFF0000"},
+    {"PaletteStop", "PaletteStop|6|0|0x000000|128|0xFF8800|255|0xFFFFFF"},
+    {"Lookup", "Lookup"},
+    {"Clock", "Clock"},
+    {"Malformed", "NoSuchCommand|1|2"},
+};
+
+int parseBenchMain(int argc, char** argv) {
+    uint32_t count = 2000;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = std::max(1, atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: lightbelt_native parse [--count N]\n");
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    printf("Parse time is host time inside PROFILE_PARSE; bytes are per command.\n");
+    printf("%-9s %-13s %10s %8s %8s %6s %6s\n", "ctrl", "command", "cmd/s", "mean_us", "max_us", "in_B", "out_B");
+
+    for (int controller = 0; controller < 2; controller++) {
+        RigConfig config = {controller == 1, false, 12, 33, 6, 5000};
+        const char* ctrl = controller ? "Bluetooth" : "Serial";
+
+        for (const ParseCase& c : PARSE_CASES) {
+            Rig rig(config);
+            // 每种命令之前回到同一模式，避免上一种命令影响本次效果开销
+            rig.command("Standby");
+            rig.run(2);
+            Profiler::reset();
+
+            sim::BusCounters before = sim::counters();
+            uint64_t inBytes = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                rig.command(c.line);
+                inBytes += strlen(c.line) + (controller && !strchr(c.line, '|') ? 2 : 1);
+                rig.step();
+            }
+            const sim::BusCounters& after = sim::counters();
+            uint64_t outBytes = controller ? after.bluetoothBytes - before.bluetoothBytes
+                                           : after.serialBytes - before.serialBytes;
+
+            const Profiler::StageStats& stats = Profiler::getStats(PROFILE_PARSE);
+            if (stats.count == 0) {
+                printf("%-9s %-13s %10s\n", ctrl, c.name, "no samples (ENABLE_PROFILER off?)");
+                continue;
+            }
+            double meanMicros = (double)stats.totalCycles / stats.count / ESP.getCpuFreqMHz();
+            printf("%-9s %-13s %10.0f %8.2f %8u %6.1f %6.1f\n", ctrl, c.name,
+                   meanMicros > 0 ? 1e6 / meanMicros : 0.0, meanMicros,
+                   Profiler::cyclesToMicros(stats.maxCycles),
+                   (double)inBytes / count, (double)outBytes / count);
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// 模糊测试
+
+static uint64_t fuzzState = 1;
+
+static uint32_t fuzzRandom(uint32_t bound) {
+    // xorshift64*，保证不同平台结果一致
+    fuzzState ^= fuzzState >> 12;
+    fuzzState ^= fuzzState << 25;
+    fuzzState ^= fuzzState >> 27;
+    return (uint32_t)((fuzzState * 2685821657736338717ULL) >> 32) % bound;
+}
+
+static bool writeInput(const std::string& path, const std::string& data) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+    fwrite(data.data(), 1, data.size(), out);
+    fclose(out);
+    return true;
+}
+
+static std::vector<std::string> loadCorpus(const std::string& dir) {
+    std::vector<std::string> names;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return names;
+    while (struct dirent* entry = readdir(d)) {
+        if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+
+    std::vector<std::string> corpus;
+    for (const std::string& name : names) {
+        FILE* in = fopen((dir + "/" + name).c_str(), "rb");
+        if (!in) continue;
+        std::string data;
+        char buf[512];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0) data.append(buf, n);
+        fclose(in);
+        corpus.push_back(data.substr(0, FUZZ_MAX_INPUT));
+    }
+    return corpus;
+}
+
+static std::string randomNumber() {
+    static const char* numbers[] = {
+        "0", "-1", "1023", "1024", "65535", "-32768", "2147483647", "-2147483648",
+        "4294967296", "99999999999999999999", "0x7fffffff", "1e9", "nan", "-0.5", "",
+    };
+    return numbers[fuzzRandom(sizeof(numbers) / sizeof(numbers[0]))];
+}
+
+static std::string mutate(const std::vector<std::string>& corpus) {
+    static const char tokens[] = {'|', '|', '\n', '\r', '\0', '-', '0', '9', 'x', ' ', (char)0xFF};
+    std::string data = corpus[fuzzRandom(corpus.size())];
+    uint32_t rounds = 1 + fuzzRandom(4);
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        size_t pos = data.empty() ? 0 : fuzzRandom(data.size() + 1);
+        switch (fuzzRandom(8)) {
+            case 0:     // 翻转一位
+                if (!data.empty()) data[pos % data.size()] ^= (char)(1 << fuzzRandom(8));
+                break;
+            case 1:     // 插入分隔符、换行或特殊字节
+                data.insert(pos, 1, tokens[fuzzRandom(sizeof(tokens))]);
+                break;
+            case 2:     // 删除一段
+                if (!data.empty()) data.erase(pos % data.size(), 1 + fuzzRandom(16));
+                break;
+            case 3:     // 插入超长片段
+                data.insert(pos, 32 + fuzzRandom(512), "9|A"[fuzzRandom(3)]);
+                break;
+            case 4:     // 插入边界数字
+                data.insert(pos, randomNumber());
+                break;
+            case 5: {   // 重复一段
+                if (data.empty()) break;
+                size_t start = pos % data.size();
+                std::string chunk = data.substr(start, 1 + fuzzRandom(64));
+                data.insert(start, chunk);
+                break;
+            }
+            case 6: {   // 与另一条输入按块交错
+                const std::string& other = corpus[fuzzRandom(corpus.size())];
+                std::string mixed;
+                size_t a = 0, b = 0;
+                while (a < data.size() || b < other.size()) {
+                    size_t n = 1 + fuzzRandom(12);
+                    mixed += data.substr(a, n);
+                    a = std::min(data.size(), a + n);
+                    n = 1 + fuzzRandom(12);
+                    mixed += other.substr(b, n);
+                    b = std::min(other.size(), b + n);
+                }
+                data = mixed;
+                break;
+            }
+            default: {  // 去掉所有换行，使多条命令连成一行
+                data.erase(std::remove(data.begin(), data.end(), '\n'), data.end());
+                break;
+            }
+        }
+    }
+    if (data.size() > FUZZ_MAX_INPUT) data.resize(FUZZ_MAX_INPUT);
+    return data;
+}
+
+/**
+ * @brief 一个被测控制器以及合法命令下舵机输出的范围
+ */
+class FuzzTarget {
+public:
+    explicit FuzzTarget(const RigConfig& config) : rig(config) {
+        low.assign(rig.getServoChannels(), 0xFFFFFFFF);
+        high.assign(rig.getServoChannels(), 0);
+
+        // 两个极限值和两种方向下的输出即为合法范围
+        const char* calibration[] = {
+            "ReverseAngle|0", "Follow|0|0|0|0|0|0", "Follow|1023|1023|1023|1023|1023|1023",
+            "ReverseAngle|1", "Follow|0|0|0|0|0|0", "Follow|1023|1023|1023|1023|1023|1023",
+            "ReverseAngle|0", "Standby",
+        };
+        for (const char* line : calibration) {
+            rig.command(line);
+            rig.run(2);
+            for (uint8_t ch = 0; ch < rig.getServoChannels(); ch++) {
+                low[ch] = std::min(low[ch], sim::servoOutput(ch));
+                high[ch] = std::max(high[ch], sim::servoOutput(ch));
+            }
+        }
+        sim::takeOutput();
+    }
+
+    /**
+     * @return 空字符串表示通过，否则为失败原因
+     */
+    std::string run(const std::string& input) {
+        rig.feedRaw((const uint8_t*)input.data(), input.size());
+        // 蓝牙控制器每帧只读一行，按行数推进足够的帧
+        uint32_t frames = 2 + std::count(input.begin(), input.end(), '\n');
+        rig.run(frames);
+
+        for (uint8_t ch = 0; ch < rig.getServoChannels(); ch++) {
+            uint32_t value = sim::servoOutput(ch);
+            if (value + 1 < low[ch] || value > high[ch] + 1) {
+                char reason[96];
+                snprintf(reason, sizeof(reason), "servo %u output %u outside [%u, %u]",
+                         ch, value, low[ch], high[ch]);
+                return reason;
+            }
+        }
+
+        // 未完成的像素帧超时后丢弃，再结束残留的半行，确认控制器仍能响应
+        rig.run(1, PIXEL_STREAM_TIMEOUT_MS + 10);
+        rig.feedRaw((const uint8_t*)"\n", 1);
+        rig.step();
+        sim::takeOutput();
+        rig.command("Lookup");
+        rig.step();
+        std::string reply = sim::takeOutput();
+        const char* marker = rig.getConfig().bluetooth ? "发送状态: " : "Status sent: ";
+        if (reply.find(marker) == std::string::npos) {
+            return "no reply to Lookup";
+        }
+        return "";
+    }
+
+private:
+    Rig rig;
+    std::vector<uint32_t> low;
+    std::vector<uint32_t> high;
+};
+
+int fuzzMain(int argc, char** argv) {
+    const char* usage = "usage: lightbelt_native fuzz [--corpus DIR] [--iterations N] [--seed S] [--save DIR]\n";
+    std::string corpusDir = "tools/native/corpus";
+    std::string saveDir = ".";
+    uint32_t iterations = 5000;
+    uint64_t seed = 1;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            corpusDir = argv[++i];
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            saveDir = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    std::vector<std::string> corpus = loadCorpus(corpusDir);
+    if (corpus.empty()) {
+        fprintf(stderr, "fuzz: no corpus in %s\n", corpusDir.c_str());
+        return 2;
+    }
+
+    sim::setConsoleEcho(false);
+    sim::setOutputCapture(true);
+    sim::setFilesystemRoot("/tmp");
+
+    std::string currentPath = saveDir + "/fuzz-current.txt";
+    int failures = 0;
+    for (int controller = 0; controller < 2; controller++) {
+        const char* ctrl = controller ? "bluetooth" : "serial";
+        // 同一个控制器连续接收全部输入，前一条输入留下的状态也参与测试
+        FuzzTarget target(RigConfig{controller == 1, false, 12, 33, 6, 5000});
+        fuzzState = seed * 2 + controller + 1;
+
+        uint32_t total = corpus.size() + iterations;
+        for (uint32_t i = 0; i < total; i++) {
+            std::string input = i < corpus.size() ? corpus[i] : mutate(corpus);
+            writeInput(currentPath, input);
+
+            std::string reason = target.run(input);
+            if (!reason.empty()) {
+                char name[64];
+                snprintf(name, sizeof(name), "/fail-%s-%llu-%u.txt", ctrl, (unsigned long long)seed, i);
+                std::string path = saveDir + name;
+                writeInput(path, input);
+                printf("FAIL %s input %u: %s (saved to %s)\n", ctrl, i, reason.c_str(), path.c_str());
+                failures++;
+            }
+        }
+        printf("%s: %zu corpus + %u mutated inputs\n", ctrl, corpus.size(), iterations);
+    }
+
+    remove(currentPath.c_str());
+    printf("fuzz: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file plan.cpp
+ * @brief 容量规划：按给定的层数/LED数/舵机层数运行固件效果，估算各输出通道耗时、可达帧率和瓶颈
+ *
+ * @details 总线计数来自替身（与bench相同），按estimateWireTime()换算为WS2812、I2C和LEDC的占用时间，
+ * 分别对有灯带输出和有舵机输出的帧求平均，得到每次输出的耗时。主循环按Scheduler的周期运行：
+ * 灯带每LED_FRAME_US输出一次，舵机每SERVO_FRAME_US输出一次，输出依次阻塞执行。
+ * 每秒的占用时间（负载）不超过100%时两者都按调度周期输出；超过时各任务一起推迟，帧率按负载等比例下降。
+ * CPU时间只能在上位机上测得，默认不计入；用--cpu-scale给出设备与上位机的耗时比后按每个灯带周期一次计入，
+ * 该比值可用设备上Stats输出的整帧耗时除以同一模式bench的mean_us得到。
+ * 同时输出按setup()顺序估算的从复位到第一帧的时间。--pins把灯带层平均分到多个数据引脚并行输出，
+ * WS2812时间按最长一段计。
+ */
+
+#include <algorithm>
+#include "Rig.h"
+#include "NativeTools.h"
+
+struct PlanStage {
+    const char* name;
+    double micros;
+};
+
+struct PlanResult {
+    double ledMicros;           ///< 每次灯带输出
+    double i2cMicros;           ///< 每次舵机输出
+    double ledcMicros;          ///< 每次舵机输出
+    double cpuMicros;           ///< 每个灯带周期
+    double worstFrameMicros;    ///< 单次update()的最大占用
+};
+
+static PlanResult planScenario(const RigConfig& config, const Scenario& scenario, uint32_t frames,
+                               uint32_t i2cClock, double cpuScale) {
+    Rig rig(config);
+    for (const std::string& line : scenario.setup) {
+        rig.command(line.c_str());
+        rig.step();
+    }
+    rig.run(50);
+
+    // 每步推进一个灯带周期，舵机在到期的步中输出
+    PlanResult result;
+    memset(&result, 0, sizeof(result));
+    uint32_t ledOutputs = 0;
+    uint32_t servoOutputs = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        FrameCost cost = rig.step(LED_FRAME_US / 1000);
+        WireTime wire = estimateWireTime(cost.bus, i2cClock);
+        double cpu = cost.hostNanos / 1000.0 * cpuScale;
+        if (cost.bus.showCalls > 0) {
+            result.ledMicros += wire.ledMicros;
+            ledOutputs++;
+        }
+        if (cost.bus.i2cTransactions > 0 || cost.bus.ledcWrites > 0) {
+            result.i2cMicros += wire.i2cMicros;
+            result.ledcMicros += wire.ledcMicros;
+            servoOutputs++;
+        }
+        result.cpuMicros += cpu;
+        result.worstFrameMicros = std::max(result.worstFrameMicros,
+                                           wire.ledMicros + wire.i2cMicros + wire.ledcMicros + cpu);
+    }
+    if (ledOutputs) result.ledMicros /= ledOutputs;
+    if (servoOutputs) {
+        result.i2cMicros /= servoOutputs;
+        result.ledcMicros /= servoOutputs;
+    }
+    result.cpuMicros /= frames;
+    return result;
+}
+
+int planMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native plan [--layers N] [--leds N] [--servo-layers N] [--servo pca|ledc]\n"
+        "                             [--controller serial|bluetooth] [--pins N] [--mode NAME] [--i2c-clock HZ]\n"
+        "                             [--cpu-scale F] [--frames N] [--assets DIR]\n";
+
+    // 默认值与main.cpp一致
+    int layers = 12;
+    int leds = 33;
+    int servoLayers = 6;
+    int pins = 1;
+    bool internalPWM = false;
+    bool bluetooth = false;
+    const char* modeFilter = NULL;
+    uint32_t i2cClock = 100000;
+    double cpuScale = 0;
+    uint32_t frames = 500;
+    const char* assetDir = "/tmp";
+
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--layers") == 0 && hasValue) {
+            layers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--leds") == 0 && hasValue) {
+            leds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--servo-layers") == 0 && hasValue) {
+            servoLayers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pins") == 0 && hasValue) {
+            pins = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--servo") == 0 && hasValue) {
+            internalPWM = strcmp(argv[++i], "ledc") == 0;
+        } else if (strcmp(argv[i], "--controller") == 0 && hasValue) {
+            bluetooth = strcmp(argv[++i], "bluetooth") == 0;
+        } else if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            modeFilter = argv[++i];
+        } else if (strcmp(argv[i], "--i2c-clock") == 0 && hasValue) {
+            i2cClock = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--cpu-scale") == 0 && hasValue) {
+            cpuScale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--assets") == 0 && hasValue) {
+            assetDir = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    if (layers < 1 || layers > 255 || leds < 1 || leds > 255 || servoLayers < 1 || servoLayers > 8) {
+        fprintf(stderr, "plan: layers and leds must be 1-255, servo layers 1-8 (16 PCA9685 channels)\n");
+        return 2;
+    }
+    if (pins < 1 || pins > LIGHT_BELT_MAX_SEGMENTS || pins > layers) {
+        fprintf(stderr, "plan: LED data pins must be 1-%d and at most the layer count\n", LIGHT_BELT_MAX_SEGMENTS);
+        return 2;
+    }
+    if (internalPWM && servoLayers > 6) {
+        fprintf(stderr, "plan: internal PWM supports at most 6 servo layers (12 LEDC channels)\n");
+        return 2;
+    }
+
+    sim::setConsoleEcho(false);
+    RigConfig config = {bluetooth, internalPWM, (uint8_t)layers, (uint8_t)leds, (uint8_t)servoLayers, 5000,
+                        false, (uint8_t)pins};
+    std::vector<Scenario> scenarios = defaultScenarios(assetDir);
+
+    printf("%s, %s servos, %dx%d LEDs on %d pin%s, %d servo layers, I2C %u Hz%s\n",
+           bluetooth ? "Bluetooth" : "Serial", internalPWM ? "LEDC" : "PCA9685", layers, leds,
+           pins, pins > 1 ? "s" : "", servoLayers,
+           i2cClock, cpuScale > 0 ? "" : ", CPU time not included");
+    printf("Scheduler periods: LED %.1f ms, servo %.1f ms; led_us per LED output, i2c_us/ledc_us per servo output\n",
+           LED_FRAME_US / 1000.0, SERVO_FRAME_US / 1000.0);
+    {
+        Rig rig(config);
+        printf("Boot to first frame: %.1f ms (delays and bus time only, radio stack init not modeled)\n",
+               rig.getBootMicros() / 1000.0);
+    }
+    printf("%-9s %8s %8s %8s %8s %6s %9s %7s %9s  %s\n", "mode", "led_us", "i2c_us", "ledc_us", "cpu_us",
+           "load", "worst_us", "led_fps", "servo_fps", "bottleneck");
+
+    for (const Scenario& scenario : scenarios) {
+        if (modeFilter && strcmp(modeFilter, scenario.name) != 0) continue;
+
+        PlanResult r = planScenario(config, scenario, frames, i2cClock, cpuScale);
+        // 每个通道每秒的占用时间（微秒）
+        PlanStage stages[] = {
+            {"WS2812", r.ledMicros * 1e6 / LED_FRAME_US},
+            {"I2C", r.i2cMicros * 1e6 / SERVO_FRAME_US},
+            {"LEDC", r.ledcMicros * 1e6 / SERVO_FRAME_US},
+            {"CPU", r.cpuMicros * 1e6 / LED_FRAME_US},
+        };
+
+        double busyMicros = 0;
+        const PlanStage* bottleneck = &stages[0];
+        for (const PlanStage& stage : stages) {
+            busyMicros += stage.micros;
+            if (stage.micros > bottleneck->micros) bottleneck = &stage;
+        }
+        double load = busyMicros / 1e6;
+        double slowdown = std::max(1.0, load);
+
+        char limit[48];
+        if (load <= 1.0) {
+            snprintf(limit, sizeof(limit), "scheduler periods");
+        } else {
+            snprintf(limit, sizeof(limit), "%s (%.0f%%)", bottleneck->name, 100.0 * bottleneck->micros / busyMicros);
+        }
+        printf("%-9s %8.0f %8.0f %8.0f %8.0f %5.0f%% %9.0f %7.1f %9.1f  %s\n", scenario.name,
+               r.ledMicros, r.i2cMicros, r.ledcMicros, r.cpuMicros, 100.0 * load, r.worstFrameMicros,
+               1e6 / LED_FRAME_US / slowdown, 1e6 / SERVO_FRAME_US / slowdown, limit);
+    }
+    return 0;
+}
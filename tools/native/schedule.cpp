@@ -0,0 +1,94 @@
+/**
+ * @file schedule.cpp
+ * @brief 多速率调度的效果：按main.cpp的loop()逐帧运行各模式，输出命令、舵机、灯带三个任务的统计
+ *
+ * @details 开启总线计时（sim::setBusTiming），输出耗时按传输时间推进模拟时钟，
+ * 得到的实际周期、开始延迟和耗时与设备上Stats输出的Job行含义一致。
+ * 进入模式后先运行1秒再统计--seconds秒，Follow场景每20ms发送一条新的Follow命令。
+ */
+
+#include <math.h>
+#include "Rig.h"
+#include "NativeTools.h"
+
+int scheduleMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native schedule [--seconds N] [--internal-pwm] [--mode NAME] [--assets DIR]\n";
+    uint32_t seconds = 10;
+    bool internalPWM = false;
+    const char* onlyMode = NULL;
+    const char* assetDir = "/tmp";
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--internal-pwm") == 0) {
+            internalPWM = true;
+        } else if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            onlyMode = argv[++i];
+        } else if (strcmp(argv[i], "--assets") == 0 && hasValue) {
+            assetDir = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    std::vector<Scenario> scenarios = defaultScenarios(assetDir);
+
+    printf("12x33 LEDs, 6 %s servo layers, serial control; bus timing on; servo period %u us, LED period %u us.\n",
+           internalPWM ? "LEDC" : "PCA9685", (unsigned)SERVO_FRAME_US, (unsigned)LED_FRAME_US);
+    printf("%-9s %-6s %8s %8s %8s %8s %8s %8s %8s %6s\n", "mode", "job", "period", "runs/s", "avg_int",
+           "max_int", "avg_late", "max_late", "avg_us", "skip");
+
+    static const char* const JOB_LABELS[JOB_COUNT] = {"comms", "servo", "led"};
+    for (const Scenario& scenario : scenarios) {
+        if (onlyMode && strcmp(scenario.name, onlyMode) != 0) continue;
+        bool follow = strcmp(scenario.name, "Follow") == 0;
+        RigConfig config = {false, internalPWM, 12, 33, 6, 5000};
+        Rig rig(config);
+        for (const std::string& line : scenario.setup) {
+            rig.command(line.c_str());
+            rig.stepGoverned();
+        }
+
+        sim::setBusTiming(true);
+        uint64_t measureStart = sim::nowMicros() + 1000000;
+        uint64_t end = measureStart + seconds * 1000000ULL;
+        uint64_t nextFollow = sim::nowMicros();
+        bool measuring = false;
+        while (sim::nowMicros() < end) {
+            if (!measuring && sim::nowMicros() >= measureStart) {
+                rig.command("Stats");
+                rig.stepGoverned();
+                measuring = true;
+            }
+            if (follow && sim::nowMicros() >= nextFollow) {
+                char line[64];
+                int values[6];
+                uint32_t t = sim::nowMicros() / 1000;
+                for (int i = 0; i < 6; i++) {
+                    values[i] = 512 + (int)(511 * sin((t + i * 300) * 2 * M_PI / 3000));
+                }
+                snprintf(line, sizeof(line), "Follow|%d|%d|%d|%d|%d|%d",
+                         values[0], values[1], values[2], values[3], values[4], values[5]);
+                rig.command(line);
+                nextFollow += 20000;
+            }
+            rig.stepGoverned();
+        }
+        sim::setBusTiming(false);
+
+        const Scheduler& scheduler = rig.getScheduler();
+        for (uint8_t job = 0; job < JOB_COUNT; job++) {
+            const Scheduler::JobStats& s = scheduler.getStats((SchedulerJob)job);
+            uint32_t intervals = s.intervals ? s.intervals : 1;
+            printf("%-9s %-6s %8u %8.1f %8u %8u %8u %8u %8u %6u\n", job == 0 ? scenario.name : "",
+                   JOB_LABELS[job], scheduler.getPeriod((SchedulerJob)job), s.runs / (double)seconds,
+                   (uint32_t)(s.totalInterval / intervals), s.maxInterval, (uint32_t)(s.totalLate / intervals),
+                   s.maxLate, s.runs ? (uint32_t)(s.totalDuration / s.runs) : 0, s.skipped);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file serve.cpp
+ * @brief 在伪终端上实时运行固件：上位机程序（如tools/loadgen）像打开真实串口一样连接
+ *
+ * @details 创建一个伪终端并打印从设备路径，串口控制器的输入输出经主设备端收发。
+ * 模拟时钟跟随实际时间：开启总线计时后灯带和舵机输出按传输时间推进模拟时钟，
+ * 超出实际时间的部分真实地等待，相当于固件阻塞在输出上；不足的部分补上。
+ * 两个方向都按--baud限速（每字节10位），串口回复多于链路能发送的量时在发送队列中积压，
+ * 与设备上TX缓冲区满后的表现一致。主循环的等待按调度器的下一个到期时间，期间有输入立即处理。
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "Rig.h"
+#include "NativeTools.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+static uint64_t wallMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleepMicros(uint64_t us) {
+    struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+}
+
+int serveMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native serve [--baud N] [--internal-pwm] [--link PATH] [--seconds N] [--quiet]\n";
+    uint32_t baud = 115200;
+    bool internalPWM = false;
+    const char* linkPath = NULL;
+    uint32_t seconds = 0;
+    bool quiet = false;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--baud") == 0 && hasValue) {
+            baud = std::max(1200, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--internal-pwm") == 0) {
+            internalPWM = true;
+        } else if (strcmp(argv[i], "--link") == 0 && hasValue) {
+            linkPath = argv[++i];
+        } else if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        fprintf(stderr, "serve: cannot create pseudo-terminal: %s\n", strerror(errno));
+        return 1;
+    }
+    const char* slavePath = ptsname(master);
+
+    // 从设备端设为原始模式，不回显、不转换换行；保持打开，上位机断开时主设备端不会一直报告挂断
+    int slave = open(slavePath, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+        fprintf(stderr, "serve: cannot open %s: %s\n", slavePath, strerror(errno));
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if (linkPath) {
+        unlink(linkPath);
+        if (symlink(slavePath, linkPath) != 0) {
+            fprintf(stderr, "serve: cannot link %s: %s\n", linkPath, strerror(errno));
+            return 1;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    RigConfig config = {false, internalPWM, 12, 33, 6, 5000};
+    Rig rig(config);
+    sim::setOutputCapture(true);
+    sim::takeOutput();
+    sim::setBusTiming(true);
+
+    printf("pty: %s\n", linkPath ? linkPath : slavePath);
+    printf("12x33 LEDs, 6 %s servo layers, serial control at %u baud. Ctrl-C to stop.\n",
+           internalPWM ? "LEDC" : "PCA9685", baud);
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    const double bytesPerMicro = baud / 10.0 / 1e6;
+    const double maxCredit = 256;           // 约等于UART的FIFO，空闲后不会一次放行大量字节
+    double inCredit = 0, outCredit = 0;
+    std::string outQueue;
+    uint64_t inBytes = 0, outBytes = 0;
+    size_t maxQueue = 0;
+
+    uint64_t wallStart = wallMicros();
+    uint64_t simStart = sim::nowMicros();
+    uint64_t lastWall = wallStart;
+    while (!stopRequested) {
+        uint64_t now = wallMicros();
+        if (seconds && now - wallStart >= seconds * 1000000ULL) break;
+
+        // 模拟时钟落后实际时间时补上
+        uint64_t wallElapsed = now - wallStart;
+        uint64_t simElapsed = sim::nowMicros() - simStart;
+        if (simElapsed < wallElapsed) sim::advanceMicros(wallElapsed - simElapsed);
+
+        inCredit = std::min(maxCredit, inCredit + (now - lastWall) * bytesPerMicro);
+        outCredit = std::min(maxCredit, outCredit + (now - lastWall) * bytesPerMicro);
+        lastWall = now;
+
+        // 按波特率接收
+        uint8_t buffer[256];
+        size_t room = std::min(sizeof(buffer), (size_t)inCredit);
+        if (room > 0) {
+            ssize_t n = read(master, buffer, room);
+            if (n > 0) {
+                sim::feedSerial(buffer, n);
+                inCredit -= n;
+                inBytes += n;
+            }
+        }
+
+        rig.step(0);
+        outQueue += sim::takeOutput();
+        if (outQueue.size() > maxQueue) maxQueue = outQueue.size();
+
+        // 按波特率发送，放不下的留在队列中
+        size_t allowed = std::min(outQueue.size(), (size_t)outCredit);
+        if (allowed > 0) {
+            ssize_t n = write(master, outQueue.data(), allowed);
+            if (n > 0) {
+                outQueue.erase(0, n);
+                outCredit -= n;
+                outBytes += n;
+            }
+        }
+
+        // 输出耗时使模拟时钟超前时，真实地等待
+        wallElapsed = wallMicros() - wallStart;
+        simElapsed = sim::nowMicros() - simStart;
+        if (simElapsed > wallElapsed) sleepMicros(simElapsed - wallElapsed);
+
+        // 等到下一个任务到期、有输入或可以继续发送
+        uint32_t wait = rig.getScheduler().untilNext(micros());
+        if (!outQueue.empty()) wait = std::min(wait, (uint32_t)(1 / bytesPerMicro) + 1);
+        if (wait > 0) {
+            struct pollfd pfd = {master, POLLIN, 0};
+            struct timespec timeout = {(time_t)(wait / 1000000), (long)(wait % 1000000) * 1000};
+            ppoll(&pfd, 1, &timeout, NULL);
+        }
+    }
+
+    sim::setBusTiming(false);
+    if (!quiet) {
+        double elapsed = (wallMicros() - wallStart) / 1e6;
+        fprintf(stderr, "serve: %.1f s, %llu bytes in, %llu bytes out, largest reply backlog %zu bytes\n",
+                elapsed, (unsigned long long)inBytes, (unsigned long long)outBytes, maxQueue);
+    }
+    if (linkPath) unlink(linkPath);
+    close(slave);
+    close(master);
+    return 0;
+}
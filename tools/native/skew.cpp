@@ -0,0 +1,98 @@
+/**
+ * @file skew.cpp
+ * @brief 舵机与灯带输出的时间差：开启总线计时后逐帧运行，读取OutputLatch的统计
+ *
+ * @details 替身按estimateWireTime()相同的时序推进模拟时钟（sim::setBusTiming），固件用micros()
+ * 测得的灯带和舵机输出耗时、先后顺序和生效时间差与设备上Stats输出的Skew行含义一致。
+ * Follow场景每帧发送一条新的Follow命令，使舵机每帧都有变化。
+ */
+
+#include <math.h>
+#include "Rig.h"
+#include "NativeTools.h"
+
+static void streamFollow(Rig& rig, uint32_t frame) {
+    char line[64];
+    int values[6];
+    for (int i = 0; i < 6; i++) {
+        values[i] = 512 + (int)(511 * sin((frame * 10 + i * 300) * 2 * M_PI / 3000));
+    }
+    snprintf(line, sizeof(line), "Follow|%d|%d|%d|%d|%d|%d",
+             values[0], values[1], values[2], values[3], values[4], values[5]);
+    rig.command(line);
+}
+
+int skewMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native skew [--frames N] [--i2c-clock HZ] [--pins N] [--mode NAME] [--assets DIR]\n";
+    uint32_t frames = 300;
+    uint32_t i2cClock = 100000;
+    uint8_t pins = 1;
+    const char* onlyMode = NULL;
+    const char* assetDir = "/tmp";
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--frames") == 0 && hasValue) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--i2c-clock") == 0 && hasValue) {
+            i2cClock = std::max(10000, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--pins") == 0 && hasValue) {
+            pins = std::min(std::max(1, atoi(argv[++i])), LIGHT_BELT_MAX_SEGMENTS);
+        } else if (strcmp(argv[i], "--mode") == 0 && hasValue) {
+            onlyMode = argv[++i];
+        } else if (strcmp(argv[i], "--assets") == 0 && hasValue) {
+            assetDir = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    std::vector<Scenario> scenarios = defaultScenarios(assetDir);
+
+    printf("Bus timing on, I2C %u Hz, %u LED pin%s; skew = time between servo and LED outputs taking effect.\n", i2cClock, pins, pins > 1 ? "s" : "");
+    printf("%-5s %-9s %-9s %8s %8s %6s %8s %8s %8s %7s\n",
+           "servo", "layout", "mode", "led_us", "servo_us", "first", "skew_min", "skew_avg", "skew_max", "frames");
+
+    for (int internalPWM = 0; internalPWM < 2; internalPWM++) {
+        for (RigConfig config : defaultConfigs(false, internalPWM)) {
+            config.ledPins = pins;
+            for (const Scenario& scenario : scenarios) {
+                bool follow = strcmp(scenario.name, "Follow") == 0;
+                if (onlyMode ? strcmp(scenario.name, onlyMode) != 0
+                             : !(follow || strcmp(scenario.name, "Rainbow") == 0 || strcmp(scenario.name, "Heatup") == 0)) {
+                    continue;
+                }
+
+                Rig rig(config);
+                Wire.setClock(i2cClock);
+                sim::setBusTiming(true);
+                for (const std::string& line : scenario.setup) {
+                    rig.command(line.c_str());
+                    rig.step();
+                }
+                rig.command("Stats");
+                rig.step();
+
+                for (uint32_t f = 0; f < frames; f++) {
+                    if (follow) streamFollow(rig, f);
+                    rig.step();
+                }
+                sim::setBusTiming(false);
+
+                const OutputLatch& latch = rig.getOutputLatch();
+                char layout[16];
+                snprintf(layout, sizeof(layout), "%ux%u/%u", config.ledLayers, config.ledsPerLayer, config.servoLayers);
+                const char* first = latch.getFrames() == 0 ? "-" :
+                                    latch.getLedFirstFrames() * 2 >= latch.getFrames() ? "led" : "servo";
+                printf("%-5s %-9s %-9s %8u %8u %6s %8u %8u %8u %7u\n",
+                       internalPWM ? "ledc" : "pca", layout, scenario.name,
+                       latch.getLedMicros(), latch.getServoMicros(), first,
+                       latch.getMinSkew(), latch.getAverageSkew(), latch.getMaxSkew(), latch.getFrames());
+            }
+        }
+    }
+    Wire.setClock(100000);
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file stream.cpp
+ * @brief 串口像素流：Adalight帧与压缩帧在给定波特率下的可达帧率，并逐帧核对解码结果
+ *
+ * @details 上位机按链路能发送的速度连续发帧（不超过--max-fps），每帧在最后一个字节按--baud到达的时刻
+ * 整帧写入替身串口（替身的串口本身不计时）。每帧解码后把灯带缓冲区与期望的GRB（按输出亮度缩放）比较，
+ * 不一致计入错误。输出的帧为解码的帧减去输出前被下一帧覆盖的帧。
+ */
+
+#include "Rig.h"
+#include "NativeTools.h"
+#include "LightBeltProtocol.h"
+
+/**
+ * @brief 测试画面：按帧号生成整条灯带的RGB
+ */
+struct StreamContent {
+    const char* name;
+    void (*render)(uint32_t frame, uint8_t layers, uint8_t ledsPerLayer, uint8_t* rgb);
+};
+
+static void hueToRgb(uint8_t hue, uint8_t* rgb) {
+    uint8_t sector = hue / 43;
+    uint8_t f = (hue - sector * 43) * 6;
+    uint8_t up = f, down = 255 - f;
+    const uint8_t table[6][3] = {
+        {255, up, 0}, {down, 255, 0}, {0, 255, up}, {0, down, 255}, {up, 0, 255}, {255, 0, down}};
+    memcpy(rgb, table[sector % 6], 3);
+}
+
+// 固定画面：每帧相同
+static void renderStatic(uint32_t, uint8_t layers, uint8_t ledsPerLayer, uint8_t* rgb) {
+    for (uint16_t i = 0; i < layers * ledsPerLayer; i++) {
+        hueToRgb(i * 256 / (layers * ledsPerLayer), rgb + i * 3);
+    }
+}
+
+// 每层一种颜色，缓慢变化
+static void renderLayers(uint32_t frame, uint8_t layers, uint8_t ledsPerLayer, uint8_t* rgb) {
+    for (uint8_t layer = 0; layer < layers; layer++) {
+        uint8_t color[3];
+        hueToRgb(frame + layer * 20, color);
+        for (uint8_t led = 0; led < ledsPerLayer; led++) {
+            memcpy(rgb + (layer * ledsPerLayer + led) * 3, color, 3);
+        }
+    }
+}
+
+// 一条亮带沿灯带移动，背景为暗蓝色
+static void renderWipe(uint32_t frame, uint8_t layers, uint8_t ledsPerLayer, uint8_t* rgb) {
+    uint16_t count = layers * ledsPerLayer;
+    uint16_t head = (frame * 3) % count;
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t distance = (head + count - i) % count;
+        uint8_t level = distance < 16 ? 255 - distance * 15 : 0;
+        rgb[i * 3] = level;
+        rgb[i * 3 + 1] = level / 2;
+        rgb[i * 3 + 2] = 32;
+    }
+}
+
+// 黑色背景上随机闪烁的少量LED
+static void renderSparkle(uint32_t frame, uint8_t layers, uint8_t ledsPerLayer, uint8_t* rgb) {
+    uint16_t count = layers * ledsPerLayer;
+    memset(rgb, 0, count * 3);
+    uint32_t seed = frame * 2654435761u;
+    for (uint8_t n = 0; n < 12; n++) {
+        seed = seed * 1103515245 + 12345;
+        uint16_t i = (seed >> 16) % count;
+        rgb[i * 3] = rgb[i * 3 + 1] = rgb[i * 3 + 2] = 200 + n * 4;
+    }
+}
+
+// 彩虹沿灯带滚动，每帧全部LED都变化
+static void renderScroll(uint32_t frame, uint8_t layers, uint8_t ledsPerLayer, uint8_t* rgb) {
+    for (uint16_t i = 0; i < layers * ledsPerLayer; i++) {
+        hueToRgb(i * 2 + frame * 5, rgb + i * 3);
+    }
+}
+
+static const StreamContent CONTENTS[] = {
+    {"Static", renderStatic},
+    {"Layers", renderLayers},
+    {"Wipe", renderWipe},
+    {"Sparkle", renderSparkle},
+    {"Scroll", renderScroll},
+};
+
+/**
+ * @brief 灯带缓冲区是否等于期望画面（GRB，按输出亮度缩放）
+ */
+static bool matches(LightBelt& belt, const uint8_t* rgb) {
+    uint16_t scale = belt.getOutputBrightness() + 1;
+    const uint8_t* pixels = belt.getPixelBuffer();
+    for (uint16_t i = 0; i < belt.getLedCount(); i++) {
+        if (pixels[i * 3] != ((rgb[i * 3 + 1] * scale) >> 8) || pixels[i * 3 + 1] != ((rgb[i * 3] * scale) >> 8) ||
+            pixels[i * 3 + 2] != ((rgb[i * 3 + 2] * scale) >> 8)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int streamMain(int argc, char** argv) {
+    const char* usage =
+        "usage: lightbelt_native stream [--seconds N] [--baud N] [--keyframe N] [--max-fps N] [--content NAME]\n";
+    uint32_t seconds = 5;
+    uint32_t baud = 115200;
+    uint32_t keyframeInterval = 30;
+    uint32_t maxFps = 100;
+    const char* onlyContent = NULL;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            seconds = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--baud") == 0 && hasValue) {
+            baud = std::max(1200, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--keyframe") == 0 && hasValue) {
+            keyframeInterval = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--max-fps") == 0 && hasValue) {
+            maxFps = std::min(std::max(1, atoi(argv[++i])), 1000);
+        } else if (strcmp(argv[i], "--content") == 0 && hasValue) {
+            onlyContent = argv[++i];
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 2;
+        }
+    }
+
+    sim::setConsoleEcho(false);
+    printf("12x33 LEDs, serial at %u baud, host capped at %u fps, keyframe every %u frames.\n",
+           baud, maxFps, keyframeInterval);
+    printf("%-8s %-10s %8s %8s %10s %6s %8s\n", "content", "encoding", "sent/s", "shown/s", "bytes/fr", "key%",
+           "errors");
+
+    int failures = 0;
+    for (const StreamContent& content : CONTENTS) {
+        if (onlyContent && strcmp(onlyContent, content.name) != 0) continue;
+        for (int compressed = 0; compressed < 2; compressed++) {
+            RigConfig config = {false, false, 12, 33, 6, 5000};
+            Rig rig(config);
+            for (int i = 0; i < 20; i++) rig.stepGoverned();
+
+            sim::setOutputCapture(true);
+            sim::setBusTiming(true);
+            LightBelt& belt = rig.getBelt();
+            uint16_t count = belt.getLedCount();
+            std::vector<uint8_t> rgb(count * 3);
+            lightbelt::PixelEncoder encoder(count, keyframeInterval);
+
+            uint64_t start = sim::nowMicros();
+            uint64_t end = start + seconds * 1000000ULL;
+            uint64_t minPeriod = 1000000 / maxFps;
+            uint64_t sendStart = start;
+            uint32_t frames = 0, keyframes = 0, errors = 0;
+            uint64_t totalBytes = 0;
+            std::string frame;
+            uint64_t arrival = 0;
+            bool check = false;
+            bool keyframe = false;
+            while (sim::nowMicros() < end) {
+                if (frame.empty()) {
+                    content.render(frames, 12, 33, &rgb[0]);
+                    frame = compressed ? encoder.encode(&rgb[0]) : lightbelt::adalight(&rgb[0], count);
+                    keyframe = !compressed || encoder.lastWasKeyframe();
+                    arrival = sendStart + frame.size() * 10 * 1000000ULL / baud;
+                }
+                if (sim::nowMicros() >= arrival) {
+                    rig.feedRaw((const uint8_t*)frame.data(), frame.size());
+                    totalBytes += frame.size();
+                    frames++;
+                    if (keyframe) keyframes++;
+                    sendStart = std::max(arrival, sendStart + minPeriod);
+                    frame.clear();
+                    check = true;
+                }
+                rig.step(0);
+                sim::takeOutput();
+                if (check && !matches(belt, &rgb[0])) errors++;
+                check = false;
+
+                // 与主循环相同，等到下一个任务到期，期间收到数据立即返回
+                uint64_t wake = sim::nowMicros() + rig.getScheduler().untilNext(micros());
+                if (!frame.empty()) wake = std::min(wake, arrival);
+                if (wake > sim::nowMicros()) sim::advanceMicros(wake - sim::nowMicros());
+            }
+            sim::setBusTiming(false);
+            sim::setOutputCapture(false);
+
+            const PixelStream* stream = rig.getPixelStream();
+            double elapsed = seconds;
+            uint32_t shown = stream->getFrames() - stream->getOverwritten();
+            printf("%-8s %-10s %8.1f %8.1f %10.0f %5.0f%% %8u\n", content.name, compressed ? "compressed" : "adalight",
+                   frames / elapsed, shown / elapsed, frames ? (double)totalBytes / frames : 0,
+                   frames ? 100.0 * keyframes / frames : 0, errors);
+            if (errors) failures++;
+        }
+    }
+    return failures ? 1 : 0;
+}
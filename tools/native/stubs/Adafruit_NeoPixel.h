@@ -0,0 +1,56 @@
+#ifndef STUB_ADAFRUIT_NEOPIXEL_H
+#define STUB_ADAFRUIT_NEOPIXEL_H
+
+/**
+ * @file Adafruit_NeoPixel.h
+ * @brief Adafruit_NeoPixel替身：像素缓冲区与亮度缩放与原库一致，show()只计数
+ */
+
+#include "Arduino.h"
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+typedef uint16_t neoPixelType;
+
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t p = 6, neoPixelType t = NEO_GRB + NEO_KHZ800);
+    Adafruit_NeoPixel();
+    Adafruit_NeoPixel(const Adafruit_NeoPixel& other);
+    Adafruit_NeoPixel& operator=(const Adafruit_NeoPixel& other);
+    ~Adafruit_NeoPixel();
+
+    void begin() {}
+    void setPin(int16_t p) { pin = p; }
+    void show();
+    bool canShow() const { return true; }
+    void updateLength(uint16_t n);
+
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+    void setPixelColor(uint16_t n, uint32_t c);
+    uint32_t getPixelColor(uint16_t n) const;
+    void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+    void clear();
+
+    void setBrightness(uint8_t b);
+    uint8_t getBrightness() const { return brightness - 1; }
+
+    uint8_t* getPixels() const { return pixels; }
+    uint16_t numPixels() const { return numLEDs; }
+    int16_t getPin() const { return pin; }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+
+protected:
+    // 与原库一致为protected，派生类可以改用外部缓冲区
+    uint16_t numLEDs;
+    uint16_t numBytes;
+    int16_t pin;
+    uint8_t brightness;     ///< 与原库相同，保存值为亮度+1，0表示未缩放
+    uint8_t* pixels;        ///< GRB顺序
+};
+
+#endif
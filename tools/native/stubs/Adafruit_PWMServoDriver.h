@@ -0,0 +1,28 @@
+#ifndef STUB_ADAFRUIT_PWM_SERVO_DRIVER_H
+#define STUB_ADAFRUIT_PWM_SERVO_DRIVER_H
+
+/**
+ * @file Adafruit_PWMServoDriver.h
+ * @brief PCA9685替身：按原库的寄存器写入方式产生I2C传输，并记录每个通道的输出值
+ */
+
+#include "Wire.h"
+
+class Adafruit_PWMServoDriver {
+public:
+    Adafruit_PWMServoDriver(uint8_t addr = 0x40, TwoWire& i2c = Wire) : address(addr), wire(&i2c) {}
+
+    bool begin(uint8_t prescale = 0);
+    void reset();
+    void setPWMFreq(float freq);
+    void setOscillatorFrequency(uint32_t freq) {}
+    uint8_t setPWM(uint8_t num, uint16_t on, uint16_t off);
+
+private:
+    uint8_t address;
+    TwoWire* wire;
+
+    void write8(uint8_t reg, uint8_t value);
+};
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef STUB_ARDUINO_H
+#define STUB_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @brief 上位机构建用的Arduino核心替身，只实现固件用到的部分
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PI 3.1415926535897932384626433832795
+#define HEX 16
+#define DEC 10
+#define IRAM_ATTR
+#define PROGMEM
+#define OUTPUT 1
+#define INPUT 0
+#define HIGH 1
+#define LOW 0
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void yield() {}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+class String {
+public:
+    String() {}
+    String(const char* c) : s(c ? c : "") {}
+    String(const std::string& x) : s(x) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(float v, int digits = 2) { format(v, digits); }
+    String(double v, int digits = 2) { format(v, digits); }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+
+    int indexOf(char c, unsigned from = 0) const { return pos(s.find(c, from)); }
+    int indexOf(const char* c, unsigned from = 0) const { return pos(s.find(c, from)); }
+    int lastIndexOf(char c) const { return pos(s.rfind(c)); }
+
+    String substring(unsigned from) const {
+        return from >= s.size() ? String() : String(s.substr(from));
+    }
+    String substring(unsigned from, unsigned to) const {
+        if (from > to) std::swap(from, to);
+        return from >= s.size() ? String() : String(s.substr(from, to - from));
+    }
+
+    // 与Arduino一致：按atol解析，非数字返回0
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+
+    void trim() {
+        size_t first = s.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            s.clear();
+            return;
+        }
+        size_t last = s.find_last_not_of(" \t\r\n");
+        s = s.substr(first, last - first + 1);
+    }
+
+    bool startsWith(const char* p) const { return s.rfind(p, 0) == 0; }
+    bool startsWith(const String& p) const { return s.rfind(p.s, 0) == 0; }
+    bool endsWith(const char* p) const {
+        size_t n = strlen(p);
+        return s.size() >= n && s.compare(s.size() - n, n, p) == 0;
+    }
+    char charAt(unsigned i) const { return i < s.size() ? s[i] : 0; }
+    char operator[](unsigned i) const { return charAt(i); }
+    bool reserve(unsigned n) { s.reserve(n); return true; }
+
+    bool operator==(const char* c) const { return s == c; }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator!=(const char* c) const { return s != c; }
+    bool operator!=(const String& o) const { return s != o.s; }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+    friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a) + b.s); }
+
+private:
+    std::string s;
+
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    void format(double v, int digits) {
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%.*f", digits, v);
+        s = buf;
+    }
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) write(buffer[i]);
+        return size;
+    }
+    size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str) { return write(str.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return printNumber(v, base); }
+    size_t print(int v, int base = DEC) { return printNumber(v, base); }
+    size_t print(unsigned v, int base = DEC) { return printNumber(v, base); }
+    size_t print(long v, int base = DEC) { return printNumber(v, base); }
+    size_t print(unsigned long v, int base = DEC) { return printNumber(v, base); }
+    size_t print(long long v, int base = DEC) { return printNumber(v, base); }
+    size_t print(unsigned long long v, int base = DEC) { return printNumber((long long)v, base); }
+    size_t print(double v, int digits = 2) {
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%.*f", digits, v);
+        return write(buf);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+    template <typename T> size_t println(T v, int base) { size_t n = print(v, base); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    size_t printNumber(long long v, int base) {
+        char buf[40];
+        snprintf(buf, sizeof(buf), base == HEX ? "%llX" : "%lld", v);
+        return write(buf);
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() { return -1; }
+
+    String readStringUntil(char terminator) {
+        std::string result;
+        while (available()) {
+            int c = read();
+            if (c < 0 || c == terminator) break;
+            result += (char)c;
+        }
+        return String(result);
+    }
+
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t n = 0;
+        while (n < length && available()) buffer[n++] = read();
+        return n;
+    }
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    void flush() {}
+    operator bool() const { return true; }
+    int available() override;
+    int read() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFreeHeap() { return 200000; }
+    void restart() {}
+};
+
+extern EspClass ESP;
+
+// 上位机单线程运行，临界区为空操作
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+// 后台任务在创建时同步执行完毕，任务函数末尾的vTaskDelete(NULL)直接返回
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+
+inline int xTaskCreatePinnedToCore(TaskFunction_t task, const char*, uint32_t, void* arg, unsigned, TaskHandle_t*, int) {
+    task(arg);
+    return 1;
+}
+
+inline void vTaskDelete(TaskHandle_t) {}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef STUB_BLUETOOTH_SERIAL_H
+#define STUB_BLUETOOTH_SERIAL_H
+
+/**
+ * @file BluetoothSerial.h
+ * @brief 蓝牙串口替身：接收数据来自sim::feedBluetooth，发送只计数
+ */
+
+#include "Arduino.h"
+
+class BluetoothSerial : public Stream {
+public:
+    bool begin(const char* name = "ESP32", bool isMaster = false) { return true; }
+    bool hasClient() { return true; }
+    int available() override;
+    int read() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef STUB_FS_H
+#define STUB_FS_H
+
+/**
+ * @file FS.h
+ * @brief 文件系统替身，文件映射到sim::filesystemRoot()下的宿主机文件
+ */
+
+#include "Arduino.h"
+
+namespace fs {
+
+class File {
+public:
+    File() : handle(NULL) {}
+    explicit File(FILE* f) : handle(f) {}
+
+    size_t read(uint8_t* buffer, size_t length) { return handle ? fread(buffer, 1, length, handle) : 0; }
+    size_t write(const uint8_t* buffer, size_t length) { return handle ? fwrite(buffer, 1, length, handle) : 0; }
+    bool seek(uint32_t position) { return handle && fseek(handle, position, SEEK_SET) == 0; }
+    size_t position() const { return handle ? ftell(handle) : 0; }
+    size_t size() const;
+    void close() {
+        if (handle) fclose(handle);
+        handle = NULL;
+    }
+    operator bool() const { return handle != NULL; }
+
+private:
+    FILE* handle;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = "r");
+    bool exists(const char* path);
+    bool remove(const char* path);
+};
+
+}
+
+using fs::File;
+using fs::FS;
+
+#endif
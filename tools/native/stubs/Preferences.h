@@ -0,0 +1,41 @@
+#ifndef STUB_PREFERENCES_H
+#define STUB_PREFERENCES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief NVS键值存储替身，数据保存在内存中，sim::reset()时清空
+ */
+class Preferences {
+public:
+    Preferences() : opened(false), readOnly(false) {}
+
+    bool begin(const char* name, bool readOnly = false);
+    void end() { opened = false; }
+
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    float getFloat(const char* key, float defaultValue = 0);
+    size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+    bool getBool(const char* key, bool defaultValue = false);
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t putString(const char* key, const char* value);
+
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLen);
+    size_t putBytes(const char* key, const void* value, size_t length);
+
+private:
+    const std::vector<uint8_t>* find(const char* key);
+
+    std::string space;
+    bool opened;
+    bool readOnly;
+};
+
+#endif
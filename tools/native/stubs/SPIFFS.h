@@ -0,0 +1,14 @@
+#ifndef STUB_SPIFFS_H
+#define STUB_SPIFFS_H
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false) { return true; }
+    void end() {}
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif
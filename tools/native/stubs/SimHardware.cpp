@@ -0,0 +1,552 @@
+/**
+ * @file SimHardware.cpp
+ * @brief 上位机硬件替身实现
+ */
+
+#include <stdarg.h>
+#include <time.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include "SimHardware.h"
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+#include "Adafruit_PWMServoDriver.h"
+#include "BluetoothSerial.h"
+#include "SPIFFS.h"
+#include "Preferences.h"
+#include "esp_timer.h"
+#include "driver/rmt.h"
+#include "driver/uart.h"
+#include "esp_sleep.h"
+
+static const uint8_t MAX_SERVO_CHANNELS = 16;
+
+static uint64_t simMicros = 0;
+static sim::BusCounters busCounters;
+static std::deque<uint8_t> serialInput;
+static std::deque<uint8_t> bluetoothInput;
+static bool consoleEcho = true;
+static bool outputCapture = false;
+static std::string capturedOutput;
+static std::string filesystemPath = "data";
+static uint8_t i2cDevice = 0x40;
+static uint32_t servoOutputs[MAX_SERVO_CHANNELS];
+static uint8_t pcaRegisters[256];
+static bool busTiming = false;
+static std::map<uint8_t, std::vector<uint8_t>> pinOutputs;
+
+/**
+ * @brief 一个RMT发送通道的替身状态
+ */
+struct RmtChannel {
+    bool installed;
+    uint8_t pin;
+    sample_to_rmt_t translator;
+    size_t pendingBytes;        // 已启动、还没有等待完成的字节数
+};
+static RmtChannel rmtChannels[RMT_CHANNEL_MAX];
+static size_t rmtGroupBytes = 0;    // 本次并行发送中最长一路的字节数
+static uint64_t sleepTimerMicros = 0;
+static esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static std::map<std::string, std::vector<uint8_t>> nvsStorage;
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+SPIFFSFS SPIFFS;
+
+// ---------------------------------------------------------------------------
+// 模拟控制接口
+
+namespace sim {
+
+void reset() {
+    simMicros = 0;
+    memset(&busCounters, 0, sizeof(busCounters));
+    memset(servoOutputs, 0, sizeof(servoOutputs));
+    memset(pcaRegisters, 0, sizeof(pcaRegisters));
+    memset(rmtChannels, 0, sizeof(rmtChannels));
+    rmtGroupBytes = 0;
+    sleepTimerMicros = 0;
+    wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    pinOutputs.clear();
+    serialInput.clear();
+    bluetoothInput.clear();
+    capturedOutput.clear();
+    nvsStorage.clear();
+}
+
+uint64_t nowMicros() { return simMicros; }
+void advanceMicros(uint64_t us) { simMicros += us; }
+BusCounters& counters() { return busCounters; }
+
+void feedSerial(const char* text) { feedSerial((const uint8_t*)text, strlen(text)); }
+
+void feedSerial(const uint8_t* data, size_t length) {
+    serialInput.insert(serialInput.end(), data, data + length);
+}
+
+void feedBluetooth(const char* text) { feedBluetooth((const uint8_t*)text, strlen(text)); }
+
+void feedBluetooth(const uint8_t* data, size_t length) {
+    bluetoothInput.insert(bluetoothInput.end(), data, data + length);
+}
+
+void setConsoleEcho(bool echo) { consoleEcho = echo; }
+void setOutputCapture(bool capture) { outputCapture = capture; }
+
+std::string takeOutput() {
+    std::string out;
+    out.swap(capturedOutput);
+    return out;
+}
+void setFilesystemRoot(const char* path) { filesystemPath = path; }
+const char* filesystemRoot() { return filesystemPath.c_str(); }
+void setI2CDevice(uint8_t address) { i2cDevice = address; }
+
+uint32_t servoOutput(uint8_t channel) {
+    return channel < MAX_SERVO_CHANNELS ? servoOutputs[channel] : 0;
+}
+
+const std::vector<uint8_t>& ledPinOutput(uint8_t pin) { return pinOutputs[pin]; }
+
+void setBusTiming(bool enabled) { busTiming = enabled; }
+
+uint64_t hostNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// Arduino核心
+
+uint32_t millis() { return simMicros / 1000; }
+uint32_t micros() { return (uint32_t)simMicros; }
+void delay(uint32_t ms) { simMicros += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { simMicros += us; }
+int64_t esp_timer_get_time() { return (int64_t)simMicros; }
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution) { return freq; }
+void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    busCounters.ledcWrites++;
+    if (busTiming) simMicros += 1;
+    if (channel < MAX_SERVO_CHANNELS) servoOutputs[channel] = duty;
+}
+
+// 周期计数器使用宿主机时间，按240MHz换算，Profiler统计的是上位机上的实际耗时
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(sim::hostNanos() * 240 / 1000);
+}
+
+size_t Print::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    write(buf);
+    return n;
+}
+
+int HardwareSerial::available() { return serialInput.size(); }
+
+int HardwareSerial::read() {
+    if (serialInput.empty()) return -1;
+    int c = serialInput.front();
+    serialInput.pop_front();
+    return c;
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    busCounters.serialBytes += size;
+    if (consoleEcho) fwrite(buffer, 1, size, stdout);
+    if (outputCapture) capturedOutput.append((const char*)buffer, size);
+    return size;
+}
+
+int BluetoothSerial::available() { return bluetoothInput.size(); }
+
+int BluetoothSerial::read() {
+    if (bluetoothInput.empty()) return -1;
+    int c = bluetoothInput.front();
+    bluetoothInput.pop_front();
+    return c;
+}
+
+size_t BluetoothSerial::write(uint8_t c) { return write(&c, 1); }
+
+size_t BluetoothSerial::write(const uint8_t* buffer, size_t size) {
+    busCounters.bluetoothBytes += size;
+    if (outputCapture) capturedOutput.append((const char*)buffer, size);
+    return size;
+}
+
+// ---------------------------------------------------------------------------
+// NVS（Preferences），键为"命名空间/键名"
+
+bool Preferences::begin(const char* name, bool ro) {
+    space = name;
+    readOnly = ro;
+    opened = true;
+    // 与NVS一致：只读打开不存在的命名空间会失败
+    if (!readOnly) return true;
+    std::string prefix = space + "/";
+    auto it = nvsStorage.lower_bound(prefix);
+    opened = it != nvsStorage.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+    return opened;
+}
+
+const std::vector<uint8_t>* Preferences::find(const char* key) {
+    if (!opened) return NULL;
+    auto it = nvsStorage.find(space + "/" + key);
+    return it == nvsStorage.end() ? NULL : &it->second;
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+    uint8_t value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+    float value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+    return getUChar(key, defaultValue ? 1 : 0) != 0;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    const std::vector<uint8_t>* data = find(key);
+    if (!data || data->size() > maxLen) return 0;
+    memcpy(value, data->data(), data->size());
+    return data->size();
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    return putBytes(key, value, strlen(value) + 1);
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    const std::vector<uint8_t>* data = find(key);
+    return data ? data->size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLen) {
+    const std::vector<uint8_t>* data = find(key);
+    if (!data || data->size() > maxLen) return 0;
+    memcpy(buffer, data->data(), data->size());
+    return data->size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (!opened || readOnly) return 0;
+    const uint8_t* bytes = (const uint8_t*)value;
+    nvsStorage[space + "/" + key].assign(bytes, bytes + length);
+    return length;
+}
+
+// ---------------------------------------------------------------------------
+// I2C与PCA9685
+
+void TwoWire::beginTransmission(uint8_t addr) {
+    address = addr;
+    length = 0;
+    busCounters.i2cBytes++;     // 地址字节
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    busCounters.i2cTransactions++;
+    if (busTiming) simMicros += ((length + 1) * 9 + 2) * 1000000ULL / clock;
+    if (i2cDevice == 0 || address != i2cDevice) return 2;
+
+    // 第一个字节为寄存器地址，之后的数据按自动递增写入；通道的OFF_H写入后更新输出
+    for (uint8_t i = 1; i < length; i++) {
+        uint8_t reg = buffer[0] + i - 1;
+        pcaRegisters[reg] = buffer[i];
+        if (reg >= 0x06 && reg < 0x06 + 4 * MAX_SERVO_CHANNELS && (reg - 0x06) % 4 == 3) {
+            servoOutputs[(reg - 0x06) / 4] = pcaRegisters[reg - 1] | ((pcaRegisters[reg] & 0x0F) << 8);
+        }
+    }
+    return 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    busCounters.i2cBytes++;
+    if (length < sizeof(buffer)) buffer[length++] = data;
+    return 1;
+}
+
+void Adafruit_PWMServoDriver::write8(uint8_t reg, uint8_t value) {
+    wire->beginTransmission(address);
+    wire->write(reg);
+    wire->write(value);
+    wire->endTransmission();
+}
+
+bool Adafruit_PWMServoDriver::begin(uint8_t prescale) {
+    reset();
+    setPWMFreq(1000);
+    return true;
+}
+
+void Adafruit_PWMServoDriver::reset() {
+    write8(0x00, 0x80);
+    delay(10);
+}
+
+void Adafruit_PWMServoDriver::setPWMFreq(float freq) {
+    // 原库：读MODE1、进入睡眠、写预分频、恢复、重启共5次寄存器访问
+    for (uint8_t i = 0; i < 5; i++) {
+        write8(0x00, 0);
+    }
+    delay(5);
+}
+
+uint8_t Adafruit_PWMServoDriver::setPWM(uint8_t num, uint16_t on, uint16_t off) {
+    wire->beginTransmission(address);
+    wire->write(0x06 + 4 * num);
+    wire->write(on);
+    wire->write(on >> 8);
+    wire->write(off);
+    wire->write(off >> 8);
+    return wire->endTransmission();
+}
+
+// ---------------------------------------------------------------------------
+// NeoPixel
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, neoPixelType t)
+    : numLEDs(0), numBytes(0), pin(p), brightness(0), pixels(NULL) {
+    updateLength(n);
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel() : numLEDs(0), numBytes(0), pin(-1), brightness(0), pixels(NULL) {}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(const Adafruit_NeoPixel& other)
+    : numLEDs(0), numBytes(0), pin(other.pin), brightness(other.brightness), pixels(NULL) {
+    updateLength(other.numLEDs);
+    if (pixels) memcpy(pixels, other.pixels, numBytes);
+}
+
+Adafruit_NeoPixel& Adafruit_NeoPixel::operator=(const Adafruit_NeoPixel& other) {
+    if (this != &other) {
+        pin = other.pin;
+        brightness = other.brightness;
+        updateLength(other.numLEDs);
+        if (pixels) memcpy(pixels, other.pixels, numBytes);
+    }
+    return *this;
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() { free(pixels); }
+
+void Adafruit_NeoPixel::updateLength(uint16_t n) {
+    free(pixels);
+    numLEDs = n;
+    numBytes = n * 3;
+    pixels = n ? (uint8_t*)calloc(numBytes, 1) : NULL;
+}
+
+void Adafruit_NeoPixel::show() {
+    busCounters.showCalls++;
+    busCounters.ledBytes += numBytes;
+    busCounters.ledPathBytes += numBytes;
+    if (busTiming) simMicros += numBytes * 10;
+    if (pin >= 0) pinOutputs[pin].assign(pixels, pixels + numBytes);
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+    if (n >= numLEDs) return;
+    if (brightness) {
+        r = (r * brightness) >> 8;
+        g = (g * brightness) >> 8;
+        b = (b * brightness) >> 8;
+    }
+    uint8_t* p = pixels + n * 3;
+    p[0] = g;
+    p[1] = r;
+    p[2] = b;
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+    setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+    if (n >= numLEDs) return 0;
+    const uint8_t* p = pixels + n * 3;
+    // 与原库一致，返回按亮度还原后的近似值
+    if (brightness) {
+        return ((uint32_t)((p[1] << 8) / brightness) << 16) |
+               ((uint32_t)((p[0] << 8) / brightness) << 8) |
+               ((p[2] << 8) / brightness);
+    }
+    return ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8) | p[2];
+}
+
+void Adafruit_NeoPixel::fill(uint32_t c, uint16_t first, uint16_t count) {
+    if (first >= numLEDs) return;
+    uint16_t end = (count == 0 || first + count > numLEDs) ? numLEDs : first + count;
+    for (uint16_t i = first; i < end; i++) setPixelColor(i, c);
+}
+
+void Adafruit_NeoPixel::clear() {
+    if (pixels) memset(pixels, 0, numLEDs * 3);
+}
+
+void Adafruit_NeoPixel::setBrightness(uint8_t b) {
+    // 与原库一致：亮度变化时按新旧比例重新缩放已有像素
+    uint8_t newBrightness = b + 1;
+    if (newBrightness == brightness) return;
+
+    uint8_t oldBrightness = brightness - 1;
+    uint16_t scale;
+    if (oldBrightness == 0) {
+        scale = 0;
+    } else if (b == 255) {
+        scale = 65535 / oldBrightness;
+    } else {
+        scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+    }
+    for (uint16_t i = 0; i < numLEDs * 3; i++) {
+        pixels[i] = (pixels[i] * scale) >> 8;
+    }
+    brightness = newBrightness;
+}
+
+// ---------------------------------------------------------------------------
+// RMT
+
+esp_err_t rmt_config(const rmt_config_t* config) {
+    if (!config || config->channel >= RMT_CHANNEL_MAX || config->rmt_mode != RMT_MODE_TX) return ESP_ERR_INVALID_ARG;
+    // 每个通道占用mem_block_num块内存，不能超出第8块
+    if (config->mem_block_num == 0 || config->channel + config->mem_block_num > RMT_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmtChannels[config->channel].pin = config->gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags) {
+    if (channel >= RMT_CHANNEL_MAX) return ESP_ERR_INVALID_ARG;
+    if (rmtChannels[channel].installed) return ESP_ERR_INVALID_STATE;
+    rmtChannels[channel].installed = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_translator_init(rmt_channel_t channel, sample_to_rmt_t fn) {
+    if (channel >= RMT_CHANNEL_MAX || !rmtChannels[channel].installed || !fn) return ESP_ERR_INVALID_ARG;
+    rmtChannels[channel].translator = fn;
+    return ESP_OK;
+}
+
+esp_err_t rmt_write_sample(rmt_channel_t channel, const uint8_t* src, size_t src_size, bool wait_tx_done) {
+    if (channel >= RMT_CHANNEL_MAX || !rmtChannels[channel].translator) return ESP_ERR_INVALID_STATE;
+    RmtChannel& ch = rmtChannels[channel];
+
+    // 与驱动的中断一样按半块内存（32个脉冲）分批转换，解码回字节
+    std::vector<uint8_t>& out = pinOutputs[ch.pin];
+    out.clear();
+    rmt_item32_t items[32];
+    size_t offset = 0;
+    while (offset < src_size) {
+        size_t translated = 0, count = 0;
+        ch.translator(src + offset, items, src_size - offset, 32, &translated, &count);
+        if (translated == 0 || count != translated * 8) return ESP_FAIL;
+        for (size_t i = 0; i < count; i += 8) {
+            uint8_t value = 0;
+            for (size_t bit = 0; bit < 8; bit++) {
+                const rmt_item32_t& item = items[i + bit];
+                value = (value << 1) | (item.duration0 > item.duration1 ? 1 : 0);
+            }
+            out.push_back(value);
+        }
+        offset += translated;
+    }
+
+    busCounters.ledBytes += src_size;
+    ch.pendingBytes += src_size;
+    if (wait_tx_done) rmt_wait_tx_done(channel, portMAX_DELAY);
+    return ESP_OK;
+}
+
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time) {
+    if (channel >= RMT_CHANNEL_MAX || !rmtChannels[channel].installed) return ESP_ERR_INVALID_ARG;
+    RmtChannel& ch = rmtChannels[channel];
+    rmtGroupBytes = std::max(rmtGroupBytes, ch.pendingBytes);
+    ch.pendingBytes = 0;
+
+    // 所有通道都已完成时本次并行发送结束，耗时为最长一路
+    for (const RmtChannel& other : rmtChannels) {
+        if (other.pendingBytes) return ESP_OK;
+    }
+    if (rmtGroupBytes) {
+        busCounters.showCalls++;
+        busCounters.ledPathBytes += rmtGroupBytes;
+        if (busTiming) simMicros += rmtGroupBytes * 10;
+        rmtGroupBytes = 0;
+    }
+    return ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// 睡眠
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    sleepTimerMicros = time_in_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_uart_wakeup(int uart_num) { return uart_num == 0 ? ESP_OK : ESP_ERR_INVALID_ARG; }
+esp_err_t uart_set_wakeup_threshold(uart_port_t uart_num, int wakeup_threshold) { return ESP_OK; }
+
+esp_err_t esp_light_sleep_start() {
+    if (!serialInput.empty()) {
+        wakeupCause = ESP_SLEEP_WAKEUP_UART;
+    } else {
+        simMicros += sleepTimerMicros;
+        wakeupCause = ESP_SLEEP_WAKEUP_TIMER;
+    }
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return wakeupCause; }
+
+// ---------------------------------------------------------------------------
+// 文件系统
+
+size_t fs::File::size() const {
+    if (!handle) return 0;
+    long current = ftell(handle);
+    fseek(handle, 0, SEEK_END);
+    long end = ftell(handle);
+    fseek(handle, current, SEEK_SET);
+    return end;
+}
+
+fs::File fs::FS::open(const char* path, const char* mode) {
+    std::string full = filesystemPath + path;
+    return File(fopen(full.c_str(), mode[0] == 'w' ? "wb" : (mode[0] == 'a' ? "ab" : "rb")));
+}
+
+bool fs::FS::exists(const char* path) {
+    File f = open(path, "r");
+    bool found = f;
+    f.close();
+    return found;
+}
+
+bool fs::FS::remove(const char* path) {
+    std::string full = filesystemPath + path;
+    return ::remove(full.c_str()) == 0;
+}
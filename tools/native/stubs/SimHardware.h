@@ -0,0 +1,115 @@
+#ifndef SIM_HARDWARE_H
+#define SIM_HARDWARE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * @file SimHardware.h
+ * @brief 上位机硬件替身的控制接口
+ *
+ * @details 替身实现Arduino、Adafruit_NeoPixel、Adafruit_PWMServoDriver、Wire、BluetoothSerial
+ * 、SPIFFS和Preferences中固件用到的部分。时间完全由模拟时钟决定（delay()只推进模拟时钟），
+ * 所有总线访问都计入计数器，便于在不烧录的情况下统计每帧的输出开销。
+ */
+
+namespace sim {
+
+/**
+ * @brief 总线访问计数
+ */
+struct BusCounters {
+    uint32_t showCalls;         ///< strip.show()调用次数
+    uint64_t ledBytes;          ///< 发送到WS2812的字节数
+    uint64_t ledPathBytes;      ///< 多个数据引脚同时发送时每次取最长一路的字节数，决定WS2812传输时间
+    uint32_t i2cTransactions;   ///< I2C传输次数
+    uint64_t i2cBytes;          ///< I2C字节数（含地址字节）
+    uint32_t ledcWrites;        ///< LEDC占空比写入次数
+    uint64_t serialBytes;       ///< 串口发送字节数
+    uint64_t bluetoothBytes;    ///< 蓝牙发送字节数
+};
+
+/**
+ * @brief 复位模拟时钟、计数器、输入队列和NVS内容
+ */
+void reset();
+
+/**
+ * @brief 模拟时钟（微秒）
+ */
+uint64_t nowMicros();
+
+/**
+ * @brief 推进模拟时钟
+ */
+void advanceMicros(uint64_t us);
+
+/**
+ * @brief 当前计数器
+ */
+BusCounters& counters();
+
+/**
+ * @brief 向串口/蓝牙接收队列写入数据
+ */
+void feedSerial(const char* text);
+void feedSerial(const uint8_t* data, size_t length);
+void feedBluetooth(const char* text);
+void feedBluetooth(const uint8_t* data, size_t length);
+
+/**
+ * @brief 串口输出是否同时打印到标准输出（默认打印）
+ */
+void setConsoleEcho(bool echo);
+
+/**
+ * @brief 记录串口和蓝牙的全部输出，供takeOutput()取出（默认不记录）
+ */
+void setOutputCapture(bool capture);
+
+/**
+ * @brief 取出并清空自上次调用以来记录的输出
+ */
+std::string takeOutput();
+
+/**
+ * @brief SPIFFS替身的根目录（默认data，与uploadfs上传的目录一致）
+ */
+void setFilesystemRoot(const char* path);
+const char* filesystemRoot();
+
+/**
+ * @brief 设置I2C总线上应答的设备地址（默认0x40，0表示总线上没有设备）
+ */
+void setI2CDevice(uint8_t address);
+
+/**
+ * @brief 最近一次写入的舵机输出值
+ * @details PCA9685为0-4095计数，LEDC为占空比；未写入过的通道为0
+ */
+uint32_t servoOutput(uint8_t channel);
+
+/**
+ * @brief 最近一次从指定引脚发出的WS2812字节
+ * @details RMT替身把转换函数生成的脉冲按高电平宽度解码回字节，与帧缓冲区中该段的内容比较即可验证分段输出；
+ * Adafruit_NeoPixel替身直接记录缓冲区
+ */
+const std::vector<uint8_t>& ledPinOutput(uint8_t pin);
+
+/**
+ * @brief 总线传输是否推进模拟时钟（默认不推进）
+ * @details 开启后strip.show()按每字节10us（RMT并行输出按最长一路）、I2C传输按每字节9位加起止条件、LEDC写入按1us推进模拟时钟，
+ * 与estimateWireTime()的估算一致，用于测量输出之间的时间差；黄金输出等需要固定时序的场合保持关闭
+ */
+void setBusTiming(bool enabled);
+
+/**
+ * @brief 宿主机单调时钟（纳秒），用于测量CPU耗时
+ */
+uint64_t hostNanos();
+
+}
+
+#endif
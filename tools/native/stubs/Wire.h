@@ -0,0 +1,37 @@
+#ifndef STUB_WIRE_H
+#define STUB_WIRE_H
+
+/**
+ * @file Wire.h
+ * @brief I2C替身：统计传输次数和字节数，设备地址由sim::setI2CDevice决定是否应答，
+ * 写入该设备的数据按PCA9685的寄存器（自动递增）解码为舵机输出
+ */
+
+#include "Arduino.h"
+
+class TwoWire : public Stream {
+public:
+    bool setPins(int sda, int scl) { return true; }
+    bool begin() { return true; }
+    void setClock(uint32_t frequency) { clock = frequency; }
+    uint32_t getClock() const { return clock; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t data) override;
+    using Print::write;
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity) { return 0; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+
+private:
+    uint8_t address = 0;
+    uint32_t clock = 100000;
+    uint8_t buffer[128];        ///< 本次传输的数据（与ESP32的I2C_BUFFER_LENGTH相同）
+    uint8_t length = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
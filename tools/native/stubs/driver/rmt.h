@@ -0,0 +1,84 @@
+#ifndef STUB_DRIVER_RMT_H
+#define STUB_DRIVER_RMT_H
+
+/**
+ * @file driver/rmt.h
+ * @brief ESP-IDF 4.x RMT发送驱动替身
+ *
+ * @details rmt_write_sample()调用注册的转换函数把字节转换为RMT脉冲，再按脉冲宽度解码回字节，
+ * 记录为该引脚最近一次发送的数据（sim::ledPinOutput）。各通道同时传输：
+ * 所有已启动的通道都等待完成后算作一次输出，传输时间按字节数最多的通道计。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+
+typedef int gpio_num_t;
+
+typedef enum {
+    RMT_CHANNEL_0 = 0,
+    RMT_CHANNEL_1,
+    RMT_CHANNEL_2,
+    RMT_CHANNEL_3,
+    RMT_CHANNEL_4,
+    RMT_CHANNEL_5,
+    RMT_CHANNEL_6,
+    RMT_CHANNEL_7,
+    RMT_CHANNEL_MAX
+} rmt_channel_t;
+
+typedef enum {
+    RMT_MODE_TX = 0,
+    RMT_MODE_RX
+} rmt_mode_t;
+
+typedef enum {
+    RMT_IDLE_LEVEL_LOW = 0,
+    RMT_IDLE_LEVEL_HIGH
+} rmt_idle_level_t;
+
+typedef struct {
+    uint32_t carrier_freq_hz;
+    uint32_t carrier_level;
+    rmt_idle_level_t idle_level;
+    uint8_t carrier_duty_percent;
+    uint32_t loop_count;
+    bool carrier_en;
+    bool loop_en;
+    bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    uint32_t flags;
+    rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+typedef union {
+    struct {
+        uint32_t duration0 : 15;
+        uint32_t level0 : 1;
+        uint32_t duration1 : 15;
+        uint32_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_item32_t;
+
+typedef void (*sample_to_rmt_t)(const void* src, rmt_item32_t* dest, size_t src_size, size_t wanted_num,
+                                size_t* translated_size, size_t* item_num);
+
+esp_err_t rmt_config(const rmt_config_t* config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_translator_init(rmt_channel_t channel, sample_to_rmt_t fn);
+esp_err_t rmt_write_sample(rmt_channel_t channel, const uint8_t* src, size_t src_size, bool wait_tx_done);
+esp_err_t rmt_wait_tx_done(rmt_channel_t channel, TickType_t wait_time);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef STUB_DRIVER_UART_H
+#define STUB_DRIVER_UART_H
+
+#include "esp_err.h"
+
+typedef int uart_port_t;
+#define UART_NUM_0 0
+
+/**
+ * @brief 浅睡眠时RX上多少个上升沿唤醒（替身只记录）
+ */
+esp_err_t uart_set_wakeup_threshold(uart_port_t uart_num, int wakeup_threshold);
+
+#endif
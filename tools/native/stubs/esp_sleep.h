@@ -0,0 +1,26 @@
+#ifndef STUB_ESP_SLEEP_H
+#define STUB_ESP_SLEEP_H
+
+/**
+ * @file esp_sleep.h
+ * @brief 浅睡眠替身
+ *
+ * @details esp_light_sleep_start()按定时唤醒时间推进模拟时钟；串口接收队列中已有数据时立即以UART唤醒返回，
+ * 与设备上收到字节即唤醒一致（设备上用于唤醒的字节会丢失，替身不模拟）。
+ */
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_TIMER = 4,
+    ESP_SLEEP_WAKEUP_UART = 8,
+} esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_sleep_enable_uart_wakeup(int uart_num);
+esp_err_t esp_light_sleep_start();
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+
+#endif
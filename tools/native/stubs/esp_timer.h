@@ -0,0 +1,11 @@
+#ifndef STUB_ESP_TIMER_H
+#define STUB_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * @brief 与模拟时钟一致的64位微秒计时
+ */
+int64_t esp_timer_get_time();
+
+#endif
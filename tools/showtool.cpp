@@ -0,0 +1,267 @@
+/**
+ * @file showtool.cpp
+ * @brief 演出文件生成与校验工具（上位机）
+ *
+ * @details 编译：g++ -std=c++11 -O2 -Iinclude tools/showtool.cpp -o showtool
+ *
+ * 用法：
+ *   showtool build <帧文本> <输出.show> [关键帧间隔]   由帧文本生成演出文件
+ *   showtool demo <输出.show> [秒数]                    生成6层舵机/12层灯带的演示演出
+ *   showtool verify <文件.show>                         校验文件结构并输出统计
+ *   showtool dump <文件.show>                           输出为帧文本（可再次build）
+ *
+ * 帧文本格式：第一行为"舵机层数 灯带层数 帧间隔ms"，之后每行一帧，
+ * 依次为各舵机层设定值(0-1023)和各灯带层颜色(十六进制RRGGBB)，以空白分隔，#开头为注释。
+ * 生成的文件放入data/目录后使用`pio run -t uploadfs`上传到SPIFFS分区。
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "ShowFormat.h"
+
+static bool writeShow(const char* path, ShowHeader header, const std::vector<ShowFrame>& frames) {
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    header.frameCount = frames.size();
+    uint8_t raw[SHOW_HEADER_SIZE];
+    showWriteHeader(raw, header);
+    fwrite(raw, 1, sizeof(raw), out);
+
+    ShowFrame prev;
+    memset(&prev, 0, sizeof(prev));
+    uint8_t chunk[SHOW_CHUNK_HEADER_SIZE + SHOW_MAX_PAYLOAD];
+    size_t total = SHOW_HEADER_SIZE;
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        bool keyframe = (i == 0) || (header.keyframeInterval > 0 && i % header.keyframeInterval == 0);
+        uint16_t length = showEncodeFrame(keyframe, header, prev, frames[i], chunk);
+        fwrite(chunk, 1, length, out);
+        total += length;
+        prev = frames[i];
+    }
+
+    uint8_t end[SHOW_CHUNK_HEADER_SIZE] = {SHOW_CHUNK_END, 0, 0};
+    fwrite(end, 1, sizeof(end), out);
+    total += sizeof(end);
+    fclose(out);
+
+    size_t raw_size = frames.size() * (header.servoLayers * 2 + header.lightLayers * 3);
+    printf("%s: %u frames, %zu bytes (uncompressed %zu bytes)\n",
+           path, (unsigned)frames.size(), total, raw_size);
+    return true;
+}
+
+static bool readShow(const char* path, ShowHeader& header, std::vector<ShowFrame>& frames, bool verbose) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    uint8_t raw[SHOW_HEADER_SIZE];
+    if (fread(raw, 1, sizeof(raw), in) != sizeof(raw) || !showParseHeader(raw, header)) {
+        fprintf(stderr, "%s: invalid header\n", path);
+        fclose(in);
+        return false;
+    }
+
+    ShowFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    uint8_t payload[SHOW_MAX_PAYLOAD];
+    size_t keyframes = 0, maxChunk = 0;
+    bool ended = false;
+
+    while (!ended) {
+        uint8_t chunkHeader[SHOW_CHUNK_HEADER_SIZE];
+        if (fread(chunkHeader, 1, sizeof(chunkHeader), in) != sizeof(chunkHeader)) {
+            fprintf(stderr, "%s: missing end chunk after %u frames\n", path, (unsigned)frames.size());
+            fclose(in);
+            return false;
+        }
+        uint16_t length = showRead16(chunkHeader + 1);
+        if (length > SHOW_MAX_PAYLOAD || fread(payload, 1, length, in) != length) {
+            fprintf(stderr, "%s: truncated chunk at frame %u\n", path, (unsigned)frames.size());
+            fclose(in);
+            return false;
+        }
+        if (frames.empty() && chunkHeader[0] != SHOW_CHUNK_KEYFRAME && chunkHeader[0] != SHOW_CHUNK_END) {
+            fprintf(stderr, "%s: first frame is not a keyframe\n", path);
+            fclose(in);
+            return false;
+        }
+
+        uint32_t changed;
+        if (!showApplyChunk(chunkHeader[0], payload, length, header, frame, changed)) {
+            fprintf(stderr, "%s: malformed chunk type 0x%02X at frame %u\n",
+                    path, chunkHeader[0], (unsigned)frames.size());
+            fclose(in);
+            return false;
+        }
+
+        if (chunkHeader[0] == SHOW_CHUNK_END) {
+            ended = true;
+        } else {
+            if (chunkHeader[0] == SHOW_CHUNK_KEYFRAME) keyframes++;
+            if ((size_t)length + SHOW_CHUNK_HEADER_SIZE > maxChunk) maxChunk = length + SHOW_CHUNK_HEADER_SIZE;
+            frames.push_back(frame);
+        }
+    }
+
+    bool trailing = fgetc(in) != EOF;
+    fclose(in);
+
+    if (frames.size() != header.frameCount) {
+        fprintf(stderr, "%s: header says %u frames, found %u\n",
+                path, header.frameCount, (unsigned)frames.size());
+        return false;
+    }
+    if (trailing) {
+        fprintf(stderr, "%s: data after end chunk\n", path);
+        return false;
+    }
+
+    if (verbose) {
+        printf("%s: OK\n", path);
+        printf("  servo layers %u, light layers %u, interval %u ms, keyframe interval %u\n",
+               header.servoLayers, header.lightLayers, header.frameIntervalMs, header.keyframeInterval);
+        printf("  %u frames (%u keyframes), duration %.2f s, largest chunk %zu bytes\n",
+               header.frameCount, (unsigned)keyframes,
+               header.frameCount * header.frameIntervalMs / 1000.0, maxChunk);
+    }
+    return true;
+}
+
+static int cmdBuild(const char* input, const char* output, int keyframeInterval) {
+    FILE* in = fopen(input, "r");
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", input);
+        return 1;
+    }
+
+    ShowHeader header;
+    memset(&header, 0, sizeof(header));
+    std::vector<ShowFrame> frames;
+    char line[4096];
+    bool haveHeader = false;
+    int lineNumber = 0;
+
+    while (fgets(line, sizeof(line), in)) {
+        lineNumber++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') continue;
+
+        if (!haveHeader) {
+            unsigned servo, light, interval;
+            if (sscanf(p, "%u %u %u", &servo, &light, &interval) != 3 ||
+                servo > SHOW_MAX_SERVO_LAYERS || light > SHOW_MAX_LIGHT_LAYERS || interval == 0) {
+                fprintf(stderr, "%s:%d: invalid header line\n", input, lineNumber);
+                fclose(in);
+                return 1;
+            }
+            header.servoLayers = servo;
+            header.lightLayers = light;
+            header.frameIntervalMs = interval;
+            header.keyframeInterval = keyframeInterval;
+            haveHeader = true;
+            continue;
+        }
+
+        ShowFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        for (int i = 0; i < header.servoLayers + header.lightLayers; i++) {
+            char* end;
+            unsigned long v = strtoul(p, &end, i < header.servoLayers ? 10 : 16);
+            if (end == p) {
+                fprintf(stderr, "%s:%d: expected %d values\n", input, lineNumber,
+                        header.servoLayers + header.lightLayers);
+                fclose(in);
+                return 1;
+            }
+            if (i < header.servoLayers) frame.servo[i] = v > 1023 ? 1023 : v;
+            else frame.light[i - header.servoLayers] = v & 0xFFFFFF;
+            p = end;
+        }
+        frames.push_back(frame);
+    }
+    fclose(in);
+
+    if (!haveHeader) {
+        fprintf(stderr, "%s: empty input\n", input);
+        return 1;
+    }
+    return writeShow(output, header, frames) ? 0 : 1;
+}
+
+static int cmdDemo(const char* output, int seconds) {
+    ShowHeader header;
+    header.servoLayers = 6;
+    header.lightLayers = 12;
+    header.frameIntervalMs = 20;
+    header.keyframeInterval = 250;
+
+    std::vector<ShowFrame> frames;
+    int count = seconds * 1000 / header.frameIntervalMs;
+    for (int f = 0; f < count; f++) {
+        ShowFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        double t = f * header.frameIntervalMs / 1000.0;
+
+        // 舵机为自下而上传播的正弦波，灯带颜色随对应舵机高度在蓝色和白色之间变化
+        for (int i = 0; i < header.servoLayers; i++) {
+            double s = 0.5 + 0.5 * sin(2 * M_PI * (t / 4.0 - i / 12.0));
+            frame.servo[i] = (uint16_t)(s * 1023);
+        }
+        for (int i = 0; i < header.lightLayers; i++) {
+            uint8_t level = frame.servo[i * header.servoLayers / header.lightLayers] >> 2;
+            uint8_t white = 255 - level;
+            frame.light[i] = ((uint32_t)white << 16) | (white << 8) | 255;
+        }
+        frames.push_back(frame);
+    }
+    return writeShow(output, header, frames) ? 0 : 1;
+}
+
+static int cmdDump(const char* path) {
+    ShowHeader header;
+    std::vector<ShowFrame> frames;
+    if (!readShow(path, header, frames, false)) return 1;
+
+    printf("%u %u %u\n", header.servoLayers, header.lightLayers, header.frameIntervalMs);
+    for (size_t f = 0; f < frames.size(); f++) {
+        for (int i = 0; i < header.servoLayers; i++) printf("%u ", frames[f].servo[i]);
+        for (int i = 0; i < header.lightLayers; i++) printf("%06X ", frames[f].light[i]);
+        printf("\n");
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "build") == 0) {
+        return cmdBuild(argv[2], argv[3], argc >= 5 ? atoi(argv[4]) : 250);
+    }
+    if (argc >= 3 && strcmp(argv[1], "demo") == 0) {
+        return cmdDemo(argv[2], argc >= 4 ? atoi(argv[3]) : 60);
+    }
+    if (argc >= 3 && strcmp(argv[1], "verify") == 0) {
+        ShowHeader header;
+        std::vector<ShowFrame> frames;
+        return readShow(argv[2], header, frames, true) ? 0 : 1;
+    }
+    if (argc >= 3 && strcmp(argv[1], "dump") == 0) {
+        return cmdDump(argv[2]);
+    }
+
+    fprintf(stderr,
+            "usage: showtool build <frames.txt> <out.show> [keyframe-interval]\n"
+            "       showtool demo <out.show> [seconds]\n"
+            "       showtool verify <file.show>\n"
+            "       showtool dump <file.show>\n");
+    return 2;
+}